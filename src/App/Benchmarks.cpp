@@ -0,0 +1,754 @@
+#include "Benchmarks.h"
+
+#include "CityScene.h"
+#include "LightsScene.h"
+#include "MultiDrawScene.h"
+
+#include <Base/Bvh.hpp>
+#include <Base/DrawList.hpp>
+#include <Base/FrustumCuller.hpp>
+#include <Base/JobSystem.hpp>
+#include <Base/LightClusters.hpp>
+#include <Base/MeshPrimitives.hpp>
+#include <Base/ParallelFor.hpp>
+#include <Base/SceneComponents.hpp>
+#include <Base/Simd.hpp>
+#include <Base/SoftwareRasterizer.hpp>
+#include <Base/TransformHierarchy.hpp>
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace
+{
+
+constexpr auto g_minMeasureNs = 200'000'000ll;
+
+// Repeats function until enough time is measured, returns average milliseconds per call.
+double measureMs(const std::function<void()> & function)
+{
+	// Warm up caches and lazily allocated buffers.
+	function();
+
+	QElapsedTimer timer;
+	timer.start();
+	std::size_t runs = 0;
+	do
+	{
+		function();
+		++runs;
+	} while (timer.nsecsElapsed() < g_minMeasureNs);
+	return static_cast<double>(timer.nsecsElapsed()) / 1e6 / static_cast<double>(runs);
+}
+
+void cullingBenchmark()
+{
+	qInfo() << "SIMD width" << fgl::simd::width << "workers" << fgl::workerCount();
+
+	const auto viewProj = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 1000.f)
+		* glm::lookAt(glm::vec3{0.f, 10.f, 0.f}, glm::vec3{100.f, 0.f, -100.f}, glm::vec3{0.f, 1.f, 0.f});
+	const auto frustum = fgl::Frustum::fromMatrix(viewProj);
+
+	for (const std::size_t count: {10'000u, 100'000u, 1'000'000u, 4'000'000u})
+	{
+		std::mt19937 random{42};
+		std::uniform_real_distribution<float> position{-1000.f, 1000.f};
+		std::uniform_real_distribution<float> size{0.5f, 5.f};
+
+		fgl::BoundsSoA bounds;
+		bounds.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const glm::vec3 center{position(random), position(random) * 0.05f, position(random)};
+			const glm::vec3 extents{size(random), size(random), size(random)};
+			bounds.add(fgl::Aabb{center - extents, center + extents});
+		}
+
+		std::vector<std::uint32_t> visible;
+		for (const auto volume: {fgl::CullVolume::Sphere, fgl::CullVolume::Box})
+		{
+			const auto name = volume == fgl::CullVolume::Sphere ? "sphere" : "box";
+			const auto singleMs = measureMs([&] { fgl::cullFrustum(frustum, bounds, volume, visible); });
+			const auto parallelMs = measureMs([&] { fgl::cullFrustumParallel(frustum, bounds, volume, visible); });
+			const auto millions = static_cast<double>(count) / 1e6;
+			qInfo().noquote() << QString{"%1 objects %2: visible %3 | single thread %4 ms (%5 M objects/ms) | parallel %6 ms (%7 M objects/ms)"}
+									 .arg(count)
+									 .arg(name)
+									 .arg(visible.size())
+									 .arg(singleMs, 0, 'f', 3)
+									 .arg(millions / singleMs, 0, 'f', 2)
+									 .arg(parallelMs, 0, 'f', 3)
+									 .arg(millions / parallelMs, 0, 'f', 2);
+		}
+	}
+}
+
+void bvhBenchmark()
+{
+	qInfo() << "workers" << fgl::workerCount();
+
+	auto mesh = fgl::makeIcosphere(8, glm::vec3{1.f});
+	fgl::displaceAlongNormals(mesh, 0.1f, 6.f);
+
+	fgl::MeshBvh bvh;
+	fgl::BvhBuildOptions options;
+	options.parallel = false;
+	const auto singleBuildMs = measureMs([&] { bvh.build(mesh, options); });
+	options.parallel = true;
+	const auto parallelBuildMs = measureMs([&] { bvh.build(mesh, options); });
+	qInfo().noquote() << QString{"%1 triangles, %2 nodes | build single thread %3 ms | parallel %4 ms"}
+							 .arg(mesh.triangleCount())
+							 .arg(bvh.bvh().nodes().size())
+							 .arg(singleBuildMs, 0, 'f', 1)
+							 .arg(parallelBuildMs, 0, 'f', 1);
+
+	auto deformed = mesh;
+	fgl::displaceAlongNormals(deformed, 0.02f, 3.f);
+	const auto refitMs = measureMs([&] { bvh.refit(deformed); });
+	qInfo().noquote() << QString{"refit %1 ms"}.arg(refitMs, 0, 'f', 1);
+
+	// Primary rays of a camera looking at sphere.
+	constexpr auto g_raysSide = 256;
+	const auto viewProj = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 10.f)
+		* glm::lookAt(glm::vec3{0.f, 0.f, 2.5f}, glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f});
+	const auto inverseViewProj = glm::inverse(viewProj);
+	std::vector<fgl::Ray> rays;
+	for (auto y = 0; y < g_raysSide; ++y)
+	{
+		for (auto x = 0; x < g_raysSide; ++x)
+		{
+			rays.push_back(fgl::rayFromScreen(inverseViewProj, {x + 0.5f, y + 0.5f}, glm::vec2{g_raysSide}));
+		}
+	}
+	std::vector<fgl::RayHit> hits(rays.size());
+	const auto singleRaysMs = measureMs([&] {
+		for (std::size_t i = 0; i < rays.size(); ++i)
+		{
+			hits[i] = bvh.raycast(rays[i]);
+		}
+	});
+	const auto parallelRaysMs = measureMs([&] { bvh.raycast(rays, hits); });
+	const auto hitCount = std::count_if(hits.begin(), hits.end(), [](const auto & hit) { return hit.isHit(); });
+	const auto millionRays = static_cast<double>(rays.size()) / 1e6;
+	qInfo().noquote() << QString{"%1 rays, %2 hits | single thread %3 ms (%4 M rays/s) | parallel %5 ms (%6 M rays/s)"}
+							 .arg(rays.size())
+							 .arg(hitCount)
+							 .arg(singleRaysMs, 0, 'f', 2)
+							 .arg(millionRays / singleRaysMs * 1e3, 0, 'f', 2)
+							 .arg(parallelRaysMs, 0, 'f', 2)
+							 .arg(millionRays / parallelRaysMs * 1e3, 0, 'f', 2);
+
+	const auto frustum = fgl::Frustum::fromMatrix(glm::perspective(glm::radians(30.f), 1.f, 0.1f, 10.f)
+												  * glm::lookAt(glm::vec3{0.f, 0.f, 2.5f}, glm::vec3{0.3f, 0.f, 0.f}, glm::vec3{0.f, 1.f, 0.f}));
+	std::vector<std::uint32_t> visible;
+	const auto queryMs = measureMs([&] { bvh.bvh().queryFrustum(frustum, visible); });
+	qInfo().noquote() << QString{"frustum query %1 ms, %2 triangles"}.arg(queryMs, 0, 'f', 2).arg(visible.size());
+}
+
+void occlusionBenchmark()
+{
+	qInfo() << "SIMD width" << fgl::simd::width << "workers" << fgl::workerCount();
+
+	const auto scene = makeCityScene();
+	CityCuller culler{scene};
+	constexpr auto g_fovY = glm::radians(60.f);
+	constexpr auto g_frames = 240;
+	const auto projection = glm::perspective(g_fovY, 16.f / 9.f, 0.1f, 1000.f);
+
+	struct Configuration
+	{
+		bool occlusion;
+		std::size_t depthWidth;
+		std::size_t depthHeight;
+	};
+	for (const auto & configuration: {Configuration{false, 0, 0}, Configuration{true, 128, 64}, Configuration{true, 256, 128},
+									   Configuration{true, 512, 256}})
+	{
+		CityCullOptions options;
+		options.occlusion = configuration.occlusion;
+		if (configuration.occlusion)
+		{
+			options.depthWidth = configuration.depthWidth;
+			options.depthHeight = configuration.depthHeight;
+		}
+		culler.setOptions(options);
+
+		// Same camera path for every configuration
+		std::vector<std::uint32_t> visible;
+		double frustumVisible = 0.;
+		double visibleSum = 0.;
+		double occluders = 0.;
+		double rasterizeMs = 0.;
+		double testMs = 0.;
+		QElapsedTimer timer;
+		timer.start();
+		for (auto frame = 0; frame < g_frames; ++frame)
+		{
+			const auto camera = cityCamera(scene, static_cast<float>(frame) * 0.5f);
+			culler.cull(projection * camera.view, camera.position, g_fovY, visible);
+			frustumVisible += static_cast<double>(culler.frustumVisible());
+			visibleSum += static_cast<double>(visible.size());
+			occluders += static_cast<double>(culler.occluderCount());
+			rasterizeMs += culler.rasterizeMs();
+			testMs += culler.testMs();
+		}
+		const auto totalMs = static_cast<double>(timer.nsecsElapsed()) / 1e6;
+
+		const auto name = configuration.occlusion ? QString{"occlusion %1x%2"}.arg(configuration.depthWidth).arg(configuration.depthHeight)
+												  : QString{"frustum only"};
+		qInfo().noquote() << QString{"%1: %2 objects, frustum visible %3, drawn %4, occlusion culled %5% | occluders %6, raster %7 ms, test %8 ms, total %9 ms per frame"}
+								 .arg(name)
+								 .arg(scene.objects.size())
+								 .arg(frustumVisible / g_frames, 0, 'f', 0)
+								 .arg(visibleSum / g_frames, 0, 'f', 0)
+								 .arg(100. * (1. - visibleSum / frustumVisible), 0, 'f', 1)
+								 .arg(occluders / g_frames, 0, 'f', 0)
+								 .arg(rasterizeMs / g_frames, 0, 'f', 3)
+								 .arg(testMs / g_frames, 0, 'f', 3)
+								 .arg(totalMs / g_frames, 0, 'f', 3);
+	}
+}
+
+void transformsBenchmark()
+{
+	qInfo() << "workers" << fgl::workerCount();
+
+	// Objects of random shape hierarchies, like skeletons or props attached to each other.
+	constexpr std::size_t g_objects = 10'000;
+	constexpr std::size_t g_nodesPerObject = 20;
+	std::mt19937 random{42};
+	std::uniform_real_distribution<float> offset{-1.f, 1.f};
+	const auto randomLocal = [&] {
+		return glm::rotate(glm::translate(glm::mat4{1.f}, glm::vec3{offset(random), offset(random), offset(random)}),
+						   offset(random), glm::vec3{0.f, 1.f, 0.f});
+	};
+
+	fgl::TransformHierarchy hierarchy;
+	hierarchy.reserve(g_objects * g_nodesPerObject);
+	for (std::size_t object = 0; object < g_objects; ++object)
+	{
+		const auto root = hierarchy.add(randomLocal());
+		for (std::size_t i = 1; i < g_nodesPerObject; ++i)
+		{
+			std::uniform_int_distribution<fgl::TransformHierarchy::Node> parent{root, static_cast<fgl::TransformHierarchy::Node>(root + i - 1)};
+			hierarchy.add(randomLocal(), parent(random));
+		}
+	}
+	hierarchy.updateAll();
+
+	// Several sets of 1% moving nodes cycled by measured updates.
+	constexpr std::size_t g_sets = 16;
+	std::vector<std::vector<fgl::TransformHierarchy::Node>> moving(g_sets);
+	std::uniform_int_distribution<fgl::TransformHierarchy::Node> node{0, static_cast<fgl::TransformHierarchy::Node>(hierarchy.size() - 1)};
+	for (auto & nodes: moving)
+	{
+		nodes.resize(hierarchy.size() / 100);
+		std::generate(nodes.begin(), nodes.end(), [&] { return node(random); });
+	}
+	const auto locals = [&] {
+		std::vector<glm::mat4> result(hierarchy.size() / 100);
+		std::generate(result.begin(), result.end(), randomLocal);
+		return result;
+	}();
+
+	std::size_t set = 0;
+	double changedSum = 0.;
+	std::size_t updates = 0;
+	const auto move = [&] {
+		for (std::size_t i = 0; i < locals.size(); ++i)
+		{
+			hierarchy.setLocal(moving[set][i], locals[i]);
+		}
+		set = (set + 1) % g_sets;
+	};
+	const auto fullMs = measureMs([&] {
+		move();
+		hierarchy.updateAll();
+	});
+	const auto singleMs = measureMs([&] {
+		move();
+		hierarchy.update(false);
+		changedSum += static_cast<double>(hierarchy.changedNodes().size());
+		++updates;
+	});
+	const auto parallelMs = measureMs([&] {
+		move();
+		hierarchy.update(true);
+	});
+	qInfo().noquote() << QString{"%1 nodes, %2 moving, %3 world matrices changed | full update %4 ms | incremental single thread %5 ms | parallel %6 ms"}
+							 .arg(hierarchy.size())
+							 .arg(locals.size())
+							 .arg(changedSum / static_cast<double>(updates), 0, 'f', 0)
+							 .arg(fullMs, 0, 'f', 3)
+							 .arg(singleMs, 0, 'f', 3)
+							 .arg(parallelMs, 0, 'f', 3);
+}
+
+// Separately allocated polymorphic scene node, the usual alternative to components.
+class SceneNode
+{
+public:
+	virtual ~SceneNode() = default;
+	virtual void update() { worldBounds = fgl::transform(localBounds, world); }
+
+	glm::mat4 world{1.f};
+	fgl::Aabb localBounds;
+	fgl::Aabb worldBounds;
+	std::uint32_t mesh = 0;
+	fgl::Material material;
+	std::string name;
+};
+
+void ecsBenchmark()
+{
+	qInfo() << "workers" << fgl::workerCount();
+
+	for (const std::size_t count: {10'000u, 100'000u, 1'000'000u})
+	{
+		std::mt19937 random{42};
+		std::uniform_real_distribution<float> position{-1000.f, 1000.f};
+		const auto randomWorld = [&] {
+			return glm::translate(glm::mat4{1.f}, glm::vec3{position(random), position(random), position(random)});
+		};
+		const fgl::Aabb box{glm::vec3{-1.f}, glm::vec3{1.f}};
+
+		// Half of entities are attached to hierarchy, so there are two archetypes.
+		fgl::World world;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const auto entity = world.create(fgl::Transform{randomWorld()}, fgl::LocalBounds{box}, fgl::WorldBounds{},
+											 fgl::MeshInstance{static_cast<std::uint32_t>(i % 16)}, fgl::Material{});
+			if (i % 2 == 0)
+			{
+				world.add(entity, fgl::TransformNode{});
+			}
+		}
+
+		// Nodes are visited in other order than allocated as in long living scenes.
+		std::vector<std::unique_ptr<SceneNode>> nodes;
+		nodes.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			nodes.push_back(std::make_unique<SceneNode>());
+			nodes.back()->world = randomWorld();
+			nodes.back()->localBounds = box;
+			nodes.back()->name = "node " + std::to_string(i);
+		}
+		std::shuffle(nodes.begin(), nodes.end(), random);
+
+		const auto nodesMs = measureMs([&] {
+			for (const auto & node: nodes)
+			{
+				node->update();
+			}
+		});
+		const auto singleMs = measureMs([&] { fgl::updateWorldBounds(world, false); });
+		const auto parallelMs = measureMs([&] { fgl::updateWorldBounds(world, true); });
+		const auto millions = static_cast<double>(count) / 1e6;
+		qInfo().noquote() << QString{"%1 entities, %2 archetypes | objects %3 ms (%4 M/ms) | ecs single thread %5 ms (%6 M/ms) | parallel %7 ms (%8 M/ms)"}
+								 .arg(count)
+								 .arg(world.archetypeCount())
+								 .arg(nodesMs, 0, 'f', 3)
+								 .arg(millions / nodesMs, 0, 'f', 2)
+								 .arg(singleMs, 0, 'f', 3)
+								 .arg(millions / singleMs, 0, 'f', 2)
+								 .arg(parallelMs, 0, 'f', 3)
+								 .arg(millions / parallelMs, 0, 'f', 2);
+	}
+}
+
+void jobsBenchmark()
+{
+	qInfo() << "hardware threads" << fgl::workerCount();
+
+	// Frame work expressed as task graph:
+	// animation -> bounds -> camera and shadow culling -> draw list.
+	constexpr std::size_t g_count = 1'000'000;
+	constexpr std::size_t g_grain = 1024;
+	std::mt19937 random{42};
+	std::uniform_real_distribution<float> position{-500.f, 500.f};
+	std::vector<glm::vec3> positions(g_count);
+	std::generate(positions.begin(), positions.end(), [&] { return glm::vec3{position(random), 0.f, position(random)}; });
+	const fgl::Aabb box{glm::vec3{-1.f}, glm::vec3{1.f}};
+
+	std::vector<glm::mat4> models(g_count);
+	std::vector<fgl::Aabb> worldBoxes(g_count);
+	std::vector<std::uint8_t> cameraVisible(g_count);
+	std::vector<std::uint8_t> shadowVisible(g_count);
+	std::vector<std::uint64_t> drawList;
+	drawList.reserve(g_count);
+
+	const auto camera = fgl::Frustum::fromMatrix(glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 1000.f)
+												 * glm::lookAt(glm::vec3{0.f, 20.f, 0.f}, glm::vec3{100.f, 0.f, -100.f}, glm::vec3{0.f, 1.f, 0.f}));
+	const auto shadow = fgl::Frustum::fromMatrix(glm::ortho(-300.f, 300.f, -300.f, 300.f, 0.f, 1000.f)
+												 * glm::lookAt(glm::vec3{0.f, 500.f, 0.f}, glm::vec3{0.f}, glm::vec3{0.f, 0.f, -1.f}));
+
+	float time = 0.f;
+	const auto animate = [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			models[i] = glm::rotate(glm::translate(glm::mat4{1.f}, positions[i]), time + static_cast<float>(i), glm::vec3{0.f, 1.f, 0.f});
+		}
+	};
+	const auto bounds = [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			worldBoxes[i] = fgl::transform(box, models[i]);
+		}
+	};
+	const auto cameraCull = [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			cameraVisible[i] = camera.intersects(worldBoxes[i]) ? 1u : 0u;
+		}
+	};
+	const auto shadowCull = [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			shadowVisible[i] = shadow.intersects(worldBoxes[i]) ? 1u : 0u;
+		}
+	};
+	// Serial stage, sorts draws by mesh then object.
+	const auto buildDrawList = [&] {
+		drawList.clear();
+		for (std::size_t i = 0; i < g_count; ++i)
+		{
+			if (cameraVisible[i] != 0u)
+			{
+				drawList.push_back((static_cast<std::uint64_t>(i % 16) << 32u) | i);
+			}
+		}
+		std::sort(drawList.begin(), drawList.end());
+	};
+
+	std::vector<std::size_t> threadCounts;
+	for (std::size_t threads = 1; threads < fgl::workerCount(); threads *= 2)
+	{
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(fgl::workerCount());
+
+	double singleForMs = 0.;
+	double singleFrameMs = 0.;
+	for (const auto threads: threadCounts)
+	{
+		fgl::JobSystem jobs{threads};
+		const auto forMs = measureMs([&] { jobs.parallelFor(g_count, g_grain, animate); });
+		const auto frameMs = measureMs([&] {
+			auto * animation = jobs.createParallelFor(g_count, g_grain, animate);
+			auto * transform = jobs.createParallelFor(g_count, g_grain, bounds);
+			auto * cameraCulling = jobs.createParallelFor(g_count, g_grain, cameraCull);
+			auto * shadowCulling = jobs.createParallelFor(g_count, g_grain, shadowCull);
+			auto * draws = jobs.create(buildDrawList);
+			jobs.addContinuation(animation, transform);
+			jobs.addContinuation(transform, cameraCulling);
+			jobs.addContinuation(transform, shadowCulling);
+			jobs.addContinuation(cameraCulling, draws);
+			jobs.addContinuation(shadowCulling, draws);
+			jobs.run(animation);
+			jobs.wait(draws);
+			time += 0.01f;
+		});
+		if (threads == 1)
+		{
+			singleForMs = forMs;
+			singleFrameMs = frameMs;
+		}
+		qInfo().noquote() << QString{"%1 threads | parallel for %2 ms (x%3) | frame graph %4 ms (x%5), %6 draws"}
+								 .arg(threads)
+								 .arg(forMs, 0, 'f', 2)
+								 .arg(singleForMs / forMs, 0, 'f', 2)
+								 .arg(frameMs, 0, 'f', 2)
+								 .arg(singleFrameMs / frameMs, 0, 'f', 2)
+								 .arg(drawList.size());
+	}
+}
+
+void sortBenchmark()
+{
+	qInfo() << "workers" << fgl::workerCount();
+
+	for (const std::size_t count: {10'000u, 100'000u, 1'000'000u})
+	{
+		std::mt19937_64 random{42};
+		std::uniform_real_distribution<float> unit{0.f, 1.f};
+
+		// Draw keys share most high bits, so radix sort skips their passes.
+		std::vector<fgl::SortItem> drawKeys(count);
+		std::vector<fgl::SortItem> randomKeys(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			fgl::DrawKey key;
+			key.translucent = unit(random) < 0.1f;
+			key.program = static_cast<std::uint32_t>(random() % 8);
+			key.material = static_cast<std::uint32_t>(random() % 256);
+			key.mesh = static_cast<std::uint32_t>(random() % 16);
+			key.depth = unit(random);
+			drawKeys[i] = {key.encode(), static_cast<std::uint32_t>(i)};
+			randomKeys[i] = {random(), static_cast<std::uint32_t>(i)};
+		}
+
+		// Every run sorts a fresh copy, copying is included in all timings.
+		std::vector<fgl::SortItem> items;
+		std::vector<fgl::SortItem> scratch;
+		for (const auto * source: {&drawKeys, &randomKeys})
+		{
+			const auto stdMs = measureMs([&] {
+				items = *source;
+				std::sort(items.begin(), items.end(), [](const auto & lhs, const auto & rhs) { return lhs.key < rhs.key; });
+			});
+			const auto singleMs = measureMs([&] {
+				items = *source;
+				fgl::radixSort(items, scratch, false);
+			});
+			const auto parallelMs = measureMs([&] {
+				items = *source;
+				fgl::radixSort(items, scratch, true);
+			});
+			qInfo().noquote() << QString{"%1 %2 | std::sort %3 ms | radix single thread %4 ms (x%5) | parallel %6 ms (x%7)"}
+									 .arg(count)
+									 .arg(source == &drawKeys ? "draw keys" : "random keys")
+									 .arg(stdMs, 0, 'f', 3)
+									 .arg(singleMs, 0, 'f', 3)
+									 .arg(stdMs / singleMs, 0, 'f', 2)
+									 .arg(parallelMs, 0, 'f', 3)
+									 .arg(stdMs / parallelMs, 0, 'f', 2);
+		}
+	}
+}
+
+// C++ port of multidraw.vs with DRAW_ID and mesh.fs for the software rasterizer.
+class MultiDrawRasterShader final : public fgl::RasterShader
+{
+public:
+	explicit MultiDrawRasterShader(const MultiDrawScene & scene)
+		: scene_(scene)
+	{
+	}
+
+	void setViewProj(const glm::mat4 & viewProj) { viewProj_ = viewProj; }
+
+	std::size_t varyingCount() const override { return 6; }
+
+	glm::vec4 vertex(const std::uint32_t draw, const std::uint32_t vertex, float * varyings) const override
+	{
+		const auto & object = scene_.objects[draw];
+		const auto & mesh = scene_.meshes[object.mesh];
+		const auto normal = glm::mat3{object.model} * mesh.normals[vertex];
+		const auto & color = mesh.colors[vertex];
+		for (auto i = 0; i < 3; ++i)
+		{
+			varyings[i] = normal[i];
+			varyings[i + 3] = color[i];
+		}
+		return viewProj_ * (object.model * glm::vec4{mesh.positions[vertex], 1.f});
+	}
+
+	void fragment(const fgl::simd::Float * varyings, fgl::simd::Float * rgba) const override
+	{
+		const auto lightDir = glm::normalize(glm::vec3{0.4f, 1.f, 0.6f});
+		const auto length = fgl::simd::sqrt(varyings[0] * varyings[0] + varyings[1] * varyings[1] + varyings[2] * varyings[2]);
+		const auto cosine = (varyings[0] * fgl::simd::broadcast(lightDir.x) + varyings[1] * fgl::simd::broadcast(lightDir.y)
+							 + varyings[2] * fgl::simd::broadcast(lightDir.z))
+			/ length;
+		const auto diffuse = fgl::simd::max(cosine, fgl::simd::broadcast(0.f));
+		const auto light = fgl::simd::broadcast(0.25f) + fgl::simd::broadcast(0.75f) * diffuse;
+		for (auto i = 0; i < 3; ++i)
+		{
+			rgba[i] = varyings[i + 3] * light;
+		}
+		rgba[3] = fgl::simd::broadcast(1.f);
+	}
+
+private:
+	const MultiDrawScene & scene_;
+	glm::mat4 viewProj_{1.f};
+};
+
+void rasterBenchmark()
+{
+	qInfo() << "SIMD width" << fgl::simd::width << "workers" << fgl::workerCount();
+
+	// Same scene and camera path as multidraw scene, so frame times compare with
+	// `--scene multidraw --benchmark` under Mesa llvmpipe
+	const auto scene = makeMultiDrawScene();
+	MultiDrawRasterShader shader{scene};
+	constexpr auto g_frames = 30;
+	const auto imagePath = QDir::current().filePath("raster.png");
+
+	struct Resolution
+	{
+		std::size_t width;
+		std::size_t height;
+	};
+	for (const auto & resolution: {Resolution{640, 480}, Resolution{1280, 720}, Resolution{1920, 1080}})
+	{
+		fgl::SoftwareRasterizer rasterizer{resolution.width, resolution.height};
+		const auto aspect = static_cast<float>(resolution.width) / static_cast<float>(resolution.height);
+
+		fgl::RasterStats total;
+		QElapsedTimer timer;
+		timer.start();
+		for (auto frame = 0; frame < g_frames; ++frame)
+		{
+			const auto camera = multiDrawCamera(static_cast<float>(frame) * 0.005f, aspect);
+			shader.setViewProj(camera.projection * camera.view);
+			rasterizer.clear(glm::vec4{0.1f, 0.1f, 0.15f, 1.f});
+			for (std::size_t i = 0; i < scene.objects.size(); ++i)
+			{
+				const auto & mesh = scene.meshes[scene.objects[i].mesh];
+				rasterizer.draw(shader, static_cast<std::uint32_t>(i), mesh.vertexCount(), mesh.indices.data(), mesh.indices.size());
+			}
+			rasterizer.flush();
+
+			const auto & stats = rasterizer.stats();
+			total.triangles += stats.triangles;
+			total.setupTriangles += stats.setupTriangles;
+			total.binned += stats.binned;
+			total.fragments += stats.fragments;
+			total.geometryMs += stats.geometryMs;
+			total.binMs += stats.binMs;
+			total.rasterMs += stats.rasterMs;
+		}
+		const auto totalMs = static_cast<double>(timer.nsecsElapsed()) / 1e6;
+
+		qInfo().noquote() << QString{"%1x%2: %3 draws, %4 triangles, %5 set up, %6 tile bins, %7 pixels | geometry %8 ms, binning %9 ms, raster %10 ms, total %11 ms per frame | %12 M triangles/s, %13 M pixels/s"}
+								 .arg(resolution.width)
+								 .arg(resolution.height)
+								 .arg(scene.objects.size())
+								 .arg(total.triangles / g_frames)
+								 .arg(total.setupTriangles / g_frames)
+								 .arg(total.binned / g_frames)
+								 .arg(total.fragments / g_frames)
+								 .arg(total.geometryMs / g_frames, 0, 'f', 2)
+								 .arg(total.binMs / g_frames, 0, 'f', 2)
+								 .arg(total.rasterMs / g_frames, 0, 'f', 2)
+								 .arg(totalMs / g_frames, 0, 'f', 2)
+								 .arg(static_cast<double>(total.triangles) / totalMs / 1e3, 0, 'f', 2)
+								 .arg(static_cast<double>(total.fragments) / totalMs / 1e3, 0, 'f', 2);
+
+		// Last frame of the default window size, rows of rasterizer go from bottom to top
+		if (resolution.width == 640)
+		{
+			const QImage image{reinterpret_cast<const uchar *>(rasterizer.colors()), static_cast<int>(rasterizer.width()),
+							   static_cast<int>(rasterizer.height()), static_cast<int>(rasterizer.stride() * sizeof(std::uint32_t)),
+							   QImage::Format_RGBA8888};
+			if (image.mirrored().save(imagePath))
+			{
+				qInfo().noquote() << "saved" << imagePath;
+			}
+			else
+			{
+				qWarning().noquote() << "failed to save" << imagePath;
+			}
+		}
+	}
+}
+
+void lightsBenchmark()
+{
+	qInfo() << "SIMD width" << fgl::simd::width << "workers" << fgl::workerCount();
+
+	// Same scene, camera and lights as lights scene at 640x480
+	const auto scene = makeLightsScene();
+	const auto camera = lightsCamera(0.f, 640.f / 480.f);
+	fgl::LightClusters clusters;
+	clusters.setProjection(camera.fovY, 640.f / 480.f, camera.near, camera.far);
+	fgl::JobSystem singleThread{1};
+	std::vector<fgl::Light> lights;
+
+	for (std::size_t count = 16; count <= 4096; count *= 4)
+	{
+		animateLights(scene, count, 1.f, lights);
+
+		// Reference is a scalar test of every light against every cluster
+		std::vector<fgl::BoundingSphere> spheres;
+		for (const auto & light: lights)
+		{
+			const auto sphere = fgl::lightBounds(light);
+			spheres.push_back({glm::vec3{camera.view * glm::vec4{sphere.center, 1.f}}, sphere.radius});
+		}
+		std::size_t bruteForceIndices = 0;
+		const auto bruteForceMs = measureMs([&] {
+			bruteForceIndices = 0;
+			for (std::size_t cluster = 0; cluster < clusters.clusterCount(); ++cluster)
+			{
+				const auto & box = clusters.clusterBounds(cluster);
+				for (const auto & sphere: spheres)
+				{
+					const auto offset = glm::max(glm::max(box.min - sphere.center, sphere.center - box.max), glm::vec3{0.f});
+					bruteForceIndices += glm::dot(offset, offset) <= sphere.radius * sphere.radius ? 1u : 0u;
+				}
+			}
+		});
+		const auto singleMs = measureMs([&] { clusters.assign(lights, camera.view, singleThread); });
+		const auto parallelMs = measureMs([&] { clusters.assign(lights, camera.view); });
+
+		qInfo().noquote() << QString{"%1 lights: %2 clusters, %3 light indices (brute force %4), max %5 per cluster | brute force %6 ms | single thread %7 ms (x%8) | parallel %9 ms (x%10)"}
+								 .arg(count)
+								 .arg(clusters.clusterCount())
+								 .arg(clusters.indices().size())
+								 .arg(bruteForceIndices)
+								 .arg(clusters.maxClusterLights())
+								 .arg(bruteForceMs, 0, 'f', 3)
+								 .arg(singleMs, 0, 'f', 3)
+								 .arg(bruteForceMs / singleMs, 0, 'f', 1)
+								 .arg(parallelMs, 0, 'f', 3)
+								 .arg(bruteForceMs / parallelMs, 0, 'f', 1);
+	}
+}
+
+struct Benchmark
+{
+	const char * name;
+	void (*run)();
+};
+
+constexpr std::array<Benchmark, 9u> g_benchmarks = {{
+	{"culling", cullingBenchmark},
+	{"bvh", bvhBenchmark},
+	{"occlusion", occlusionBenchmark},
+	{"transforms", transformsBenchmark},
+	{"ecs", ecsBenchmark},
+	{"jobs", jobsBenchmark},
+	{"sort", sortBenchmark},
+	{"raster", rasterBenchmark},
+	{"lights", lightsBenchmark},
+}};
+
+}// namespace
+
+QStringList benchmarkNames()
+{
+	QStringList names;
+	for (const auto & benchmark: g_benchmarks)
+	{
+		names.append(benchmark.name);
+	}
+	return names;
+}
+
+bool runBenchmark(const QString & name)
+{
+	for (const auto & benchmark: g_benchmarks)
+	{
+		if (name == benchmark.name)
+		{
+			qInfo() << "Running" << benchmark.name << "benchmark";
+			benchmark.run();
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+// Headless CPU benchmarks, they need neither window nor OpenGL context.
+QStringList benchmarkNames();
+
+// Runs benchmark with given name and logs results, returns false for unknown name.
+bool runBenchmark(const QString & name);
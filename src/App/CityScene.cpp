@@ -0,0 +1,165 @@
+#include "CityScene.h"
+
+#include <Base/MeshPrimitives.hpp>
+
+#include <QElapsedTimer>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+constexpr auto g_blockSize = 20.f;
+constexpr auto g_streetWidth = 8.f;
+constexpr auto g_blockPitch = g_blockSize + g_streetWidth;
+constexpr auto g_propsPerSide = 8;
+constexpr auto g_eyeHeight = 1.8f;
+
+constexpr std::size_t g_buildingMesh = 0;
+constexpr std::size_t g_treeMesh = 1;
+constexpr std::size_t g_propMesh = 2;
+
+double elapsedMs(const QElapsedTimer & timer) { return static_cast<double>(timer.nsecsElapsed()) / 1e6; }
+
+}// namespace
+
+CityScene makeCityScene(const int blocksPerSide)
+{
+	CityScene scene;
+	scene.size = static_cast<float>(blocksPerSide) * g_blockPitch + g_streetWidth;
+
+	// Unit box scaled per building, detailed meshes for props
+	scene.meshes.push_back(fgl::makeBox(glm::vec3{0.5f}, {0.55f, 0.55f, 0.6f}));
+	auto tree = fgl::makeIcosphere(3, {0.2f, 0.6f, 0.25f});
+	fgl::displaceAlongNormals(tree, 0.2f, 3.f);
+	scene.meshes.push_back(std::move(tree));
+	auto prop = fgl::makeIcosphere(2, {0.8f, 0.3f, 0.2f});
+	fgl::displaceAlongNormals(prop, 0.1f, 2.f);
+	scene.meshes.push_back(std::move(prop));
+
+	std::mt19937 random{7};
+	std::uniform_real_distribution<float> height{6.f, 40.f};
+	std::uniform_real_distribution<float> jitter{-0.5f, 0.5f};
+
+	const auto addObject = [&](const glm::mat4 & model, const std::size_t mesh, const bool occluder) {
+		scene.objects.push_back({model, mesh, occluder});
+		scene.bounds.push_back(fgl::transform(fgl::computeAabb(scene.meshes[mesh]), model));
+		scene.cullBounds.add(scene.bounds.back());
+	};
+
+	for (int blockX = 0; blockX < blocksPerSide; ++blockX)
+	{
+		for (int blockZ = 0; blockZ < blocksPerSide; ++blockZ)
+		{
+			const glm::vec2 origin{g_streetWidth + static_cast<float>(blockX) * g_blockPitch,
+								   g_streetWidth + static_cast<float>(blockZ) * g_blockPitch};
+
+			// Four buildings with small gaps between them
+			const auto footprint = g_blockSize * 0.5f - 1.f;
+			for (int i = 0; i < 4; ++i)
+			{
+				const glm::vec2 corner = origin + glm::vec2{static_cast<float>(i % 2), static_cast<float>(i / 2)} * (footprint + 2.f);
+				const auto buildingHeight = height(random);
+				const auto model = glm::scale(glm::translate(glm::mat4{1.f}, {corner.x + footprint * 0.5f, buildingHeight * 0.5f, corner.y + footprint * 0.5f}),
+											  {footprint, buildingHeight, footprint});
+				addObject(model, g_buildingMesh, true);
+			}
+
+			// Trees and props along sidewalks of the block
+			for (int side = 0; side < 4; ++side)
+			{
+				for (int i = 0; i < g_propsPerSide; ++i)
+				{
+					const auto along = (static_cast<float>(i) + 0.5f + jitter(random)) / g_propsPerSide * g_blockSize;
+					const auto across = -1.5f + jitter(random);
+					const glm::vec2 offsets[] = {{along, across}, {along, g_blockSize - across}, {across, along}, {g_blockSize - across, along}};
+					const auto position = origin + offsets[side];
+					const auto isTree = (i + side) % 2 == 0;
+					const auto scale = isTree ? 1.2f : 0.5f;
+					const auto model = glm::scale(glm::translate(glm::mat4{1.f}, {position.x, scale, position.y}), glm::vec3{scale});
+					addObject(model, isTree ? g_treeMesh : g_propMesh, false);
+				}
+			}
+		}
+	}
+	return scene;
+}
+
+CityCamera cityCamera(const CityScene & scene, const float time)
+{
+	// Walk back and forth along the street in the middle of the city
+	const auto streets = std::floor((scene.size - g_streetWidth) / g_blockPitch);
+	const auto streetX = std::floor(streets * 0.5f) * g_blockPitch + g_streetWidth * 0.5f;
+	const auto z = scene.size * (0.5f + 0.45f * std::cos(time * 0.05f));
+	const glm::vec3 position{streetX, g_eyeHeight, z};
+
+	const auto yaw = 0.8f * std::sin(time * 0.3f);
+	const glm::vec3 direction{std::sin(yaw), 0.05f, -std::cos(yaw)};
+	return {position, glm::lookAt(position, position + direction, glm::vec3{0.f, 1.f, 0.f})};
+}
+
+CityCuller::CityCuller(const CityScene & scene)
+	: scene_{scene}
+	, occlusion_{options_.depthWidth, options_.depthHeight}
+{
+}
+
+void CityCuller::setOptions(const CityCullOptions & options)
+{
+	options_ = options;
+	occlusion_.resize(options_.depthWidth, options_.depthHeight);
+}
+
+void CityCuller::cull(const glm::mat4 & viewProj, const glm::vec3 & cameraPosition, const float fovY,
+					  std::vector<std::uint32_t> & visible)
+{
+	fgl::cullFrustumParallel(fgl::Frustum::fromMatrix(viewProj), scene_.cullBounds, fgl::CullVolume::Box, visible);
+	frustumVisible_ = visible.size();
+	rasterizeMs_ = 0.;
+	testMs_ = 0.;
+	if (!options_.occlusion)
+	{
+		return;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// Largest buildings on screen are the best occluders
+	occluders_.clear();
+	const auto tanHalfFov = std::tan(fovY * 0.5f);
+	for (const auto index: visible)
+	{
+		if (!scene_.objects[index].occluder)
+		{
+			continue;
+		}
+		const auto & box = scene_.bounds[index];
+		const auto distance = std::max(glm::length(box.center() - cameraPosition), 1e-3f);
+		const auto size = glm::length(box.extents()) / (distance * tanHalfFov);
+		if (size >= options_.minOccluderSize)
+		{
+			occluders_.emplace_back(size, index);
+		}
+	}
+	const auto occluderCount = std::min(occluders_.size(), options_.maxOccluders);
+	std::partial_sort(occluders_.begin(), occluders_.begin() + static_cast<std::ptrdiff_t>(occluderCount), occluders_.end(),
+					  [](const auto & a, const auto & b) { return a.first > b.first; });
+
+	occlusion_.beginFrame(viewProj);
+	for (std::size_t i = 0; i < occluderCount; ++i)
+	{
+		const auto & object = scene_.objects[occluders_[i].second];
+		occlusion_.addOccluder(scene_.meshes[object.mesh], object.model);
+	}
+	occlusion_.rasterize();
+	rasterizeMs_ = elapsedMs(timer);
+
+	timer.restart();
+	occlusion_.filterVisible(scene_.bounds, visible);
+	testMs_ = elapsedMs(timer);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/FrustumCuller.hpp>
+#include <Base/Mesh.hpp>
+#include <Base/OcclusionCuller.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// City blocks with tall buildings hiding most of trees and props along the streets.
+// Shared by occlusion culling scenes and headless benchmarks.
+struct CityScene
+{
+	struct Object
+	{
+		glm::mat4 model;
+		std::size_t mesh;
+		// Buildings are closed boxes and are used as occluders.
+		bool occluder;
+	};
+
+	std::vector<fgl::Mesh> meshes;
+	std::vector<Object> objects;
+	// World space boxes of objects.
+	std::vector<fgl::Aabb> bounds;
+	fgl::BoundsSoA cullBounds;
+
+	// City spans [0, size] along X and Z.
+	float size = 0.f;
+};
+
+CityScene makeCityScene(int blocksPerSide = 16);
+
+struct CityCamera
+{
+	glm::vec3 position;
+	glm::mat4 view;
+};
+
+// Street level camera walking along the city and looking around.
+CityCamera cityCamera(const CityScene & scene, float time);
+
+struct CityCullOptions
+{
+	bool occlusion = true;
+	std::size_t depthWidth = 256;
+	std::size_t depthHeight = 128;
+	std::size_t maxOccluders = 96;
+	// Occluders must cover at least this part of view height.
+	float minOccluderSize = 0.05f;
+};
+
+// Frustum and occlusion culling of city objects.
+class CityCuller
+{
+public:
+	explicit CityCuller(const CityScene & scene);
+
+	void setOptions(const CityCullOptions & options);
+	const CityCullOptions & options() const { return options_; }
+
+	// Writes indices of potentially visible objects in increasing order.
+	void cull(const glm::mat4 & viewProj, const glm::vec3 & cameraPosition, float fovY, std::vector<std::uint32_t> & visible);
+
+	// Results of the last cull.
+	std::size_t frustumVisible() const { return frustumVisible_; }
+	std::size_t occluderCount() const { return occlusion_.occluderCount(); }
+	double rasterizeMs() const { return rasterizeMs_; }
+	double testMs() const { return testMs_; }
+
+private:
+	const CityScene & scene_;
+	CityCullOptions options_;
+	fgl::OcclusionCuller occlusion_;
+
+	std::vector<std::pair<float, std::uint32_t>> occluders_;
+
+	std::size_t frustumVisible_ = 0;
+	double rasterizeMs_ = 0.;
+	double testMs_ = 0.;
+};
@@ -0,0 +1,265 @@
+#include "CityWindow.h"
+
+#include <QDebug>
+#include <QKeyEvent>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+
+constexpr auto g_fovY = glm::radians(60.f);
+// Hidden objects with more triangles are drawn under conditional render to avoid popping.
+constexpr GLsizei g_conditionalTriangles = 1000;
+
+struct BenchmarkConfiguration
+{
+	CityWindow::OcclusionMode occlusionMode;
+	std::size_t depthWidth;
+	std::size_t depthHeight;
+};
+
+constexpr std::array<BenchmarkConfiguration, 6u> g_benchmarkConfigurations = {{
+	{CityWindow::OcclusionMode::None, 256, 128},
+	{CityWindow::OcclusionMode::Software, 128, 64},
+	{CityWindow::OcclusionMode::Software, 256, 128},
+	{CityWindow::OcclusionMode::Software, 512, 256},
+	{CityWindow::OcclusionMode::Queries, 256, 128},
+	{CityWindow::OcclusionMode::HiZ, 256, 128},
+}};
+
+}// namespace
+
+CityWindow::CityWindow()
+	: scene_{makeCityScene()}
+	, culler_{scene_}
+{
+}
+
+void CityWindow::init()
+{
+	// Configure shaders
+	program_ = std::make_unique<QOpenGLShaderProgram>(this);
+	program_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/mesh.vs");
+	program_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/mesh.fs");
+	program_->link();
+
+	viewProjUniform_ = program_->uniformLocation("viewProj");
+	modelUniform_ = program_->uniformLocation("model");
+
+	for (const auto & mesh: scene_.meshes)
+	{
+		meshes_.push_back(std::make_unique<fgl::GpuMesh>());
+		meshes_.back()->create(mesh);
+	}
+	qInfo() << "city objects" << scene_.objects.size();
+
+	queries_.create(gl33(), scene_.objects.size());
+	hiZ_.create(gl33(), scene_.objects.size());
+	target_.create(gl33(), width(), height());
+
+	trianglesCounter_ = stats().addCounter("triangles");
+	drawsCounter_ = stats().addCounter("draws");
+	frustumCulledCounter_ = stats().addCounter("frustum culled");
+	occlusionCulledCounter_ = stats().addCounter("occlusion culled");
+	occlusionPercentCounter_ = stats().addCounter("occlusion culled %");
+	occludersCounter_ = stats().addCounter("occluders");
+	rasterizeMsCounter_ = stats().addCounter("occluders raster ms");
+	testMsCounter_ = stats().addCounter("occlusion test ms");
+	queriesCounter_ = stats().addCounter("queries");
+	skippedCounter_ = stats().addCounter("query skipped");
+	conditionalCounter_ = stats().addCounter("conditional draws");
+	latencyCounter_ = stats().addCounter("query latency frames");
+	hiZLatencyCounter_ = stats().addCounter("hi-z latency frames");
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+}
+
+void CityWindow::render()
+{
+	const auto retinaScale = devicePixelRatio();
+	const auto viewportWidth = static_cast<GLint>(width() * retinaScale);
+	const auto viewportHeight = static_cast<GLint>(height() * retinaScale);
+
+	const auto camera = cityCamera(scene_, static_cast<float>(frame_) * 0.05f);
+	const auto aspect = static_cast<float>(viewportWidth) / static_cast<float>(std::max(viewportHeight, 1));
+	const auto viewProj = glm::perspective(g_fovY, aspect, 0.1f, 1000.f) * camera.view;
+
+	culler_.cull(viewProj, camera.position, g_fovY, visible_);
+	stats().setCounter(frustumCulledCounter_, static_cast<double>(scene_.objects.size() - culler_.frustumVisible()));
+	stats().setCounter(occludersCounter_, static_cast<double>(culler_.occluderCount()));
+	stats().setCounter(rasterizeMsCounter_, culler_.rasterizeMs());
+	stats().setCounter(testMsCounter_, culler_.testMs());
+
+	if (occlusionMode_ == OcclusionMode::HiZ)
+	{
+		// Use results of previous frames, all frustum visible objects are tested again below
+		hiZ_.beginFrame();
+		hiZCandidates_ = visible_;
+		visible_.erase(std::remove_if(visible_.begin(), visible_.end(), [&](const auto index) { return !hiZ_.isVisible(index); }),
+					   visible_.end());
+		target_.resize(viewportWidth, viewportHeight);
+		target_.bind();
+	}
+
+	// Configure viewport
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	// Clear buffers
+	glClearColor(0.55f, 0.7f, 0.85f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	program_->bind();
+	glUniformMatrix4fv(viewProjUniform_, 1, GL_FALSE, glm::value_ptr(viewProj));
+
+	if (occlusionMode_ == OcclusionMode::Queries)
+	{
+		drawWithQueries(viewProj, camera.position);
+	}
+	else
+	{
+		for (const auto index: visible_)
+		{
+			drawObject(index);
+		}
+	}
+
+	program_->release();
+
+	if (occlusionMode_ == OcclusionMode::HiZ)
+	{
+		hiZ_.buildPyramid(target_.depthTexture(), target_.width(), target_.height());
+		hiZ_.test(viewProj, hiZCandidates_, scene_.bounds);
+		stats().setCounter(hiZLatencyCounter_, static_cast<double>(hiZ_.stats().latencyFrames));
+
+		target_.release();
+		glViewport(0, 0, viewportWidth, viewportHeight);
+		target_.present();
+	}
+
+	const auto occluded = occlusionMode_ == OcclusionMode::Queries ? queries_.stats().objectsSkipped
+																   : culler_.frustumVisible() - visible_.size();
+	stats().setCounter(occlusionCulledCounter_, static_cast<double>(occluded));
+	stats().setCounter(occlusionPercentCounter_, 100. * static_cast<double>(occluded) / static_cast<double>(std::max<std::size_t>(culler_.frustumVisible(), 1u)));
+
+	++frame_;
+}
+
+void CityWindow::drawWithQueries(const glm::mat4 & viewProj, const glm::vec3 & cameraPosition)
+{
+	// Draw objects visible by previous query results, some of them are queried again
+	queries_.beginFrame();
+	hidden_.clear();
+	for (const auto index: visible_)
+	{
+		if (!queries_.isVisible(index))
+		{
+			hidden_.push_back(index);
+			continue;
+		}
+		queries_.beginObject(index);
+		drawObject(index);
+		queries_.endObject();
+	}
+
+	// Query boxes of hidden objects against depth of visible ones
+	queries_.queryHidden(viewProj, cameraPosition, hidden_, scene_.bounds);
+
+	program_->bind();
+	for (const auto index: hidden_)
+	{
+		if (meshes_[scene_.objects[index].mesh]->indexCount() / 3 >= g_conditionalTriangles && queries_.beginConditional(index))
+		{
+			drawObject(index);
+			queries_.endConditional();
+		}
+	}
+
+	const auto & queryStats = queries_.stats();
+	stats().setCounter(queriesCounter_, static_cast<double>(queryStats.queriesIssued));
+	stats().setCounter(skippedCounter_, static_cast<double>(queryStats.objectsSkipped));
+	stats().setCounter(conditionalCounter_, static_cast<double>(queryStats.conditionalDraws));
+	stats().setCounter(latencyCounter_, queryStats.averageLatencyFrames);
+}
+
+void CityWindow::drawObject(const std::uint32_t index)
+{
+	const auto & object = scene_.objects[index];
+	auto & mesh = *meshes_[object.mesh];
+	mesh.bind();
+	glUniformMatrix4fv(modelUniform_, 1, GL_FALSE, glm::value_ptr(object.model));
+	mesh.draw(*this);
+	mesh.release();
+
+	stats().addToCounter(trianglesCounter_, static_cast<double>(mesh.indexCount() / 3));
+	stats().addToCounter(drawsCounter_, 1.);
+}
+
+void CityWindow::setOcclusionMode(const OcclusionMode mode)
+{
+	occlusionMode_ = mode;
+	auto options = culler_.options();
+	options.occlusion = mode == OcclusionMode::Software;
+	culler_.setOptions(options);
+	queries_.reset();
+	hiZ_.reset();
+}
+
+void CityWindow::keyPressEvent(QKeyEvent * e)
+{
+	auto options = culler_.options();
+	switch (e->key())
+	{
+		case Qt::Key_O:
+			setOcclusionMode(static_cast<OcclusionMode>((static_cast<int>(occlusionMode_) + 1) % 4));
+			qInfo().noquote() << benchmarkConfigurationName();
+			return;
+		case Qt::Key_R:
+			// 128x64 -> 256x128 -> 512x256 -> 128x64
+			options.depthWidth = options.depthWidth >= 512 ? 128 : options.depthWidth * 2;
+			options.depthHeight = options.depthWidth / 2;
+			break;
+		default:
+			return;
+	}
+	culler_.setOptions(options);
+	qInfo().noquote() << benchmarkConfigurationName();
+}
+
+bool CityWindow::setBenchmarkConfiguration(const std::size_t index)
+{
+	if (index >= g_benchmarkConfigurations.size())
+	{
+		return false;
+	}
+	const auto & configuration = g_benchmarkConfigurations[index];
+	auto options = culler_.options();
+	options.depthWidth = configuration.depthWidth;
+	options.depthHeight = configuration.depthHeight;
+	culler_.setOptions(options);
+	setOcclusionMode(configuration.occlusionMode);
+	return true;
+}
+
+QString CityWindow::benchmarkConfigurationName() const
+{
+	const auto & options = culler_.options();
+	if (occlusionMode_ == OcclusionMode::None)
+	{
+		return "frustum culling only";
+	}
+	if (occlusionMode_ == OcclusionMode::Queries)
+	{
+		return "occlusion queries";
+	}
+	if (occlusionMode_ == OcclusionMode::HiZ)
+	{
+		return "hi-z occlusion culling";
+	}
+	return QString{"occlusion culling %1x%2"}.arg(options.depthWidth).arg(options.depthHeight);
+}
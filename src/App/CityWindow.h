@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CityScene.h"
+
+#include <Base/GLWindow.hpp>
+#include <Base/GpuMesh.hpp>
+#include <Base/HiZCuller.hpp>
+#include <Base/OcclusionQueries.hpp>
+#include <Base/RenderTarget.hpp>
+
+#include <QOpenGLShaderProgram>
+
+#include <memory>
+#include <vector>
+
+// City blocks stress scene for occlusion culling on CPU, with GPU queries or Hi-Z pyramid.
+// Keys: O cycles occlusion culling mode, R cycles software depth buffer resolution.
+class CityWindow final : public fgl::GLWindow
+{
+
+public:
+	enum class OcclusionMode
+	{
+		None,
+		Software,
+		Queries,
+		HiZ,
+	};
+
+public:
+	CityWindow();
+
+	void init() override;
+	void render() override;
+
+protected:
+	void keyPressEvent(QKeyEvent * e) override;
+
+	bool setBenchmarkConfiguration(std::size_t index) override;
+	QString benchmarkConfigurationName() const override;
+
+private:
+	void setOcclusionMode(OcclusionMode mode);
+	void drawObject(std::uint32_t index);
+	void drawWithQueries(const glm::mat4 & viewProj, const glm::vec3 & cameraPosition);
+
+private:
+	GLint viewProjUniform_ = -1;
+	GLint modelUniform_ = -1;
+
+	std::unique_ptr<QOpenGLShaderProgram> program_ = nullptr;
+
+	CityScene scene_;
+	CityCuller culler_;
+	std::vector<std::unique_ptr<fgl::GpuMesh>> meshes_;
+	std::vector<std::uint32_t> visible_;
+
+	OcclusionMode occlusionMode_ = OcclusionMode::Software;
+	fgl::OcclusionQueries queries_;
+	std::vector<std::uint32_t> hidden_;
+
+	// Hi-Z needs depth texture so scene is rendered offscreen in that mode.
+	fgl::HiZCuller hiZ_;
+	fgl::RenderTarget target_;
+	std::vector<std::uint32_t> hiZCandidates_;
+
+	fgl::FrameStats::CounterId trianglesCounter_ = 0;
+	fgl::FrameStats::CounterId drawsCounter_ = 0;
+	fgl::FrameStats::CounterId frustumCulledCounter_ = 0;
+	fgl::FrameStats::CounterId occlusionCulledCounter_ = 0;
+	fgl::FrameStats::CounterId occlusionPercentCounter_ = 0;
+	fgl::FrameStats::CounterId occludersCounter_ = 0;
+	fgl::FrameStats::CounterId rasterizeMsCounter_ = 0;
+	fgl::FrameStats::CounterId testMsCounter_ = 0;
+	fgl::FrameStats::CounterId queriesCounter_ = 0;
+	fgl::FrameStats::CounterId skippedCounter_ = 0;
+	fgl::FrameStats::CounterId conditionalCounter_ = 0;
+	fgl::FrameStats::CounterId latencyCounter_ = 0;
+	fgl::FrameStats::CounterId hiZLatencyCounter_ = 0;
+
+	std::size_t frame_ = 0;
+};
@@ -0,0 +1,104 @@
+#include "LightsScene.h"
+
+#include <Base/MeshPrimitives.hpp>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+constexpr auto g_gridSize = 16;
+constexpr auto g_gridSpacing = 4.5f;
+constexpr auto g_fovY = glm::radians(60.f);
+constexpr auto g_near = 0.5f;
+constexpr auto g_far = 200.f;
+
+constexpr auto g_minLightRadius = 2.f;
+constexpr auto g_maxLightRadius = 16.f;
+constexpr auto g_spotHeight = 6.f;
+constexpr auto g_spotCosInner = 0.93f;
+constexpr auto g_spotCosOuter = 0.85f;
+
+}// namespace
+
+LightsScene makeLightsScene()
+{
+	LightsScene scene;
+	scene.size = g_gridSize * g_gridSpacing + 8.f;
+
+	// Light gray surfaces show light colors
+	scene.meshes.push_back(fgl::makeBox(glm::vec3{scene.size * 0.5f, 0.5f, scene.size * 0.5f}, glm::vec3{0.7f}));
+	scene.meshes.push_back(fgl::makeIcosphere(3, glm::vec3{0.8f}));
+	scene.meshes.push_back(fgl::makeTorus(0.8f, 0.3f, 32, 16, glm::vec3{0.75f, 0.7f, 0.65f}));
+	scene.meshes.push_back(fgl::makeBox(glm::vec3{0.6f, 1.5f, 0.6f}, glm::vec3{0.65f, 0.7f, 0.75f}));
+	scene.roughness = {0.8f, 0.3f, 0.5f, 0.65f};
+	scene.objects.push_back({glm::translate(glm::mat4{1.f}, glm::vec3{0.f, -0.5f, 0.f}), 0u});
+
+	std::mt19937 random{3};
+	std::uniform_real_distribution<float> unit{0.f, 1.f};
+	for (int x = 0; x < g_gridSize; ++x)
+	{
+		for (int z = 0; z < g_gridSize; ++z)
+		{
+			const auto mesh = static_cast<std::uint32_t>(1 + (x + z) % 3);
+			const glm::vec3 position{(static_cast<float>(x) - (g_gridSize - 1) * 0.5f) * g_gridSpacing,
+									 -fgl::computeAabb(scene.meshes[mesh]).min.y,
+									 (static_cast<float>(z) - (g_gridSize - 1) * 0.5f) * g_gridSpacing};
+			scene.objects.push_back({glm::rotate(glm::translate(glm::mat4{1.f}, position), 6.28f * unit(random), glm::vec3{0.f, 1.f, 0.f}), mesh});
+		}
+	}
+	std::stable_sort(scene.objects.begin(), scene.objects.end(),
+					 [](const LightsScene::Object & a, const LightsScene::Object & b) { return a.mesh < b.mesh; });
+	return scene;
+}
+
+void animateLights(const LightsScene & scene, const std::size_t count, const float time, std::vector<fgl::Light> & lights)
+{
+	const auto radius = std::clamp(scene.size / std::sqrt(static_cast<float>(std::max<std::size_t>(count, 1u))),
+								   g_minLightRadius, g_maxLightRadius);
+
+	// Parameters of a light do not depend on count, so lights keep their paths when count changes
+	std::mt19937 random{17};
+	std::uniform_real_distribution<float> unit{0.f, 1.f};
+	lights.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const glm::vec3 center{(unit(random) - 0.5f) * scene.size, 0.f, (unit(random) - 0.5f) * scene.size};
+		const auto orbit = 1.f + 3.f * unit(random);
+		const auto phase = time * (0.3f + unit(random)) + 6.28f * unit(random);
+		const auto hue = unit(random);
+		const auto height = 0.5f + 2.5f * unit(random);
+
+		auto & light = lights[i];
+		// Saturated color of random hue
+		light.color = glm::clamp(glm::abs(glm::mod(glm::vec3{hue * 6.f} + glm::vec3{0.f, 4.f, 2.f}, 6.f) - 3.f) - 1.f, 0.f, 1.f);
+		light.position = center + glm::vec3{orbit * std::cos(phase), height, orbit * std::sin(phase)};
+		light.radius = radius;
+		if (i % 3 == 2)
+		{
+			// Cone reaches the ground with circle of about radius size
+			light.position.y = g_spotHeight;
+			light.radius = radius + g_spotHeight;
+			light.direction = glm::normalize(glm::vec3{std::cos(phase), -4.f, std::sin(phase)});
+			light.spotCosInner = g_spotCosInner;
+			light.spotCosOuter = g_spotCosOuter;
+		}
+	}
+}
+
+LightsCamera lightsCamera(const float time, const float aspect)
+{
+	LightsCamera camera;
+	camera.position = glm::vec3{55.f * std::cos(time), 22.f, 55.f * std::sin(time)};
+	camera.view = glm::lookAt(camera.position, glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f});
+	camera.fovY = g_fovY;
+	camera.near = g_near;
+	camera.far = g_far;
+	camera.projection = glm::perspective(g_fovY, aspect, g_near, g_far);
+	return camera;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Base/LightClusters.hpp>
+#include <Base/Mesh.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Ground with a grid of objects lit by many moving point and spot lights.
+// Shared by clustered lights scene and headless benchmarks.
+struct LightsScene
+{
+	struct Object
+	{
+		glm::mat4 model;
+		std::uint32_t mesh;
+	};
+
+	std::vector<fgl::Mesh> meshes;
+	// Roughness of mesh surfaces in [0, 1].
+	std::vector<float> roughness;
+	// Sorted by mesh, so objects of a mesh are drawn with one instanced call.
+	std::vector<Object> objects;
+
+	// Scene spans [-size / 2, size / 2] along X and Z.
+	float size = 0.f;
+};
+
+LightsScene makeLightsScene();
+
+// Lights circling above the ground at given time, every third one is a spot light looking
+// down. Radius shrinks as count grows, so a point is lit by a few lights on average.
+void animateLights(const LightsScene & scene, std::size_t count, float time, std::vector<fgl::Light> & lights);
+
+struct LightsCamera
+{
+	glm::vec3 position;
+	glm::mat4 view;
+	glm::mat4 projection;
+	float fovY;
+	float near;
+	float far;
+};
+
+// Camera orbiting the scene low above the ground.
+LightsCamera lightsCamera(float time, float aspect);
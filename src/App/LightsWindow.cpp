@@ -0,0 +1,281 @@
+#include "LightsWindow.h"
+
+#include <Base/ShaderReflection.hpp>
+#include <Base/ShaderSource.hpp>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+#include <QVector3D>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+
+constexpr auto g_modelsUnit = 0;
+// Lights, clusters and light indices take three units starting with this one.
+constexpr auto g_lightsUnit = 1;
+// G-buffer albedo, normal and depth take three units starting with this one.
+constexpr auto g_gBufferUnit = 4;
+
+constexpr std::size_t g_minLights = 16;
+constexpr std::size_t g_maxLights = 4096;
+
+struct BenchmarkConfiguration
+{
+	std::size_t lights;
+	LightsWindow::ShadingMode mode;
+};
+
+constexpr std::array<BenchmarkConfiguration, 10u> g_benchmarkConfigurations = {{
+	{16, LightsWindow::ShadingMode::Forward},
+	{16, LightsWindow::ShadingMode::Deferred},
+	{64, LightsWindow::ShadingMode::Forward},
+	{64, LightsWindow::ShadingMode::Deferred},
+	{256, LightsWindow::ShadingMode::Forward},
+	{256, LightsWindow::ShadingMode::Deferred},
+	{1024, LightsWindow::ShadingMode::Forward},
+	{1024, LightsWindow::ShadingMode::Deferred},
+	{4096, LightsWindow::ShadingMode::Forward},
+	{4096, LightsWindow::ShadingMode::Deferred},
+}};
+
+}// namespace
+
+void LightsWindow::init()
+{
+	frameUniforms_.create(gl33());
+	clusteredProgram_ = reflectProgram(shaders_.program(":/Shaders/lit.vs", ":/Shaders/lit.fs"));
+	allLightsProgram_ = reflectProgram(shaders_.program(":/Shaders/lit.vs", ":/Shaders/lit.fs", {"ALL_LIGHTS"}));
+	geometryProgram_ = reflectProgram(shaders_.program(":/Shaders/lit.vs", ":/Shaders/gbuffer.fs"));
+
+	// Lighting pass shares fullscreen triangle vertex shader
+	deferredLighting_ = std::make_unique<QOpenGLShaderProgram>();
+	deferredLighting_->addShaderFromSourceCode(QOpenGLShader::Vertex, fgl::FullscreenPass::vertexShader());
+	deferredLighting_->addShaderFromSourceCode(QOpenGLShader::Fragment, fgl::loadShaderSource(":/Shaders/deferred.fs"));
+	deferredLighting_->link();
+	lightingProgram_ = reflectProgram(deferredLighting_.get());
+	deferredLighting_->bind();
+	deferredLighting_->setUniformValue("gbufferAlbedo", g_gBufferUnit);
+	deferredLighting_->setUniformValue("gbufferNormal", g_gBufferUnit + 1);
+	deferredLighting_->setUniformValue("gbufferDepth", g_gBufferUnit + 2);
+	deferredLighting_->release();
+
+	scene_ = makeLightsScene();
+	pool_.create(gl33(), scene_.meshes);
+
+	// Objects do not move, so model matrices are uploaded once
+	std::vector<glm::mat4> models;
+	for (const auto & object: scene_.objects)
+	{
+		models.push_back(object.model);
+	}
+	models_.create(gl33());
+	models_.upload(models);
+
+	clusterBuffer_.create(gl33());
+	gBuffer_.create(gl33(), 1, 1);
+	fullscreen_.create(gl33());
+	gpuTimer_.create(gl33(), SectionCount);
+
+	lightsCounter_ = stats().addCounter("lights");
+	assignMsCounter_ = stats().addCounter("assign ms");
+	indicesCounter_ = stats().addCounter("light indices");
+	maxClusterLightsCounter_ = stats().addCounter("max cluster lights");
+	uploadKbCounter_ = stats().addCounter("upload KB");
+	geometryGpuMsCounter_ = stats().addCounter("geometry gpu ms");
+	lightingGpuMsCounter_ = stats().addCounter("lighting gpu ms");
+	gBufferMbCounter_ = stats().addCounter("G-buffer MB");
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+}
+
+LightsWindow::Program LightsWindow::reflectProgram(QOpenGLShaderProgram * program)
+{
+	Program result;
+	result.program = program;
+	const auto reflection = fgl::ShaderReflection::reflect(gl33(), program->programId());
+	frameUniforms_.attach(reflection);
+	result.firstInstance = reflection.uniformLocation("firstInstance");
+	result.roughness = reflection.uniformLocation("roughness");
+	result.lightCount = reflection.uniformLocation("lightCount");
+	result.clusterCounts = reflection.uniformLocation("clusterCounts");
+	result.clusterTileScale = reflection.uniformLocation("clusterTileScale");
+	result.clusterDepthScaleBias = reflection.uniformLocation("clusterDepthScaleBias");
+	result.inverseViewProj = reflection.uniformLocation("inverseViewProj");
+
+	// Samplers and uniforms a program does not use have no location and are ignored
+	program->bind();
+	program->setUniformValue("models", g_modelsUnit);
+	program->setUniformValue("lights", g_lightsUnit);
+	program->setUniformValue("lightClusters", g_lightsUnit + 1);
+	program->setUniformValue("lightIndices", g_lightsUnit + 2);
+	program->setUniformValue("ambient", QVector3D{0.08f, 0.08f, 0.1f});
+	program->release();
+	return result;
+}
+
+void LightsWindow::render()
+{
+	gpuTimer_.beginFrame();
+	stats().setCounter(geometryGpuMsCounter_, gpuTimer_.ms(GeometrySection));
+	stats().setCounter(lightingGpuMsCounter_, gpuTimer_.ms(LightingSection));
+
+	// Configure viewport
+	const auto retinaScale = devicePixelRatio();
+	const auto viewportWidth = static_cast<GLint>(width() * retinaScale);
+	const auto viewportHeight = static_cast<GLint>(height() * retinaScale);
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	// Clear buffers
+	glClearColor(0.1f, 0.1f, 0.15f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	const auto time = static_cast<float>(frame_) * 0.01f;
+	const auto aspect = static_cast<float>(viewportWidth) / static_cast<float>(std::max(viewportHeight, 1));
+	const auto camera = lightsCamera(time * 0.2f, aspect);
+	fgl::FrameData frameData;
+	frameData.view = camera.view;
+	frameData.projection = camera.projection;
+	frameData.viewProj = camera.projection * camera.view;
+	frameData.cameraPosition = glm::vec4{camera.position, 1.f};
+	frameUniforms_.update(frameData);
+
+	animateLights(scene_, lightCount_, time, lights_);
+	QElapsedTimer assignTimer;
+	assignTimer.start();
+	clusters_.setProjection(camera.fovY, aspect, camera.near, camera.far);
+	clusters_.assign(lights_, camera.view);
+	stats().setCounter(assignMsCounter_, static_cast<double>(assignTimer.nsecsElapsed()) / 1e6);
+	clusterBuffer_.upload(lights_, clusters_);
+
+	models_.bind(g_modelsUnit);
+	clusterBuffer_.bind(g_lightsUnit);
+	if (mode_ == ShadingMode::Deferred)
+	{
+		gBuffer_.resize(viewportWidth, viewportHeight);
+		gBuffer_.bind();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		geometryProgram_.program->bind();
+		gpuTimer_.begin(GeometrySection);
+		drawObjects(geometryProgram_);
+		gpuTimer_.end();
+		geometryProgram_.program->release();
+		gBuffer_.release();
+
+		// Lighting writes every covered pixel once, background keeps clear color
+		glDisable(GL_DEPTH_TEST);
+		gBuffer_.bindTextures(g_gBufferUnit);
+		deferredLighting_->bind();
+		setLightUniforms(lightingProgram_, viewportWidth, viewportHeight);
+		const auto inverseViewProj = glm::inverse(frameData.viewProj);
+		glUniformMatrix4fv(lightingProgram_.inverseViewProj, 1, GL_FALSE, glm::value_ptr(inverseViewProj));
+		gpuTimer_.begin(LightingSection);
+		fullscreen_.draw();
+		gpuTimer_.end();
+		deferredLighting_->release();
+		glEnable(GL_DEPTH_TEST);
+		stats().setCounter(gBufferMbCounter_, static_cast<double>(gBuffer_.frameBytes()) / 1e6);
+	}
+	else
+	{
+		const auto & program = mode_ == ShadingMode::Forward ? clusteredProgram_ : allLightsProgram_;
+		program.program->bind();
+		setLightUniforms(program, viewportWidth, viewportHeight);
+		gpuTimer_.begin(GeometrySection);
+		drawObjects(program);
+		gpuTimer_.end();
+		program.program->release();
+	}
+
+	stats().setCounter(lightsCounter_, static_cast<double>(lights_.size()));
+	stats().setCounter(indicesCounter_, static_cast<double>(clusters_.indices().size()));
+	stats().setCounter(maxClusterLightsCounter_, static_cast<double>(clusters_.maxClusterLights()));
+	stats().setCounter(uploadKbCounter_, static_cast<double>(clusterBuffer_.uploadedBytes()) / 1024.);
+
+	++frame_;
+}
+
+void LightsWindow::setLightUniforms(const Program & program, const GLint viewportWidth, const GLint viewportHeight)
+{
+	const auto & grid = clusters_.grid();
+	glUniform1i(program.lightCount, static_cast<GLint>(lights_.size()));
+	glUniform3i(program.clusterCounts, static_cast<GLint>(grid.tilesX), static_cast<GLint>(grid.tilesY), static_cast<GLint>(grid.slices));
+	glUniform2f(program.clusterTileScale, static_cast<float>(grid.tilesX) / static_cast<float>(viewportWidth),
+				static_cast<float>(grid.tilesY) / static_cast<float>(std::max(viewportHeight, 1)));
+	glUniform2f(program.clusterDepthScaleBias, clusters_.depthScale(), clusters_.depthBias());
+}
+
+void LightsWindow::drawObjects(const Program & program)
+{
+	auto & gl = gl33();
+	gl.glBindVertexArray(pool_.vertexArray());
+	// Objects are sorted by mesh, a run of the same mesh is one instanced draw
+	for (std::size_t begin = 0; begin < scene_.objects.size();)
+	{
+		const auto mesh = scene_.objects[begin].mesh;
+		auto end = begin;
+		while (end < scene_.objects.size() && scene_.objects[end].mesh == mesh)
+		{
+			++end;
+		}
+		const auto & range = pool_.range(mesh);
+		glUniform1i(program.firstInstance, static_cast<GLint>(begin));
+		glUniform1f(program.roughness, scene_.roughness[mesh]);
+		gl.glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_INT,
+											 reinterpret_cast<const void *>(range.firstIndex * sizeof(std::uint32_t)),
+											 static_cast<GLsizei>(end - begin), range.baseVertex);
+		begin = end;
+	}
+	gl.glBindVertexArray(0);
+}
+
+void LightsWindow::keyPressEvent(QKeyEvent * e)
+{
+	switch (e->key())
+	{
+		case Qt::Key_S:
+			mode_ = static_cast<ShadingMode>((static_cast<int>(mode_) + 1) % 3);
+			break;
+		case Qt::Key_Plus:
+		case Qt::Key_Equal:
+			lightCount_ = std::min(lightCount_ * 2, g_maxLights);
+			break;
+		case Qt::Key_Minus:
+			lightCount_ = std::max(lightCount_ / 2, g_minLights);
+			break;
+		default:
+			return;
+	}
+	qInfo() << benchmarkConfigurationName();
+}
+
+bool LightsWindow::setBenchmarkConfiguration(const std::size_t index)
+{
+	if (index >= g_benchmarkConfigurations.size())
+	{
+		return false;
+	}
+	lightCount_ = g_benchmarkConfigurations[index].lights;
+	mode_ = g_benchmarkConfigurations[index].mode;
+	return true;
+}
+
+QString LightsWindow::benchmarkConfigurationName() const
+{
+	switch (mode_)
+	{
+		case ShadingMode::Forward:
+			return QString{"%1 lights, clustered forward"}.arg(lightCount_);
+		case ShadingMode::ForwardAllLights:
+			return QString{"%1 lights, forward with all lights per fragment"}.arg(lightCount_);
+		case ShadingMode::Deferred:
+			return QString{"%1 lights, clustered deferred, %2 bytes per pixel G-buffer"}.arg(lightCount_).arg(fgl::GBuffer::bytesPerPixel);
+	}
+	return {};
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "LightsScene.h"
+
+#include <Base/FrameUniforms.hpp>
+#include <Base/FullscreenPass.hpp>
+#include <Base/GBuffer.hpp>
+#include <Base/GLWindow.hpp>
+#include <Base/GpuTimer.hpp>
+#include <Base/InstanceBuffer.hpp>
+#include <Base/LightClusterBuffer.hpp>
+#include <Base/LightClusters.hpp>
+#include <Base/MeshPool.hpp>
+#include <Base/ShaderVariants.hpp>
+
+#include <QOpenGLShaderProgram>
+
+#include <memory>
+#include <vector>
+
+// Hundreds to thousands of moving point and spot lights. Lights are assigned to view frustum
+// clusters on CPU every frame and shading loops over lights of pixel cluster only, either
+// in forward pass or in fullscreen lighting pass over G-buffer of deferred shading.
+// Keys: +/- double or halve light count, S cycles shading modes.
+class LightsWindow final : public fgl::GLWindow
+{
+public:
+	enum class ShadingMode
+	{
+		Forward,
+		// Forward with all lights per fragment, for comparison.
+		ForwardAllLights,
+		Deferred,
+	};
+
+public:
+	void init() override;
+	void render() override;
+
+protected:
+	void keyPressEvent(QKeyEvent * e) override;
+
+	bool setBenchmarkConfiguration(std::size_t index) override;
+	QString benchmarkConfigurationName() const override;
+
+private:
+	struct Program
+	{
+		QOpenGLShaderProgram * program = nullptr;
+		GLint firstInstance = -1;
+		GLint roughness = -1;
+		GLint lightCount = -1;
+		GLint clusterCounts = -1;
+		GLint clusterTileScale = -1;
+		GLint clusterDepthScaleBias = -1;
+		GLint inverseViewProj = -1;
+	};
+
+	// GPU timer sections.
+	enum Section : std::size_t
+	{
+		GeometrySection,
+		LightingSection,
+		SectionCount,
+	};
+
+private:
+	Program reflectProgram(QOpenGLShaderProgram * program);
+	void setLightUniforms(const Program & program, GLint viewportWidth, GLint viewportHeight);
+	// Program must be bound.
+	void drawObjects(const Program & program);
+
+private:
+	fgl::ShaderVariants shaders_;
+	Program clusteredProgram_;
+	Program allLightsProgram_;
+	Program geometryProgram_;
+	std::unique_ptr<QOpenGLShaderProgram> deferredLighting_ = nullptr;
+	Program lightingProgram_;
+	fgl::FrameUniformBuffer frameUniforms_;
+
+	LightsScene scene_;
+	fgl::MeshPool pool_;
+	fgl::InstanceBuffer models_;
+
+	std::vector<fgl::Light> lights_;
+	fgl::LightClusters clusters_;
+	fgl::LightClusterBuffer clusterBuffer_;
+	std::size_t lightCount_ = 256;
+	ShadingMode mode_ = ShadingMode::Forward;
+
+	fgl::GBuffer gBuffer_;
+	fgl::FullscreenPass fullscreen_;
+	fgl::GpuTimer gpuTimer_;
+
+	fgl::FrameStats::CounterId lightsCounter_ = 0;
+	fgl::FrameStats::CounterId assignMsCounter_ = 0;
+	fgl::FrameStats::CounterId indicesCounter_ = 0;
+	fgl::FrameStats::CounterId maxClusterLightsCounter_ = 0;
+	fgl::FrameStats::CounterId uploadKbCounter_ = 0;
+	fgl::FrameStats::CounterId geometryGpuMsCounter_ = 0;
+	fgl::FrameStats::CounterId lightingGpuMsCounter_ = 0;
+	fgl::FrameStats::CounterId gBufferMbCounter_ = 0;
+
+	std::size_t frame_ = 0;
+};
@@ -0,0 +1,209 @@
+#include "LodWindow.h"
+
+#include <Base/MeshPrimitives.hpp>
+
+#include <QDebug>
+#include <QKeyEvent>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+constexpr auto g_gridSize = 64;
+constexpr auto g_gridSpacing = 4.f;
+constexpr auto g_fovY = glm::radians(60.f);
+
+struct BenchmarkConfiguration
+{
+	bool culling;
+	// Zero budget disables lod selection.
+	float pixelErrorBudget;
+};
+
+constexpr std::array<BenchmarkConfiguration, 4u> g_benchmarkConfigurations = {{
+	{false, 0.f},
+	{true, 0.f},
+	{true, 1.f},
+	{true, 4.f},
+}};
+
+}// namespace
+
+void LodWindow::init()
+{
+	// Configure shaders
+	program_ = std::make_unique<QOpenGLShaderProgram>(this);
+	program_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/mesh.vs");
+	program_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/mesh.fs");
+	program_->link();
+
+	viewProjUniform_ = program_->uniformLocation("viewProj");
+	modelUniform_ = program_->uniformLocation("model");
+
+	// Build lod chains at load time
+	auto sphere = fgl::makeIcosphere(5, {0.9f, 0.6f, 0.3f});
+	fgl::displaceAlongNormals(sphere, 0.08f, 3.f);
+	auto torus = fgl::makeTorus(0.7f, 0.3f, 128, 64, {0.3f, 0.7f, 0.9f});
+	fgl::displaceAlongNormals(torus, 0.03f, 6.f);
+	auto rock = fgl::makeIcosphere(4, {0.6f, 0.6f, 0.6f});
+	fgl::displaceAlongNormals(rock, 0.25f, 1.5f);
+
+	for (const auto * mesh: {&sphere, &torus, &rock})
+	{
+		chains_.push_back(fgl::buildLodChain(*mesh));
+
+		auto & levels = meshes_.emplace_back();
+		for (const auto & level: chains_.back().levels)
+		{
+			levels.push_back(std::make_unique<fgl::GpuMesh>());
+			levels.back()->create(level.mesh);
+		}
+		qInfo() << "lod chain" << chains_.size() - 1 << "levels" << chains_.back().levels.size()
+				<< "triangles" << chains_.back().levels.front().mesh.triangleCount()
+				<< "->" << chains_.back().levels.back().mesh.triangleCount();
+	}
+
+	// Place objects on a grid going away from camera
+	std::mt19937 random{42};
+	std::uniform_real_distribution<float> jitter{-1.f, 1.f};
+	for (int x = 0; x < g_gridSize; ++x)
+	{
+		for (int z = 0; z < g_gridSize; ++z)
+		{
+			const glm::vec3 position{(static_cast<float>(x) - g_gridSize * 0.5f) * g_gridSpacing + jitter(random),
+									 0.f,
+									 -static_cast<float>(z) * g_gridSpacing + jitter(random)};
+			const auto scale = 1.f + 0.3f * jitter(random);
+			const auto chain = static_cast<std::size_t>(x + z) % chains_.size();
+
+			Object object;
+			object.model = glm::scale(glm::translate(glm::mat4{1.f}, position), glm::vec3{scale});
+			object.bounds = fgl::transform(chains_[chain].bounds, object.model);
+			object.chain = chain;
+			object.level = 0;
+			objects_.push_back(object);
+			bounds_.add(object.bounds);
+		}
+	}
+
+	trianglesCounter_ = stats().addCounter("triangles");
+	drawsCounter_ = stats().addCounter("draws");
+	culledCounter_ = stats().addCounter("culled");
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+}
+
+void LodWindow::render()
+{
+	// Configure viewport
+	const auto retinaScale = devicePixelRatio();
+	const auto viewportWidth = static_cast<GLint>(width() * retinaScale);
+	const auto viewportHeight = static_cast<GLint>(height() * retinaScale);
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	// Clear buffers
+	glClearColor(0.1f, 0.1f, 0.15f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// Camera flies along the grid back and forth
+	const auto time = static_cast<float>(frame_) * 0.01f;
+	const glm::vec3 cameraPosition{0.f, 6.f, 20.f - 60.f * (1.f - std::cos(time))};
+	const auto view = glm::lookAt(cameraPosition, cameraPosition + glm::vec3{0.f, -0.15f, -1.f}, glm::vec3{0.f, 1.f, 0.f});
+	const auto aspect = static_cast<float>(viewportWidth) / static_cast<float>(std::max(viewportHeight, 1));
+	const auto projection = glm::perspective(g_fovY, aspect, 0.1f, 500.f);
+	const auto viewProj = projection * view;
+
+	selector_.setProjection(g_fovY, static_cast<float>(viewportHeight));
+
+	program_->bind();
+	glUniformMatrix4fv(viewProjUniform_, 1, GL_FALSE, glm::value_ptr(viewProj));
+
+	// Frustum culling
+	if (cullingEnabled_)
+	{
+		fgl::cullFrustumParallel(fgl::Frustum::fromMatrix(viewProj), bounds_, fgl::CullVolume::Sphere, visible_);
+	}
+	else
+	{
+		visible_.resize(objects_.size());
+		for (std::size_t i = 0; i < visible_.size(); ++i)
+		{
+			visible_[i] = static_cast<std::uint32_t>(i);
+		}
+	}
+	stats().setCounter(culledCounter_, static_cast<double>(objects_.size() - visible_.size()));
+
+	for (const auto index: visible_)
+	{
+		auto & object = objects_[index];
+		const auto & chain = chains_[object.chain];
+		object.level = lodEnabled_ ? selector_.select(chain, object.bounds, cameraPosition, object.level) : std::uint8_t{0};
+
+		auto & mesh = *meshes_[object.chain][object.level];
+		mesh.bind();
+		glUniformMatrix4fv(modelUniform_, 1, GL_FALSE, glm::value_ptr(object.model));
+		mesh.draw(*this);
+		mesh.release();
+
+		stats().addToCounter(trianglesCounter_, static_cast<double>(mesh.indexCount() / 3));
+		stats().addToCounter(drawsCounter_, 1.);
+	}
+
+	program_->release();
+
+	++frame_;
+}
+
+void LodWindow::keyPressEvent(QKeyEvent * e)
+{
+	auto options = selector_.options();
+	switch (e->key())
+	{
+		case Qt::Key_L:
+			lodEnabled_ = !lodEnabled_;
+			qInfo() << "lod" << (lodEnabled_ ? "enabled" : "disabled");
+			return;
+		case Qt::Key_F:
+			cullingEnabled_ = !cullingEnabled_;
+			qInfo() << "frustum culling" << (cullingEnabled_ ? "enabled" : "disabled");
+			return;
+		case Qt::Key_Plus:
+		case Qt::Key_Equal:
+			options.pixelErrorBudget *= 2.f;
+			break;
+		case Qt::Key_Minus:
+			options.pixelErrorBudget *= 0.5f;
+			break;
+		default:
+			return;
+	}
+	selector_.setOptions(options);
+	qInfo() << "pixel error budget" << options.pixelErrorBudget;
+}
+
+bool LodWindow::setBenchmarkConfiguration(const std::size_t index)
+{
+	if (index >= g_benchmarkConfigurations.size())
+	{
+		return false;
+	}
+	const auto & configuration = g_benchmarkConfigurations[index];
+	auto options = selector_.options();
+	options.pixelErrorBudget = configuration.pixelErrorBudget;
+	selector_.setOptions(options);
+	lodEnabled_ = configuration.pixelErrorBudget > 0.f;
+	cullingEnabled_ = configuration.culling;
+	return true;
+}
+
+QString LodWindow::benchmarkConfigurationName() const
+{
+	const auto lod = lodEnabled_ ? QString{"lod budget %1 px"}.arg(static_cast<double>(selector_.options().pixelErrorBudget)) : QString{"lod disabled"};
+	return lod + (cullingEnabled_ ? ", culling" : ", no culling");
+}
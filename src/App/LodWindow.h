@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Base/FrustumCuller.hpp>
+#include <Base/GLWindow.hpp>
+#include <Base/GpuMesh.hpp>
+#include <Base/Lod.hpp>
+
+#include <QOpenGLShaderProgram>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// Thousands of detailed objects at varying distance to measure lod selection and culling gains.
+// Keys: L toggles lod selection, F toggles frustum culling, +/- change pixel error budget.
+class LodWindow final : public fgl::GLWindow
+{
+
+public:
+	void init() override;
+	void render() override;
+
+protected:
+	void keyPressEvent(QKeyEvent * e) override;
+
+	bool setBenchmarkConfiguration(std::size_t index) override;
+	QString benchmarkConfigurationName() const override;
+
+private:
+	struct Object
+	{
+		glm::mat4 model;
+		fgl::BoundingSphere bounds;
+		std::size_t chain;
+		std::uint8_t level;
+	};
+
+private:
+	GLint viewProjUniform_ = -1;
+	GLint modelUniform_ = -1;
+
+	std::unique_ptr<QOpenGLShaderProgram> program_ = nullptr;
+
+	std::vector<fgl::LodChain> chains_;
+	// Gpu meshes per chain per level.
+	std::vector<std::vector<std::unique_ptr<fgl::GpuMesh>>> meshes_;
+	std::vector<Object> objects_;
+
+	fgl::BoundsSoA bounds_;
+	std::vector<std::uint32_t> visible_;
+	bool cullingEnabled_ = true;
+
+	fgl::LodSelector selector_;
+	bool lodEnabled_ = true;
+
+	fgl::FrameStats::CounterId trianglesCounter_ = 0;
+	fgl::FrameStats::CounterId drawsCounter_ = 0;
+	fgl::FrameStats::CounterId culledCounter_ = 0;
+
+	std::size_t frame_ = 0;
+};
@@ -0,0 +1,507 @@
+#include "MaterialsWindow.h"
+
+#include <Base/MeshPrimitives.hpp>
+#include <Base/ParallelFor.hpp>
+#include <Base/ShaderReflection.hpp>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+constexpr auto g_gridSize = 64;
+constexpr auto g_gridSpacing = 3.f;
+// Objects farther from the center are static and merged into batches.
+constexpr auto g_dynamicRadius = 40.f;
+constexpr auto g_staticCellSize = 96.f;
+constexpr auto g_maxInstances = 1024u;
+constexpr auto g_materialCount = 256u;
+constexpr auto g_textureCount = 32u;
+constexpr auto g_textureSize = 64;
+constexpr auto g_translucentShare = 0.05f;
+constexpr auto g_instanceUnit = 1;
+constexpr auto g_fovY = glm::radians(60.f);
+constexpr auto g_far = 400.f;
+
+struct ProgramVariant
+{
+	bool textured;
+	bool lit;
+};
+
+constexpr std::array<ProgramVariant, 4u> g_programVariants = {{
+	{false, false},
+	{false, true},
+	{true, false},
+	{true, true},
+}};
+
+struct BenchmarkConfiguration
+{
+	MaterialsWindow::SortMode sortMode;
+	bool batching;
+};
+
+constexpr std::array<BenchmarkConfiguration, 4u> g_benchmarkConfigurations = {{
+	{MaterialsWindow::SortMode::None, false},
+	{MaterialsWindow::SortMode::Sorted, false},
+	{MaterialsWindow::SortMode::SortedParallel, false},
+	{MaterialsWindow::SortMode::SortedParallel, true},
+}};
+
+}// namespace
+
+void MaterialsWindow::init()
+{
+	frameUniforms_.create(gl33());
+	colorParameter_ = materialLayout_.add("color", fgl::ParameterType::Vec4);
+	// Variants are compiled on first use, listed ones right away
+	shaders_.prewarm(":/Shaders/materials.prewarm");
+	programs_.resize(g_programVariants.size() * 2);
+	createTextures();
+
+	auto rock = fgl::makeIcosphere(2, glm::vec3{1.f});
+	fgl::displaceAlongNormals(rock, 0.2f, 1.5f);
+	meshes_ = {
+		fgl::makeIcosphere(1, glm::vec3{1.f}),
+		fgl::makeIcosphere(3, glm::vec3{1.f}),
+		fgl::makeTorus(0.7f, 0.3f, 32, 16, glm::vec3{1.f}),
+		fgl::makeBox(glm::vec3{0.8f}, glm::vec3{1.f}),
+		fgl::makeBox(glm::vec3{0.4f, 1.2f, 0.4f}, glm::vec3{1.f}),
+		rock,
+	};
+	for (const auto & mesh: meshes_)
+	{
+		gpuMeshes_.push_back(std::make_unique<fgl::GpuMesh>());
+		gpuMeshes_.back()->create(mesh);
+	}
+
+	createObjects();
+	createStaticBatches();
+
+	state_.create(gl33());
+	instanceBuffer_.create(gl33());
+
+	drawsCounter_ = stats().addCounter("draws");
+	objectsCounter_ = stats().addCounter("objects");
+	programsCounter_ = stats().addCounter("program changes");
+	vertexArraysCounter_ = stats().addCounter("vao changes");
+	texturesCounter_ = stats().addCounter("texture changes");
+	blendCounter_ = stats().addCounter("blend changes");
+	materialsCounter_ = stats().addCounter("material changes");
+	changesCounter_ = stats().addCounter("state changes");
+	redundantCounter_ = stats().addCounter("redundant state calls");
+	uniformBytesCounter_ = stats().addCounter("uniform bytes");
+	sortMsCounter_ = stats().addCounter("sort ms");
+}
+
+MaterialsWindow::Program & MaterialsWindow::programVariant(const std::size_t variant, const bool instanced)
+{
+	auto & slot = programs_[variant * 2 + (instanced ? 1 : 0)];
+	if (slot == nullptr)
+	{
+		// Program setup binds and releases it behind state cache
+		slot = std::make_unique<Program>(createProgram(variant, instanced));
+		state_.invalidate();
+	}
+	return *slot;
+}
+
+MaterialsWindow::Program MaterialsWindow::createProgram(const std::size_t variant, const bool instanced)
+{
+	fgl::ShaderDefines defines;
+	if (instanced)
+	{
+		defines.set("INSTANCED");
+	}
+	if (g_programVariants[variant].textured)
+	{
+		defines.set("TEXTURED");
+	}
+	if (g_programVariants[variant].lit)
+	{
+		defines.set("LIT");
+	}
+
+	Program program;
+	program.program = shaders_.program(":/Shaders/material.vs", ":/Shaders/material.fs", defines);
+
+	// All binding tables are built here from reflection, drawing does no name lookups
+	const auto reflection = fgl::ShaderReflection::reflect(gl33(), program.program->programId());
+	frameUniforms_.attach(reflection);
+	program.materialParameters.create(gl33(), reflection, materialLayout_);
+	program.opaque = fgl::PipelineState::create(gl33(), reflection, fgl::RenderState{});
+	program.translucent = fgl::PipelineState::create(gl33(), reflection, fgl::RenderState::translucent());
+	program.modelUniform = reflection.uniformLocation("model");
+	program.instanceOffsetUniform = reflection.uniformLocation("instanceOffset");
+	program.textured = g_programVariants[variant].textured;
+	program.instanced = instanced;
+
+	program.program->bind();
+	program.program->setUniformValue("albedo", 0);
+	program.program->setUniformValue("instances", g_instanceUnit);
+	program.program->release();
+	return program;
+}
+
+void MaterialsWindow::createTextures()
+{
+	auto & gl = gl33();
+	std::mt19937 random{13};
+	std::vector<glm::u8vec4> pixels(g_textureSize * g_textureSize);
+
+	textures_.resize(g_textureCount);
+	gl.glGenTextures(static_cast<GLsizei>(textures_.size()), textures_.data());
+	for (std::size_t i = 0; i < textures_.size(); ++i)
+	{
+		// Checkers of different cell sizes in two random colors
+		const glm::u8vec4 first(random() % 256, random() % 256, random() % 256, 255);
+		const glm::u8vec4 second(255 - first.r, 255 - first.g, 255 - first.b, 255);
+		const auto cell = 4 << (i % 4);
+		for (int y = 0; y < g_textureSize; ++y)
+		{
+			for (int x = 0; x < g_textureSize; ++x)
+			{
+				pixels[y * g_textureSize + x] = (x / cell + y / cell) % 2 == 0 ? first : second;
+			}
+		}
+
+		gl.glBindTexture(GL_TEXTURE_2D, textures_[i]);
+		gl.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, g_textureSize, g_textureSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		gl.glGenerateMipmap(GL_TEXTURE_2D);
+		gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	}
+	gl.glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void MaterialsWindow::createObjects()
+{
+	// Materials spread over all programs and textures, so neighbouring objects rarely share state
+	std::mt19937 random{7};
+	std::uniform_real_distribution<float> unit{0.f, 1.f};
+	for (std::uint32_t i = 0; i < g_materialCount; ++i)
+	{
+		Material material;
+		material.translucent = unit(random) < g_translucentShare;
+		material.color = glm::vec4{0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random),
+								   material.translucent ? 0.5f : 1.f};
+		material.program = static_cast<std::uint32_t>(random() % g_programVariants.size());
+		material.texture = static_cast<std::uint32_t>(random() % textures_.size());
+		materials_.push_back(material);
+		materialParameters_.emplace_back(materialLayout_);
+		materialParameters_.back().set(colorParameter_, material.color);
+	}
+
+	std::vector<fgl::BoundingSphere> meshBounds;
+	for (const auto & mesh: meshes_)
+	{
+		meshBounds.push_back(fgl::computeBoundingSphere(mesh));
+	}
+
+	// Few materials are used often as in real scenes, so there are runs to instance
+	std::uniform_real_distribution<float> jitter{-0.5f, 0.5f};
+	std::vector<Object> staticObjects;
+	for (int x = 0; x < g_gridSize; ++x)
+	{
+		for (int z = 0; z < g_gridSize; ++z)
+		{
+			Object object;
+			object.center = glm::vec3{(static_cast<float>(x) - g_gridSize * 0.5f) * g_gridSpacing + jitter(random),
+									  0.f,
+									  (static_cast<float>(z) - g_gridSize * 0.5f) * g_gridSpacing + jitter(random)};
+			object.angle = 6.28f * unit(random);
+			object.spin = glm::length(object.center) < g_dynamicRadius ? 0.5f + 2.f * unit(random) : 0.f;
+			object.model = glm::rotate(glm::translate(glm::mat4{1.f}, object.center), object.angle, glm::vec3{0.f, 1.f, 0.f});
+			object.mesh = static_cast<std::uint32_t>(random() % meshes_.size());
+			object.material = static_cast<std::uint32_t>(static_cast<float>(g_materialCount) * std::pow(unit(random), 3.f)) % g_materialCount;
+			(object.spin > 0.f ? objects_ : staticObjects).push_back(object);
+		}
+	}
+	dynamicCount_ = objects_.size();
+	objects_.insert(objects_.end(), staticObjects.begin(), staticObjects.end());
+
+	// Spinning around vertical axis keeps bounding spheres of origin centered meshes
+	for (const auto & object: objects_)
+	{
+		objectBounds_.add(fgl::transform(meshBounds[object.mesh], object.model));
+	}
+}
+
+void MaterialsWindow::createStaticBatches()
+{
+	// Translucent objects are not merged, they need per object depth order
+	std::vector<fgl::StaticDraw> draws;
+	for (auto i = dynamicCount_; i < objects_.size(); ++i)
+	{
+		const auto & object = objects_[i];
+		if (!materials_[object.material].translucent)
+		{
+			draws.push_back({object.model, object.mesh, object.material});
+		}
+	}
+	staticBatches_ = fgl::buildStaticBatches(meshes_, draws, g_staticCellSize);
+	// Static batches are told apart by mesh key field, objects are drawn one by one when ids run out
+	Q_ASSERT(meshes_.size() <= fgl::DrawKey::maxMesh + 1);
+	const auto maxBatches = fgl::DrawKey::maxMesh + 1 - meshes_.size();
+	if (staticBatches_.size() > maxBatches)
+	{
+		qWarning() << "static batches" << staticBatches_.size() << "exceed mesh key limit" << maxBatches << ", batching disabled";
+		staticBatches_.clear();
+	}
+	const auto batched = !staticBatches_.empty();
+
+	const auto addBatched = [&](const fgl::BoundingSphere & bounds, const std::size_t payload) {
+		batchedBounds_.add(bounds);
+		batchedPayloads_.push_back(static_cast<std::uint32_t>(payload));
+	};
+	for (std::size_t i = 0; i < objects_.size(); ++i)
+	{
+		if (i < dynamicCount_ || materials_[objects_[i].material].translucent || !batched)
+		{
+			addBatched(fgl::transform(fgl::computeBoundingSphere(meshes_[objects_[i].mesh]), objects_[i].model), i);
+		}
+	}
+	for (std::size_t i = 0; i < staticBatches_.size(); ++i)
+	{
+		staticMeshes_.push_back(std::make_unique<fgl::GpuMesh>());
+		staticMeshes_.back()->create(staticBatches_[i].mesh);
+		const auto & box = staticBatches_[i].bounds;
+		addBatched(fgl::BoundingSphere{box.center(), glm::length(box.extents())}, objects_.size() + i);
+	}
+	qInfo() << "static objects" << draws.size() << "merged into" << staticBatches_.size() << "batches";
+}
+
+void MaterialsWindow::render()
+{
+	// Configure viewport
+	const auto retinaScale = devicePixelRatio();
+	const auto viewportWidth = static_cast<GLint>(width() * retinaScale);
+	const auto viewportHeight = static_cast<GLint>(height() * retinaScale);
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	// Clear buffers
+	glClearColor(0.12f, 0.12f, 0.14f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// Camera orbits around the grid
+	const auto time = static_cast<float>(frame_) * 0.005f;
+	const glm::vec3 cameraPosition{110.f * std::cos(time), 45.f, 110.f * std::sin(time)};
+	const auto view = glm::lookAt(cameraPosition, glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f});
+	const auto aspect = static_cast<float>(viewportWidth) / static_cast<float>(std::max(viewportHeight, 1));
+	const auto projection = glm::perspective(g_fovY, aspect, 0.1f, g_far);
+	const auto viewProj = projection * view;
+
+	animate(time);
+	buildDrawList(viewProj, view);
+
+	QElapsedTimer sortTimer;
+	sortTimer.start();
+	if (sortMode_ != SortMode::None)
+	{
+		drawList_.sort(sortMode_ == SortMode::SortedParallel);
+	}
+	stats().setCounter(sortMsCounter_, static_cast<double>(sortTimer.nsecsElapsed()) / 1e6);
+
+	// Camera data goes to all programs with a single buffer update
+	fgl::FrameData frameData;
+	frameData.viewProj = viewProj;
+	frameData.view = view;
+	frameData.projection = projection;
+	frameData.cameraPosition = glm::vec4{cameraPosition, 1.f};
+	uniformBytes_ = frameUniforms_.update(frameData);
+
+	submit();
+	stats().setCounter(uniformBytesCounter_, static_cast<double>(uniformBytes_));
+
+	++frame_;
+}
+
+void MaterialsWindow::animate(const float time)
+{
+	fgl::parallelFor(dynamicCount_, 1024, [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			auto & object = objects_[i];
+			object.model = glm::rotate(glm::translate(glm::mat4{1.f}, object.center), object.angle + object.spin * time, glm::vec3{0.f, 1.f, 0.f});
+		}
+	});
+}
+
+void MaterialsWindow::buildDrawList(const glm::mat4 & viewProj, const glm::mat4 & view)
+{
+	fgl::cullFrustumParallel(fgl::Frustum::fromMatrix(viewProj), batching_ ? batchedBounds_ : objectBounds_, fgl::CullVolume::Sphere, visible_);
+
+	drawList_.resize(visible_.size());
+	fgl::parallelFor(visible_.size(), 1024, [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			const auto payload = batching_ ? batchedPayloads_[visible_[i]] : visible_[i];
+			fgl::DrawKey key;
+			glm::vec3 center;
+			if (payload >= objects_.size())
+			{
+				const auto & batch = staticBatches_[payload - objects_.size()];
+				key.material = batch.material;
+				key.mesh = static_cast<std::uint32_t>(meshes_.size() + payload - objects_.size());
+				center = batch.bounds.center();
+			}
+			else
+			{
+				const auto & object = objects_[payload];
+				key.material = object.material;
+				key.mesh = object.mesh;
+				center = object.center;
+			}
+			const auto & material = materials_[key.material];
+			key.translucent = material.translucent;
+			key.program = material.program;
+			key.depth = -(view * glm::vec4{center, 1.f}).z / g_far;
+			drawList_.set(i, key, payload);
+		}
+	});
+}
+
+void MaterialsWindow::submit()
+{
+	const auto & items = drawList_.items();
+	if (batching_)
+	{
+		fgl::collapseInstances(items, g_maxInstances, batches_);
+
+		// Instances are written in draw order, so each batch reads a contiguous range
+		instances_.resize(items.size());
+		fgl::parallelFor(items.size(), 1024, [&](const std::size_t begin, const std::size_t end) {
+			for (auto i = begin; i < end; ++i)
+			{
+				const auto payload = items[i].payload;
+				instances_[i] = payload < objects_.size() ? objects_[payload].model : glm::mat4{1.f};
+			}
+		});
+		instanceBuffer_.upload(instances_);
+		instanceBuffer_.bind(g_instanceUnit);
+	}
+	else
+	{
+		batches_.resize(items.size());
+		for (std::size_t i = 0; i < items.size(); ++i)
+		{
+			batches_[i] = {static_cast<std::uint32_t>(i), 1u};
+		}
+	}
+
+	state_.invalidate();
+	state_.resetStats();
+
+	// Material uniforms live in programs, which remember values sent to them across frames,
+	// so only parameters differing from the values a program holds are uploaded
+	const auto identity = glm::mat4{1.f};
+	std::size_t materialChanges = 0;
+	std::size_t objectCount = 0;
+	for (const auto & batch: batches_)
+	{
+		const auto payload = items[batch.first].payload;
+		const auto isStatic = payload >= objects_.size();
+		const auto * staticBatch = isStatic ? &staticBatches_[payload - objects_.size()] : nullptr;
+		const auto materialIndex = isStatic ? staticBatch->material : objects_[payload].material;
+		const auto & material = materials_[materialIndex];
+		auto & program = programVariant(material.program, batching_ && !isStatic);
+		auto & mesh = isStatic ? *staticMeshes_[payload - objects_.size()] : *gpuMeshes_[objects_[payload].mesh];
+
+		state_.applyPipeline(material.translucent ? program.translucent : program.opaque);
+		if (program.textured)
+		{
+			state_.bindTexture(0, textures_[material.texture]);
+		}
+		const auto materialBytes = program.materialParameters.apply(materialParameters_[materialIndex]);
+		materialChanges += materialBytes > 0 ? 1 : 0;
+		uniformBytes_ += materialBytes;
+		state_.bindVertexArray(mesh.vertexArray());
+		if (program.instanced)
+		{
+			glUniform1i(program.instanceOffsetUniform, static_cast<GLint>(batch.first));
+			uniformBytes_ += sizeof(GLint);
+			mesh.drawInstanced(gl33(), static_cast<GLsizei>(batch.count));
+		}
+		else
+		{
+			glUniformMatrix4fv(program.modelUniform, 1, GL_FALSE, glm::value_ptr(isStatic ? identity : objects_[payload].model));
+			uniformBytes_ += sizeof(glm::mat4);
+			mesh.draw(*this);
+		}
+		objectCount += isStatic ? staticBatch->drawCount : batch.count;
+	}
+
+	// Leave default state for next frame
+	state_.bindVertexArray(0);
+	state_.setRenderState(fgl::RenderState{});
+	state_.useProgram(0);
+
+	const auto & stateStats = state_.stats();
+	stats().setCounter(drawsCounter_, static_cast<double>(batches_.size()));
+	stats().setCounter(objectsCounter_, static_cast<double>(objectCount));
+	stats().setCounter(programsCounter_, static_cast<double>(stateStats.programs));
+	stats().setCounter(vertexArraysCounter_, static_cast<double>(stateStats.vertexArrays));
+	stats().setCounter(texturesCounter_, static_cast<double>(stateStats.textures));
+	stats().setCounter(blendCounter_, static_cast<double>(stateStats.blend + stateStats.depth));
+	stats().setCounter(materialsCounter_, static_cast<double>(materialChanges));
+	stats().setCounter(changesCounter_, static_cast<double>(stateStats.changes() + materialChanges));
+	stats().setCounter(redundantCounter_, static_cast<double>(stateStats.redundant));
+}
+
+void MaterialsWindow::keyPressEvent(QKeyEvent * e)
+{
+	switch (e->key())
+	{
+		case Qt::Key_S:
+			sortMode_ = static_cast<SortMode>((static_cast<int>(sortMode_) + 1) % 3);
+			break;
+		case Qt::Key_B:
+			batching_ = !batching_;
+			break;
+		default:
+			return;
+	}
+	qInfo() << benchmarkConfigurationName();
+}
+
+bool MaterialsWindow::setBenchmarkConfiguration(const std::size_t index)
+{
+	if (index >= g_benchmarkConfigurations.size())
+	{
+		return false;
+	}
+	sortMode_ = g_benchmarkConfigurations[index].sortMode;
+	batching_ = g_benchmarkConfigurations[index].batching;
+	return true;
+}
+
+QString MaterialsWindow::benchmarkConfigurationName() const
+{
+	QString name;
+	switch (sortMode_)
+	{
+		case SortMode::None:
+			name = "unsorted";
+			break;
+		case SortMode::Sorted:
+			name = "sorted";
+			break;
+		case SortMode::SortedParallel:
+			name = "sorted in parallel";
+			break;
+	}
+	return name + (batching_ ? ", batching" : ", no batching");
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <Base/Batching.hpp>
+#include <Base/DrawList.hpp>
+#include <Base/FrameUniforms.hpp>
+#include <Base/FrustumCuller.hpp>
+#include <Base/GLStateCache.hpp>
+#include <Base/GLWindow.hpp>
+#include <Base/GpuMesh.hpp>
+#include <Base/InstanceBuffer.hpp>
+#include <Base/Parameters.hpp>
+#include <Base/PipelineState.hpp>
+#include <Base/ShaderVariants.hpp>
+
+#include <QOpenGLShaderProgram>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// Thousands of objects with hundreds of materials over a few programs, textures and meshes
+// to measure state changes and draw calls with and without sorting and batching. Objects
+// near the center spin, the outer ones are static.
+// Keys: S cycles draw order: unsorted, sorted, sorted in parallel. B toggles batching.
+class MaterialsWindow final : public fgl::GLWindow
+{
+public:
+	enum class SortMode
+	{
+		None,
+		Sorted,
+		SortedParallel,
+	};
+
+public:
+	void init() override;
+	void render() override;
+
+protected:
+	void keyPressEvent(QKeyEvent * e) override;
+
+	bool setBenchmarkConfiguration(std::size_t index) override;
+	QString benchmarkConfigurationName() const override;
+
+private:
+	struct Program
+	{
+		QOpenGLShaderProgram * program = nullptr;
+		fgl::PipelineState opaque;
+		fgl::PipelineState translucent;
+		fgl::ProgramParameters materialParameters;
+		GLint modelUniform = -1;
+		GLint instanceOffsetUniform = -1;
+		bool textured = false;
+		bool instanced = false;
+	};
+
+	struct Material
+	{
+		glm::vec4 color;
+		std::uint32_t program;
+		std::uint32_t texture;
+		bool translucent;
+	};
+
+	struct Object
+	{
+		glm::mat4 model;
+		glm::vec3 center;
+		float angle;
+		float spin;
+		std::uint32_t mesh;
+		std::uint32_t material;
+	};
+
+private:
+	Program & programVariant(std::size_t variant, bool instanced);
+	Program createProgram(std::size_t variant, bool instanced);
+	void createTextures();
+	void createObjects();
+	void createStaticBatches();
+
+	void animate(float time);
+	void buildDrawList(const glm::mat4 & viewProj, const glm::mat4 & view);
+	void submit();
+
+private:
+	fgl::ShaderVariants shaders_;
+	// Created on first use, plain and instanced variant of each program variant.
+	std::vector<std::unique_ptr<Program>> programs_;
+	std::vector<GLuint> textures_;
+	std::vector<fgl::Mesh> meshes_;
+	std::vector<std::unique_ptr<fgl::GpuMesh>> gpuMeshes_;
+	std::vector<Material> materials_;
+	fgl::ParameterLayout materialLayout_;
+	fgl::ParameterLayout::Id colorParameter_ = fgl::ParameterLayout::invalid;
+	// Parameter values of materials, in material order.
+	std::vector<fgl::ParameterBlock> materialParameters_;
+	fgl::FrameUniformBuffer frameUniforms_;
+
+	// Spinning objects go first, static ones follow.
+	std::vector<Object> objects_;
+	std::size_t dynamicCount_ = 0;
+	fgl::BoundsSoA objectBounds_;
+
+	std::vector<fgl::StaticBatch> staticBatches_;
+	std::vector<std::unique_ptr<fgl::GpuMesh>> staticMeshes_;
+	// Bounds of spinning objects, translucent static objects and static batches, drawn
+	// when batching. Payloads are object indices or object count plus static batch index.
+	fgl::BoundsSoA batchedBounds_;
+	std::vector<std::uint32_t> batchedPayloads_;
+
+	std::vector<std::uint32_t> visible_;
+	fgl::DrawList drawList_;
+	std::vector<fgl::InstancedBatch> batches_;
+	std::vector<glm::mat4> instances_;
+	fgl::InstanceBuffer instanceBuffer_;
+	fgl::GLStateCache state_;
+
+	SortMode sortMode_ = SortMode::SortedParallel;
+	bool batching_ = true;
+
+	fgl::FrameStats::CounterId drawsCounter_ = 0;
+	fgl::FrameStats::CounterId objectsCounter_ = 0;
+	fgl::FrameStats::CounterId programsCounter_ = 0;
+	fgl::FrameStats::CounterId vertexArraysCounter_ = 0;
+	fgl::FrameStats::CounterId texturesCounter_ = 0;
+	fgl::FrameStats::CounterId blendCounter_ = 0;
+	fgl::FrameStats::CounterId materialsCounter_ = 0;
+	fgl::FrameStats::CounterId changesCounter_ = 0;
+	fgl::FrameStats::CounterId redundantCounter_ = 0;
+	fgl::FrameStats::CounterId uniformBytesCounter_ = 0;
+	fgl::FrameStats::CounterId sortMsCounter_ = 0;
+
+	// Uniform and uniform buffer bytes uploaded in current frame.
+	std::size_t uniformBytes_ = 0;
+	std::size_t frame_ = 0;
+};
@@ -0,0 +1,165 @@
+#include "MeshletWindow.h"
+
+#include <Base/MeshPrimitives.hpp>
+#include <Base/ObjLoader.hpp>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+
+constexpr auto g_fovY = glm::radians(60.f);
+
+struct CullMode
+{
+	const char * name;
+	fgl::MeshletCullOptions options;
+};
+
+constexpr std::array<CullMode, 3u> g_cullModes = {{
+	{"no culling", {false, false}},
+	{"frustum", {true, false}},
+	{"frustum and cone", {true, true}},
+}};
+
+}// namespace
+
+MeshletWindow::MeshletWindow(QString modelPath)
+	: modelPath_{std::move(modelPath)}
+{
+}
+
+void MeshletWindow::init()
+{
+	// Configure shaders
+	program_ = std::make_unique<QOpenGLShaderProgram>(this);
+	program_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/mesh.vs");
+	program_->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/Shaders/mesh.fs");
+	program_->link();
+
+	viewProjUniform_ = program_->uniformLocation("viewProj");
+	modelUniform_ = program_->uniformLocation("model");
+
+	// Load model and split it into meshlets
+	if (!modelPath_.isEmpty())
+	{
+		if (auto mesh = fgl::loadObj(modelPath_))
+		{
+			mesh_ = std::move(*mesh);
+		}
+	}
+	if (mesh_.indices.empty())
+	{
+		mesh_ = fgl::makeIcosphere(7, {0.8f, 0.7f, 0.6f});
+		fgl::displaceAlongNormals(mesh_, 0.03f, 6.f);
+	}
+	bounds_ = fgl::computeBoundingSphere(mesh_);
+	meshlets_ = fgl::buildMeshlets(mesh_);
+	qInfo() << "meshlets" << meshlets_.meshlets.size() << "triangles" << mesh_.triangleCount();
+
+	// Upload mesh with meshlet ordered indices
+	auto drawMesh = mesh_;
+	drawMesh.indices = meshlets_.indices;
+	gpuMesh_.create(drawMesh);
+
+	totalCounter_ = stats().addCounter("total triangles");
+	submittedCounter_ = stats().addCounter("submitted triangles");
+	visibleCounter_ = stats().addCounter("visible triangles");
+	meshletsCounter_ = stats().addCounter("meshlets");
+	rangesCounter_ = stats().addCounter("ranges");
+	cullCounter_ = stats().addCounter("cull ms");
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+}
+
+void MeshletWindow::render()
+{
+	// Configure viewport
+	const auto retinaScale = devicePixelRatio();
+	const auto viewportWidth = static_cast<GLint>(width() * retinaScale);
+	const auto viewportHeight = static_cast<GLint>(height() * retinaScale);
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	// Clear buffers
+	glClearColor(0.1f, 0.1f, 0.15f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// Camera orbits model moving closer and further so only part of it is in view
+	const auto & bounds = bounds_;
+	const auto time = static_cast<float>(frame_) * 0.01f;
+	const auto distance = bounds.radius * (1.8f + 0.6f * std::sin(time * 0.7f));
+	const auto cameraPosition = bounds.center + distance * glm::vec3{std::sin(time), 0.3f, std::cos(time)};
+	const auto target = bounds.center + bounds.radius * 0.5f * glm::vec3{std::cos(time), 0.f, -std::sin(time)};
+	const auto view = glm::lookAt(cameraPosition, target, glm::vec3{0.f, 1.f, 0.f});
+	const auto aspect = static_cast<float>(viewportWidth) / static_cast<float>(std::max(viewportHeight, 1));
+	const auto projection = glm::perspective(g_fovY, aspect, bounds.radius * 0.01f, bounds.radius * 10.f);
+	const auto viewProj = projection * view;
+
+	// Model matrix is identity so world space is object space
+	const auto frustum = fgl::Frustum::fromMatrix(viewProj);
+	QElapsedTimer cullTimer;
+	cullTimer.start();
+	fgl::cullMeshlets(meshlets_, frustum, cameraPosition, g_cullModes[cullMode_].options, drawList_);
+	stats().setCounter(cullCounter_, static_cast<double>(cullTimer.nsecsElapsed()) / 1e6);
+
+	program_->bind();
+	glUniformMatrix4fv(viewProjUniform_, 1, GL_FALSE, glm::value_ptr(viewProj));
+	glUniformMatrix4fv(modelUniform_, 1, GL_FALSE, glm::value_ptr(glm::mat4{1.f}));
+
+	gpuMesh_.bind();
+	gl33().glMultiDrawElements(GL_TRIANGLES, drawList_.counts.data(), GL_UNSIGNED_INT, drawList_.offsets.data(),
+							   static_cast<GLsizei>(drawList_.counts.size()));
+	gpuMesh_.release();
+
+	program_->release();
+
+	stats().setCounter(totalCounter_, static_cast<double>(mesh_.triangleCount()));
+	stats().setCounter(submittedCounter_, static_cast<double>(drawList_.triangles));
+	stats().setCounter(meshletsCounter_, static_cast<double>(drawList_.visibleMeshlets));
+	stats().setCounter(rangesCounter_, static_cast<double>(drawList_.counts.size()));
+	if (countVisible_)
+	{
+		stats().setCounter(visibleCounter_, static_cast<double>(fgl::countVisibleTriangles(mesh_, frustum, cameraPosition)));
+	}
+
+	++frame_;
+}
+
+void MeshletWindow::keyPressEvent(QKeyEvent * e)
+{
+	switch (e->key())
+	{
+		case Qt::Key_C:
+			cullMode_ = (cullMode_ + 1) % g_cullModes.size();
+			qInfo() << "meshlet culling:" << g_cullModes[cullMode_].name;
+			break;
+		case Qt::Key_V:
+			countVisible_ = !countVisible_;
+			qInfo() << "visible triangles counting" << (countVisible_ ? "enabled" : "disabled");
+			break;
+		default:
+			break;
+	}
+}
+
+bool MeshletWindow::setBenchmarkConfiguration(const std::size_t index)
+{
+	if (index >= g_cullModes.size())
+	{
+		return false;
+	}
+	cullMode_ = index;
+	return true;
+}
+
+QString MeshletWindow::benchmarkConfigurationName() const { return g_cullModes[cullMode_].name; }
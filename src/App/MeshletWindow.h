@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Base/GLWindow.hpp>
+#include <Base/GpuMesh.hpp>
+#include <Base/Meshlets.hpp>
+
+#include <QOpenGLShaderProgram>
+
+#include <memory>
+
+// Large mesh split into meshlets culled on CPU every frame.
+// Keys: C cycles culling mode, V toggles exact visible triangles counting.
+class MeshletWindow final : public fgl::GLWindow
+{
+
+public:
+	// Loads OBJ model from given path, generates dense procedural mesh if path is empty.
+	explicit MeshletWindow(QString modelPath);
+
+	void init() override;
+	void render() override;
+
+protected:
+	void keyPressEvent(QKeyEvent * e) override;
+
+	bool setBenchmarkConfiguration(std::size_t index) override;
+	QString benchmarkConfigurationName() const override;
+
+private:
+	GLint viewProjUniform_ = -1;
+	GLint modelUniform_ = -1;
+
+	std::unique_ptr<QOpenGLShaderProgram> program_ = nullptr;
+
+	QString modelPath_;
+	fgl::Mesh mesh_;
+	fgl::BoundingSphere bounds_;
+	fgl::MeshletMesh meshlets_;
+	fgl::GpuMesh gpuMesh_;
+
+	std::size_t cullMode_ = 2;
+	bool countVisible_ = true;
+	fgl::MeshletDrawList drawList_;
+
+	fgl::FrameStats::CounterId totalCounter_ = 0;
+	fgl::FrameStats::CounterId submittedCounter_ = 0;
+	fgl::FrameStats::CounterId visibleCounter_ = 0;
+	fgl::FrameStats::CounterId meshletsCounter_ = 0;
+	fgl::FrameStats::CounterId rangesCounter_ = 0;
+	fgl::FrameStats::CounterId cullCounter_ = 0;
+
+	std::size_t frame_ = 0;
+};
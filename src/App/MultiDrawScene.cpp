@@ -0,0 +1,67 @@
+#include "MultiDrawScene.h"
+
+#include <Base/MeshPrimitives.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+constexpr auto g_gridSize = 200;
+constexpr auto g_gridSpacing = 2.f;
+constexpr auto g_meshCount = 32;
+constexpr auto g_fovY = glm::radians(60.f);
+
+}// namespace
+
+MultiDrawScene makeMultiDrawScene()
+{
+	MultiDrawScene scene;
+
+	// Small low poly meshes, so submission and not vertex work dominates
+	std::mt19937 random{5};
+	std::uniform_real_distribution<float> unit{0.f, 1.f};
+	for (int i = 0; i < g_meshCount; ++i)
+	{
+		const glm::vec3 color{0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random)};
+		switch (i % 3)
+		{
+			case 0:
+				scene.meshes.push_back(fgl::makeIcosphere(i % 2, color));
+				break;
+			case 1:
+				scene.meshes.push_back(fgl::makeTorus(0.6f, 0.2f + 0.1f * unit(random), 12, 6, color));
+				break;
+			default:
+				scene.meshes.push_back(
+					fgl::makeBox(glm::vec3{0.3f + 0.5f * unit(random), 0.3f + unit(random), 0.3f + 0.5f * unit(random)}, color));
+				break;
+		}
+	}
+
+	for (int x = 0; x < g_gridSize; ++x)
+	{
+		for (int z = 0; z < g_gridSize; ++z)
+		{
+			const glm::vec3 position{(static_cast<float>(x) - g_gridSize * 0.5f) * g_gridSpacing, 0.f,
+									 (static_cast<float>(z) - g_gridSize * 0.5f) * g_gridSpacing};
+			MultiDrawScene::Object object;
+			object.model = glm::rotate(glm::translate(glm::mat4{1.f}, position), 6.28f * unit(random), glm::vec3{0.f, 1.f, 0.f});
+			object.mesh = static_cast<std::uint32_t>(random() % scene.meshes.size());
+			scene.objects.push_back(object);
+		}
+	}
+	return scene;
+}
+
+MultiDrawCamera multiDrawCamera(const float time, const float aspect)
+{
+	MultiDrawCamera camera;
+	camera.position = glm::vec3{260.f * std::cos(time), 180.f, 260.f * std::sin(time)};
+	camera.view = glm::lookAt(camera.position, glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f});
+	camera.projection = glm::perspective(g_fovY, aspect, 1.f, 1000.f);
+	return camera;
+}
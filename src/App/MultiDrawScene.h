@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Base/Mesh.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Grid of tens of thousands of small low poly objects, drawn with a draw each.
+// Shared by multi draw scene and headless benchmarks.
+struct MultiDrawScene
+{
+	struct Object
+	{
+		glm::mat4 model;
+		std::uint32_t mesh;
+	};
+
+	std::vector<fgl::Mesh> meshes;
+	std::vector<Object> objects;
+};
+
+MultiDrawScene makeMultiDrawScene();
+
+struct MultiDrawCamera
+{
+	glm::vec3 position;
+	glm::mat4 view;
+	glm::mat4 projection;
+};
+
+// Camera looking at the whole grid from above while orbiting.
+MultiDrawCamera multiDrawCamera(float time, float aspect);
@@ -0,0 +1,192 @@
+#include "MultiDrawWindow.h"
+
+#include <Base/ShaderReflection.hpp>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace
+{
+
+constexpr auto g_verticesUnit = 0;
+constexpr auto g_drawsUnit = 1;
+
+constexpr std::array<MultiDrawWindow::SubmitMode, 3u> g_benchmarkConfigurations = {{
+	MultiDrawWindow::SubmitMode::PerDraw,
+	MultiDrawWindow::SubmitMode::Indirect,
+	MultiDrawWindow::SubmitMode::BaseVertex,
+}};
+
+}// namespace
+
+void MultiDrawWindow::init()
+{
+	frameUniforms_.create(gl33());
+	perDrawProgram_ = createProgram({});
+	drawIdProgram_ = createProgram({"DRAW_ID"});
+	pullProgram_ = createProgram({"PULL_VERTICES"});
+	modelUniform_ = fgl::ShaderReflection::reflect(gl33(), perDrawProgram_->programId()).uniformLocation("model");
+	const auto pullReflection = fgl::ShaderReflection::reflect(gl33(), pullProgram_->programId());
+	vertexStrideUniform_ = pullReflection.uniformLocation("vertexStride");
+	drawOffsetUniform_ = pullReflection.uniformLocation("drawOffset");
+
+	scene_ = makeMultiDrawScene();
+	pool_.create(gl33(), scene_.meshes);
+
+	std::vector<glm::mat4> models;
+	for (const auto & object: scene_.objects)
+	{
+		models.push_back(object.model);
+	}
+
+	// Objects do not move, so per draw data is uploaded once
+	draws_.create(gl33());
+	draws_.upload(models);
+
+	submitter_.create(gl33(), pool_);
+	for (const auto & object: scene_.objects)
+	{
+		submitter_.add(object.mesh);
+	}
+	qInfo() << "multi draw indirect" << (submitter_.supportsIndirect() ? "supported" : "not supported, using base vertex fallback");
+	drawsFit_ = submitter_.size() <= submitter_.maxDraws();
+	if (!drawsFit_)
+	{
+		qWarning() << "draws" << submitter_.size() << "exceed texture buffer limit of" << submitter_.maxDraws() << ", multi draw modes disabled";
+	}
+	setMode(mode_);
+
+	drawsCounter_ = stats().addCounter("draws");
+	callsCounter_ = stats().addCounter("draw calls");
+	submitMsCounter_ = stats().addCounter("submit ms");
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+}
+
+QOpenGLShaderProgram * MultiDrawWindow::createProgram(const fgl::ShaderDefines & defines)
+{
+	auto * program = shaders_.program(":/Shaders/multidraw.vs", ":/Shaders/mesh.fs", defines);
+	frameUniforms_.attach(fgl::ShaderReflection::reflect(gl33(), program->programId()));
+
+	program->bind();
+	program->setUniformValue("vertices", g_verticesUnit);
+	program->setUniformValue("draws", g_drawsUnit);
+	program->release();
+	return program;
+}
+
+void MultiDrawWindow::setMode(const SubmitMode mode)
+{
+	mode_ = mode == SubmitMode::Indirect && !submitter_.supportsIndirect() ? SubmitMode::BaseVertex : mode;
+	if (!drawsFit_ || (mode_ == SubmitMode::BaseVertex && !pool_.supportsPulling()))
+	{
+		mode_ = SubmitMode::PerDraw;
+	}
+}
+
+void MultiDrawWindow::render()
+{
+	// Configure viewport
+	const auto retinaScale = devicePixelRatio();
+	const auto viewportWidth = static_cast<GLint>(width() * retinaScale);
+	const auto viewportHeight = static_cast<GLint>(height() * retinaScale);
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	// Clear buffers
+	glClearColor(0.1f, 0.1f, 0.15f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	const auto aspect = static_cast<float>(viewportWidth) / static_cast<float>(std::max(viewportHeight, 1));
+	const auto camera = multiDrawCamera(static_cast<float>(frame_) * 0.005f, aspect);
+	fgl::FrameData frameData;
+	frameData.view = camera.view;
+	frameData.projection = camera.projection;
+	frameData.viewProj = camera.projection * camera.view;
+	frameData.cameraPosition = glm::vec4{camera.position, 1.f};
+	frameUniforms_.update(frameData);
+
+	auto & gl = gl33();
+	gl.glActiveTexture(GL_TEXTURE0 + g_verticesUnit);
+	gl.glBindTexture(GL_TEXTURE_BUFFER, pool_.vertexTexture());
+	draws_.bind(g_drawsUnit);
+
+	QElapsedTimer submitTimer;
+	submitTimer.start();
+	std::size_t calls = 0;
+	switch (mode_)
+	{
+		case SubmitMode::PerDraw:
+			perDrawProgram_->bind();
+			gl.glBindVertexArray(pool_.vertexArray());
+			for (const auto & object: scene_.objects)
+			{
+				const auto & range = pool_.range(object.mesh);
+				glUniformMatrix4fv(modelUniform_, 1, GL_FALSE, glm::value_ptr(object.model));
+				gl.glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_INT,
+											reinterpret_cast<const void *>(range.firstIndex * sizeof(std::uint32_t)), range.baseVertex);
+			}
+			calls = scene_.objects.size();
+			perDrawProgram_->release();
+			break;
+		case SubmitMode::Indirect:
+			drawIdProgram_->bind();
+			submitter_.submitIndirect();
+			calls = submitter_.calls();
+			drawIdProgram_->release();
+			break;
+		case SubmitMode::BaseVertex:
+			pullProgram_->bind();
+			submitter_.submitBaseVertex(vertexStrideUniform_, drawOffsetUniform_);
+			calls = submitter_.calls();
+			pullProgram_->release();
+			break;
+	}
+	gl.glBindVertexArray(0);
+	stats().setCounter(submitMsCounter_, static_cast<double>(submitTimer.nsecsElapsed()) / 1e6);
+	stats().setCounter(drawsCounter_, static_cast<double>(scene_.objects.size()));
+	stats().setCounter(callsCounter_, static_cast<double>(calls));
+
+	++frame_;
+}
+
+void MultiDrawWindow::keyPressEvent(QKeyEvent * e)
+{
+	if (e->key() != Qt::Key_M)
+	{
+		return;
+	}
+	setMode(static_cast<SubmitMode>((static_cast<int>(mode_) + 1) % 3));
+	qInfo() << benchmarkConfigurationName();
+}
+
+bool MultiDrawWindow::setBenchmarkConfiguration(const std::size_t index)
+{
+	if (index >= g_benchmarkConfigurations.size())
+	{
+		return false;
+	}
+	setMode(g_benchmarkConfigurations[index]);
+	return true;
+}
+
+QString MultiDrawWindow::benchmarkConfigurationName() const
+{
+	switch (mode_)
+	{
+		case SubmitMode::PerDraw:
+			return "per draw calls";
+		case SubmitMode::Indirect:
+			return "multi draw indirect";
+		case SubmitMode::BaseVertex:
+			return "multi draw base vertex";
+	}
+	return {};
+}
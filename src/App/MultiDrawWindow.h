@@ -0,0 +1,66 @@
+#pragma once
+
+#include "MultiDrawScene.h"
+
+#include <Base/FrameUniforms.hpp>
+#include <Base/GLWindow.hpp>
+#include <Base/InstanceBuffer.hpp>
+#include <Base/MeshPool.hpp>
+#include <Base/MultiDraw.hpp>
+#include <Base/ShaderVariants.hpp>
+
+#include <QOpenGLShaderProgram>
+
+// Tens of thousands of distinct small draws to measure submission overhead of per draw
+// calls against multi draw indirect and its GL 3.3 base vertex fallback.
+// Keys: M cycles submission modes.
+class MultiDrawWindow final : public fgl::GLWindow
+{
+public:
+	enum class SubmitMode
+	{
+		PerDraw,
+		Indirect,
+		BaseVertex,
+	};
+
+public:
+	void init() override;
+	void render() override;
+
+protected:
+	void keyPressEvent(QKeyEvent * e) override;
+
+	bool setBenchmarkConfiguration(std::size_t index) override;
+	QString benchmarkConfigurationName() const override;
+
+private:
+	QOpenGLShaderProgram * createProgram(const fgl::ShaderDefines & defines);
+	void setMode(SubmitMode mode);
+
+private:
+	fgl::ShaderVariants shaders_;
+	QOpenGLShaderProgram * perDrawProgram_ = nullptr;
+	QOpenGLShaderProgram * drawIdProgram_ = nullptr;
+	QOpenGLShaderProgram * pullProgram_ = nullptr;
+	GLint modelUniform_ = -1;
+	GLint vertexStrideUniform_ = -1;
+	GLint drawOffsetUniform_ = -1;
+	fgl::FrameUniformBuffer frameUniforms_;
+
+	MultiDrawScene scene_;
+	fgl::MeshPool pool_;
+	// Model matrices of objects in draw order.
+	fgl::InstanceBuffer draws_;
+	fgl::MultiDrawSubmitter submitter_;
+	// Multi draw modes read model matrices of all draws from buffer texture.
+	bool drawsFit_ = true;
+
+	SubmitMode mode_ = SubmitMode::Indirect;
+
+	fgl::FrameStats::CounterId drawsCounter_ = 0;
+	fgl::FrameStats::CounterId callsCounter_ = 0;
+	fgl::FrameStats::CounterId submitMsCounter_ = 0;
+
+	std::size_t frame_ = 0;
+};
@@ -0,0 +1,54 @@
+// Lights and clusters of fgl::LightClusters bound by fgl::LightClusterBuffer, include
+// after frame.glsl. ALL_LIGHTS define loops over all lights instead of lights of fragment cluster.
+uniform samplerBuffer lights;
+uniform usamplerBuffer lightClusters;
+uniform usamplerBuffer lightIndices;
+uniform int lightCount;
+// Tiles along x and y and depth slices.
+uniform ivec3 clusterCounts;
+// Tiles per pixel, tile of fragment is gl_FragCoord.xy * clusterTileScale.
+uniform vec2 clusterTileScale;
+// Slice of view depth d is log(d) * x + y.
+uniform vec2 clusterDepthScaleBias;
+
+// Lambertian diffuse and Blinn-Phong specular lighting by light with given index, light
+// fades out smoothly to its radius.
+vec3 shadeLight(int index, vec3 albedo, float roughness, vec3 position, vec3 normal, vec3 toCamera) {
+	vec4 positionRadius = texelFetch(lights, index * 3);
+	vec3 toLight = positionRadius.xyz - position;
+	float distanceSquared = dot(toLight, toLight);
+	float falloff = clamp(1.0 - distanceSquared / (positionRadius.w * positionRadius.w), 0.0, 1.0);
+	if (falloff == 0.0) {
+		return vec3(0.0);
+	}
+	vec4 colorInner = texelFetch(lights, index * 3 + 1);
+	vec4 directionOuter = texelFetch(lights, index * 3 + 2);
+	vec3 direction = toLight * inversesqrt(distanceSquared);
+	float attenuation = falloff * falloff;
+	if (directionOuter.w > -1.0) {
+		attenuation *= smoothstep(directionOuter.w, colorInner.w, dot(-direction, directionOuter.xyz));
+	}
+	float cosine = max(dot(normal, direction), 0.0);
+	float shininess = exp2(10.0 * (1.0 - roughness) + 1.0);
+	float specular = pow(max(dot(normal, normalize(direction + toCamera)), 0.0), shininess) * (1.0 - roughness) * float(cosine > 0.0);
+	return colorInner.rgb * (attenuation * (albedo * cosine + specular));
+}
+
+// Position and normal are in world space, viewDepth is distance along view direction.
+vec3 clusteredLighting(vec3 albedo, float roughness, vec3 position, vec3 normal, float viewDepth) {
+	vec3 toCamera = normalize(cameraPosition.xyz - position);
+	vec3 result = vec3(0.0);
+#ifdef ALL_LIGHTS
+	for (int i = 0; i < lightCount; ++i) {
+		result += shadeLight(i, albedo, roughness, position, normal, toCamera);
+	}
+#else
+	ivec3 cluster = ivec3(ivec2(gl_FragCoord.xy * clusterTileScale), int(log(viewDepth) * clusterDepthScaleBias.x + clusterDepthScaleBias.y));
+	cluster = clamp(cluster, ivec3(0), clusterCounts - 1);
+	uvec2 range = texelFetch(lightClusters, cluster.x + clusterCounts.x * (cluster.y + clusterCounts.y * cluster.z)).xy;
+	for (uint i = 0u; i < range.y; ++i) {
+		result += shadeLight(int(texelFetch(lightIndices, int(range.x + i)).x), albedo, roughness, position, normal, toCamera);
+	}
+#endif
+	return result;
+}
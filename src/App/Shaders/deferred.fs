@@ -0,0 +1,31 @@
+#version 330 core
+
+// Lighting pass of deferred shading, drawn with fgl::FullscreenPass vertex shader.
+
+#include "frame.glsl"
+#include "clustered.glsl"
+#include "gbuffer.glsl"
+
+in vec2 uv;
+out vec4 out_col;
+
+uniform sampler2D gbufferAlbedo;
+uniform sampler2D gbufferNormal;
+uniform sampler2D gbufferDepth;
+uniform mat4 inverseViewProj;
+uniform vec3 ambient;
+
+void main() {
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(gbufferDepth, texel, 0).r;
+	if (depth == 1.0) {
+		// Background keeps clear color
+		discard;
+	}
+	vec4 albedoRoughness = texelFetch(gbufferAlbedo, texel, 0);
+	vec3 normal = decodeNormal(texelFetch(gbufferNormal, texel, 0).rg);
+	vec3 position = reconstructPosition(inverseViewProj, uv, depth);
+	float viewDepth = -(view * vec4(position, 1.0)).z;
+	vec3 light = clusteredLighting(albedoRoughness.rgb, albedoRoughness.a, position, normal, viewDepth);
+	out_col = vec4(albedoRoughness.rgb * ambient + light, 1.0);
+}
@@ -3,6 +3,8 @@
 in vec3 vert_col;
 out vec4 out_col;
 
+uniform vec4 tint;
+
 void main() {
-	out_col = vec4(vert_col.rgb, 1.0);
+	out_col = vec4(vert_col.rgb, 1.0) * tint;
 }
\ No newline at end of file
@@ -0,0 +1,7 @@
+// Per frame and per view data, matches fgl::FrameData bound by fgl::FrameUniformBuffer.
+layout(std140) uniform FrameData {
+	mat4 viewProj;
+	mat4 view;
+	mat4 projection;
+	vec4 cameraPosition;
+};
@@ -0,0 +1,17 @@
+#version 330 core
+
+#include "gbuffer.glsl"
+
+in vec3 vert_position;
+in vec3 vert_normal;
+in vec3 vert_col;
+
+layout(location=0) out vec4 out_albedo;
+layout(location=1) out vec2 out_normal;
+
+uniform float roughness;
+
+void main() {
+	out_albedo = vec4(vert_col, roughness);
+	out_normal = encodeNormal(normalize(vert_normal));
+}
@@ -0,0 +1,24 @@
+// Packing of fgl::GBuffer attachments.
+
+// Octahedral normal encoding, Cigolle et al., "A Survey of Efficient Representations for
+// Independent Unit Vectors". Result is in [0, 1] for unsigned normalized RG16 target.
+vec2 encodeNormal(vec3 normal) {
+	normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+	vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+	vec2 folded = normal.z >= 0.0 ? normal.xy : (1.0 - abs(normal.yx)) * signs;
+	return folded * 0.5 + 0.5;
+}
+
+vec3 decodeNormal(vec2 encoded) {
+	encoded = encoded * 2.0 - 1.0;
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = clamp(-normal.z, 0.0, 1.0);
+	normal.xy += vec2(normal.x >= 0.0 ? -fold : fold, normal.y >= 0.0 ? -fold : fold);
+	return normalize(normal);
+}
+
+// World space position of pixel with window coordinates in [0, 1] and depth buffer value.
+vec3 reconstructPosition(mat4 inverseViewProj, vec2 uv, float depth) {
+	vec4 position = inverseViewProj * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+	return position.xyz / position.w;
+}
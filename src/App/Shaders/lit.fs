@@ -0,0 +1,18 @@
+#version 330 core
+
+#include "frame.glsl"
+#include "clustered.glsl"
+
+in vec3 vert_position;
+in vec3 vert_normal;
+in vec3 vert_col;
+out vec4 out_col;
+
+uniform vec3 ambient;
+uniform float roughness;
+
+void main() {
+	float viewDepth = -(view * vec4(vert_position, 1.0)).z;
+	vec3 light = clusteredLighting(vert_col, roughness, vert_position, normalize(vert_normal), viewDepth);
+	out_col = vec4(vert_col * ambient + light, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+layout(location=0) in vec3 pos;
+layout(location=1) in vec3 normal;
+layout(location=2) in vec3 col;
+
+// Model matrices of instances, matrix of instance i starts at texel 4 * (firstInstance + i).
+uniform samplerBuffer models;
+uniform int firstInstance;
+
+#include "frame.glsl"
+
+out vec3 vert_position;
+out vec3 vert_normal;
+out vec3 vert_col;
+
+void main() {
+	int base = (firstInstance + gl_InstanceID) * 4;
+	mat4 model = mat4(texelFetch(models, base), texelFetch(models, base + 1), texelFetch(models, base + 2), texelFetch(models, base + 3));
+	vec4 position = model * vec4(pos, 1.0);
+	vert_position = position.xyz;
+	vert_normal = mat3(model) * normal;
+	vert_col = col;
+	gl_Position = viewProj * position;
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+// Variants are selected by TEXTURED and LIT defines inserted after version line.
+
+in vec3 vert_pos;
+in vec3 vert_normal;
+in vec3 vert_col;
+out vec4 out_col;
+
+uniform vec4 color;
+uniform sampler2D albedo;
+
+const vec3 light_dir = normalize(vec3(0.4, 1.0, 0.6));
+
+void main() {
+	vec4 base = color * vec4(vert_col, 1.0);
+#ifdef TEXTURED
+	// Meshes have no texture coordinates, project object space position instead
+	base *= texture(albedo, vert_pos.xy + vert_pos.zz * 0.5);
+#endif
+#ifdef LIT
+	float diffuse = max(dot(normalize(vert_normal), light_dir), 0.0);
+	base.rgb *= 0.25 + 0.75 * diffuse;
+#endif
+	out_col = base;
+}
@@ -0,0 +1,32 @@
+#version 330 core
+
+// INSTANCED define inserted after version line reads model matrices from instance buffer.
+
+layout(location=0) in vec3 pos;
+layout(location=1) in vec3 normal;
+layout(location=2) in vec3 col;
+
+#include "frame.glsl"
+
+#ifdef INSTANCED
+uniform samplerBuffer instances;
+uniform int instanceOffset;
+#else
+uniform mat4 model;
+#endif
+
+out vec3 vert_pos;
+out vec3 vert_normal;
+out vec3 vert_col;
+
+void main() {
+#ifdef INSTANCED
+	int base = (instanceOffset + gl_InstanceID) * 4;
+	mat4 model = mat4(texelFetch(instances, base), texelFetch(instances, base + 1),
+					  texelFetch(instances, base + 2), texelFetch(instances, base + 3));
+#endif
+	vert_pos = pos;
+	vert_normal = mat3(model) * normal;
+	vert_col = col;
+	gl_Position = viewProj * model * vec4(pos, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec3 vert_normal;
+in vec3 vert_col;
+out vec4 out_col;
+
+const vec3 light_dir = normalize(vec3(0.4, 1.0, 0.6));
+
+void main() {
+	float diffuse = max(dot(normalize(vert_normal), light_dir), 0.0);
+	out_col = vec4(vert_col.rgb * (0.25 + 0.75 * diffuse), 1.0);
+}
@@ -0,0 +1,51 @@
+#version 330 core
+
+// Variants are selected by defines inserted after version line:
+// DRAW_ID - model matrix is read from draws buffer at index of per draw instanced attribute;
+// PULL_VERTICES - vertex and draw index are decoded from gl_VertexID, base vertex of draw d
+// is offset by d * vertexStride, vertices are read from pool buffer.
+// Without defines model matrix is uniform.
+
+#ifdef PULL_VERTICES
+uniform samplerBuffer vertices;
+uniform int vertexStride;
+uniform int drawOffset;
+#else
+layout(location=0) in vec3 pos;
+layout(location=1) in vec3 normal;
+layout(location=2) in vec3 col;
+#endif
+#ifdef DRAW_ID
+layout(location=3) in uint drawId;
+#endif
+
+#if defined(DRAW_ID) || defined(PULL_VERTICES)
+uniform samplerBuffer draws;
+
+mat4 drawModel(int draw) {
+	int base = draw * 4;
+	return mat4(texelFetch(draws, base), texelFetch(draws, base + 1), texelFetch(draws, base + 2), texelFetch(draws, base + 3));
+}
+#else
+uniform mat4 model;
+#endif
+
+#include "frame.glsl"
+
+out vec3 vert_normal;
+out vec3 vert_col;
+
+void main() {
+#if defined(PULL_VERTICES)
+	int vertex = (gl_VertexID % vertexStride) * 3;
+	mat4 model = drawModel(drawOffset + gl_VertexID / vertexStride);
+	vec3 pos = texelFetch(vertices, vertex).xyz;
+	vec3 normal = texelFetch(vertices, vertex + 1).xyz;
+	vec3 col = texelFetch(vertices, vertex + 2).xyz;
+#elif defined(DRAW_ID)
+	mat4 model = drawModel(int(drawId));
+#endif
+	vert_normal = mat3(model) * normal;
+	vert_col = col;
+	gl_Position = viewProj * model * vec4(pos, 1.0);
+}
@@ -0,0 +1,35 @@
+// Cascades of fgl::CascadedShadowMaps, include after frame.glsl.
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 cascadeViewProj[4];
+uniform int cascadeCount;
+// View depth where each cascade ends.
+uniform vec4 cascadeSplits;
+// World size of shadow map texel of each cascade.
+uniform vec4 cascadeTexelSizes;
+
+int shadowCascade(float viewDepth) {
+	int cascade = 0;
+	for (int i = 0; i < cascadeCount - 1; ++i) {
+		cascade += int(viewDepth > cascadeSplits[i]);
+	}
+	return cascade;
+}
+
+// Part of sun light reaching the point, 3x3 taps of 2x2 PCF. Point is moved along normal by
+// texel size of its cascade against self shadowing, points beyond the last cascade are lit.
+float sunShadow(vec3 position, vec3 normal, float viewDepth) {
+	if (viewDepth > cascadeSplits[cascadeCount - 1]) {
+		return 1.0;
+	}
+	int cascade = shadowCascade(viewDepth);
+	vec4 clip = cascadeViewProj[cascade] * vec4(position + normal * (1.5 * cascadeTexelSizes[cascade]), 1.0);
+	vec3 coords = clip.xyz * 0.5 + 0.5;
+	vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+	float lit = 0.0;
+	for (int y = -1; y <= 1; ++y) {
+		for (int x = -1; x <= 1; ++x) {
+			lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, float(cascade), coords.z));
+		}
+	}
+	return lit / 9.0;
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+in vec3 vert_normal;
+in vec2 vert_uv;
+out vec4 out_col;
+
+uniform sampler2D albedo;
+// Tint of the finest resident level, white when levels are not shown.
+uniform vec3 tint;
+
+const vec3 light_dir = normalize(vec3(0.4, 1.0, 0.6));
+
+void main() {
+	float diffuse = max(dot(normalize(vert_normal), light_dir), 0.0);
+	out_col = vec4(texture(albedo, vert_uv).rgb * tint * (0.35 + 0.65 * diffuse), 1.0);
+}
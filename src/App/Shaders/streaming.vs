@@ -0,0 +1,18 @@
+#version 330 core
+
+layout(location=0) in vec3 pos;
+layout(location=1) in vec3 normal;
+
+uniform mat4 model;
+
+#include "frame.glsl"
+
+out vec3 vert_normal;
+out vec2 vert_uv;
+
+void main() {
+	// Top of unit tile box covers the whole texture
+	vert_uv = pos.xz + 0.5;
+	vert_normal = mat3(model) * normal;
+	gl_Position = viewProj * model * vec4(pos, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 330 core
+
+#include "frame.glsl"
+#include "shadows.glsl"
+
+in vec3 vert_position;
+in vec3 vert_normal;
+in vec3 vert_col;
+out vec4 out_col;
+
+// Direction towards the sun.
+uniform vec3 sunDirection;
+uniform vec3 sunColor;
+uniform vec3 ambient;
+// Tints surfaces by cascade they sample.
+uniform bool showCascades;
+
+const vec3 cascadeTints[4] = vec3[4](vec3(1.0, 0.6, 0.6), vec3(0.6, 1.0, 0.6), vec3(0.6, 0.6, 1.0), vec3(1.0, 1.0, 0.6));
+
+void main() {
+	vec3 normal = normalize(vert_normal);
+	float viewDepth = -(view * vec4(vert_position, 1.0)).z;
+	float cosine = max(dot(normal, sunDirection), 0.0);
+	float shadow = cosine > 0.0 ? sunShadow(vert_position, normal, viewDepth) : 0.0;
+	vec3 color = vert_col * (ambient + sunColor * (cosine * shadow));
+	if (showCascades) {
+		color *= cascadeTints[shadowCascade(viewDepth)];
+	}
+	out_col = vec4(color, 1.0);
+}
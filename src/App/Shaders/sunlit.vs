@@ -0,0 +1,21 @@
+#version 330 core
+
+layout(location=0) in vec3 pos;
+layout(location=1) in vec3 normal;
+layout(location=2) in vec3 col;
+
+uniform mat4 model;
+
+#include "frame.glsl"
+
+out vec3 vert_position;
+out vec3 vert_normal;
+out vec3 vert_col;
+
+void main() {
+	vec4 position = model * vec4(pos, 1.0);
+	vert_position = position.xyz;
+	vert_normal = mat3(model) * normal;
+	vert_col = col;
+	gl_Position = viewProj * position;
+}
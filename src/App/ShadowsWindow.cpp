@@ -0,0 +1,325 @@
+#include "ShadowsWindow.h"
+
+#include <Base/MeshPrimitives.hpp>
+#include <Base/ShaderReflection.hpp>
+
+#include <QDebug>
+#include <QKeyEvent>
+#include <QVector3D>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+constexpr auto g_fovY = glm::radians(60.f);
+constexpr auto g_near = 0.1f;
+constexpr auto g_far = 1000.f;
+constexpr auto g_shadowUnit = 0;
+
+constexpr std::size_t g_ballCount = 48;
+constexpr auto g_ballRadius = 0.6f;
+
+struct BenchmarkConfiguration
+{
+	bool caching;
+	bool sunMoving;
+	int resolution;
+};
+
+constexpr std::array<BenchmarkConfiguration, 4u> g_benchmarkConfigurations = {{
+	{false, false, 1024},
+	{true, false, 1024},
+	{true, true, 1024},
+	{true, false, 2048},
+}};
+
+glm::vec3 sunDirection(const float time)
+{
+	const auto angle = 0.6f + time * 0.05f;
+	return glm::normalize(glm::vec3{0.7f * std::cos(angle), 1.f, 0.7f * std::sin(angle)});
+}
+
+}// namespace
+
+ShadowsWindow::ShadowsWindow()
+	: scene_{makeCityScene()}
+{
+}
+
+void ShadowsWindow::init()
+{
+	frameUniforms_.create(gl33());
+
+	litProgram_ = shaders_.program(":/Shaders/sunlit.vs", ":/Shaders/sunlit.fs");
+	const auto litReflection = fgl::ShaderReflection::reflect(gl33(), litProgram_->programId());
+	frameUniforms_.attach(litReflection);
+	modelUniform_ = litReflection.uniformLocation("model");
+	sunDirectionUniform_ = litReflection.uniformLocation("sunDirection");
+	showCascadesUniform_ = litReflection.uniformLocation("showCascades");
+	cascadeViewProjUniform_ = litReflection.uniformLocation("cascadeViewProj");
+	cascadeCountUniform_ = litReflection.uniformLocation("cascadeCount");
+	cascadeSplitsUniform_ = litReflection.uniformLocation("cascadeSplits");
+	cascadeTexelSizesUniform_ = litReflection.uniformLocation("cascadeTexelSizes");
+	litProgram_->bind();
+	litProgram_->setUniformValue("shadowMap", g_shadowUnit);
+	litProgram_->setUniformValue("sunColor", QVector3D{1.f, 0.95f, 0.85f});
+	litProgram_->setUniformValue("ambient", QVector3D{0.3f, 0.33f, 0.4f});
+	litProgram_->release();
+
+	casterProgram_ = shaders_.program(":/Shaders/shadowcaster.vs", ":/Shaders/shadowcaster.fs");
+	const auto casterReflection = fgl::ShaderReflection::reflect(gl33(), casterProgram_->programId());
+	casterModelUniform_ = casterReflection.uniformLocation("model");
+	lightViewProjUniform_ = casterReflection.uniformLocation("lightViewProj");
+
+	// Ground and balls are drawn from the same pool as city meshes
+	auto meshes = scene_.meshes;
+	groundMesh_ = meshes.size();
+	meshes.push_back(fgl::makeBox(glm::vec3{scene_.size * 0.5f, 0.5f, scene_.size * 0.5f}, glm::vec3{0.45f, 0.45f, 0.42f}));
+	const auto ballMesh = meshes.size();
+	meshes.push_back(fgl::makeIcosphere(2, glm::vec3{0.9f, 0.85f, 0.3f}));
+	pool_.create(gl33(), meshes);
+	for (const auto & mesh: meshes)
+	{
+		meshBounds_.push_back(fgl::computeAabb(mesh));
+	}
+	groundModel_ = glm::translate(glm::mat4{1.f}, glm::vec3{scene_.size * 0.5f, -0.5f, scene_.size * 0.5f});
+
+	dynamic_.resize(g_ballCount);
+	for (auto & object: dynamic_)
+	{
+		object.mesh = ballMesh;
+		dynamicBounds_.add(fgl::Aabb{});
+	}
+
+	// Balls stay below the tallest building, so city bounds with ground hold all casters and receivers
+	auto sceneBounds = fgl::transform(meshBounds_[groundMesh_], groundModel_);
+	for (const auto & box: scene_.bounds)
+	{
+		sceneBounds.expand(box);
+	}
+	shadows_.setSettings(settings_);
+	shadows_.setSceneBounds(sceneBounds);
+	shadows_.create(gl33());
+	gpuTimer_.create(gl33(), SectionCount);
+
+	for (std::size_t cascade = 0; cascade < fgl::CascadedShadowMaps::maxCascades; ++cascade)
+	{
+		cascadeDrawsCounters_[cascade] = stats().addCounter(QString{"cascade %1 draws"}.arg(cascade));
+		cascadeGpuMsCounters_[cascade] = stats().addCounter(QString{"cascade %1 gpu ms"}.arg(cascade));
+	}
+	shadowDrawsCounter_ = stats().addCounter("shadow draws");
+	cascadesRenderedCounter_ = stats().addCounter("cascades rendered");
+	drawsCounter_ = stats().addCounter("draws");
+	mainGpuMsCounter_ = stats().addCounter("main gpu ms");
+	shadowMapMbCounter_ = stats().addCounter("shadow map MB");
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+}
+
+void ShadowsWindow::animate(const glm::vec3 & cameraPosition, const float time)
+{
+	// Balls bounce on rings around the camera, so they are always in near cascades
+	for (std::size_t i = 0; i < dynamic_.size(); ++i)
+	{
+		const auto phase = static_cast<float>(i) * 2.39996f;
+		const auto distance = 3.f + static_cast<float>(i % 6) * 2.5f;
+		const auto angle = phase + time * (0.3f + 0.05f * static_cast<float>(i % 5));
+		const auto height = g_ballRadius + 2.f * std::abs(std::sin(time * 2.f + phase));
+		const glm::vec3 position{cameraPosition.x + distance * std::cos(angle), height, cameraPosition.z + distance * std::sin(angle)};
+		auto & object = dynamic_[i];
+		object.model = glm::scale(glm::translate(glm::mat4{1.f}, position), glm::vec3{g_ballRadius});
+		dynamicBounds_.set(static_cast<std::uint32_t>(i), fgl::transform(meshBounds_[object.mesh], object.model));
+	}
+}
+
+void ShadowsWindow::render()
+{
+	gpuTimer_.beginFrame();
+	for (std::size_t cascade = 0; cascade < fgl::CascadedShadowMaps::maxCascades; ++cascade)
+	{
+		stats().setCounter(cascadeGpuMsCounters_[cascade], gpuTimer_.ms(cascade));
+	}
+	stats().setCounter(mainGpuMsCounter_, gpuTimer_.ms(MainSection));
+
+	const auto retinaScale = devicePixelRatio();
+	const auto viewportWidth = static_cast<GLint>(width() * retinaScale);
+	const auto viewportHeight = static_cast<GLint>(height() * retinaScale);
+	const auto aspect = static_cast<float>(viewportWidth) / static_cast<float>(std::max(viewportHeight, 1));
+
+	const auto time = static_cast<float>(frame_) * 0.05f;
+	const auto camera = cityCamera(scene_, time);
+	const auto projection = glm::perspective(g_fovY, aspect, g_near, g_far);
+	animate(camera.position, time);
+
+	const auto sun = sunDirection(sunMoving_ ? time : 0.f);
+	shadows_.setLightDirection(sun);
+	shadows_.update(camera.view, g_fovY, aspect, g_near);
+
+	// Back faces go into shadow maps, front faces of closed casters then have no acne
+	std::size_t shadowDraws = 0;
+	std::size_t cascadesRendered = 0;
+	casterProgram_->bind();
+	glCullFace(GL_FRONT);
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(1.f, 2.f);
+	for (std::size_t cascade = 0; cascade < fgl::CascadedShadowMaps::maxCascades; ++cascade)
+	{
+		auto draws = std::size_t{0};
+		if (cascade < shadows_.cascadeCount() && shadows_.beginCascade(cascade))
+		{
+			gpuTimer_.begin(cascade);
+			draws = renderCascade(cascade);
+			gpuTimer_.end();
+			shadows_.endCascade();
+			++cascadesRendered;
+		}
+		stats().setCounter(cascadeDrawsCounters_[cascade], static_cast<double>(draws));
+		shadowDraws += draws;
+	}
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glCullFace(GL_BACK);
+	casterProgram_->release();
+	stats().setCounter(shadowDrawsCounter_, static_cast<double>(shadowDraws));
+	stats().setCounter(cascadesRenderedCounter_, static_cast<double>(cascadesRendered));
+	stats().setCounter(shadowMapMbCounter_, static_cast<double>(shadows_.textureBytes()) / 1e6);
+
+	// Configure viewport
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	// Clear buffers
+	glClearColor(0.55f, 0.7f, 0.85f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	fgl::FrameData frameData;
+	frameData.view = camera.view;
+	frameData.projection = projection;
+	frameData.viewProj = projection * camera.view;
+	frameData.cameraPosition = glm::vec4{camera.position, 1.f};
+	frameUniforms_.update(frameData);
+
+	std::array<glm::mat4, fgl::CascadedShadowMaps::maxCascades> cascadeViewProj;
+	glm::vec4 splits{0.f};
+	glm::vec4 texelSizes{0.f};
+	for (std::size_t cascade = 0; cascade < shadows_.cascadeCount(); ++cascade)
+	{
+		const auto & data = shadows_.cascade(cascade);
+		cascadeViewProj[cascade] = data.viewProj;
+		splits[static_cast<int>(cascade)] = data.splitDepth;
+		texelSizes[static_cast<int>(cascade)] = std::max(data.texelSize.x, data.texelSize.y);
+	}
+
+	shadows_.bindTexture(g_shadowUnit);
+	litProgram_->bind();
+	glUniform3fv(sunDirectionUniform_, 1, glm::value_ptr(sun));
+	glUniform1i(showCascadesUniform_, showCascades_ ? 1 : 0);
+	glUniformMatrix4fv(cascadeViewProjUniform_, static_cast<GLsizei>(shadows_.cascadeCount()), GL_FALSE, glm::value_ptr(cascadeViewProj[0]));
+	glUniform1i(cascadeCountUniform_, static_cast<GLint>(shadows_.cascadeCount()));
+	glUniform4fv(cascadeSplitsUniform_, 1, glm::value_ptr(splits));
+	glUniform4fv(cascadeTexelSizesUniform_, 1, glm::value_ptr(texelSizes));
+
+	gpuTimer_.begin(MainSection);
+	const auto frustum = fgl::Frustum::fromMatrix(frameData.viewProj);
+	fgl::cullFrustumParallel(frustum, scene_.cullBounds, fgl::CullVolume::Box, visible_);
+	for (const auto index: visible_)
+	{
+		const auto & object = scene_.objects[index];
+		drawMesh(object.mesh, object.model, modelUniform_);
+	}
+	auto draws = visible_.size() + 1;
+	drawMesh(groundMesh_, groundModel_, modelUniform_);
+	fgl::cullFrustum(frustum, dynamicBounds_, fgl::CullVolume::Box, visible_);
+	for (const auto index: visible_)
+	{
+		drawMesh(dynamic_[index].mesh, dynamic_[index].model, modelUniform_);
+	}
+	draws += visible_.size();
+	gpuTimer_.end();
+	litProgram_->release();
+	stats().setCounter(drawsCounter_, static_cast<double>(draws));
+
+	++frame_;
+}
+
+std::size_t ShadowsWindow::renderCascade(const std::size_t cascade)
+{
+	glUniformMatrix4fv(lightViewProjUniform_, 1, GL_FALSE, glm::value_ptr(shadows_.cascade(cascade).viewProj));
+
+	// Ground is the lowest surface and casts nothing
+	const auto frustum = shadows_.frustum(cascade);
+	fgl::cullFrustumParallel(frustum, scene_.cullBounds, fgl::CullVolume::Box, visible_);
+	for (const auto index: visible_)
+	{
+		const auto & object = scene_.objects[index];
+		drawMesh(object.mesh, object.model, casterModelUniform_);
+	}
+	auto draws = visible_.size();
+	if (!shadows_.isStaticOnly(cascade))
+	{
+		fgl::cullFrustum(frustum, dynamicBounds_, fgl::CullVolume::Box, visible_);
+		for (const auto index: visible_)
+		{
+			drawMesh(dynamic_[index].mesh, dynamic_[index].model, casterModelUniform_);
+		}
+		draws += visible_.size();
+	}
+	return draws;
+}
+
+void ShadowsWindow::drawMesh(const std::size_t mesh, const glm::mat4 & model, const GLint modelUniform)
+{
+	auto & gl = gl33();
+	const auto & range = pool_.range(mesh);
+	gl.glBindVertexArray(pool_.vertexArray());
+	glUniformMatrix4fv(modelUniform, 1, GL_FALSE, glm::value_ptr(model));
+	gl.glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_INT,
+								reinterpret_cast<const void *>(range.firstIndex * sizeof(std::uint32_t)), range.baseVertex);
+}
+
+void ShadowsWindow::keyPressEvent(QKeyEvent * e)
+{
+	switch (e->key())
+	{
+		case Qt::Key_C:
+			settings_.caching = !settings_.caching;
+			shadows_.setSettings(settings_);
+			break;
+		case Qt::Key_L:
+			sunMoving_ = !sunMoving_;
+			break;
+		case Qt::Key_V:
+			showCascades_ = !showCascades_;
+			break;
+		default:
+			return;
+	}
+	qInfo() << benchmarkConfigurationName();
+}
+
+bool ShadowsWindow::setBenchmarkConfiguration(const std::size_t index)
+{
+	if (index >= g_benchmarkConfigurations.size())
+	{
+		return false;
+	}
+	const auto & configuration = g_benchmarkConfigurations[index];
+	settings_.caching = configuration.caching;
+	settings_.resolution = configuration.resolution;
+	shadows_.setSettings(settings_);
+	sunMoving_ = configuration.sunMoving;
+	return true;
+}
+
+QString ShadowsWindow::benchmarkConfigurationName() const
+{
+	return QString{"%1 cascades %2x%2, %3, %4"}
+		.arg(settings_.cascadeCount)
+		.arg(settings_.resolution)
+		.arg(settings_.caching ? QString{"cascades from %1 cached"}.arg(settings_.dynamicCascades) : QString{"all cascades every frame"})
+		.arg(sunMoving_ ? "moving sun" : "static sun");
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CityScene.h"
+
+#include <Base/CascadedShadowMaps.hpp>
+#include <Base/FrameUniforms.hpp>
+#include <Base/FrustumCuller.hpp>
+#include <Base/GLWindow.hpp>
+#include <Base/GpuTimer.hpp>
+#include <Base/MeshPool.hpp>
+#include <Base/ShaderVariants.hpp>
+
+#include <QOpenGLShaderProgram>
+
+#include <array>
+#include <vector>
+
+// City lit by the sun with cascaded shadow maps. Buildings, trees and props are static
+// casters, balls bouncing around the camera are dynamic ones drawn into near cascades only.
+// Far cascades are cached and rendered again when the sun moves or camera leaves them.
+// Keys: C toggles caching of far cascades, L toggles sun motion, V tints cascades.
+class ShadowsWindow final : public fgl::GLWindow
+{
+public:
+	ShadowsWindow();
+
+	void init() override;
+	void render() override;
+
+protected:
+	void keyPressEvent(QKeyEvent * e) override;
+
+	bool setBenchmarkConfiguration(std::size_t index) override;
+	QString benchmarkConfigurationName() const override;
+
+private:
+	struct DynamicObject
+	{
+		glm::mat4 model{1.f};
+		std::size_t mesh = 0;
+	};
+
+	// GPU timer sections, cascades go first.
+	enum Section : std::size_t
+	{
+		MainSection = fgl::CascadedShadowMaps::maxCascades,
+		SectionCount,
+	};
+
+private:
+	void animate(const glm::vec3 & cameraPosition, float time);
+	// Returns number of draws.
+	std::size_t renderCascade(std::size_t cascade);
+	// Program must be bound.
+	void drawMesh(std::size_t mesh, const glm::mat4 & model, GLint modelUniform);
+
+private:
+	fgl::ShaderVariants shaders_;
+	QOpenGLShaderProgram * litProgram_ = nullptr;
+	QOpenGLShaderProgram * casterProgram_ = nullptr;
+	GLint modelUniform_ = -1;
+	GLint sunDirectionUniform_ = -1;
+	GLint showCascadesUniform_ = -1;
+	GLint cascadeViewProjUniform_ = -1;
+	GLint cascadeCountUniform_ = -1;
+	GLint cascadeSplitsUniform_ = -1;
+	GLint cascadeTexelSizesUniform_ = -1;
+	GLint casterModelUniform_ = -1;
+	GLint lightViewProjUniform_ = -1;
+	fgl::FrameUniformBuffer frameUniforms_;
+
+	CityScene scene_;
+	fgl::MeshPool pool_;
+	std::size_t groundMesh_ = 0;
+	glm::mat4 groundModel_{1.f};
+	std::vector<fgl::Aabb> meshBounds_;
+	std::vector<DynamicObject> dynamic_;
+	fgl::BoundsSoA dynamicBounds_;
+	std::vector<std::uint32_t> visible_;
+
+	fgl::CascadedShadowMaps shadows_;
+	fgl::CascadeSettings settings_;
+	fgl::GpuTimer gpuTimer_;
+	bool sunMoving_ = false;
+	bool showCascades_ = false;
+
+	std::array<fgl::FrameStats::CounterId, fgl::CascadedShadowMaps::maxCascades> cascadeDrawsCounters_{};
+	std::array<fgl::FrameStats::CounterId, fgl::CascadedShadowMaps::maxCascades> cascadeGpuMsCounters_{};
+	fgl::FrameStats::CounterId shadowDrawsCounter_ = 0;
+	fgl::FrameStats::CounterId cascadesRenderedCounter_ = 0;
+	fgl::FrameStats::CounterId drawsCounter_ = 0;
+	fgl::FrameStats::CounterId mainGpuMsCounter_ = 0;
+	fgl::FrameStats::CounterId shadowMapMbCounter_ = 0;
+
+	std::size_t frame_ = 0;
+};
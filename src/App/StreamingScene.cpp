@@ -0,0 +1,172 @@
+#include "StreamingScene.h"
+
+#include <Base/Ktx2.hpp>
+#include <Base/MeshPrimitives.hpp>
+#include <Base/ParallelFor.hpp>
+#include <Base/TextureCompression.hpp>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+constexpr auto g_gridSize = 32;
+constexpr auto g_tileSize = 8.f;
+constexpr auto g_tileThickness = 0.04f;
+constexpr auto g_cameraHeight = 4.f;
+
+// Hue of texture index as RGB in [0, 255].
+glm::ivec3 hueColor(const std::uint32_t index, const std::uint32_t count)
+{
+	const auto hue = static_cast<float>(index) / static_cast<float>(count) * 6.f;
+	const auto channel = [&](const float offset) {
+		return std::clamp(std::abs(std::fmod(hue + offset, 6.f) - 3.f) - 1.f, 0.f, 1.f);
+	};
+	return glm::ivec3{glm::vec3{channel(0.f), channel(4.f), channel(2.f)} * 200.f} + 40;
+}
+
+// Checker of large cells with thin grid lines and stripes, so every mip level shows
+// different detail.
+QImage makeTexture(const std::uint32_t index, const std::uint32_t count, const int size)
+{
+	QImage image{size, size, QImage::Format_RGBA8888};
+	const auto color = hueColor(index, count);
+	const auto cell = std::max(size / 8, 1);
+	const auto line = std::max(size / 64, 1);
+	const auto stripe = 3 + static_cast<int>(index % 5);
+	for (int y = 0; y < size; ++y)
+	{
+		auto * row = reinterpret_cast<std::uint32_t *>(image.scanLine(y));
+		for (int x = 0; x < size; ++x)
+		{
+			auto shade = (x / cell + y / cell) % 2 == 0 ? 1.f : 0.6f;
+			if (x % line == 0 || y % line == 0)
+			{
+				shade *= 0.5f;
+			}
+			if ((x + y) / stripe % 4 == 0)
+			{
+				shade *= 0.85f;
+			}
+			const auto texel = glm::ivec3{glm::vec3{color} * shade};
+			row[x] = static_cast<std::uint32_t>(texel.r) | static_cast<std::uint32_t>(texel.g) << 8u |
+					 static_cast<std::uint32_t>(texel.b) << 16u | 0xff000000u;
+		}
+	}
+	return image;
+}
+
+}// namespace
+
+StreamingScene makeStreamingScene(const std::uint32_t textureCount)
+{
+	StreamingScene scene;
+	scene.textureCount = textureCount;
+	scene.tileSize = g_tileSize;
+	scene.size = g_gridSize * g_tileSize;
+	scene.tileMesh = fgl::makeBox(glm::vec3{0.5f}, glm::vec3{1.f});
+
+	std::mt19937 random{5};
+	for (int x = 0; x < g_gridSize; ++x)
+	{
+		for (int z = 0; z < g_gridSize; ++z)
+		{
+			const glm::vec3 center{(static_cast<float>(x) + 0.5f) * g_tileSize - scene.size * 0.5f, -g_tileThickness * 0.5f,
+								   (static_cast<float>(z) + 0.5f) * g_tileSize - scene.size * 0.5f};
+			const auto model = glm::scale(glm::translate(glm::mat4{1.f}, center), glm::vec3{g_tileSize, g_tileThickness, g_tileSize});
+			scene.tiles.push_back({model, static_cast<std::uint32_t>(random() % textureCount)});
+			scene.bounds.push_back({center, g_tileSize * std::sqrt(0.5f)});
+			scene.cullBounds.add(scene.bounds.back());
+		}
+	}
+	return scene;
+}
+
+QStringList writeStreamingTextures(const QString & directory, const std::uint32_t textureCount, const int size)
+{
+	QDir{}.mkpath(directory);
+	QStringList paths;
+	for (std::uint32_t i = 0; i < textureCount; ++i)
+	{
+		paths.append(QDir{directory}.filePath(QString{"texture-%1-%2.png"}.arg(size).arg(i)));
+	}
+	fgl::parallelFor(static_cast<std::size_t>(paths.size()), 1, [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			const auto & path = paths.at(static_cast<int>(i));
+			if (!QFileInfo{path}.exists())
+			{
+				makeTexture(static_cast<std::uint32_t>(i), textureCount, size).save(path);
+			}
+		}
+	});
+	return paths;
+}
+
+QStringList cookStreamingTextures(const QStringList & images, const fgl::TextureFormat format)
+{
+	// Each level is encoded on worker threads, so files go one by one
+	QStringList paths;
+	for (const auto & image: images)
+	{
+		const QFileInfo info{image};
+		const auto path = QDir{info.path()}.filePath(QString{"%1.%2.ktx2"}.arg(info.completeBaseName()).arg(fgl::textureFormatName(format)));
+		const auto existing = QFileInfo{path}.exists() ? fgl::readKtx2Info(path) : std::nullopt;
+		if (existing && existing->format == format && existing->levelCount > 0)
+		{
+			paths.append(path);
+			continue;
+		}
+
+		auto level = fgl::loadRgba8Image(image);
+		if (!level)
+		{
+			qWarning() << "failed to load" << image;
+			return {};
+		}
+		fgl::TextureData texture;
+		texture.format = format;
+		texture.width = level->width;
+		texture.height = level->height;
+		const auto levelCount = fgl::fullLevelCount(level->width, level->height);
+		for (int i = 0; i < levelCount; ++i)
+		{
+			texture.levels.push_back(fgl::encode(*level, format, fgl::EncoderPreset::Fast).bytes);
+			if (i + 1 < levelCount)
+			{
+				level = fgl::downsample(*level);
+			}
+		}
+
+		// File is renamed into place once complete, so interrupted runs leave no file to skip
+		const auto partPath = path + ".part";
+		if (!fgl::saveKtx2(partPath, texture) || (QFile::exists(path) && !QFile::remove(path)) || !QFile::rename(partPath, path))
+		{
+			qWarning() << "failed to write" << path;
+			QFile::remove(partPath);
+			return {};
+		}
+		paths.append(path);
+	}
+	return paths;
+}
+
+StreamingCamera streamingCamera(const StreamingScene & scene, const float time)
+{
+	// Circle over the field looking ahead and slightly down
+	const auto radius = scene.size * 0.3f;
+	const auto angle = time * 0.1f;
+	const glm::vec3 position{radius * std::cos(angle), g_cameraHeight, radius * std::sin(angle)};
+	const glm::vec3 direction{-std::sin(angle), -0.15f, std::cos(angle)};
+	return {position, glm::lookAt(position, position + direction, glm::vec3{0.f, 1.f, 0.f})};
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/FrustumCuller.hpp>
+#include <Base/Mesh.hpp>
+#include <Base/TextureFormat.hpp>
+
+#include <QString>
+#include <QStringList>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Field of flat tiles, each showing one of many large textures, far more than fit into
+// texture memory at full resolution.
+struct StreamingScene
+{
+	struct Tile
+	{
+		glm::mat4 model;
+		std::uint32_t texture;
+	};
+
+	// Tile is a thin unit box, shaders map its top to [0, 1] texture coordinates.
+	fgl::Mesh tileMesh;
+	std::vector<Tile> tiles;
+	std::vector<fgl::BoundingSphere> bounds;
+	fgl::BoundsSoA cullBounds;
+
+	std::uint32_t textureCount = 0;
+	// World size of tile side.
+	float tileSize = 0.f;
+	// Scene spans [-size / 2, size / 2] along X and Z.
+	float size = 0.f;
+};
+
+StreamingScene makeStreamingScene(std::uint32_t textureCount);
+
+// Writes textureCount generated square images of given size to directory unless they are
+// there already, on worker threads. Returns their paths.
+QStringList writeStreamingTextures(const QString & directory, std::uint32_t textureCount, int size);
+// Encodes images with all mip levels into KTX2 files next to them unless they are there
+// already. Returns their paths, or empty list when some image can not be cooked.
+QStringList cookStreamingTextures(const QStringList & images, fgl::TextureFormat format);
+
+struct StreamingCamera
+{
+	glm::vec3 position;
+	glm::mat4 view;
+};
+
+// Camera flying low above the tiles, so near tiles need full resolution and far ones coarse levels.
+StreamingCamera streamingCamera(const StreamingScene & scene, float time);
@@ -0,0 +1,256 @@
+#include "StreamingWindow.h"
+
+#include <Base/ShaderReflection.hpp>
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+
+constexpr auto g_fovY = glm::radians(60.f);
+constexpr auto g_near = 0.1f;
+constexpr auto g_far = 400.f;
+constexpr auto g_albedoUnit = 0;
+
+constexpr std::uint32_t g_textureCount = 64;
+constexpr auto g_textureSize = 1024;
+constexpr std::size_t g_megabyte = std::size_t{1} << 20u;
+constexpr std::size_t g_minMemoryBudget = 4 * g_megabyte;
+constexpr std::size_t g_maxMemoryBudget = 1024 * g_megabyte;
+constexpr std::array<std::size_t, 3u> g_uploadBudgets = {1 * g_megabyte, 4 * g_megabyte, 16 * g_megabyte};
+// Textures are opaque, so 4 bits per pixel are enough.
+constexpr auto g_compressedFormat = fgl::TextureFormat::Bc1;
+
+// Tints of finest resident level, from full resolution to coarse ones.
+constexpr std::array<glm::vec3, 6u> g_levelTints = {{
+	{1.f, 0.4f, 0.4f},
+	{1.f, 1.f, 0.4f},
+	{0.4f, 1.f, 0.4f},
+	{0.4f, 1.f, 1.f},
+	{0.4f, 0.4f, 1.f},
+	{1.f, 0.4f, 1.f},
+}};
+
+struct BenchmarkConfiguration
+{
+	std::size_t memoryBudget;
+	std::size_t uploadBudget;
+	bool compressed;
+};
+
+constexpr std::array<BenchmarkConfiguration, 6u> g_benchmarkConfigurations = {{
+	{16 * g_megabyte, 4 * g_megabyte, false},
+	{64 * g_megabyte, 1 * g_megabyte, false},
+	{64 * g_megabyte, 4 * g_megabyte, false},
+	{256 * g_megabyte, 16 * g_megabyte, false},
+	{16 * g_megabyte, 4 * g_megabyte, true},
+	{64 * g_megabyte, 4 * g_megabyte, true},
+}};
+
+}// namespace
+
+StreamingWindow::StreamingWindow()
+	: scene_{makeStreamingScene(g_textureCount)}
+{
+}
+
+void StreamingWindow::init()
+{
+	frameUniforms_.create(gl33());
+	program_ = shaders_.program(":/Shaders/streaming.vs", ":/Shaders/streaming.fs");
+	const auto reflection = fgl::ShaderReflection::reflect(gl33(), program_->programId());
+	frameUniforms_.attach(reflection);
+	modelUniform_ = reflection.uniformLocation("model");
+	tintUniform_ = reflection.uniformLocation("tint");
+	program_->bind();
+	program_->setUniformValue("albedo", g_albedoUnit);
+	program_->release();
+
+	tileMesh_.create(scene_.tileMesh);
+
+	// Images are generated once and then read from disk like any other assets
+	QElapsedTimer timer;
+	timer.start();
+	imagePaths_ = writeStreamingTextures(QDir::temp().filePath("fgl-streaming"), g_textureCount, g_textureSize);
+	qInfo() << "texture files ready in" << timer.elapsed() << "ms";
+	setCompressed(false);
+
+	residentMbCounter_ = stats().addCounter("resident MB");
+	residentTexturesCounter_ = stats().addCounter("resident textures");
+	uploadedKbCounter_ = stats().addCounter("uploaded KB");
+	evictedKbCounter_ = stats().addCounter("evicted KB");
+	decodesCounter_ = stats().addCounter("decodes started");
+	pendingDecodesCounter_ = stats().addCounter("pending decodes");
+	missingLevelsCounter_ = stats().addCounter("missing levels");
+	updateMsCounter_ = stats().addCounter("streaming ms");
+	drawsCounter_ = stats().addCounter("draws");
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+}
+
+void StreamingWindow::render()
+{
+	const auto retinaScale = devicePixelRatio();
+	const auto viewportWidth = static_cast<GLint>(width() * retinaScale);
+	const auto viewportHeight = static_cast<GLint>(height() * retinaScale);
+	const auto aspect = static_cast<float>(viewportWidth) / static_cast<float>(std::max(viewportHeight, 1));
+
+	const auto camera = streamingCamera(scene_, static_cast<float>(frame_) * 0.05f);
+	fgl::FrameData frameData;
+	frameData.view = camera.view;
+	frameData.projection = glm::perspective(g_fovY, aspect, g_near, g_far);
+	frameData.viewProj = frameData.projection * camera.view;
+	frameData.cameraPosition = glm::vec4{camera.position, 1.f};
+	frameUniforms_.update(frameData);
+
+	// Visible tiles request levels matching their size on screen
+	fgl::cullFrustum(fgl::Frustum::fromMatrix(frameData.viewProj), scene_.cullBounds, fgl::CullVolume::Sphere, visible_);
+	const auto pixelsPerUnit = static_cast<float>(viewportHeight) / (2.f * std::tan(g_fovY * 0.5f));
+	for (const auto index: visible_)
+	{
+		const auto & sphere = scene_.bounds[index];
+		const auto distance = std::max(glm::length(sphere.center - camera.position) - sphere.radius, g_near);
+		streamer_.request(textures_[scene_.tiles[index].texture], scene_.tileSize * pixelsPerUnit / distance);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	streamer_.update();
+	stats().setCounter(updateMsCounter_, static_cast<double>(timer.nsecsElapsed()) / 1e6);
+
+	// Configure viewport
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	// Clear buffers
+	glClearColor(0.55f, 0.7f, 0.85f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	program_->bind();
+	tileMesh_.bind();
+	glActiveTexture(GL_TEXTURE0 + g_albedoUnit);
+	glUniform3f(tintUniform_, 1.f, 1.f, 1.f);
+	for (const auto index: visible_)
+	{
+		const auto & tile = scene_.tiles[index];
+		const auto texture = textures_[tile.texture];
+		glBindTexture(GL_TEXTURE_2D, streamer_.texture(texture));
+		glUniformMatrix4fv(modelUniform_, 1, GL_FALSE, glm::value_ptr(tile.model));
+		if (showLevels_)
+		{
+			const auto level = std::min<std::size_t>(static_cast<std::size_t>(streamer_.residentLevel(texture)), g_levelTints.size() - 1);
+			glUniform3fv(tintUniform_, 1, glm::value_ptr(g_levelTints[level]));
+		}
+		tileMesh_.draw(*this);
+	}
+	tileMesh_.release();
+	program_->release();
+
+	const auto & streamerStats = streamer_.stats();
+	stats().setCounter(residentMbCounter_, static_cast<double>(streamerStats.residentBytes) / static_cast<double>(g_megabyte));
+	stats().setCounter(residentTexturesCounter_, static_cast<double>(streamerStats.residentTextures));
+	stats().setCounter(uploadedKbCounter_, static_cast<double>(streamerStats.uploadedBytes) / 1024.);
+	stats().setCounter(evictedKbCounter_, static_cast<double>(streamerStats.evictedBytes) / 1024.);
+	stats().setCounter(decodesCounter_, static_cast<double>(streamerStats.decodesStarted));
+	stats().setCounter(pendingDecodesCounter_, static_cast<double>(streamerStats.pendingDecodes));
+	stats().setCounter(missingLevelsCounter_, static_cast<double>(streamerStats.missingLevels));
+	stats().setCounter(drawsCounter_, static_cast<double>(visible_.size()));
+
+	++frame_;
+}
+
+void StreamingWindow::keyPressEvent(QKeyEvent * e)
+{
+	switch (e->key())
+	{
+		case Qt::Key_Plus:
+		case Qt::Key_Equal:
+			settings_.memoryBudget = std::min(settings_.memoryBudget * 2, g_maxMemoryBudget);
+			break;
+		case Qt::Key_Minus:
+			settings_.memoryBudget = std::max(settings_.memoryBudget / 2, g_minMemoryBudget);
+			break;
+		case Qt::Key_U:
+		{
+			const auto current = std::find(g_uploadBudgets.begin(), g_uploadBudgets.end(), settings_.uploadBudget);
+			settings_.uploadBudget = current == g_uploadBudgets.end() || current + 1 == g_uploadBudgets.end() ? g_uploadBudgets.front() : *(current + 1);
+			break;
+		}
+		case Qt::Key_C:
+			setCompressed(!compressed_);
+			break;
+		case Qt::Key_M:
+			showLevels_ = !showLevels_;
+			break;
+		default:
+			return;
+	}
+	streamer_.setSettings(settings_);
+	qInfo() << benchmarkConfigurationName();
+}
+
+bool StreamingWindow::setBenchmarkConfiguration(const std::size_t index)
+{
+	if (index >= g_benchmarkConfigurations.size())
+	{
+		return false;
+	}
+	settings_.memoryBudget = g_benchmarkConfigurations[index].memoryBudget;
+	settings_.uploadBudget = g_benchmarkConfigurations[index].uploadBudget;
+	streamer_.setSettings(settings_);
+	if (g_benchmarkConfigurations[index].compressed != compressed_)
+	{
+		setCompressed(g_benchmarkConfigurations[index].compressed);
+	}
+	return true;
+}
+
+QString StreamingWindow::benchmarkConfigurationName() const
+{
+	return QString{"%1 %2 textures %3x%3, %4 MB memory budget, %5 MB per frame upload budget"}
+		.arg(g_textureCount)
+		.arg(compressed_ ? fgl::textureFormatName(g_compressedFormat) : fgl::textureFormatName(fgl::TextureFormat::Rgba8))
+		.arg(g_textureSize)
+		.arg(settings_.memoryBudget / g_megabyte)
+		.arg(settings_.uploadBudget / g_megabyte);
+}
+
+void StreamingWindow::setCompressed(const bool compressed)
+{
+	if (compressed && !fgl::isTextureFormatSupported(g_compressedFormat))
+	{
+		qWarning() << fgl::textureFormatName(g_compressedFormat) << "textures are not supported";
+		return;
+	}
+	if (compressed && compressedPaths_.isEmpty())
+	{
+		QElapsedTimer timer;
+		timer.start();
+		compressedPaths_ = cookStreamingTextures(imagePaths_, g_compressedFormat);
+		if (compressedPaths_.isEmpty())
+		{
+			qWarning() << "compressed texture files are not ready";
+			return;
+		}
+		qInfo() << "compressed texture files ready in" << timer.elapsed() << "ms";
+	}
+
+	compressed_ = compressed;
+	streamer_.destroy();
+	streamer_.create(gl33(), settings_);
+	textures_.clear();
+	for (const auto & path: compressed ? compressedPaths_ : imagePaths_)
+	{
+		textures_.push_back(streamer_.add(path));
+	}
+}
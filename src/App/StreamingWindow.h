@@ -0,0 +1,69 @@
+#pragma once
+
+#include "StreamingScene.h"
+
+#include <Base/FrameUniforms.hpp>
+#include <Base/GLWindow.hpp>
+#include <Base/GpuMesh.hpp>
+#include <Base/ShaderVariants.hpp>
+#include <Base/TextureStreamer.hpp>
+
+#include <QOpenGLShaderProgram>
+
+#include <memory>
+#include <vector>
+
+// Field of tiles with 1024x1024 textures streamed from generated image files. Visible tiles
+// request mip levels by their screen size, levels are decoded on streamer threads and
+// uploaded within per frame budget, least recently used levels are dropped to stay within
+// memory budget. The same textures can be streamed from BC1 compressed KTX2 files instead.
+// Keys: +/- double or halve memory budget, U cycles upload budget, C toggles compressed
+// textures, M tints tiles by finest resident level.
+class StreamingWindow final : public fgl::GLWindow
+{
+public:
+	StreamingWindow();
+
+	void init() override;
+	void render() override;
+
+protected:
+	void keyPressEvent(QKeyEvent * e) override;
+
+	bool setBenchmarkConfiguration(std::size_t index) override;
+	QString benchmarkConfigurationName() const override;
+
+private:
+	// Restarts streaming from image or KTX2 files, the latter are cooked on first use.
+	void setCompressed(bool compressed);
+
+private:
+	fgl::ShaderVariants shaders_;
+	QOpenGLShaderProgram * program_ = nullptr;
+	GLint modelUniform_ = -1;
+	GLint tintUniform_ = -1;
+	fgl::FrameUniformBuffer frameUniforms_;
+
+	StreamingScene scene_;
+	fgl::GpuMesh tileMesh_;
+	QStringList imagePaths_;
+	QStringList compressedPaths_;
+	bool compressed_ = false;
+	std::vector<fgl::TextureStreamer::TextureId> textures_;
+	fgl::TextureStreamer streamer_;
+	fgl::TextureStreamerSettings settings_;
+	std::vector<std::uint32_t> visible_;
+	bool showLevels_ = false;
+
+	fgl::FrameStats::CounterId residentMbCounter_ = 0;
+	fgl::FrameStats::CounterId residentTexturesCounter_ = 0;
+	fgl::FrameStats::CounterId uploadedKbCounter_ = 0;
+	fgl::FrameStats::CounterId evictedKbCounter_ = 0;
+	fgl::FrameStats::CounterId decodesCounter_ = 0;
+	fgl::FrameStats::CounterId pendingDecodesCounter_ = 0;
+	fgl::FrameStats::CounterId missingLevelsCounter_ = 0;
+	fgl::FrameStats::CounterId updateMsCounter_ = 0;
+	fgl::FrameStats::CounterId drawsCounter_ = 0;
+
+	std::size_t frame_ = 0;
+};
@@ -1,8 +1,17 @@
 #include "TriangleWindow.h"
 
+#include <Base/PipelineState.hpp>
+#include <Base/SceneComponents.hpp>
+#include <Base/ShaderReflection.hpp>
+#include <Base/VertexFormat.hpp>
+
+#include <QDebug>
 #include <QMouseEvent>
 #include <QOpenGLFunctions>
 #include <QScreen>
+#include <QVector3D>
+
+#include <glm/gtc/matrix_transform.hpp>
 
 #include <array>
 
@@ -16,16 +25,20 @@ constexpr std::array<GLfloat, 15u> vertices = {
 };
 constexpr std::array<GLuint, 3u> indices = {0, 1, 2};
 
+// Rotation in degrees around axis, advanced every frame.
+struct Spin
+{
+	glm::vec3 axis{0.f, 1.f, 0.f};
+	float angle = 0.f;
+};
+
 }// namespace
 
 void TriangleWindow::init()
 {
 	// Configure shaders
-	program_ = std::make_unique<QOpenGLShaderProgram>(this);
-	program_->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/Shaders/diffuse.vs");
-	program_->addShaderFromSourceFile(QOpenGLShader::Fragment,
-									  ":/Shaders/diffuse.fs");
-	program_->link();
+	program_ = shaders_.program(":/Shaders/diffuse.vs", ":/Shaders/diffuse.fs");
+	const auto reflection = fgl::ShaderReflection::reflect(gl33(), program_->programId());
 
 	// Create VAO object
 	vao_.create();
@@ -43,17 +56,38 @@ void TriangleWindow::init()
 	ibo_.setUsagePattern(QOpenGLBuffer::StaticDraw);
 	ibo_.allocate(indices.data(), static_cast<int>(indices.size() * sizeof(GLuint)));
 
-	// Bind attributes
-	program_->bind();
-
-	program_->enableAttributeArray(0);
-	program_->setAttributeBuffer(0, GL_FLOAT, 0, 2, static_cast<int>(5 * sizeof(GLfloat)));
+	// Bake pipeline, triangle spins so both faces are drawn
+	fgl::VertexFormat format;
+	format.add("pos", 2).add("col", 3);
+	fgl::RenderState renderState;
+	renderState.cull.enabled = false;
+	pipeline_ = fgl::PipelineState::create(gl33(), reflection, renderState, format);
+	state_.create(gl33());
 
-	program_->enableAttributeArray(1);
-	program_->setAttributeBuffer(1, GL_FLOAT, static_cast<int>(2 * sizeof(GLfloat)), 3,
-								 static_cast<int>(5 * sizeof(GLfloat)));
-
-	matrixUniform_ = program_->uniformLocation("matrix");
+	// Bind attributes by shader input names
+	program_->bind();
+	pipeline_.setupVertexArray(gl33());
+
+	// Build binding tables once, drawing refers to parameters by ids
+	frameUniforms_.create(gl33());
+	frameUniforms_.attach(reflection);
+	modelParameter_ = objectLayout_.add("model", fgl::ParameterType::Mat4);
+	objectParameters_.create(gl33(), reflection, objectLayout_);
+	tintParameter_ = materialLayout_.add("tint", fgl::ParameterType::Vec4);
+	materialParameters_.create(gl33(), reflection, materialLayout_);
+	materials_.emplace_back(materialLayout_);
+	uniformBytesCounter_ = stats().addCounter("uniform bytes");
+
+	// Keep triangle on CPU for mouse picking
+	for (std::size_t i = 0; i < vertices.size(); i += 5)
+	{
+		pickMesh_.positions.emplace_back(vertices[i], vertices[i + 1], 0.f);
+	}
+	pickMesh_.indices.assign(indices.begin(), indices.end());
+	pickBvh_.build(pickMesh_);
+
+	// Triangle is the only mesh of the scene
+	triangle_ = world_.create(fgl::Transform{}, fgl::MeshInstance{0}, fgl::Material{}, Spin{});
 
 	// Release all
 	program_->release();
@@ -63,10 +97,6 @@ void TriangleWindow::init()
 	ibo_.release();
 	vbo_.release();
 
-	// Uncomment to enable depth test and face culling
-	// glEnable(GL_DEPTH_TEST);
-	// glEnable(GL_CULL_FACE);
-
 	// Clear all FBO buffers
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
@@ -81,38 +111,67 @@ void TriangleWindow::render()
 	// Clear buffers
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// Calculate MVP matrix
-	QMatrix4x4 matrix;
-	matrix.perspective(60.0f, 4.0f / 3.0f, 0.1f, 100.0f);
-	matrix.translate(0, 0, -2);
-	const auto angle = 100.0 * static_cast<double>(frame_) / screen()->refreshRate();
-	matrix.rotate(static_cast<float>(angle), rotationAxis_);
-
-	// Bind VAO and shader program
-	program_->bind();
-	vao_.bind();
-
-	// Update uniform value
-	program_->setUniformValue(matrixUniform_, matrix);
-
-	// Draw
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr);
+	// Advance spinning entities
+	const auto angleStep = static_cast<float>(100.0 / screen()->refreshRate());
+	world_.query<Spin, fgl::Transform>().forEach([&](Spin & spin, fgl::Transform & transform) {
+		transform.world = glm::rotate(glm::mat4{1.f}, glm::radians(spin.angle), spin.axis);
+		spin.angle += angleStep;
+	});
+
+	// Calculate view projection matrix
+	fgl::FrameData frameData;
+	frameData.projection = glm::perspective(glm::radians(60.f), 4.f / 3.f, 0.1f, 100.f);
+	frameData.view = glm::translate(glm::mat4{1.f}, glm::vec3{0.f, 0.f, -2.f});
+	frameData.viewProj = frameData.projection * frameData.view;
+	frameData.cameraPosition = glm::vec4{0.f, 0.f, 2.f, 1.f};
+	auto uniformBytes = frameUniforms_.update(frameData);
+
+	// Apply pipeline and bind VAO, Qt may change state between frames
+	state_.invalidate();
+	state_.applyPipeline(pipeline_);
+	state_.bindVertexArray(vao_.objectId());
+
+	// Draw renderable entities
+	world_.query<const fgl::Transform, const fgl::MeshInstance, const fgl::Material>().forEach(
+		[&](const fgl::Transform & transform, const fgl::MeshInstance &, const fgl::Material & material) {
+			matrix_ = frameData.viewProj * transform.world;
+			object_.set(modelParameter_, transform.world);
+			uniformBytes += objectParameters_.apply(object_);
+			auto & parameters = materials_[material.id];
+			parameters.set(tintParameter_, material.color);
+			uniformBytes += materialParameters_.apply(parameters);
+			glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr);
+		});
 
 	// Release VAO and shader program
-	vao_.release();
-	program_->release();
+	state_.bindVertexArray(0);
+	state_.useProgram(0);
 
-	// Increment frame counter
-	++frame_;
+	stats().setCounter(uniformBytesCounter_, static_cast<double>(uniformBytes));
 }
 
 void TriangleWindow::mousePressEvent(QMouseEvent * e)
 {
 	mousePressPosition_ = QVector2D(e->localPos());
+
+	// Cast ray through clicked pixel in triangle space
+	const auto inverseMatrix = glm::inverse(matrix_);
+	const auto ray = fgl::rayFromScreen(inverseMatrix, {mousePressPosition_.x(), mousePressPosition_.y()},
+										{static_cast<float>(width()), static_cast<float>(height())});
+	const auto hit = pickBvh_.raycast(ray);
+	if (hit.isHit())
+	{
+		qInfo() << "Picked triangle" << hit.primitive << "at distance" << hit.distance
+				<< "barycentric" << hit.barycentric.x << hit.barycentric.y;
+	}
 }
 
 void TriangleWindow::mouseReleaseEvent(QMouseEvent * e)
 {
 	const auto diff = QVector2D(e->localPos()) - mousePressPosition_;
-	rotationAxis_ = QVector3D(diff.y(), diff.x(), 0.0).normalized();
+	const auto axis = QVector3D(diff.y(), diff.x(), 0.0).normalized();
+	if (!axis.isNull())
+	{
+		world_.get<Spin>(triangle_).axis = glm::vec3{axis.x(), axis.y(), axis.z()};
+	}
 }
\ No newline at end of file
@@ -1,16 +1,22 @@
 #pragma once
 
+#include <Base/Bvh.hpp>
+#include <Base/Ecs.hpp>
+#include <Base/FrameUniforms.hpp>
+#include <Base/GLStateCache.hpp>
 #include <Base/GLWindow.hpp>
+#include <Base/Mesh.hpp>
+#include <Base/Parameters.hpp>
+#include <Base/ShaderVariants.hpp>
 
-#include <QMatrix4x4>
 #include <QOpenGLBuffer>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
-#include <QQuaternion>
 #include <QVector2D>
-#include <QVector3D>
 
-#include <memory>
+#include <glm/glm.hpp>
+
+#include <vector>
 
 class TriangleWindow final : public fgl::GLWindow
 {
@@ -24,16 +30,36 @@ protected:
 	void mouseReleaseEvent(QMouseEvent * e) override;
 
 private:
-	GLint matrixUniform_ = -1;
-
 	QOpenGLBuffer vbo_{QOpenGLBuffer::Type::VertexBuffer};
 	QOpenGLBuffer ibo_{QOpenGLBuffer::Type::IndexBuffer};
 	QOpenGLVertexArrayObject vao_;
 
-	std::unique_ptr<QOpenGLShaderProgram> program_ = nullptr;
+	fgl::ShaderVariants shaders_;
+	QOpenGLShaderProgram * program_ = nullptr;
+	fgl::PipelineState pipeline_;
+	fgl::GLStateCache state_;
+
+	// Camera data shared by programs, per object and per material parameters.
+	fgl::FrameUniformBuffer frameUniforms_;
+	fgl::ParameterLayout objectLayout_;
+	fgl::ParameterLayout::Id modelParameter_ = fgl::ParameterLayout::invalid;
+	fgl::ParameterBlock object_{objectLayout_};
+	fgl::ProgramParameters objectParameters_;
+	fgl::ParameterLayout materialLayout_;
+	fgl::ParameterLayout::Id tintParameter_ = fgl::ParameterLayout::invalid;
+	// Indexed by material id.
+	std::vector<fgl::ParameterBlock> materials_;
+	fgl::ProgramParameters materialParameters_;
+	fgl::FrameStats::CounterId uniformBytesCounter_ = 0;
+
+	// Scene entities, the triangle spins around axis set by mouse drag.
+	fgl::World world_;
+	fgl::Entity triangle_;
 
-	size_t frame_ = 0;
+	// Matrix of the last frame and CPU copy of the triangle for picking.
+	glm::mat4 matrix_{1.f};
+	fgl::Mesh pickMesh_;
+	fgl::MeshBvh pickBvh_;
 
 	QVector2D mousePressPosition_{0., 0.};
-	QVector3D rotationAxis_{0., 1., 0.};
 };
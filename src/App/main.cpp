@@ -1,30 +1,144 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QSurfaceFormat>
 
+#include "Benchmarks.h"
+#include "CityWindow.h"
+#include "LightsWindow.h"
+#include "LodWindow.h"
+#include "MaterialsWindow.h"
+#include "MeshletWindow.h"
+#include "MultiDrawWindow.h"
+#include "ShadowsWindow.h"
+#include "StreamingWindow.h"
 #include "TriangleWindow.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
 namespace
 {
-constexpr auto g_sampels = 16;
+constexpr auto g_samples = 4;
 constexpr auto g_gl_major_version = 3;
 constexpr auto g_gl_minor_version = 3;
+
+std::unique_ptr<fgl::GLWindow> makeWindow(const QString & scene, const QString & model)
+{
+	if (scene == "lod")
+	{
+		return std::make_unique<LodWindow>();
+	}
+	if (scene == "city")
+	{
+		return std::make_unique<CityWindow>();
+	}
+	if (scene == "materials")
+	{
+		return std::make_unique<MaterialsWindow>();
+	}
+	if (scene == "meshlets")
+	{
+		return std::make_unique<MeshletWindow>(model);
+	}
+	if (scene == "multidraw")
+	{
+		return std::make_unique<MultiDrawWindow>();
+	}
+	if (scene == "lights")
+	{
+		return std::make_unique<LightsWindow>();
+	}
+	if (scene == "shadows")
+	{
+		return std::make_unique<ShadowsWindow>();
+	}
+	if (scene == "streaming")
+	{
+		return std::make_unique<StreamingWindow>();
+	}
+	return std::make_unique<TriangleWindow>();
+}
+
+// Headless benchmarks run without GUI application so they work on hosts without display.
+bool isHeadless(const int argc, char ** argv)
+{
+	return std::any_of(argv + 1, argv + argc, [](const char * arg) {
+		return std::strcmp(arg, "--bench") == 0 || std::strncmp(arg, "--bench=", 8) == 0;
+	});
+}
 }// namespace
 
 int main(int argc, char ** argv)
 {
-	QApplication app(argc, argv);
+	const auto headless = isHeadless(argc, argv);
+	const auto app = headless ? std::make_unique<QCoreApplication>(argc, argv)
+							  : std::make_unique<QApplication>(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("OpenGL demo application");
+	parser.addHelpOption();
+	const QCommandLineOption sceneOption{"scene", "Scene to show: triangle, lod, meshlets, city, materials, multidraw, lights, shadows, streaming.", "name", "triangle"};
+	const QCommandLineOption modelOption{"model", "OBJ model for scenes showing single mesh.", "path"};
+	const QCommandLineOption benchmarkOption{"benchmark", "Render given number of frames per benchmark configuration, log stats and quit.", "frames"};
+	const QCommandLineOption statsOption{"stats", "Log frame stats every given number of frames.", "frames"};
+	const QCommandLineOption benchOption{"bench", "Run headless CPU benchmark: " + benchmarkNames().join(", ") + ".", "name"};
+	const QCommandLineOption aaOption{"aa", "Anti-aliasing modes separated by commas: none, msaa, fxaa. Window uses the first one, benchmark runs each.",
+									  "modes", "msaa"};
+	const QCommandLineOption samplesOption{"samples", "MSAA sample count.", "count", QString::number(g_samples)};
+	parser.addOption(sceneOption);
+	parser.addOption(modelOption);
+	parser.addOption(benchmarkOption);
+	parser.addOption(statsOption);
+	parser.addOption(benchOption);
+	parser.addOption(aaOption);
+	parser.addOption(samplesOption);
+	parser.process(*app);
+
+	if (headless)
+	{
+		return runBenchmark(parser.value(benchOption)) ? 0 : 1;
+	}
+
+	std::vector<fgl::AntialiasingMode> aaModes;
+	for (const auto & name: parser.value(aaOption).split(','))
+	{
+		const auto mode = fgl::parseAntialiasingMode(name.trimmed());
+		if (!mode)
+		{
+			parser.showHelp(1);
+		}
+		aaModes.push_back(*mode);
+	}
+	bool samplesValid = false;
+	const auto samples = parser.value(samplesOption).toInt(&samplesValid);
+	if (!samplesValid || samples <= 0)
+	{
+		parser.showHelp(1);
+	}
+
+	const auto benchmarkFrames = parser.value(benchmarkOption).toInt();
 
+	// Scene is multisampled in offscreen target, so default framebuffer has single sample
 	QSurfaceFormat format;
-	format.setSamples(g_sampels);
 	format.setVersion(g_gl_major_version, g_gl_minor_version);
 	format.setProfile(QSurfaceFormat::CoreProfile);
+	if (benchmarkFrames > 0)
+	{
+		// Do not wait for vsync to measure real frame time.
+		format.setSwapInterval(0);
+	}
 
-	TriangleWindow window;
-	window.setFormat(format);
-	window.resize(640, 480);
-	window.show();
+	const auto window = makeWindow(parser.value(sceneOption), parser.value(modelOption));
+	window->setFormat(format);
+	window->resize(640, 480);
+	window->show();
 
-	window.setAnimated(true);
+	window->setAnimated(true);
+	window->setStatsInterval(static_cast<std::size_t>(std::max(parser.value(statsOption).toInt(), 0)));
+	window->setBenchmark(static_cast<std::size_t>(std::max(benchmarkFrames, 0)));
+	window->setAntialiasing(std::move(aaModes), samples);
 
-	return app.exec();
-}
\ No newline at end of file
+	return app->exec();
+}
@@ -0,0 +1,396 @@
+#include "Antialiasing.hpp"
+
+#include <Base/SceneFramebuffer.hpp>
+
+#include <QDebug>
+#include <QOpenGLContext>
+#include <QVector2D>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+// FXAA 3.11 quality algorithm with five search steps: local luma contrast decides whether
+// pixel is on edge, edge ends are searched along it with growing steps and color is sampled
+// across edge by distance to the nearest end, or by subpixel aliasing amount when it is larger.
+constexpr auto g_fxaaFragmentShader = R"(#version 330 core
+in vec2 uv;
+out vec4 fragColor;
+
+uniform sampler2D colorTexture;
+uniform vec2 texelSize;
+
+const float edgeThreshold = 0.125;
+const float edgeThresholdMin = 0.0312;
+const float subpixelQuality = 0.75;
+const int searchSteps = 5;
+const float searchStep[searchSteps] = float[](1.0, 1.5, 2.0, 4.0, 8.0);
+
+float luma(vec3 color)
+{
+	return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+float lumaAt(vec2 position)
+{
+	return luma(textureLod(colorTexture, position, 0.0).rgb);
+}
+
+void main()
+{
+	vec3 color = textureLod(colorTexture, uv, 0.0).rgb;
+	float lumaCenter = luma(color);
+	float lumaDown = luma(textureLodOffset(colorTexture, uv, 0.0, ivec2(0, -1)).rgb);
+	float lumaUp = luma(textureLodOffset(colorTexture, uv, 0.0, ivec2(0, 1)).rgb);
+	float lumaLeft = luma(textureLodOffset(colorTexture, uv, 0.0, ivec2(-1, 0)).rgb);
+	float lumaRight = luma(textureLodOffset(colorTexture, uv, 0.0, ivec2(1, 0)).rgb);
+
+	float lumaMin = min(lumaCenter, min(min(lumaDown, lumaUp), min(lumaLeft, lumaRight)));
+	float lumaMax = max(lumaCenter, max(max(lumaDown, lumaUp), max(lumaLeft, lumaRight)));
+	float lumaRange = lumaMax - lumaMin;
+	if (lumaRange < max(edgeThresholdMin, lumaMax * edgeThreshold))
+	{
+		fragColor = vec4(color, 1.0);
+		return;
+	}
+
+	float lumaDownLeft = luma(textureLodOffset(colorTexture, uv, 0.0, ivec2(-1, -1)).rgb);
+	float lumaUpRight = luma(textureLodOffset(colorTexture, uv, 0.0, ivec2(1, 1)).rgb);
+	float lumaUpLeft = luma(textureLodOffset(colorTexture, uv, 0.0, ivec2(-1, 1)).rgb);
+	float lumaDownRight = luma(textureLodOffset(colorTexture, uv, 0.0, ivec2(1, -1)).rgb);
+
+	float lumaDownUp = lumaDown + lumaUp;
+	float lumaLeftRight = lumaLeft + lumaRight;
+	float lumaLeftCorners = lumaDownLeft + lumaUpLeft;
+	float lumaDownCorners = lumaDownLeft + lumaDownRight;
+	float lumaRightCorners = lumaDownRight + lumaUpRight;
+	float lumaUpCorners = lumaUpRight + lumaUpLeft;
+
+	// Edge runs along direction with smaller second derivative of luma
+	float edgeHorizontal = abs(-2.0 * lumaLeft + lumaLeftCorners) + abs(-2.0 * lumaCenter + lumaDownUp) * 2.0
+		+ abs(-2.0 * lumaRight + lumaRightCorners);
+	float edgeVertical = abs(-2.0 * lumaUp + lumaUpCorners) + abs(-2.0 * lumaCenter + lumaLeftRight) * 2.0
+		+ abs(-2.0 * lumaDown + lumaDownCorners);
+	bool isHorizontal = edgeHorizontal >= edgeVertical;
+
+	// Edge lies between pixel and its neighbor across edge with steeper gradient
+	float luma1 = isHorizontal ? lumaDown : lumaLeft;
+	float luma2 = isHorizontal ? lumaUp : lumaRight;
+	float gradient1 = luma1 - lumaCenter;
+	float gradient2 = luma2 - lumaCenter;
+	bool is1Steepest = abs(gradient1) >= abs(gradient2);
+	float gradientScaled = 0.25 * max(abs(gradient1), abs(gradient2));
+
+	float stepLength = isHorizontal ? texelSize.y : texelSize.x;
+	float lumaLocalAverage = 0.0;
+	if (is1Steepest)
+	{
+		stepLength = -stepLength;
+		lumaLocalAverage = 0.5 * (luma1 + lumaCenter);
+	}
+	else
+	{
+		lumaLocalAverage = 0.5 * (luma2 + lumaCenter);
+	}
+
+	vec2 edgeUv = uv;
+	vec2 offset = isHorizontal ? vec2(texelSize.x, 0.0) : vec2(0.0, texelSize.y);
+	if (isHorizontal)
+	{
+		edgeUv.y += stepLength * 0.5;
+	}
+	else
+	{
+		edgeUv.x += stepLength * 0.5;
+	}
+
+	// Walk both ways until luma leaves local average, which is the edge end
+	vec2 uv1 = edgeUv;
+	vec2 uv2 = edgeUv;
+	float lumaEnd1 = 0.0;
+	float lumaEnd2 = 0.0;
+	bool reached1 = false;
+	bool reached2 = false;
+	for (int i = 0; i < searchSteps && !(reached1 && reached2); ++i)
+	{
+		if (!reached1)
+		{
+			uv1 -= offset * searchStep[i];
+			lumaEnd1 = lumaAt(uv1) - lumaLocalAverage;
+			reached1 = abs(lumaEnd1) >= gradientScaled;
+		}
+		if (!reached2)
+		{
+			uv2 += offset * searchStep[i];
+			lumaEnd2 = lumaAt(uv2) - lumaLocalAverage;
+			reached2 = abs(lumaEnd2) >= gradientScaled;
+		}
+	}
+
+	float distance1 = isHorizontal ? uv.x - uv1.x : uv.y - uv1.y;
+	float distance2 = isHorizontal ? uv2.x - uv.x : uv2.y - uv.y;
+	bool isDirection1 = distance1 < distance2;
+	float pixelOffset = 0.5 - min(distance1, distance2) / (distance1 + distance2);
+
+	// Nearest end must vary the other way than center does, otherwise pixel is not on this edge
+	bool isLumaCenterSmaller = lumaCenter < lumaLocalAverage;
+	bool correctVariation = ((isDirection1 ? lumaEnd1 : lumaEnd2) < 0.0) != isLumaCenterSmaller;
+	float finalOffset = correctVariation ? pixelOffset : 0.0;
+
+	float lumaAverage = (2.0 * (lumaDownUp + lumaLeftRight) + lumaLeftCorners + lumaRightCorners) / 12.0;
+	float subpixel = clamp(abs(lumaAverage - lumaCenter) / lumaRange, 0.0, 1.0);
+	subpixel = (-2.0 * subpixel + 3.0) * subpixel * subpixel;
+	finalOffset = max(finalOffset, subpixel * subpixel * subpixelQuality);
+
+	vec2 finalUv = uv;
+	if (isHorizontal)
+	{
+		finalUv.y += finalOffset * stepLength;
+	}
+	else
+	{
+		finalUv.x += finalOffset * stepLength;
+	}
+	fragColor = vec4(textureLod(colorTexture, finalUv, 0.0).rgb, 1.0);
+}
+)";
+
+}// namespace
+
+const char * antialiasingModeName(const AntialiasingMode mode)
+{
+	switch (mode)
+	{
+		case AntialiasingMode::None:
+			return "none";
+		case AntialiasingMode::Msaa:
+			return "msaa";
+		case AntialiasingMode::Fxaa:
+			return "fxaa";
+	}
+	return "";
+}
+
+std::optional<AntialiasingMode> parseAntialiasingMode(const QString & name)
+{
+	for (const auto mode: {AntialiasingMode::None, AntialiasingMode::Msaa, AntialiasingMode::Fxaa})
+	{
+		if (name.toLower() == antialiasingModeName(mode))
+		{
+			return mode;
+		}
+	}
+	return std::nullopt;
+}
+
+void Antialiasing::create(QOpenGLFunctions_3_3_Core & gl)
+{
+	gl_ = &gl;
+	gl_->glGetIntegerv(GL_MAX_SAMPLES, &maxSamples_);
+
+	fxaaProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	fxaaProgram_->addShaderFromSourceCode(QOpenGLShader::Vertex, FullscreenPass::vertexShader());
+	fxaaProgram_->addShaderFromSourceCode(QOpenGLShader::Fragment, g_fxaaFragmentShader);
+	fxaaProgram_->link();
+	fxaaProgram_->bind();
+	fxaaProgram_->setUniformValue("colorTexture", 0);
+	fxaaProgram_->release();
+
+	fullscreen_.create(gl);
+}
+
+void Antialiasing::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	destroyTargets();
+	fxaaProgram_.reset();
+	fullscreen_.destroy();
+}
+
+void Antialiasing::setMode(const AntialiasingMode mode, const int samples)
+{
+	const auto clampedSamples = std::clamp(samples, 1, std::max(maxSamples_, 1));
+	if (mode == mode_ && clampedSamples == samples_)
+	{
+		return;
+	}
+	mode_ = mode;
+	samples_ = clampedSamples;
+	// Targets of new mode are created by the next begin()
+	destroyTargets();
+}
+
+void Antialiasing::begin(const int width, const int height)
+{
+	// Minimized window may still be exposed with empty drawable
+	if (mode_ == AntialiasingMode::None || width <= 0 || height <= 0)
+	{
+		return;
+	}
+	if (framebuffer_ == 0 || width != width_ || height != height_)
+	{
+		destroyTargets();
+		width_ = width;
+		height_ = height;
+		if (!createTargets())
+		{
+			qWarning() << "failed to create" << antialiasingModeName(mode_) << "target, anti-aliasing is off";
+			destroyTargets();
+			mode_ = AntialiasingMode::None;
+			return;
+		}
+	}
+
+	const auto target = mode_ == AntialiasingMode::Msaa ? multisampleFramebuffer_ : framebuffer_;
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, target);
+	gl_->glViewport(0, 0, width_, height_);
+	setSceneFramebuffer(target);
+	active_ = true;
+}
+
+void Antialiasing::end()
+{
+	if (!active_)
+	{
+		return;
+	}
+	active_ = false;
+	setSceneFramebuffer(0);
+	const auto defaultFramebuffer = QOpenGLContext::currentContext()->defaultFramebufferObject();
+
+	if (mode_ == AntialiasingMode::Msaa)
+	{
+		// Multisampled blit requires identical formats, which default framebuffer may not
+		// have, so samples are resolved into own texture first
+		gl_->glBindFramebuffer(GL_READ_FRAMEBUFFER, multisampleFramebuffer_);
+		gl_->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer_);
+		gl_->glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		gl_->glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+		gl_->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, defaultFramebuffer);
+		gl_->glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		gl_->glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer);
+		return;
+	}
+
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer);
+	gl_->glViewport(0, 0, width_, height_);
+
+	const auto depthTest = gl_->glIsEnabled(GL_DEPTH_TEST);
+	const auto blend = gl_->glIsEnabled(GL_BLEND);
+	gl_->glDisable(GL_DEPTH_TEST);
+	gl_->glDisable(GL_BLEND);
+
+	fxaaProgram_->bind();
+	fxaaProgram_->setUniformValue("texelSize", QVector2D{1.f / static_cast<float>(width_), 1.f / static_cast<float>(height_)});
+	gl_->glActiveTexture(GL_TEXTURE0);
+	gl_->glBindTexture(GL_TEXTURE_2D, colorTexture_);
+	fullscreen_.draw();
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+	fxaaProgram_->release();
+
+	if (depthTest)
+	{
+		gl_->glEnable(GL_DEPTH_TEST);
+	}
+	if (blend)
+	{
+		gl_->glEnable(GL_BLEND);
+	}
+}
+
+std::size_t Antialiasing::bytes() const
+{
+	if (framebuffer_ == 0)
+	{
+		return 0;
+	}
+	const auto pixels = static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_);
+	// RGBA8 color and 24 bit depth with 8 bit stencil per sample
+	constexpr std::size_t sampleBytes = 8;
+	if (mode_ == AntialiasingMode::Msaa)
+	{
+		return pixels * (static_cast<std::size_t>(samples_) * sampleBytes + 4);
+	}
+	return pixels * sampleBytes;
+}
+
+bool Antialiasing::createTargets()
+{
+	gl_->glGenTextures(1, &colorTexture_);
+	gl_->glBindTexture(GL_TEXTURE_2D, colorTexture_);
+	gl_->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	// FXAA samples between texels
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+
+	gl_->glGenFramebuffers(1, &framebuffer_);
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+	gl_->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture_, 0);
+
+	// Resolve target of Msaa mode needs no depth
+	if (mode_ == AntialiasingMode::Fxaa)
+	{
+		gl_->glGenRenderbuffers(1, &depth_);
+		gl_->glBindRenderbuffer(GL_RENDERBUFFER, depth_);
+		gl_->glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width_, height_);
+		gl_->glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_);
+	}
+	auto complete = gl_->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+	if (mode_ == AntialiasingMode::Msaa)
+	{
+		const auto createRenderbuffer = [&](const GLenum format) {
+			GLuint renderbuffer = 0;
+			gl_->glGenRenderbuffers(1, &renderbuffer);
+			gl_->glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+			gl_->glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_, format, width_, height_);
+			// Implementation may round sample count up
+			gl_->glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_SAMPLES, &samples_);
+			return renderbuffer;
+		};
+		multisampleColor_ = createRenderbuffer(GL_RGBA8);
+		multisampleDepth_ = createRenderbuffer(GL_DEPTH24_STENCIL8);
+
+		gl_->glGenFramebuffers(1, &multisampleFramebuffer_);
+		gl_->glBindFramebuffer(GL_FRAMEBUFFER, multisampleFramebuffer_);
+		gl_->glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, multisampleColor_);
+		gl_->glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, multisampleDepth_);
+		complete = complete && gl_->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	}
+	gl_->glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, QOpenGLContext::currentContext()->defaultFramebufferObject());
+	return complete;
+}
+
+void Antialiasing::destroyTargets()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	gl_->glDeleteFramebuffers(1, &multisampleFramebuffer_);
+	gl_->glDeleteRenderbuffers(1, &multisampleColor_);
+	gl_->glDeleteRenderbuffers(1, &multisampleDepth_);
+	gl_->glDeleteFramebuffers(1, &framebuffer_);
+	gl_->glDeleteTextures(1, &colorTexture_);
+	gl_->glDeleteRenderbuffers(1, &depth_);
+	multisampleFramebuffer_ = 0;
+	multisampleColor_ = 0;
+	multisampleDepth_ = 0;
+	framebuffer_ = 0;
+	colorTexture_ = 0;
+	depth_ = 0;
+}
+
+}// namespace fgl
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Base/FullscreenPass.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QString>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace fgl
+{
+
+enum class AntialiasingMode
+{
+	// Scene draws straight into default framebuffer
+	None,
+	// Scene draws into multisampled target, samples are resolved by blits
+	Msaa,
+	// Scene draws into single sampled target, edges are smoothed by FXAA pass
+	Fxaa,
+};
+
+const char * antialiasingModeName(AntialiasingMode mode);
+std::optional<AntialiasingMode> parseAntialiasingMode(const QString & name);
+
+// Offscreen target window scene renders into, resolved to default framebuffer at the end of
+// frame. While it is bound it is scene framebuffer, so passes rendering into their own
+// targets return to it.
+class Antialiasing
+{
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl);
+	void destroy();
+
+	// Sample count is used by Msaa mode and clamped to GL_MAX_SAMPLES.
+	void setMode(AntialiasingMode mode, int samples);
+	AntialiasingMode mode() const { return mode_; }
+	int samples() const { return samples_; }
+
+	// Binds target of given size and sets viewport to it, recreates target when size changed.
+	// Does nothing in None mode or for empty size. Mode falls back to None when target
+	// can not be created.
+	void begin(int width, int height);
+	// Resolves target into default framebuffer of current context.
+	void end();
+
+	// Memory of offscreen targets, zero in None mode.
+	std::size_t bytes() const;
+
+private:
+	// Returns false when framebuffers are incomplete.
+	bool createTargets();
+	void destroyTargets();
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	AntialiasingMode mode_ = AntialiasingMode::None;
+	int samples_ = 0;
+	int maxSamples_ = 0;
+	int width_ = 0;
+	int height_ = 0;
+	// Target is bound between begin() and end().
+	bool active_ = false;
+
+	// Multisampled color and depth scene draws into in Msaa mode.
+	GLuint multisampleFramebuffer_ = 0;
+	GLuint multisampleColor_ = 0;
+	GLuint multisampleDepth_ = 0;
+
+	// Single sampled color, scene target with depth in Fxaa mode, resolve target in Msaa mode.
+	GLuint framebuffer_ = 0;
+	GLuint colorTexture_ = 0;
+	GLuint depth_ = 0;
+
+	std::unique_ptr<QOpenGLShaderProgram> fxaaProgram_ = nullptr;
+	FullscreenPass fullscreen_;
+};
+
+}// namespace fgl
@@ -0,0 +1,73 @@
+#include "Batching.hpp"
+
+#include <Base/DrawList.hpp>
+
+#include <cmath>
+#include <map>
+#include <tuple>
+
+namespace fgl
+{
+
+void collapseInstances(const std::vector<SortItem> & items, const std::uint32_t maxInstances, std::vector<InstancedBatch> & batches)
+{
+	batches.clear();
+	const auto count = static_cast<std::uint32_t>(items.size());
+	for (std::uint32_t first = 0; first < count;)
+	{
+		const auto state = DrawKey::state(items[first].key);
+		auto last = first + 1;
+		while (last < count && last - first < maxInstances && DrawKey::state(items[last].key) == state)
+		{
+			++last;
+		}
+		batches.push_back({first, last - first});
+		first = last;
+	}
+}
+
+std::vector<StaticBatch> buildStaticBatches(const std::vector<Mesh> & meshes, const std::vector<StaticDraw> & draws, const float cellSize)
+{
+	std::map<std::tuple<int, int, std::uint32_t>, std::size_t> batchIndices;
+	std::vector<StaticBatch> batches;
+	for (const auto & draw: draws)
+	{
+		const auto cellX = static_cast<int>(std::floor(draw.model[3].x / cellSize));
+		const auto cellZ = static_cast<int>(std::floor(draw.model[3].z / cellSize));
+		const auto [it, inserted] = batchIndices.try_emplace({cellX, cellZ, draw.material}, batches.size());
+		if (inserted)
+		{
+			batches.emplace_back().material = draw.material;
+		}
+		auto & batch = batches[it->second];
+
+		// Pre-transform vertices, normals need inverse transpose for non uniform scale
+		const auto & mesh = meshes[draw.mesh];
+		const auto normalMatrix = glm::transpose(glm::inverse(glm::mat3{draw.model}));
+		const auto base = static_cast<std::uint32_t>(batch.mesh.vertexCount());
+		for (std::size_t i = 0; i < mesh.vertexCount(); ++i)
+		{
+			const auto position = glm::vec3{draw.model * glm::vec4{mesh.positions[i], 1.f}};
+			batch.mesh.positions.push_back(position);
+			batch.mesh.normals.push_back(i < mesh.normals.size() ? glm::normalize(normalMatrix * mesh.normals[i]) : glm::vec3{0.f, 0.f, 1.f});
+			batch.mesh.colors.push_back(i < mesh.colors.size() ? mesh.colors[i] : glm::vec3{1.f});
+			batch.bounds.expand(position);
+		}
+		for (const auto index: mesh.indices)
+		{
+			batch.mesh.indices.push_back(base + index);
+		}
+		++batch.drawCount;
+	}
+
+	// Order by cell so neighbouring batches are close in space
+	std::vector<StaticBatch> ordered;
+	ordered.reserve(batches.size());
+	for (const auto & [key, index]: batchIndices)
+	{
+		ordered.push_back(std::move(batches[index]));
+	}
+	return ordered;
+}
+
+}// namespace fgl
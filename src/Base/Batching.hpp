@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/Mesh.hpp>
+#include <Base/RadixSort.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// Run of sorted draws sharing program, material and mesh, drawn as one instanced draw.
+struct InstancedBatch
+{
+	// Index of the first draw in sorted list.
+	std::uint32_t first = 0;
+	std::uint32_t count = 0;
+};
+
+// Collapses runs of draws with equal DrawKey::state in sorted list into batches of at most
+// maxInstances draws. Depth does not break runs, translucent draws keep their order.
+void collapseInstances(const std::vector<SortItem> & items, std::uint32_t maxInstances, std::vector<InstancedBatch> & batches);
+
+struct StaticDraw
+{
+	glm::mat4 model{1.f};
+	std::uint32_t mesh = 0;
+	std::uint32_t material = 0;
+};
+
+// Static draws of one material merged into a single world space mesh.
+struct StaticBatch
+{
+	Mesh mesh;
+	Aabb bounds;
+	std::uint32_t material = 0;
+	std::uint32_t drawCount = 0;
+};
+
+// Merges static draws of the same material inside each cell of XZ grid, meshes may differ.
+// Cells keep batches small enough to be culled. Batches are ordered by cell, then material.
+std::vector<StaticBatch> buildStaticBatches(const std::vector<Mesh> & meshes, const std::vector<StaticDraw> & draws, float cellSize);
+
+}// namespace fgl
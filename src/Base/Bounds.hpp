@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <limits>
+
+namespace fgl
+{
+
+struct BoundingSphere
+{
+	glm::vec3 center{0.f};
+	float radius = 0.f;
+};
+
+struct Aabb
+{
+	glm::vec3 min{std::numeric_limits<float>::max()};
+	glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+	bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+	void expand(const glm::vec3 & point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	void expand(const Aabb & other)
+	{
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+};
+
+// Transforms sphere by matrix with possibly non uniform scale.
+inline BoundingSphere transform(const BoundingSphere & sphere, const glm::mat4 & matrix)
+{
+	const auto scale = glm::max(glm::length(glm::vec3{matrix[0]}),
+								glm::max(glm::length(glm::vec3{matrix[1]}), glm::length(glm::vec3{matrix[2]})));
+	return {glm::vec3{matrix * glm::vec4{sphere.center, 1.f}}, sphere.radius * scale};
+}
+
+// Transforms box by matrix, result is box around transformed box.
+inline Aabb transform(const Aabb & box, const glm::mat4 & matrix)
+{
+	const auto center = glm::vec3{matrix * glm::vec4{box.center(), 1.f}};
+	const auto extents = box.extents();
+	const auto absAxis = [&](const int axis) { return glm::abs(glm::vec3{matrix[axis]}) * extents[axis]; };
+	const auto halfSize = absAxis(0) + absAxis(1) + absAxis(2);
+	return {center - halfSize, center + halfSize};
+}
+
+}// namespace fgl
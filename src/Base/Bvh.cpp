@@ -0,0 +1,456 @@
+#include "Bvh.hpp"
+
+#include <Base/ParallelFor.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/intersect.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Deeper nodes are split by median which keeps depth logarithmic.
+constexpr std::size_t g_maxSahDepth = 64;
+// Smaller subtrees are not worth a separate task.
+constexpr std::uint32_t g_minParallelPrimitives = 4096;
+constexpr std::size_t g_subtreesPerWorker = 4;
+constexpr std::size_t g_raycastGrain = 256;
+
+float surfaceArea(const Aabb & box)
+{
+	if (box.isEmpty())
+	{
+		return 0.f;
+	}
+	const auto size = box.max - box.min;
+	return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+enum class Containment
+{
+	Outside,
+	Intersects,
+	Inside,
+};
+
+Containment classify(const Frustum & frustum, const Aabb & box)
+{
+	const auto center = box.center();
+	const auto extents = box.extents();
+	auto result = Containment::Inside;
+	for (const auto & plane: frustum.planes)
+	{
+		const glm::vec3 normal{plane};
+		const auto distance = glm::dot(normal, center) + plane.w;
+		const auto radius = glm::dot(extents, glm::abs(normal));
+		if (distance < -radius)
+		{
+			return Containment::Outside;
+		}
+		if (distance < radius)
+		{
+			result = Containment::Intersects;
+		}
+	}
+	return result;
+}
+
+class Builder
+{
+public:
+	Builder(const BvhBuildOptions & options, const std::vector<Aabb> & bounds, std::vector<std::uint32_t> & primitives)
+		: options_{options}
+		, bounds_{bounds}
+		, primitives_{primitives}
+		, centroids_(bounds.size())
+	{
+		for (std::size_t i = 0; i < bounds.size(); ++i)
+		{
+			centroids_[i] = bounds[i].center();
+		}
+	}
+
+	Aabb rangeBounds(const std::uint32_t begin, const std::uint32_t count) const
+	{
+		Aabb result;
+		for (auto i = begin; i < begin + count; ++i)
+		{
+			result.expand(bounds_[primitives_[i]]);
+		}
+		return result;
+	}
+
+	// Partitions node primitives and appends two children, returns false if node stays leaf.
+	bool split(std::vector<BvhNode> & nodes, const std::uint32_t nodeIndex, const std::size_t depth) const
+	{
+		const auto node = nodes[nodeIndex];
+		if (node.primitiveCount <= options_.maxLeafSize)
+		{
+			return false;
+		}
+		const auto begin = primitives_.begin() + node.primitiveBegin;
+		const auto end = begin + node.primitiveCount;
+
+		Aabb centroidBounds;
+		for (auto it = begin; it != end; ++it)
+		{
+			centroidBounds.expand(centroids_[*it]);
+		}
+		const auto extent = centroidBounds.max - centroidBounds.min;
+		const auto largestAxis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+		if (extent[largestAxis] <= 0.f)
+		{
+			// All centroids are the same, nothing to split.
+			return false;
+		}
+
+		auto middle = end;
+		if (depth < g_maxSahDepth)
+		{
+			middle = sahPartition(node, centroidBounds, begin, end);
+			if (middle == end)
+			{
+				return false;
+			}
+		}
+		if (middle == begin || middle == end)
+		{
+			middle = begin + node.primitiveCount / 2;
+			std::nth_element(begin, middle, end, [&](const auto a, const auto b) {
+				return centroids_[a][largestAxis] < centroids_[b][largestAxis];
+			});
+		}
+
+		const auto leftCount = static_cast<std::uint32_t>(middle - begin);
+		const auto left = static_cast<std::uint32_t>(nodes.size());
+		nodes[nodeIndex].left = left;
+		nodes.push_back({rangeBounds(node.primitiveBegin, leftCount), 0, node.primitiveBegin, leftCount});
+		nodes.push_back({rangeBounds(node.primitiveBegin + leftCount, node.primitiveCount - leftCount), 0,
+						 node.primitiveBegin + leftCount, node.primitiveCount - leftCount});
+		return true;
+	}
+
+	void buildSubtree(std::vector<BvhNode> & nodes, const std::uint32_t root, const std::size_t rootDepth) const
+	{
+		std::vector<std::pair<std::uint32_t, std::size_t>> stack{{root, rootDepth}};
+		while (!stack.empty())
+		{
+			const auto [node, depth] = stack.back();
+			stack.pop_back();
+			if (split(nodes, node, depth))
+			{
+				stack.emplace_back(nodes[node].left, depth + 1);
+				stack.emplace_back(nodes[node].left + 1, depth + 1);
+			}
+		}
+	}
+
+private:
+	using Iterator = std::vector<std::uint32_t>::iterator;
+
+	struct Bin
+	{
+		Aabb bounds;
+		std::uint32_t count = 0;
+	};
+
+	// Returns end when making a leaf is cheaper, begin when no split is possible.
+	Iterator sahPartition(const BvhNode & node, const Aabb & centroidBounds, const Iterator begin, const Iterator end) const
+	{
+		const auto binCount = std::max<std::size_t>(options_.binCount, 2u);
+		const auto extent = centroidBounds.max - centroidBounds.min;
+
+		auto bestCost = std::numeric_limits<float>::max();
+		auto bestAxis = -1;
+		std::size_t bestBin = 0;
+
+		std::vector<Bin> bins(binCount);
+		std::vector<float> rightCosts(binCount);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (extent[axis] <= 0.f)
+			{
+				continue;
+			}
+			const auto scale = static_cast<float>(binCount) / extent[axis];
+			std::fill(bins.begin(), bins.end(), Bin{});
+			for (auto it = begin; it != end; ++it)
+			{
+				const auto bin = std::min(binCount - 1, static_cast<std::size_t>((centroids_[*it][axis] - centroidBounds.min[axis]) * scale));
+				bins[bin].bounds.expand(bounds_[*it]);
+				++bins[bin].count;
+			}
+
+			// Cost of right side for split planes after each bin, then sweep left side.
+			Aabb right;
+			std::uint32_t rightCount = 0;
+			for (auto bin = binCount - 1; bin > 0; --bin)
+			{
+				right.expand(bins[bin].bounds);
+				rightCount += bins[bin].count;
+				rightCosts[bin - 1] = surfaceArea(right) * static_cast<float>(rightCount);
+			}
+			Aabb left;
+			std::uint32_t leftCount = 0;
+			for (std::size_t bin = 0; bin + 1 < binCount; ++bin)
+			{
+				left.expand(bins[bin].bounds);
+				leftCount += bins[bin].count;
+				const auto cost = surfaceArea(left) * static_cast<float>(leftCount) + rightCosts[bin];
+				if (leftCount != 0 && leftCount != node.primitiveCount && cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = bin;
+				}
+			}
+		}
+
+		if (bestAxis < 0)
+		{
+			return begin;
+		}
+		// Leaf costs count intersections, split costs one more traversal step.
+		const auto leafCost = surfaceArea(node.bounds) * static_cast<float>(node.primitiveCount);
+		if (bestCost >= leafCost && node.primitiveCount <= options_.maxLeafSize * 4)
+		{
+			return end;
+		}
+
+		const auto scale = static_cast<float>(binCount) / extent[bestAxis];
+		return std::partition(begin, end, [&](const auto primitive) {
+			const auto bin = std::min(binCount - 1, static_cast<std::size_t>((centroids_[primitive][bestAxis] - centroidBounds.min[bestAxis]) * scale));
+			return bin <= bestBin;
+		});
+	}
+
+private:
+	const BvhBuildOptions & options_;
+	const std::vector<Aabb> & bounds_;
+	std::vector<std::uint32_t> & primitives_;
+	std::vector<glm::vec3> centroids_;
+};
+
+}// namespace
+
+RayBoxTest::RayBoxTest(const Ray & ray)
+	: origin{ray.origin}
+	, inverseDirection{1.f / ray.direction.x, 1.f / ray.direction.y, 1.f / ray.direction.z}
+{
+}
+
+bool RayBoxTest::intersects(const Aabb & box, const float maxDistance) const
+{
+	const auto t0 = (box.min - origin) * inverseDirection;
+	const auto t1 = (box.max - origin) * inverseDirection;
+	const auto tNear = glm::min(t0, t1);
+	const auto tFar = glm::max(t0, t1);
+	const auto enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.f));
+	const auto exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+	return enter <= exit;
+}
+
+void Bvh::build(std::vector<Aabb> primitiveBounds, const BvhBuildOptions & options)
+{
+	primitiveBounds_ = std::move(primitiveBounds);
+	const auto count = static_cast<std::uint32_t>(primitiveBounds_.size());
+
+	primitives_.resize(count);
+	std::iota(primitives_.begin(), primitives_.end(), 0u);
+	nodes_.clear();
+	if (count == 0)
+	{
+		return;
+	}
+	nodes_.reserve(2 * static_cast<std::size_t>(count));
+
+	const Builder builder{options, primitiveBounds_, primitives_};
+	nodes_.push_back({builder.rangeBounds(0, count), 0, 0, count});
+
+	if (!options.parallel || count < g_minParallelPrimitives)
+	{
+		builder.buildSubtree(nodes_, 0, 0);
+		return;
+	}
+
+	// Split top levels serially until there are enough big independent subtrees.
+	std::vector<std::pair<std::uint32_t, std::size_t>> pending{{0u, 0u}};
+	const auto targetSubtrees = workerCount() * g_subtreesPerWorker;
+	while (pending.size() < targetSubtrees)
+	{
+		const auto largest = std::max_element(pending.begin(), pending.end(), [&](const auto & a, const auto & b) {
+			return nodes_[a.first].primitiveCount < nodes_[b.first].primitiveCount;
+		});
+		const auto [node, depth] = *largest;
+		if (nodes_[node].primitiveCount < g_minParallelPrimitives)
+		{
+			break;
+		}
+		pending.erase(largest);
+		if (builder.split(nodes_, node, depth))
+		{
+			pending.emplace_back(nodes_[node].left, depth + 1);
+			pending.emplace_back(nodes_[node].left + 1, depth + 1);
+		}
+	}
+
+	// Subtrees are built into local arrays and appended in order so result is deterministic.
+	std::vector<std::vector<BvhNode>> subtrees(pending.size());
+	parallelFor(pending.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			auto & subtree = subtrees[i];
+			subtree.push_back(nodes_[pending[i].first]);
+			builder.buildSubtree(subtree, 0, pending[i].second);
+		}
+	});
+
+	for (std::size_t i = 0; i < pending.size(); ++i)
+	{
+		// Local index 0 is the pending node itself, others are appended.
+		const auto offset = static_cast<std::uint32_t>(nodes_.size()) - 1u;
+		auto & subtree = subtrees[i];
+		for (auto & node: subtree)
+		{
+			node.left = node.isLeaf() ? 0u : node.left + offset;
+		}
+		nodes_[pending[i].first] = subtree.front();
+		nodes_.insert(nodes_.end(), subtree.begin() + 1, subtree.end());
+	}
+}
+
+void Bvh::refit(std::vector<Aabb> primitiveBounds)
+{
+	primitiveBounds_ = std::move(primitiveBounds);
+	for (auto index = nodes_.size(); index-- > 0;)
+	{
+		auto & node = nodes_[index];
+		if (node.isLeaf())
+		{
+			node.bounds = {};
+			for (auto i = node.primitiveBegin; i < node.primitiveBegin + node.primitiveCount; ++i)
+			{
+				node.bounds.expand(primitiveBounds_[primitives_[i]]);
+			}
+		}
+		else
+		{
+			node.bounds = nodes_[node.left].bounds;
+			node.bounds.expand(nodes_[node.left + 1].bounds);
+		}
+	}
+}
+
+void Bvh::queryFrustum(const Frustum & frustum, std::vector<std::uint32_t> & result) const
+{
+	result.clear();
+	if (nodes_.empty())
+	{
+		return;
+	}
+	std::uint32_t stack[128];
+	std::size_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize != 0)
+	{
+		const auto & node = nodes_[stack[--stackSize]];
+		const auto containment = classify(frustum, node.bounds);
+		if (containment == Containment::Outside)
+		{
+			continue;
+		}
+		const auto first = primitives_.begin() + node.primitiveBegin;
+		if (containment == Containment::Inside)
+		{
+			result.insert(result.end(), first, first + node.primitiveCount);
+		}
+		else if (node.isLeaf())
+		{
+			std::copy_if(first, first + node.primitiveCount, std::back_inserter(result), [&](const auto primitive) {
+				return frustum.intersects(primitiveBounds_[primitive]);
+			});
+		}
+		else
+		{
+			stack[stackSize++] = node.left;
+			stack[stackSize++] = node.left + 1;
+		}
+	}
+}
+
+void MeshBvh::build(const Mesh & mesh, const BvhBuildOptions & options)
+{
+	mesh_ = &mesh;
+	bvh_.build(triangleBounds(mesh), options);
+}
+
+void MeshBvh::refit(const Mesh & mesh)
+{
+	mesh_ = &mesh;
+	bvh_.refit(triangleBounds(mesh));
+}
+
+std::vector<Aabb> MeshBvh::triangleBounds(const Mesh & mesh) const
+{
+	std::vector<Aabb> result(mesh.triangleCount());
+	parallelFor(result.size(), 16384, [&](const std::size_t begin, const std::size_t end) {
+		for (auto triangle = begin; triangle < end; ++triangle)
+		{
+			for (std::size_t corner = 0; corner < 3; ++corner)
+			{
+				result[triangle].expand(mesh.positions[mesh.indices[triangle * 3 + corner]]);
+			}
+		}
+	});
+	return result;
+}
+
+RayHit MeshBvh::raycast(const Ray & ray) const
+{
+	const auto & mesh = *mesh_;
+	return bvh_.raycast(ray, [&](const std::uint32_t triangle, const Ray & r, RayHit & hit) {
+		const auto * corners = &mesh.indices[triangle * 3u];
+		glm::vec2 barycentric;
+		float distance = 0.f;
+		if (glm::intersectRayTriangle(r.origin, r.direction, mesh.positions[corners[0]], mesh.positions[corners[1]],
+									  mesh.positions[corners[2]], barycentric, distance)
+			&& distance >= 0.f && distance < hit.distance)
+		{
+			hit.primitive = triangle;
+			hit.distance = distance;
+			hit.barycentric = barycentric;
+			return true;
+		}
+		return false;
+	});
+}
+
+void MeshBvh::raycast(const std::vector<Ray> & rays, std::vector<RayHit> & hits) const
+{
+	hits.resize(rays.size());
+	parallelFor(rays.size(), g_raycastGrain, [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			hits[i] = raycast(rays[i]);
+		}
+	});
+}
+
+Ray rayFromScreen(const glm::mat4 & inverseViewProj, const glm::vec2 & pixel, const glm::vec2 & viewportSize)
+{
+	const glm::vec2 ndc{pixel.x / viewportSize.x * 2.f - 1.f, 1.f - pixel.y / viewportSize.y * 2.f};
+	const auto unproject = [&](const float depth) {
+		const auto point = inverseViewProj * glm::vec4{ndc, depth, 1.f};
+		return glm::vec3{point} / point.w;
+	};
+	const auto nearPoint = unproject(-1.f);
+	const auto farPoint = unproject(1.f);
+	return {nearPoint, glm::normalize(farPoint - nearPoint), glm::length(farPoint - nearPoint)};
+}
+
+}// namespace fgl
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/Frustum.hpp>
+#include <Base/Mesh.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace fgl
+{
+
+struct Ray
+{
+	glm::vec3 origin{0.f};
+	// Normalized direction.
+	glm::vec3 direction{0.f, 0.f, -1.f};
+	float maxDistance = std::numeric_limits<float>::max();
+};
+
+struct RayHit
+{
+	static constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+
+	std::uint32_t primitive = none;
+	float distance = std::numeric_limits<float>::max();
+	// Barycentric coordinates of hit point for triangles.
+	glm::vec2 barycentric{0.f};
+
+	bool isHit() const { return primitive != none; }
+};
+
+// Ray with precomputed inverse direction for box tests.
+struct RayBoxTest
+{
+	explicit RayBoxTest(const Ray & ray);
+
+	// Returns true when ray enters box closer than max distance.
+	bool intersects(const Aabb & box, float maxDistance) const;
+
+	glm::vec3 origin;
+	glm::vec3 inverseDirection;
+};
+
+struct BvhNode
+{
+	Aabb bounds;
+	// Index of the left child, right one follows it. Zero for leaves.
+	std::uint32_t left = 0;
+	// Range in primitive indices covered by the node, for inner nodes too.
+	std::uint32_t primitiveBegin = 0;
+	std::uint32_t primitiveCount = 0;
+
+	bool isLeaf() const { return left == 0; }
+};
+
+struct BvhBuildOptions
+{
+	std::size_t maxLeafSize = 4;
+	std::size_t binCount = 16;
+	// Build independent subtrees on worker threads.
+	bool parallel = true;
+};
+
+// Bounding volume hierarchy over arbitrary primitives given by their boxes. Built
+// with binned surface area heuristic, children are always stored after parents
+// so refit is a single backward pass.
+class Bvh
+{
+public:
+	void build(std::vector<Aabb> primitiveBounds, const BvhBuildOptions & options = {});
+
+	// Updates boxes after primitives moved keeping tree topology. Tree quality
+	// degrades with large movements, rebuild then.
+	void refit(std::vector<Aabb> primitiveBounds);
+
+	const std::vector<BvhNode> & nodes() const { return nodes_; }
+	// Primitive indices ordered by leaves.
+	const std::vector<std::uint32_t> & primitives() const { return primitives_; }
+	const std::vector<Aabb> & primitiveBounds() const { return primitiveBounds_; }
+
+	// Collects primitives whose boxes intersect frustum.
+	void queryFrustum(const Frustum & frustum, std::vector<std::uint32_t> & result) const;
+
+	// Finds the closest primitive hit. Test is called as test(primitive, ray, hit), it must
+	// return true and update hit when primitive is hit closer than hit.distance.
+	template<typename PrimitiveTest>
+	RayHit raycast(const Ray & ray, PrimitiveTest && test) const;
+
+private:
+	std::vector<BvhNode> nodes_;
+	std::vector<std::uint32_t> primitives_;
+	std::vector<Aabb> primitiveBounds_;
+};
+
+// Triangle mesh with BVH for ray queries, ray and mesh are in the same space.
+class MeshBvh
+{
+public:
+	void build(const Mesh & mesh, const BvhBuildOptions & options = {});
+	// Rebuilds boxes after vertices moved, mesh topology must be the same.
+	void refit(const Mesh & mesh);
+
+	RayHit raycast(const Ray & ray) const;
+	// Casts rays on worker threads.
+	void raycast(const std::vector<Ray> & rays, std::vector<RayHit> & hits) const;
+
+	const Bvh & bvh() const { return bvh_; }
+
+private:
+	std::vector<Aabb> triangleBounds(const Mesh & mesh) const;
+
+private:
+	Bvh bvh_;
+	const Mesh * mesh_ = nullptr;
+};
+
+// Ray through viewport pixel, pixel coordinates start at top left corner.
+Ray rayFromScreen(const glm::mat4 & inverseViewProj, const glm::vec2 & pixel, const glm::vec2 & viewportSize);
+
+template<typename PrimitiveTest>
+RayHit Bvh::raycast(const Ray & ray, PrimitiveTest && test) const
+{
+	RayHit hit;
+	hit.distance = ray.maxDistance;
+	if (nodes_.empty())
+	{
+		return hit;
+	}
+
+	const RayBoxTest boxTest{ray};
+	// Build limits tree depth so stack never overflows.
+	std::uint32_t stack[128];
+	std::size_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize != 0)
+	{
+		const auto & node = nodes_[stack[--stackSize]];
+		if (!boxTest.intersects(node.bounds, hit.distance))
+		{
+			continue;
+		}
+		if (node.isLeaf())
+		{
+			for (auto i = node.primitiveBegin; i < node.primitiveBegin + node.primitiveCount; ++i)
+			{
+				test(primitives_[i], ray, hit);
+			}
+			continue;
+		}
+		// Visit nearer child first so farther one is likely culled by hit distance.
+		auto first = node.left;
+		auto second = node.left + 1;
+		const auto axis = glm::abs(ray.direction.x) > glm::abs(ray.direction.y)
+			? (glm::abs(ray.direction.x) > glm::abs(ray.direction.z) ? 0 : 2)
+			: (glm::abs(ray.direction.y) > glm::abs(ray.direction.z) ? 1 : 2);
+		if (ray.direction[axis] < 0.f)
+		{
+			std::swap(first, second);
+		}
+		stack[stackSize++] = second;
+		stack[stackSize++] = first;
+	}
+	return hit;
+}
+
+}// namespace fgl
@@ -0,0 +1,227 @@
+#include "CascadedShadowMaps.hpp"
+
+#include <Base/SceneFramebuffer.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_minResolution = 16;
+// Light space depth padding in world units, so casters lying on scene bounds are not clipped.
+constexpr auto g_depthPadding = 1.f;
+// Cascade sizes change in steps of this part of power of two below them.
+constexpr auto g_sizeSteps = 8.f;
+
+bool contains(const glm::vec2 & min, const glm::vec2 & max, const Aabb & box)
+{
+	return box.min.x >= min.x && box.min.y >= min.y && box.max.x <= max.x && box.max.y <= max.y;
+}
+
+}// namespace
+
+void CascadedShadowMaps::setSettings(const CascadeSettings & settings)
+{
+	settings_ = settings;
+	settings_.cascadeCount = std::clamp<std::size_t>(settings.cascadeCount, 1u, maxCascades);
+	settings_.dynamicCascades = std::min(settings.dynamicCascades, settings_.cascadeCount);
+	settings_.resolution = std::max(settings.resolution, g_minResolution);
+	valid_.fill(false);
+
+	if (gl_ != nullptr && settings_.resolution != textureResolution_)
+	{
+		destroyTexture();
+		createTexture();
+	}
+}
+
+void CascadedShadowMaps::setLightDirection(const glm::vec3 & direction)
+{
+	lightDirection_ = glm::normalize(direction);
+	const auto up = std::abs(lightDirection_.y) > 0.99f ? glm::vec3{1.f, 0.f, 0.f} : glm::vec3{0.f, 1.f, 0.f};
+	// Rotation only, so snapping to texels in light space does not depend on camera position
+	lightView_ = glm::lookAt(glm::vec3{0.f}, -lightDirection_, up);
+}
+
+void CascadedShadowMaps::setSceneBounds(const Aabb & bounds)
+{
+	sceneBounds_ = bounds;
+	valid_.fill(false);
+}
+
+void CascadedShadowMaps::update(const glm::mat4 & view, const float fovY, const float aspect, const float near)
+{
+	const auto tanHalfFovY = std::tan(fovY * 0.5f);
+	const auto tanHalfFovX = tanHalfFovY * aspect;
+	const auto far = std::max(settings_.shadowDistance, near * 1.01f);
+	const auto viewToLight = lightView_ * glm::inverse(view);
+	const auto count = settings_.cascadeCount;
+
+	auto sliceNear = near;
+	for (std::size_t index = 0; index < count; ++index)
+	{
+		const auto t = static_cast<float>(index + 1) / static_cast<float>(count);
+		const auto splitDepth = glm::mix(near + (far - near) * t, near * std::pow(far / near, t), settings_.splitLambda);
+
+		Aabb slice;
+		for (const auto depth: {sliceNear, splitDepth})
+		{
+			for (const auto x: {-1.f, 1.f})
+			{
+				for (const auto y: {-1.f, 1.f})
+				{
+					slice.expand(glm::vec3{viewToLight * glm::vec4{x * tanHalfFovX * depth, y * tanHalfFovY * depth, -depth, 1.f}});
+				}
+			}
+		}
+		sliceNear = splitDepth;
+
+		auto & cascade = cascades_[index];
+		cascade.splitDepth = splitDepth;
+		const auto cached = settings_.caching && index >= settings_.dynamicCascades;
+		if (!cached)
+		{
+			cascade.cached = false;
+			fitCascade(index, slice, 0.f);
+			valid_[index] = false;
+			continue;
+		}
+
+		auto & fit = cachedFits_[index];
+		if (cascade.cached && valid_[index] && fit.lightDirection == lightDirection_ && fit.staticVersion == staticVersion_ &&
+			contains(fit.min, fit.max, slice))
+		{
+			continue;
+		}
+		cascade.cached = true;
+		fitCascade(index, slice, settings_.cacheMargin);
+		valid_[index] = false;
+		fit.lightDirection = lightDirection_;
+		fit.staticVersion = staticVersion_;
+	}
+}
+
+void CascadedShadowMaps::fitCascade(const std::size_t index, const Aabb & slice, const float margin)
+{
+	const auto resolution = static_cast<float>(settings_.resolution);
+	const glm::vec2 center{slice.center()};
+	const auto extent = glm::vec2{slice.max - slice.min} * (1.f + 2.f * margin);
+
+	// Size is quantized, so it stays the same while camera turns a little, and leaves room
+	// for two texels the corner may move by when snapped
+	glm::vec2 size;
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		const auto minSize = std::max(extent[axis], 1e-3f) / (1.f - 2.f / resolution);
+		const auto step = std::exp2(std::floor(std::log2(minSize))) / g_sizeSteps;
+		size[axis] = std::ceil(minSize / step) * step;
+	}
+	const auto texelSize = size / resolution;
+	const auto min = glm::floor((center - size * 0.5f) / texelSize) * texelSize;
+	const auto max = min + size;
+
+	auto depth = slice;
+	if (!sceneBounds_.isEmpty())
+	{
+		depth.expand(transform(sceneBounds_, lightView_));
+	}
+
+	// Light looks along -Z, so near plane is at the largest Z
+	const auto projection = glm::ortho(min.x, max.x, min.y, max.y, -depth.max.z - g_depthPadding, -depth.min.z + g_depthPadding);
+	auto & cascade = cascades_[index];
+	cascade.viewProj = projection * lightView_;
+	cascade.texelSize = texelSize;
+	cachedFits_[index].min = min;
+	cachedFits_[index].max = max;
+}
+
+void CascadedShadowMaps::create(QOpenGLFunctions_3_3_Core & gl)
+{
+	gl_ = &gl;
+	gl_->glGenFramebuffers(static_cast<GLsizei>(maxCascades), framebuffers_.data());
+	createTexture();
+}
+
+void CascadedShadowMaps::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	destroyTexture();
+	gl_->glDeleteFramebuffers(static_cast<GLsizei>(maxCascades), framebuffers_.data());
+	framebuffers_.fill(0);
+}
+
+bool CascadedShadowMaps::beginCascade(const std::size_t index)
+{
+	if (valid_[index])
+	{
+		return false;
+	}
+	activeCascade_ = index;
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_[index]);
+	gl_->glViewport(0, 0, textureResolution_, textureResolution_);
+	gl_->glClear(GL_DEPTH_BUFFER_BIT);
+	return true;
+}
+
+void CascadedShadowMaps::endCascade()
+{
+	Q_ASSERT(activeCascade_ < maxCascades);
+	valid_[activeCascade_] = true;
+	activeCascade_ = maxCascades;
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer());
+}
+
+void CascadedShadowMaps::bindTexture(const GLuint unit)
+{
+	gl_->glActiveTexture(GL_TEXTURE0 + unit);
+	gl_->glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+}
+
+void CascadedShadowMaps::createTexture()
+{
+	textureResolution_ = settings_.resolution;
+	gl_->glGenTextures(1, &texture_);
+	gl_->glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+	gl_->glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, textureResolution_, textureResolution_,
+					  static_cast<GLsizei>(maxCascades), 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	// Linear filter with comparison gives 2x2 PCF per tap, outside of map is lit
+	const GLfloat border[] = {1.f, 1.f, 1.f, 1.f};
+	gl_->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	gl_->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl_->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	gl_->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	gl_->glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+	gl_->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	gl_->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	gl_->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+	gl_->glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	for (std::size_t layer = 0; layer < maxCascades; ++layer)
+	{
+		gl_->glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_[layer]);
+		gl_->glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture_, 0, static_cast<GLint>(layer));
+		gl_->glDrawBuffer(GL_NONE);
+		gl_->glReadBuffer(GL_NONE);
+		Q_ASSERT(gl_->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	}
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer());
+	valid_.fill(false);
+}
+
+void CascadedShadowMaps::destroyTexture()
+{
+	gl_->glDeleteTextures(1, &texture_);
+	texture_ = 0;
+	textureResolution_ = 0;
+}
+
+}// namespace fgl
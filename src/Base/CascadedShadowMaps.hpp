@@ -0,0 +1,135 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/Frustum.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fgl
+{
+
+struct CascadeSettings
+{
+	std::size_t cascadeCount = 4;
+	// Cascades rendered every frame with all casters, the following ones hold static casters
+	// only and are cached.
+	std::size_t dynamicCascades = 2;
+	bool caching = true;
+	int resolution = 1024;
+	// View depth shadows end at.
+	float shadowDistance = 150.f;
+	// Split distances blend logarithmic (1) and uniform (0) splits, Zhang et al.,
+	// "Parallel-Split Shadow Maps".
+	float splitLambda = 0.75f;
+	// Cached cascades are fitted with this part of slice size added on each side, so camera
+	// moves for a while before they are fitted and rendered again.
+	float cacheMargin = 0.25f;
+};
+
+// Shadow maps of directional light for view frustum slices, stored in layers of one depth
+// texture array with comparison mode for sampler2DArrayShadow. Each cascade is an
+// orthographic box fitted to light space bounds of its slice, with sizes quantized and
+// corners snapped to texels, so shadow edges do not shimmer while camera moves. Depth range
+// of every cascade covers the whole scene, so casters outside of slice still cast.
+// Cascades beyond dynamicCascades keep their contents between frames and are rendered again
+// only when light direction or static casters change or camera leaves their margin.
+//
+// Each frame: update(), then for every cascade render casters culled with frustum()
+// between beginCascade() returning true and endCascade().
+class CascadedShadowMaps
+{
+public:
+	static constexpr std::size_t maxCascades = 4;
+
+	struct Cascade
+	{
+		// World to light clip space.
+		glm::mat4 viewProj{1.f};
+		// View depth where the cascade ends.
+		float splitDepth = 0.f;
+		// World size of shadow map texel along light space X and Y.
+		glm::vec2 texelSize{0.f};
+		// Cascade holds static casters only and keeps them between frames.
+		bool cached = false;
+	};
+
+public:
+	void setSettings(const CascadeSettings & settings);
+	const CascadeSettings & settings() const { return settings_; }
+
+	// Direction towards the light.
+	void setLightDirection(const glm::vec3 & direction);
+	// Bounds of all casters and receivers, depth range of cascades.
+	void setSceneBounds(const Aabb & bounds);
+	// Cached cascades are rendered again, call when static casters change.
+	void invalidateStatic() { ++staticVersion_; }
+
+	// Fits cascades to view frustum of symmetric perspective camera.
+	void update(const glm::mat4 & view, float fovY, float aspect, float near);
+
+	std::size_t cascadeCount() const { return settings_.cascadeCount; }
+	const Cascade & cascade(const std::size_t index) const { return cascades_[index]; }
+	// Casters touching light space box of cascade.
+	Frustum frustum(const std::size_t index) const { return Frustum::fromMatrix(cascades_[index].viewProj); }
+	// Cascade must be rendered this frame, always true for not cached ones.
+	bool needsRender(const std::size_t index) const { return !valid_[index]; }
+	// Casters of cached cascade are static ones only, dynamic cascades take all casters.
+	bool isStaticOnly(const std::size_t index) const { return cascades_[index].cached; }
+
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl);
+	void destroy();
+
+	// Binds framebuffer of cascade layer, sets viewport and clears depth. Returns false and
+	// binds nothing when cascade is up to date.
+	bool beginCascade(std::size_t index);
+	// Binds scene framebuffer back, see sceneFramebuffer().
+	void endCascade();
+
+	void bindTexture(GLuint unit);
+
+	std::size_t textureBytes() const
+	{
+		return static_cast<std::size_t>(textureResolution_) * static_cast<std::size_t>(textureResolution_) * maxCascades * sizeof(float);
+	}
+
+private:
+	struct CachedFit
+	{
+		glm::vec3 lightDirection{0.f};
+		std::uint64_t staticVersion = 0;
+		// Light space bounds of the rendered box.
+		glm::vec2 min{0.f};
+		glm::vec2 max{0.f};
+	};
+
+private:
+	void fitCascade(std::size_t index, const Aabb & slice, float margin);
+	void createTexture();
+	void destroyTexture();
+
+private:
+	CascadeSettings settings_;
+	glm::vec3 lightDirection_{0.f, 1.f, 0.f};
+	glm::mat4 lightView_{1.f};
+	Aabb sceneBounds_;
+	std::uint64_t staticVersion_ = 1;
+
+	std::array<Cascade, maxCascades> cascades_;
+	std::array<CachedFit, maxCascades> cachedFits_;
+	std::array<bool, maxCascades> valid_{};
+
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+	GLuint texture_ = 0;
+	int textureResolution_ = 0;
+	std::array<GLuint, maxCascades> framebuffers_{};
+	std::size_t activeCascade_ = maxCascades;
+};
+
+}// namespace fgl
@@ -0,0 +1,76 @@
+#include "DrawList.hpp"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::uint32_t g_depthBits = 24;
+constexpr std::uint32_t g_maxDepth = (1u << g_depthBits) - 1;
+
+std::uint64_t quantizeDepth(const float depth)
+{
+	return static_cast<std::uint64_t>(std::lround(static_cast<double>(std::clamp(depth, 0.f, 1.f)) * g_maxDepth));
+}
+
+}// namespace
+
+bool DrawKey::fits() const
+{
+	return layer <= maxLayer && program <= maxProgram && material <= maxMaterial && mesh <= maxMesh;
+}
+
+std::uint64_t DrawKey::encode() const
+{
+	Q_ASSERT_X(layer <= maxLayer, "DrawKey::encode", "layer out of range");
+	Q_ASSERT_X(program <= maxProgram, "DrawKey::encode", "program out of range");
+	Q_ASSERT_X(material <= maxMaterial, "DrawKey::encode", "material out of range");
+	Q_ASSERT_X(mesh <= maxMesh, "DrawKey::encode", "mesh out of range");
+	if (!fits())
+	{
+		qWarning() << "draw key out of range, layer" << layer << "program" << program << "material" << material << "mesh" << mesh;
+	}
+
+	const auto state = (std::uint64_t{std::min(program, maxProgram)} << 27u)
+		| (std::uint64_t{std::min(material, maxMaterial)} << 11u)
+		| std::uint64_t{std::min(mesh, maxMesh)};
+	auto key = std::uint64_t{std::min(layer, maxLayer)} << 60u;
+	if (translucent)
+	{
+		key |= std::uint64_t{1} << 59u;
+		key |= (g_maxDepth - quantizeDepth(depth)) << 35u;
+		key |= state;
+	}
+	else
+	{
+		key |= state << g_depthBits;
+		key |= quantizeDepth(depth);
+	}
+	return key;
+}
+
+std::uint64_t DrawKey::state(const std::uint64_t key)
+{
+	constexpr auto stateMask = (std::uint64_t{1} << 35u) - 1;
+	const auto state = (key & (std::uint64_t{1} << 59u)) != 0 ? key : key >> g_depthBits;
+	return ((key >> 59u) << 35u) | (state & stateMask);
+}
+
+bool DrawList::add(const DrawKey & key, const std::uint32_t payload)
+{
+	if (!key.fits())
+	{
+		qWarning() << "rejected draw" << payload << "with key out of range";
+		return false;
+	}
+	items_.push_back({key.encode(), payload});
+	return true;
+}
+
+}// namespace fgl
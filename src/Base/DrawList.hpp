@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Base/RadixSort.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// Fields of draw sort key, from the most significant. Opaque draws are grouped by
+// program, material and mesh to minimize state changes and go front to back inside
+// groups. Translucent draws go after opaque ones of the same layer, back to front.
+//
+//   opaque:      layer 4 | 0 | program 8 | material 16 | mesh 11 | depth 24
+//   translucent: layer 4 | 1 | inverted depth 24 | program 8 | material 16 | mesh 11
+struct DrawKey
+{
+	static constexpr std::uint32_t maxLayer = (1u << 4) - 1;
+	static constexpr std::uint32_t maxProgram = (1u << 8) - 1;
+	static constexpr std::uint32_t maxMaterial = (1u << 16) - 1;
+	static constexpr std::uint32_t maxMesh = (1u << 11) - 1;
+
+	std::uint32_t layer = 0;
+	bool translucent = false;
+	std::uint32_t program = 0;
+	std::uint32_t material = 0;
+	std::uint32_t mesh = 0;
+	// View depth normalized to [0, 1], quantized to 24 bit buckets.
+	float depth = 0.f;
+
+	// Whether all fields fit their bits, keys of fields out of range would collide with
+	// keys of other state.
+	bool fits() const;
+	// Fields must fit, out of range ones are logged and saturated.
+	std::uint64_t encode() const;
+	// Layer, translucency, program, material and mesh of encoded key without depth,
+	// draws with equal state can be merged into one instanced draw.
+	static std::uint64_t state(std::uint64_t key);
+};
+
+// Draws of a frame as sort keys with payload indices, usually of objects to draw.
+class DrawList
+{
+public:
+	void clear() { items_.clear(); }
+	// Rejects and logs draws whose key does not fit.
+	bool add(const DrawKey & key, std::uint32_t payload);
+
+	// Resizes list for set() calls, that may come from several threads. Keys must fit.
+	void resize(std::size_t count) { items_.resize(count); }
+	void set(const std::size_t index, const DrawKey & key, const std::uint32_t payload) { items_[index] = {key.encode(), payload}; }
+
+	// Orders draws by keys with radix sort.
+	void sort(bool parallel = true) { radixSort(items_, scratch_, parallel); }
+
+	const std::vector<SortItem> & items() const { return items_; }
+	std::size_t size() const { return items_.size(); }
+
+private:
+	std::vector<SortItem> items_;
+	std::vector<SortItem> scratch_;
+};
+
+}// namespace fgl
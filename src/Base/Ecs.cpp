@@ -0,0 +1,232 @@
+#include "Ecs.hpp"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::size_t g_chunkBytes = 16 * 1024;
+// Columns start at cache line boundary.
+constexpr std::size_t g_columnAlignment = 64;
+
+struct ComponentInfo
+{
+	std::size_t size;
+	std::size_t alignment;
+};
+
+std::mutex g_componentsMutex;
+std::vector<ComponentInfo> g_components;
+
+std::size_t componentSize(const ComponentId id)
+{
+	const std::lock_guard<std::mutex> lock{g_componentsMutex};
+	return g_components[id].size;
+}
+
+std::size_t alignUp(const std::size_t value, const std::size_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// Offsets of columns for given capacity, returns bytes used.
+std::size_t layoutColumns(const std::vector<std::size_t> & sizes, const std::size_t capacity, std::vector<std::size_t> & offsets)
+{
+	offsets.clear();
+	auto offset = sizeof(Entity) * capacity;
+	for (const auto size: sizes)
+	{
+		offset = alignUp(offset, g_columnAlignment);
+		offsets.push_back(offset);
+		offset += size * capacity;
+	}
+	return offset;
+}
+
+}// namespace
+
+void ChunkDeleter::operator()(std::byte * data) const { ::operator delete[](data, std::align_val_t{g_columnAlignment}); }
+
+ComponentId registerComponent(const std::size_t size, const std::size_t alignment)
+{
+	const std::lock_guard<std::mutex> lock{g_componentsMutex};
+	// Checked in release builds too, id past the mask would be out of its range
+	if (g_components.size() >= maxComponentTypes)
+	{
+		qFatal("ecs: more than %zu component types registered", maxComponentTypes);
+	}
+	if (alignment > g_columnAlignment)
+	{
+		qFatal("ecs: component alignment %zu exceeds %zu", alignment, g_columnAlignment);
+	}
+	g_components.push_back({size, alignment});
+	return static_cast<ComponentId>(g_components.size() - 1);
+}
+
+void World::destroy(const Entity entity)
+{
+	if (!isAlive(entity))
+	{
+		return;
+	}
+	const auto record = records_[entity.index];
+	releaseRow(record.archetype, record.chunk, record.row);
+	++records_[entity.index].generation;
+	freeIndices_.push_back(entity.index);
+	--entityCount_;
+}
+
+bool World::isAlive(const Entity entity) const
+{
+	return entity.index < records_.size() && records_[entity.index].generation == entity.generation;
+}
+
+Entity World::createEntity(const ComponentMask & mask)
+{
+	Entity entity;
+	if (freeIndices_.empty())
+	{
+		entity.index = static_cast<std::uint32_t>(records_.size());
+		records_.emplace_back();
+	}
+	else
+	{
+		entity.index = freeIndices_.back();
+		freeIndices_.pop_back();
+	}
+	entity.generation = records_[entity.index].generation;
+	allocateRow(entity, archetypeFor(mask));
+	++entityCount_;
+	return entity;
+}
+
+std::uint32_t World::archetypeFor(const ComponentMask & mask)
+{
+	const auto found = archetypeIndices_.find(mask);
+	if (found != archetypeIndices_.end())
+	{
+		return found->second;
+	}
+
+	Archetype archetype;
+	archetype.mask = mask;
+	archetype.columns.fill(-1);
+	auto & sizes = archetype.sizes;
+	for (ComponentId id = 0; id < maxComponentTypes; ++id)
+	{
+		if (mask.test(id))
+		{
+			archetype.columns[id] = static_cast<std::int32_t>(archetype.components.size());
+			archetype.components.push_back(id);
+			sizes.push_back(componentSize(id));
+		}
+	}
+
+	// As many rows as fit into chunk, components bigger than chunk get a chunk per entity
+	auto rowBytes = sizeof(Entity);
+	for (const auto size: sizes)
+	{
+		rowBytes += size;
+	}
+	auto capacity = std::max<std::size_t>(g_chunkBytes / rowBytes, 1);
+	while (capacity > 1 && layoutColumns(sizes, capacity, archetype.offsets) > g_chunkBytes)
+	{
+		--capacity;
+	}
+	archetype.chunkBytes = std::max(layoutColumns(sizes, capacity, archetype.offsets), g_chunkBytes);
+	archetype.chunkCapacity = static_cast<std::uint32_t>(capacity);
+
+	const auto index = static_cast<std::uint32_t>(archetypes_.size());
+	archetypes_.push_back(std::move(archetype));
+	archetypeIndices_.emplace(mask, index);
+	return index;
+}
+
+void World::allocateRow(const Entity entity, const std::uint32_t archetypeIndex)
+{
+	auto & archetype = archetypes_[archetypeIndex];
+	if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.chunkCapacity)
+	{
+		archetype.chunks.emplace_back();
+		// Default new aligns to 16 bytes only, columns promise cache line alignment
+		auto * data = static_cast<std::byte *>(::operator new[](archetype.chunkBytes, std::align_val_t{g_columnAlignment}));
+		std::memset(data, 0, archetype.chunkBytes);
+		archetype.chunks.back().data.reset(data);
+	}
+	auto & chunk = archetype.chunks.back();
+	archetype.entities(chunk)[chunk.count] = entity;
+
+	auto & record = records_[entity.index];
+	record.archetype = archetypeIndex;
+	record.chunk = static_cast<std::uint32_t>(archetype.chunks.size() - 1);
+	record.row = chunk.count;
+	++chunk.count;
+}
+
+void World::releaseRow(const std::uint32_t archetypeIndex, const std::uint32_t chunkIndex, const std::uint32_t row)
+{
+	auto & archetype = archetypes_[archetypeIndex];
+	auto & chunk = archetype.chunks[chunkIndex];
+	auto & last = archetype.chunks.back();
+	const auto lastRow = last.count - 1;
+	if (&chunk != &last || row != lastRow)
+	{
+		const auto moved = archetype.entities(last)[lastRow];
+		archetype.entities(chunk)[row] = moved;
+		for (std::size_t column = 0; column < archetype.components.size(); ++column)
+		{
+			const auto size = archetype.sizes[column];
+			std::memcpy(chunk.data.get() + archetype.offsets[column] + row * size,
+						last.data.get() + archetype.offsets[column] + lastRow * size, size);
+		}
+		records_[moved.index].chunk = chunkIndex;
+		records_[moved.index].row = row;
+	}
+	if (--last.count == 0)
+	{
+		archetype.chunks.pop_back();
+	}
+}
+
+void World::move(const Entity entity, const ComponentMask & mask)
+{
+	const auto source = records_[entity.index];
+	const auto target = archetypeFor(mask);
+	allocateRow(entity, target);
+	const auto destination = records_[entity.index];
+
+	// Components present in both archetypes keep their values
+	const auto & from = archetypes_[source.archetype];
+	const auto & to = archetypes_[target];
+	for (std::size_t column = 0; column < to.components.size(); ++column)
+	{
+		const auto id = to.components[column];
+		if (from.columns[id] < 0)
+		{
+			continue;
+		}
+		const auto size = to.sizes[column];
+		const auto fromColumn = static_cast<std::size_t>(from.columns[id]);
+		std::memcpy(to.chunks[destination.chunk].data.get() + to.offsets[column] + destination.row * size,
+					from.chunks[source.chunk].data.get() + from.offsets[fromColumn] + source.row * size, size);
+	}
+	releaseRow(source.archetype, source.chunk, source.row);
+}
+
+std::byte * World::component(const Entity entity, const ComponentId id) const
+{
+	const auto & record = records_[entity.index];
+	const auto & archetype = archetypes_[record.archetype];
+	const auto column = static_cast<std::size_t>(archetype.columns[id]);
+	return archetype.chunks[record.chunk].data.get() + archetype.offsets[column] + record.row * archetype.sizes[column];
+}
+
+}// namespace fgl
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <Base/ParallelFor.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace fgl
+{
+
+// Entity handle. Generation tells handles of destroyed entities from reused ones.
+struct Entity
+{
+	static constexpr auto invalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+	std::uint32_t index = invalidIndex;
+	std::uint32_t generation = 0;
+
+	bool operator==(const Entity & other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const Entity & other) const { return !(*this == other); }
+};
+
+using ComponentId = std::uint32_t;
+constexpr std::size_t maxComponentTypes = 64;
+using ComponentMask = std::bitset<maxComponentTypes>;
+
+// Registers component type layout, used by componentId.
+ComponentId registerComponent(std::size_t size, std::size_t alignment);
+
+// Dense id of component type, assigned on first use. Components are plain data
+// moved between chunks with memcpy.
+template<typename Component>
+ComponentId componentId()
+{
+	if constexpr (std::is_const_v<Component> || std::is_volatile_v<Component>)
+	{
+		return componentId<std::remove_cv_t<Component>>();
+	}
+	else
+	{
+		static_assert(std::is_trivially_copyable_v<Component> && std::is_trivially_destructible_v<Component>,
+					  "Components must be plain data");
+		static const auto id = registerComponent(sizeof(Component), alignof(Component));
+		return id;
+	}
+}
+
+// Frees chunk memory allocated with column alignment.
+struct ChunkDeleter
+{
+	void operator()(std::byte * data) const;
+};
+
+// Fixed size block holding entities of one archetype. Each component is a contiguous
+// array inside the block, entity handles go first.
+struct Chunk
+{
+	std::unique_ptr<std::byte[], ChunkDeleter> data;
+	std::uint32_t count = 0;
+};
+
+// Entities with the same set of components.
+struct Archetype
+{
+	ComponentMask mask;
+	std::vector<ComponentId> components;
+	// Column of component id or -1.
+	std::array<std::int32_t, maxComponentTypes> columns;
+	std::vector<std::size_t> offsets;
+	std::vector<std::size_t> sizes;
+	std::size_t chunkBytes = 0;
+	std::uint32_t chunkCapacity = 0;
+	std::vector<Chunk> chunks;
+
+	Entity * entities(const Chunk & chunk) const { return reinterpret_cast<Entity *>(chunk.data.get()); }
+
+	// Archetype must have the component.
+	template<typename Component>
+	Component * column(const Chunk & chunk) const
+	{
+		const auto offset = offsets[static_cast<std::size_t>(columns[componentId<Component>()])];
+		return reinterpret_cast<Component *>(chunk.data.get() + offset);
+	}
+};
+
+template<typename... Components>
+class Query;
+
+// Archetype based entity component system. Entities with the same component set share
+// an archetype whose chunks keep components packed, so queries walk memory linearly.
+// Adding or removing components moves entity to another archetype. Structural changes
+// are not allowed while iterating a query.
+class World
+{
+public:
+	template<typename... Components>
+	Entity create(const Components &... components)
+	{
+		ComponentMask mask;
+		(mask.set(componentId<Components>()), ...);
+		const auto entity = createEntity(mask);
+		((get<Components>(entity) = components), ...);
+		return entity;
+	}
+
+	void destroy(Entity entity);
+	bool isAlive(Entity entity) const;
+	std::size_t entityCount() const { return entityCount_; }
+	std::size_t archetypeCount() const { return archetypes_.size(); }
+
+	template<typename Component>
+	bool has(const Entity entity) const
+	{
+		return archetypes_[records_[entity.index].archetype].mask.test(componentId<Component>());
+	}
+
+	// Entity must have the component.
+	template<typename Component>
+	Component & get(const Entity entity)
+	{
+		return *reinterpret_cast<Component *>(component(entity, componentId<Component>()));
+	}
+
+	template<typename Component>
+	const Component & get(const Entity entity) const
+	{
+		return *reinterpret_cast<const Component *>(component(entity, componentId<Component>()));
+	}
+
+	// Replaces value when entity already has the component.
+	template<typename Component>
+	void add(const Entity entity, const Component & value)
+	{
+		const auto id = componentId<Component>();
+		if (!archetypes_[records_[entity.index].archetype].mask.test(id))
+		{
+			auto mask = archetypes_[records_[entity.index].archetype].mask;
+			move(entity, mask.set(id));
+		}
+		get<Component>(entity) = value;
+	}
+
+	template<typename Component>
+	void remove(const Entity entity)
+	{
+		const auto id = componentId<Component>();
+		if (archetypes_[records_[entity.index].archetype].mask.test(id))
+		{
+			auto mask = archetypes_[records_[entity.index].archetype].mask;
+			move(entity, mask.reset(id));
+		}
+	}
+
+	template<typename... Components>
+	Query<Components...> query() { return Query<Components...>{*this}; }
+
+private:
+	struct Record
+	{
+		std::uint32_t generation = 0;
+		std::uint32_t archetype = 0;
+		std::uint32_t chunk = 0;
+		std::uint32_t row = 0;
+	};
+
+	template<typename... Components>
+	friend class Query;
+
+private:
+	Entity createEntity(const ComponentMask & mask);
+	std::uint32_t archetypeFor(const ComponentMask & mask);
+	// Places entity into the last chunk of archetype and updates its record.
+	void allocateRow(Entity entity, std::uint32_t archetype);
+	// Fills the row with the last entity of archetype.
+	void releaseRow(std::uint32_t archetype, std::uint32_t chunk, std::uint32_t row);
+	void move(Entity entity, const ComponentMask & mask);
+	std::byte * component(Entity entity, ComponentId id) const;
+
+private:
+	std::vector<Archetype> archetypes_;
+	std::unordered_map<ComponentMask, std::uint32_t> archetypeIndices_;
+
+	std::vector<Record> records_;
+	std::vector<std::uint32_t> freeIndices_;
+	std::size_t entityCount_ = 0;
+};
+
+// Iterates entities having all given components. Function takes component references
+// in the same order, optionally preceded by entity handle. Components given as const
+// are only read. Matching archetypes are cached and extended when world gets new ones.
+template<typename... Components>
+class Query
+{
+public:
+	explicit Query(World & world)
+		: world_(world)
+	{
+		(mask_.set(componentId<Components>()), ...);
+	}
+
+	template<typename Function>
+	void forEach(Function && function)
+	{
+		refresh();
+		for (const auto archetype: archetypes_)
+		{
+			for (const auto & chunk: world_.archetypes_[archetype].chunks)
+			{
+				forEachInChunk(world_.archetypes_[archetype], chunk, function);
+			}
+		}
+	}
+
+	// Chunks are distributed over worker threads, function must be thread safe.
+	template<typename Function>
+	void parallelForEach(Function && function)
+	{
+		refresh();
+		chunks_.clear();
+		for (const auto archetype: archetypes_)
+		{
+			for (std::size_t chunk = 0; chunk < world_.archetypes_[archetype].chunks.size(); ++chunk)
+			{
+				chunks_.push_back({archetype, static_cast<std::uint32_t>(chunk)});
+			}
+		}
+		parallelFor(chunks_.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+			for (auto i = begin; i < end; ++i)
+			{
+				const auto & archetype = world_.archetypes_[chunks_[i].archetype];
+				forEachInChunk(archetype, archetype.chunks[chunks_[i].chunk], function);
+			}
+		});
+	}
+
+	std::size_t count()
+	{
+		refresh();
+		std::size_t result = 0;
+		for (const auto archetype: archetypes_)
+		{
+			for (const auto & chunk: world_.archetypes_[archetype].chunks)
+			{
+				result += chunk.count;
+			}
+		}
+		return result;
+	}
+
+private:
+	struct ChunkRef
+	{
+		std::uint32_t archetype;
+		std::uint32_t chunk;
+	};
+
+private:
+	void refresh()
+	{
+		for (; checked_ < world_.archetypes_.size(); ++checked_)
+		{
+			if ((world_.archetypes_[checked_].mask & mask_) == mask_)
+			{
+				archetypes_.push_back(static_cast<std::uint32_t>(checked_));
+			}
+		}
+	}
+
+	template<typename Function>
+	static void forEachInChunk(const Archetype & archetype, const Chunk & chunk, Function & function)
+	{
+		forEachRow(function, chunk.count, archetype.entities(chunk), archetype.template column<Components>(chunk)...);
+	}
+
+	template<typename Function, typename... Columns>
+	static void forEachRow(Function & function, const std::uint32_t count, const Entity * entities, Columns *... columns)
+	{
+		for (std::uint32_t row = 0; row < count; ++row)
+		{
+			if constexpr (std::is_invocable_v<Function &, Entity, Columns &...>)
+			{
+				function(entities[row], columns[row]...);
+			}
+			else
+			{
+				function(columns[row]...);
+			}
+		}
+	}
+
+private:
+	World & world_;
+	ComponentMask mask_;
+	std::vector<std::uint32_t> archetypes_;
+	std::size_t checked_ = 0;
+	std::vector<ChunkRef> chunks_;
+};
+
+}// namespace fgl
@@ -0,0 +1,92 @@
+#include "FrameStats.hpp"
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_nsInMs = 1e6;
+
+}// namespace
+
+FrameStats::CounterId FrameStats::addCounter(const QString & name)
+{
+	counters_.push_back({name});
+	return counters_.size() - 1;
+}
+
+void FrameStats::setCounter(const CounterId id, const double value) { counters_[id].value = value; }
+
+void FrameStats::addToCounter(const CounterId id, const double value) { counters_[id].value += value; }
+
+void FrameStats::beginFrame()
+{
+	if (frameTimer_.isValid())
+	{
+		const auto frameMs = static_cast<double>(frameTimer_.nsecsElapsed()) / g_nsInMs;
+		frameMsMin_ = intervals_ == 0 ? frameMs : std::min(frameMsMin_, frameMs);
+		frameMsMax_ = intervals_ == 0 ? frameMs : std::max(frameMsMax_, frameMs);
+		frameMsSum_ += frameMs;
+		++intervals_;
+	}
+	frameTimer_.start();
+	cpuTimer_.start();
+
+	for (auto & counter: counters_)
+	{
+		counter.value = 0.;
+	}
+}
+
+void FrameStats::endFrame()
+{
+	cpuMsSum_ += static_cast<double>(cpuTimer_.nsecsElapsed()) / g_nsInMs;
+	for (auto & counter: counters_)
+	{
+		counter.sum += counter.value;
+	}
+	++frames_;
+}
+
+void FrameStats::reset()
+{
+	frames_ = 0;
+	intervals_ = 0;
+	frameMsSum_ = 0.;
+	frameMsMin_ = 0.;
+	frameMsMax_ = 0.;
+	cpuMsSum_ = 0.;
+	frameTimer_.invalidate();
+	for (auto & counter: counters_)
+	{
+		counter.sum = 0.;
+	}
+}
+
+double FrameStats::averageFrameMs() const { return intervals_ ? frameMsSum_ / static_cast<double>(intervals_) : 0.; }
+
+double FrameStats::averageCpuMs() const { return frames_ ? cpuMsSum_ / static_cast<double>(frames_) : 0.; }
+
+double FrameStats::averageCounter(const CounterId id) const
+{
+	return frames_ ? counters_[id].sum / static_cast<double>(frames_) : 0.;
+}
+
+QString FrameStats::summary() const
+{
+	auto result = QString{"frame %1 ms (min %2, max %3) | cpu %4 ms"}
+					  .arg(averageFrameMs(), 0, 'f', 2)
+					  .arg(frameMsMin_, 0, 'f', 2)
+					  .arg(frameMsMax_, 0, 'f', 2)
+					  .arg(averageCpuMs(), 0, 'f', 2);
+	for (CounterId id = 0; id < counters_.size(); ++id)
+	{
+		result += QString{" | %1 %2"}.arg(counters_[id].name).arg(averageCounter(id), 0, 'f', 1);
+	}
+	return result;
+}
+
+}// namespace fgl
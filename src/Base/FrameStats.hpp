@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <cstddef>
+#include <vector>
+
+namespace fgl
+{
+
+// Accumulates frame timings and user counters (triangles, draw calls, etc.) over
+// several frames and reports averages.
+class FrameStats
+{
+public:
+	using CounterId = std::size_t;
+
+	CounterId addCounter(const QString & name);
+
+	// Counters are reset to zero at the start of each frame.
+	void setCounter(CounterId id, double value);
+	void addToCounter(CounterId id, double value);
+
+	void beginFrame();
+	void endFrame();
+
+	// Drops accumulated values but keeps registered counters.
+	void reset();
+
+	std::size_t frameCount() const { return frames_; }
+	double averageFrameMs() const;
+	double averageCpuMs() const;
+	double averageCounter(CounterId id) const;
+
+	QString summary() const;
+
+private:
+	struct Counter
+	{
+		QString name;
+		double value = 0.;
+		double sum = 0.;
+	};
+
+	std::vector<Counter> counters_;
+
+	QElapsedTimer frameTimer_;
+	QElapsedTimer cpuTimer_;
+
+	std::size_t frames_ = 0;
+	// Frame intervals are measured between frame starts so first frame has none.
+	std::size_t intervals_ = 0;
+	double frameMsSum_ = 0.;
+	double frameMsMin_ = 0.;
+	double frameMsMax_ = 0.;
+	double cpuMsSum_ = 0.;
+};
+
+}// namespace fgl
@@ -0,0 +1,66 @@
+#include "FrameUniforms.hpp"
+
+#include <QDebug>
+
+#include <cstring>
+
+namespace fgl
+{
+
+static_assert(sizeof(FrameData) == 3 * 64 + 16, "FrameData must match std140 layout of FrameData block");
+
+void FrameUniformBuffer::create(QOpenGLFunctions_3_3_Core & gl)
+{
+	gl_ = &gl;
+	gl_->glGenBuffers(1, &buffer_);
+	gl_->glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+	gl_->glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+	gl_->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	uploadedValid_ = false;
+}
+
+void FrameUniformBuffer::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	gl_->glDeleteBuffers(1, &buffer_);
+	buffer_ = 0;
+	uploadedValid_ = false;
+}
+
+void FrameUniformBuffer::attach(const ShaderReflection & reflection) const
+{
+	const auto * block = reflection.findBlock(blockName);
+	if (block == nullptr)
+	{
+		qWarning() << "program" << reflection.program() << "has no active uniform block" << blockName;
+		return;
+	}
+	if (block->size != static_cast<GLint>(sizeof(FrameData)))
+	{
+		qWarning() << "program" << reflection.program() << "has uniform block" << blockName << "of" << block->size
+				   << "bytes, expected" << static_cast<int>(sizeof(FrameData));
+		return;
+	}
+	gl_->glUniformBlockBinding(reflection.program(), block->index, binding);
+}
+
+std::size_t FrameUniformBuffer::update(const FrameData & data)
+{
+	std::size_t bytes = 0;
+	if (!uploadedValid_ || std::memcmp(&uploaded_, &data, sizeof(FrameData)) != 0)
+	{
+		gl_->glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+		gl_->glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+		gl_->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		uploaded_ = data;
+		uploadedValid_ = true;
+		bytes = sizeof(FrameData);
+	}
+	gl_->glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer_);
+	return bytes;
+}
+
+}// namespace fgl
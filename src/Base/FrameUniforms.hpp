@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Base/ShaderReflection.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+namespace fgl
+{
+
+// Per frame and per view data shared by all programs, matches std140 uniform block
+//	layout(std140) uniform FrameData { mat4 viewProj; mat4 view; mat4 projection; vec4 cameraPosition; };
+struct FrameData
+{
+	glm::mat4 viewProj{1.f};
+	glm::mat4 view{1.f};
+	glm::mat4 projection{1.f};
+	glm::vec4 cameraPosition{0.f, 0.f, 0.f, 1.f};
+};
+
+// Uniform buffer holding FrameData, bound to a fixed binding point once per frame so
+// programs need no per frame uniform calls for camera data.
+class FrameUniformBuffer
+{
+public:
+	static constexpr GLuint binding = 0;
+	static constexpr const char * blockName = "FrameData";
+
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl);
+	void destroy();
+
+	// Connects FrameData block of reflected program to binding point, call once after link.
+	// Blocks of other size than FrameData are reported and left unbound.
+	void attach(const ShaderReflection & reflection) const;
+
+	// Uploads data if changed and binds buffer to binding point. Returns bytes uploaded.
+	std::size_t update(const FrameData & data);
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	GLuint buffer_ = 0;
+	FrameData uploaded_;
+	bool uploadedValid_ = false;
+};
+
+}// namespace fgl
@@ -0,0 +1,55 @@
+#include "Frustum.hpp"
+
+namespace fgl
+{
+
+Frustum Frustum::fromMatrix(const glm::mat4 & matrix)
+{
+	// Rows of column major matrix.
+	const auto row = [&](const int index) {
+		return glm::vec4{matrix[0][index], matrix[1][index], matrix[2][index], matrix[3][index]};
+	};
+
+	Frustum frustum;
+	frustum.planes[Left] = row(3) + row(0);
+	frustum.planes[Right] = row(3) - row(0);
+	frustum.planes[Bottom] = row(3) + row(1);
+	frustum.planes[Top] = row(3) - row(1);
+	frustum.planes[Near] = row(3) + row(2);
+	frustum.planes[Far] = row(3) - row(2);
+	for (auto & plane: frustum.planes)
+	{
+		plane /= glm::length(glm::vec3{plane});
+	}
+	return frustum;
+}
+
+bool Frustum::intersects(const BoundingSphere & sphere) const
+{
+	for (const auto & plane: planes)
+	{
+		if (glm::dot(glm::vec3{plane}, sphere.center) + plane.w < -sphere.radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::intersects(const Aabb & box) const
+{
+	const auto center = box.center();
+	const auto extents = box.extents();
+	for (const auto & plane: planes)
+	{
+		const glm::vec3 normal{plane};
+		const auto radius = glm::dot(extents, glm::abs(normal));
+		if (glm::dot(normal, center) + plane.w < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+}// namespace fgl
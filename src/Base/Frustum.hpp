@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+namespace fgl
+{
+
+// Six planes pointing inside of the frustum, point p is inside when dot(plane.xyz, p) + plane.w >= 0.
+struct Frustum
+{
+	enum Plane
+	{
+		Left = 0,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far,
+	};
+
+	std::array<glm::vec4, 6u> planes;
+
+	// Extracts normalized planes from projection matrix (Gribb & Hartmann). For view projection
+	// matrix planes are in world space, for model view projection in object space.
+	static Frustum fromMatrix(const glm::mat4 & matrix);
+
+	bool intersects(const BoundingSphere & sphere) const;
+	bool intersects(const Aabb & box) const;
+};
+
+}// namespace fgl
@@ -0,0 +1,205 @@
+#include "FrustumCuller.hpp"
+
+#include <Base/ParallelFor.hpp>
+#include <Base/Simd.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Padding bounds fail every plane test.
+constexpr auto g_paddingRadius = std::numeric_limits<float>::lowest();
+
+std::size_t paddedSize(const std::size_t count) { return (count + simd::width - 1) / simd::width * simd::width; }
+
+struct SimdPlane
+{
+	simd::Float x, y, z, w;
+	simd::Float absX, absY, absZ;
+};
+
+std::array<SimdPlane, 6u> broadcastPlanes(const Frustum & frustum)
+{
+	std::array<SimdPlane, 6u> result;
+	for (std::size_t i = 0; i < result.size(); ++i)
+	{
+		const auto & plane = frustum.planes[i];
+		result[i] = {simd::broadcast(plane.x), simd::broadcast(plane.y), simd::broadcast(plane.z), simd::broadcast(plane.w),
+					 simd::broadcast(std::abs(plane.x)), simd::broadcast(std::abs(plane.y)), simd::broadcast(std::abs(plane.z))};
+	}
+	return result;
+}
+
+// Culls objects [begin, end), begin must be multiple of SIMD width. Output must have
+// space for end - begin + simd::width indices, returns number of visible objects.
+template<CullVolume volume>
+std::size_t cullRange(const std::array<SimdPlane, 6u> & planes, const BoundsSoA & bounds,
+					  const std::size_t begin, const std::size_t end, std::uint32_t * output)
+{
+	std::size_t count = 0;
+	for (auto i = begin; i < end; i += simd::width)
+	{
+		const auto x = simd::load(bounds.centerX() + i);
+		const auto y = simd::load(bounds.centerY() + i);
+		const auto z = simd::load(bounds.centerZ() + i);
+
+		simd::Float radius;
+		simd::Float extentX, extentY, extentZ;
+		if constexpr (volume == CullVolume::Sphere)
+		{
+			radius = simd::load(bounds.radius() + i);
+		}
+		else
+		{
+			extentX = simd::load(bounds.extentX() + i);
+			extentY = simd::load(bounds.extentY() + i);
+			extentZ = simd::load(bounds.extentZ() + i);
+		}
+
+		auto inside = simd::trueMask();
+		for (const auto & plane: planes)
+		{
+			const auto distance = x * plane.x + y * plane.y + z * plane.z + plane.w;
+			if constexpr (volume == CullVolume::Sphere)
+			{
+				inside = inside & (distance + radius >= simd::broadcast(0.f));
+			}
+			else
+			{
+				// Projected box radius on plane normal.
+				const auto projected = extentX * plane.absX + extentY * plane.absY + extentZ * plane.absZ;
+				inside = inside & (distance + projected >= simd::broadcast(0.f));
+			}
+		}
+
+		// Branchless compaction: every lane is written, only visible ones advance output.
+		const auto mask = simd::bits(inside);
+		for (std::size_t lane = 0; lane < simd::width; ++lane)
+		{
+			output[count] = static_cast<std::uint32_t>(i + lane);
+			count += (mask >> lane) & 1u;
+		}
+	}
+	// Lanes past the end belong to padding and are never visible.
+	return count;
+}
+
+std::size_t cullRange(const std::array<SimdPlane, 6u> & planes, const BoundsSoA & bounds, const CullVolume volume,
+					  const std::size_t begin, const std::size_t end, std::uint32_t * output)
+{
+	return volume == CullVolume::Sphere
+		? cullRange<CullVolume::Sphere>(planes, bounds, begin, end, output)
+		: cullRange<CullVolume::Box>(planes, bounds, begin, end, output);
+}
+
+}// namespace
+
+void BoundsSoA::clear() { resize(0); }
+
+void BoundsSoA::reserve(const std::size_t count)
+{
+	const auto padded = paddedSize(count);
+	for (auto * array: {&centerX_, &centerY_, &centerZ_, &radius_, &extentX_, &extentY_, &extentZ_})
+	{
+		array->reserve(padded);
+	}
+}
+
+void BoundsSoA::resize(const std::size_t count)
+{
+	const auto padded = paddedSize(count);
+	for (auto * array: {&centerX_, &centerY_, &centerZ_, &extentX_, &extentY_, &extentZ_})
+	{
+		array->resize(padded, 0.f);
+	}
+	radius_.resize(padded, g_paddingRadius);
+	// Reset padding after shrinking or growing.
+	for (auto i = count; i < padded; ++i)
+	{
+		centerX_[i] = centerY_[i] = centerZ_[i] = 0.f;
+		radius_[i] = extentX_[i] = extentY_[i] = extentZ_[i] = g_paddingRadius;
+	}
+	size_ = count;
+}
+
+std::uint32_t BoundsSoA::add(const Aabb & box)
+{
+	const auto index = static_cast<std::uint32_t>(size_);
+	resize(size_ + 1);
+	set(index, box);
+	return index;
+}
+
+std::uint32_t BoundsSoA::add(const BoundingSphere & sphere)
+{
+	const auto index = static_cast<std::uint32_t>(size_);
+	resize(size_ + 1);
+	set(index, sphere);
+	return index;
+}
+
+void BoundsSoA::set(const std::uint32_t index, const Aabb & box)
+{
+	const auto center = box.center();
+	const auto extents = box.extents();
+	centerX_[index] = center.x;
+	centerY_[index] = center.y;
+	centerZ_[index] = center.z;
+	radius_[index] = glm::length(extents);
+	extentX_[index] = extents.x;
+	extentY_[index] = extents.y;
+	extentZ_[index] = extents.z;
+}
+
+void BoundsSoA::set(const std::uint32_t index, const BoundingSphere & sphere)
+{
+	centerX_[index] = sphere.center.x;
+	centerY_[index] = sphere.center.y;
+	centerZ_[index] = sphere.center.z;
+	radius_[index] = sphere.radius;
+	extentX_[index] = extentY_[index] = extentZ_[index] = sphere.radius;
+}
+
+void cullFrustum(const Frustum & frustum, const BoundsSoA & bounds, const CullVolume volume,
+				 std::vector<std::uint32_t> & visible)
+{
+	visible.resize(bounds.size() + simd::width);
+	const auto count = cullRange(broadcastPlanes(frustum), bounds, volume, 0, bounds.size(), visible.data());
+	visible.resize(count);
+}
+
+void cullFrustumParallel(const Frustum & frustum, const BoundsSoA & bounds, const CullVolume volume,
+						 std::vector<std::uint32_t> & visible, const std::size_t chunkSize)
+{
+	const auto planes = broadcastPlanes(frustum);
+	const auto chunk = paddedSize(std::max<std::size_t>(chunkSize, 1u));
+	const auto chunkCount = (bounds.size() + chunk - 1) / chunk;
+
+	// Each chunk writes results in place of its own objects, then chunks are
+	// compacted in order. Destination never overlaps results of next chunks.
+	visible.resize(bounds.size() + simd::width);
+	std::vector<std::size_t> counts(chunkCount);
+	parallelFor(chunkCount, 1, [&](const std::size_t beginChunk, const std::size_t endChunk) {
+		for (auto i = beginChunk; i < endChunk; ++i)
+		{
+			const auto begin = i * chunk;
+			const auto end = std::min(begin + chunk, bounds.size());
+			counts[i] = cullRange(planes, bounds, volume, begin, end, visible.data() + begin);
+		}
+	});
+
+	std::size_t total = 0;
+	for (std::size_t i = 0; i < chunkCount; ++i)
+	{
+		std::memmove(visible.data() + total, visible.data() + i * chunk, counts[i] * sizeof(std::uint32_t));
+		total += counts[i];
+	}
+	visible.resize(total);
+}
+
+}// namespace fgl
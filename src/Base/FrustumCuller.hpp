@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/Frustum.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// Object bounds in structure of arrays layout for SIMD culling. Each object has box
+// and sphere sharing the same center. Arrays are padded to SIMD width with bounds
+// that never pass any test.
+class BoundsSoA
+{
+public:
+	void clear();
+	void reserve(std::size_t count);
+
+	// Returns index of added object.
+	std::uint32_t add(const Aabb & box);
+	std::uint32_t add(const BoundingSphere & sphere);
+
+	void set(std::uint32_t index, const Aabb & box);
+	void set(std::uint32_t index, const BoundingSphere & sphere);
+
+	std::size_t size() const { return size_; }
+
+	const float * centerX() const { return centerX_.data(); }
+	const float * centerY() const { return centerY_.data(); }
+	const float * centerZ() const { return centerZ_.data(); }
+	const float * radius() const { return radius_.data(); }
+	const float * extentX() const { return extentX_.data(); }
+	const float * extentY() const { return extentY_.data(); }
+	const float * extentZ() const { return extentZ_.data(); }
+
+private:
+	void resize(std::size_t count);
+
+private:
+	std::size_t size_ = 0;
+
+	std::vector<float> centerX_;
+	std::vector<float> centerY_;
+	std::vector<float> centerZ_;
+	std::vector<float> radius_;
+	std::vector<float> extentX_;
+	std::vector<float> extentY_;
+	std::vector<float> extentZ_;
+};
+
+enum class CullVolume
+{
+	Sphere,
+	Box,
+};
+
+// Tests bounds against frustum several objects at a time and writes indices
+// of visible ones in increasing order.
+void cullFrustum(const Frustum & frustum, const BoundsSoA & bounds, CullVolume volume,
+				 std::vector<std::uint32_t> & visible);
+
+// Same as cullFrustum but splits objects into chunks processed on worker threads.
+void cullFrustumParallel(const Frustum & frustum, const BoundsSoA & bounds, CullVolume volume,
+						 std::vector<std::uint32_t> & visible, std::size_t chunkSize = 16384);
+
+}// namespace fgl
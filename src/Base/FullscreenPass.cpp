@@ -0,0 +1,41 @@
+#include "FullscreenPass.hpp"
+
+namespace fgl
+{
+
+const char * FullscreenPass::vertexShader()
+{
+	return R"(#version 330 core
+out vec2 uv;
+
+void main()
+{
+	uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+}
+
+void FullscreenPass::create(QOpenGLFunctions_3_3_Core & gl)
+{
+	gl_ = &gl;
+	gl_->glGenVertexArrays(1, &vao_);
+}
+
+void FullscreenPass::destroy()
+{
+	if (gl_ != nullptr)
+	{
+		gl_->glDeleteVertexArrays(1, &vao_);
+	}
+	vao_ = 0;
+}
+
+void FullscreenPass::draw()
+{
+	gl_->glBindVertexArray(vao_);
+	gl_->glDrawArrays(GL_TRIANGLES, 0, 3);
+	gl_->glBindVertexArray(0);
+}
+
+}// namespace fgl
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+
+namespace fgl
+{
+
+// Draws single triangle covering the whole viewport. Vertex positions are generated
+// from gl_VertexID, so only an empty VAO is needed.
+class FullscreenPass
+{
+public:
+	// Vertex shader passing texture coordinates in [0, 1] as "uv" output.
+	static const char * vertexShader();
+
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl);
+	void destroy();
+
+	// Program must be bound.
+	void draw();
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+	GLuint vao_ = 0;
+};
+
+}// namespace fgl
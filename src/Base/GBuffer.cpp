@@ -0,0 +1,102 @@
+#include "GBuffer.hpp"
+
+#include <Base/SceneFramebuffer.hpp>
+
+namespace fgl
+{
+
+void GBuffer::create(QOpenGLFunctions_3_3_Core & gl, const int width, const int height)
+{
+	gl_ = &gl;
+	width_ = width;
+	height_ = height;
+
+	gl_->glGenFramebuffers(1, &framebuffer_);
+	createTextures();
+}
+
+void GBuffer::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	destroyTextures();
+	gl_->glDeleteFramebuffers(1, &framebuffer_);
+	framebuffer_ = 0;
+}
+
+void GBuffer::resize(const int width, const int height)
+{
+	if (width == width_ && height == height_)
+	{
+		return;
+	}
+	width_ = width;
+	height_ = height;
+	destroyTextures();
+	createTextures();
+}
+
+void GBuffer::bind()
+{
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+	gl_->glViewport(0, 0, width_, height_);
+}
+
+void GBuffer::release()
+{
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer());
+}
+
+void GBuffer::bindTextures(const GLuint firstUnit)
+{
+	const GLuint textures[] = {albedoTexture_, normalTexture_, depthTexture_};
+	for (GLuint i = 0; i < 3; ++i)
+	{
+		gl_->glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+		gl_->glBindTexture(GL_TEXTURE_2D, textures[i]);
+	}
+}
+
+void GBuffer::createTextures()
+{
+	// Lighting pass reads texels with texelFetch, so no filtering is needed
+	const auto createTexture = [&](const GLint format, const GLenum dataFormat, const GLenum type) {
+		GLuint texture = 0;
+		gl_->glGenTextures(1, &texture);
+		gl_->glBindTexture(GL_TEXTURE_2D, texture);
+		gl_->glTexImage2D(GL_TEXTURE_2D, 0, format, width_, height_, 0, dataFormat, type, nullptr);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		return texture;
+	};
+	albedoTexture_ = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+	normalTexture_ = createTexture(GL_RG16, GL_RG, GL_UNSIGNED_SHORT);
+	depthTexture_ = createTexture(GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT);
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+	gl_->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTexture_, 0);
+	gl_->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTexture_, 0);
+	gl_->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture_, 0);
+	const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+	gl_->glDrawBuffers(2, drawBuffers);
+	Q_ASSERT(gl_->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	release();
+}
+
+void GBuffer::destroyTextures()
+{
+	gl_->glDeleteTextures(1, &albedoTexture_);
+	gl_->glDeleteTextures(1, &normalTexture_);
+	gl_->glDeleteTextures(1, &depthTexture_);
+	albedoTexture_ = 0;
+	normalTexture_ = 0;
+	depthTexture_ = 0;
+}
+
+}// namespace fgl
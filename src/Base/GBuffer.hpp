@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <cstddef>
+
+namespace fgl
+{
+
+// Minimal G-buffer of deferred shading, 12 bytes per pixel:
+//   color attachment 0, RGBA8 - albedo and roughness;
+//   color attachment 1, RG16 - octahedral encoded world space normal;
+//   depth, 32 bit float - position is reconstructed from it.
+// Shaders write and read it through helpers of Shaders/gbuffer.glsl.
+class GBuffer
+{
+public:
+	static constexpr std::size_t bytesPerPixel = 4 + 4 + 4;
+
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl, int width, int height);
+	void destroy();
+
+	// Recreates textures when size changed.
+	void resize(int width, int height);
+
+	int width() const { return width_; }
+	int height() const { return height_; }
+
+	// Binds framebuffer for geometry pass and sets viewport to its size.
+	void bind();
+	// Binds scene framebuffer back, see sceneFramebuffer().
+	void release();
+
+	// Binds albedo and roughness, normal and depth textures to units firstUnit, firstUnit + 1
+	// and firstUnit + 2 for lighting pass.
+	void bindTextures(GLuint firstUnit);
+
+	// Bytes written by geometry pass without overdraw and read by lighting pass.
+	std::size_t frameBytes() const { return static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_) * bytesPerPixel * 2; }
+
+private:
+	void createTextures();
+	void destroyTextures();
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	int width_ = 0;
+	int height_ = 0;
+
+	GLuint framebuffer_ = 0;
+	GLuint albedoTexture_ = 0;
+	GLuint normalTexture_ = 0;
+	GLuint depthTexture_ = 0;
+};
+
+}// namespace fgl
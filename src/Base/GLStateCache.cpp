@@ -0,0 +1,124 @@
+#include "GLStateCache.hpp"
+
+namespace fgl
+{
+
+void GLStateCache::create(QOpenGLFunctions_3_3_Core & gl)
+{
+	gl_ = &gl;
+	invalidate();
+}
+
+void GLStateCache::invalidate()
+{
+	program_ = unknownObject;
+	vertexArray_ = unknownObject;
+	textures_.fill(unknownObject);
+	activeUnit_ = textureUnits;
+	renderStateKnown_ = false;
+}
+
+bool GLStateCache::update(GLuint & cached, const GLuint value, std::size_t & counter)
+{
+	if (cached == value)
+	{
+		++stats_.redundant;
+		return false;
+	}
+	cached = value;
+	++counter;
+	return true;
+}
+
+void GLStateCache::useProgram(const GLuint program)
+{
+	if (update(program_, program, stats_.programs))
+	{
+		gl_->glUseProgram(program);
+	}
+}
+
+void GLStateCache::bindVertexArray(const GLuint vertexArray)
+{
+	if (update(vertexArray_, vertexArray, stats_.vertexArrays))
+	{
+		gl_->glBindVertexArray(vertexArray);
+	}
+}
+
+void GLStateCache::bindTexture(const std::size_t unit, const GLuint texture)
+{
+	if (!update(textures_[unit], texture, stats_.textures))
+	{
+		return;
+	}
+	// Active unit is a selector only, its changes are not counted
+	if (activeUnit_ != unit)
+	{
+		gl_->glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + unit));
+		activeUnit_ = unit;
+	}
+	gl_->glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+template<typename T>
+bool GLStateCache::update(T & cached, const T & value, const bool known, std::size_t & counter)
+{
+	if (known && cached == value)
+	{
+		++stats_.redundant;
+		return false;
+	}
+	cached = value;
+	++counter;
+	return true;
+}
+
+void GLStateCache::setRenderState(const RenderState & state)
+{
+	const auto known = renderStateKnown_;
+	renderStateKnown_ = true;
+	const auto setEnabled = [&](const GLenum capability, const bool enabled) {
+		if (enabled)
+		{
+			gl_->glEnable(capability);
+		}
+		else
+		{
+			gl_->glDisable(capability);
+		}
+	};
+
+	if (update(renderState_.blend, state.blend, known, stats_.blend))
+	{
+		setEnabled(GL_BLEND, state.blend.enabled);
+		gl_->glBlendFunc(state.blend.source, state.blend.destination);
+	}
+	if (update(renderState_.depth, state.depth, known, stats_.depth))
+	{
+		setEnabled(GL_DEPTH_TEST, state.depth.test);
+		gl_->glDepthMask(state.depth.write ? GL_TRUE : GL_FALSE);
+		gl_->glDepthFunc(state.depth.func);
+	}
+	if (update(renderState_.cull, state.cull, known, stats_.cull))
+	{
+		setEnabled(GL_CULL_FACE, state.cull.enabled);
+		gl_->glCullFace(state.cull.face);
+	}
+	if (update(renderState_.stencil, state.stencil, known, stats_.stencil))
+	{
+		const auto & stencil = state.stencil;
+		setEnabled(GL_STENCIL_TEST, stencil.test);
+		gl_->glStencilFunc(stencil.func, stencil.reference, stencil.readMask);
+		gl_->glStencilOp(stencil.stencilFail, stencil.depthFail, stencil.pass);
+		gl_->glStencilMask(stencil.writeMask);
+	}
+}
+
+void GLStateCache::applyPipeline(const PipelineState & pipeline)
+{
+	useProgram(pipeline.program());
+	setRenderState(pipeline.renderState());
+}
+
+}// namespace fgl
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Base/PipelineState.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fgl
+{
+
+struct GLStateStats
+{
+	std::size_t programs = 0;
+	std::size_t vertexArrays = 0;
+	std::size_t textures = 0;
+	std::size_t blend = 0;
+	std::size_t depth = 0;
+	std::size_t cull = 0;
+	std::size_t stencil = 0;
+	// Calls skipped because state was already set.
+	std::size_t redundant = 0;
+
+	std::size_t changes() const { return programs + vertexArrays + textures + blend + depth + cull + stencil; }
+};
+
+// Shadows OpenGL binding and render state to skip redundant calls and count changes
+// actually sent to driver. Code changing state behind the cache must invalidate it.
+class GLStateCache
+{
+public:
+	static constexpr std::size_t textureUnits = 16;
+
+public:
+	void create(QOpenGLFunctions_3_3_Core & gl);
+
+	// Forgets cached state, next calls are sent to driver.
+	void invalidate();
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vertexArray);
+	// Binds GL_TEXTURE_2D texture to unit.
+	void bindTexture(std::size_t unit, GLuint texture);
+	// Sends only state groups differing from current ones.
+	void setRenderState(const RenderState & state);
+	void applyPipeline(const PipelineState & pipeline);
+
+	const GLStateStats & stats() const { return stats_; }
+	void resetStats() { stats_ = {}; }
+
+private:
+	static constexpr GLuint unknownObject = ~GLuint{0};
+
+	// Returns true when value changed.
+	bool update(GLuint & cached, GLuint value, std::size_t & counter);
+	template<typename T>
+	bool update(T & cached, const T & value, bool known, std::size_t & counter);
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	GLuint program_ = unknownObject;
+	GLuint vertexArray_ = unknownObject;
+	std::array<GLuint, textureUnits> textures_{};
+	std::size_t activeUnit_ = textureUnits;
+	RenderState renderState_;
+	bool renderStateKnown_ = false;
+
+	GLStateStats stats_;
+};
+
+}// namespace fgl
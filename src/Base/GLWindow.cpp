@@ -1,5 +1,7 @@
 #include "GLWindow.hpp"
 
+#include <QCoreApplication>
+#include <QDebug>
 #include <QPainter>
 
 namespace fgl
@@ -45,6 +47,89 @@ void GLWindow::renderLater()
 
 void GLWindow::setAnimated(const bool animating) { animating_ = animating; }
 
+void GLWindow::setStatsInterval(const std::size_t frames) { statsInterval_ = frames; }
+
+void GLWindow::setBenchmark(const std::size_t framesPerConfiguration) { benchmarkFrames_ = framesPerConfiguration; }
+
+void GLWindow::setAntialiasing(std::vector<AntialiasingMode> modes, const int samples)
+{
+	Q_ASSERT(!modes.empty());
+	antialiasingModes_ = std::move(modes);
+	antialiasingIndex_ = 0;
+	samples_ = samples;
+}
+
+bool GLWindow::setBenchmarkConfiguration(const std::size_t index) { return index == 0; }
+
+QString GLWindow::benchmarkConfigurationName() const { return "default"; }
+
+void GLWindow::reportStats()
+{
+	if (benchmarkFrames_ != 0)
+	{
+		if (stats_.frameCount() < benchmarkFrames_)
+		{
+			return;
+		}
+		qInfo().noquote() << "[benchmark]" << benchmarkConfigurationName() << "| aa" << antialiasingName() << "|" << stats_.summary();
+		stats_.reset();
+		if (setBenchmarkConfiguration(++benchmarkConfiguration_))
+		{
+			return;
+		}
+		// Scene configurations are run again with the next anti-aliasing mode
+		if (gl33_ && ++antialiasingIndex_ < antialiasingModes_.size())
+		{
+			antialiasing_.setMode(antialiasingModes_[antialiasingIndex_], samples_);
+			benchmarkConfiguration_ = 0;
+			setBenchmarkConfiguration(benchmarkConfiguration_);
+			return;
+		}
+		QCoreApplication::quit();
+		return;
+	}
+
+	if (statsInterval_ != 0 && stats_.frameCount() >= statsInterval_)
+	{
+		qInfo().noquote() << stats_.summary();
+		stats_.reset();
+	}
+}
+
+QString GLWindow::antialiasingName() const
+{
+	if (antialiasing_.mode() == AntialiasingMode::Msaa)
+	{
+		return QString{"msaa %1x"}.arg(antialiasing_.samples());
+	}
+	return antialiasingModeName(antialiasing_.mode());
+}
+
+void GLWindow::beginAntialiasing()
+{
+	if (!gl33_)
+	{
+		return;
+	}
+	antialiasingTimer_.beginFrame();
+	stats_.setCounter(antialiasingGpuMsCounter_, antialiasingTimer_.ms(0));
+
+	const auto pixelRatio = devicePixelRatio();
+	antialiasing_.begin(static_cast<int>(width() * pixelRatio), static_cast<int>(height() * pixelRatio));
+	stats_.setCounter(antialiasingMbCounter_, static_cast<double>(antialiasing_.bytes()) / 1e6);
+}
+
+void GLWindow::endAntialiasing()
+{
+	if (!gl33_)
+	{
+		return;
+	}
+	antialiasingTimer_.begin(0);
+	antialiasing_.end();
+	antialiasingTimer_.end();
+}
+
 void GLWindow::renderNow()
 {
 	// If not exposed yet then skip render.
@@ -74,14 +159,40 @@ void GLWindow::renderNow()
 	if (needsInitialize)
 	{
 		initializeOpenGLFunctions();
+		gl33_ = context_->versionFunctions<QOpenGLFunctions_3_3_Core>();
+		if (gl33_)
+		{
+			gl33_->initializeOpenGLFunctions();
+		}
 		init();
+
+		// Without OpenGL 3.3 scene renders straight into default framebuffer
+		if (gl33_)
+		{
+			antialiasing_.create(*gl33_);
+			antialiasing_.setMode(antialiasingModes_[antialiasingIndex_], samples_);
+			antialiasingTimer_.create(*gl33_, 1);
+			antialiasingMbCounter_ = stats_.addCounter("aa target MB");
+			antialiasingGpuMsCounter_ = stats_.addCounter("aa resolve gpu ms");
+		}
+
+		if (benchmarkFrames_ != 0)
+		{
+			setBenchmarkConfiguration(benchmarkConfiguration_);
+		}
 	}
 
 	// Render now then swap buffers.
+	stats_.beginFrame();
+	beginAntialiasing();
 	render();
+	endAntialiasing();
+	stats_.endFrame();
 
 	context_->swapBuffers(this);
 
+	reportStats();
+
 	// Post message to redraw later if animating.
 	if (animating_)
 	{
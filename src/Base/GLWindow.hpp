@@ -1,11 +1,17 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <QWindow>
 
+#include <Base/Antialiasing.hpp>
+#include <Base/FrameStats.hpp>
+#include <Base/GpuTimer.hpp>
+
 #include <QOpenGLContext>
 #include <QOpenGLFunctions>
+#include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLPaintDevice>
 
 class QEvent;
@@ -30,6 +36,17 @@ public:
 public:
 	void setAnimated(bool animating = false);
 
+	// Logs frame stats summary every given number of frames, zero disables logging.
+	void setStatsInterval(std::size_t frames);
+
+	// Renders given number of frames for each benchmark configuration, logs
+	// stats summary for each of them and quits application after the last one.
+	void setBenchmark(std::size_t framesPerConfiguration);
+
+	// Window renders with the first mode, benchmark runs all scene configurations with each
+	// of them. Sample count is used by Msaa mode.
+	void setAntialiasing(std::vector<AntialiasingMode> modes, int samples);
+
 public slots:
 	void renderNow();
 	void renderLater();
@@ -38,9 +55,44 @@ protected:
 	bool event(QEvent * event) override;
 	void exposeEvent(QExposeEvent * event) override;
 
+	FrameStats & stats() { return stats_; }
+
+	// Full OpenGL 3.3 core API, available after context creation.
+	QOpenGLFunctions_3_3_Core & gl33()
+	{
+		Q_ASSERT(gl33_);
+		return *gl33_;
+	}
+
+	// Switches scene to benchmark configuration with given index, returns false when there is none.
+	virtual bool setBenchmarkConfiguration(std::size_t index);
+	virtual QString benchmarkConfigurationName() const;
+
+private:
+	void reportStats();
+
+	QString antialiasingName() const;
+	void beginAntialiasing();
+	void endAntialiasing();
+
 private:
 	bool animating_ = false;
+
+	FrameStats stats_;
+	std::size_t statsInterval_ = 0;
+	std::size_t benchmarkFrames_ = 0;
+	std::size_t benchmarkConfiguration_ = 0;
+
+	Antialiasing antialiasing_;
+	std::vector<AntialiasingMode> antialiasingModes_{AntialiasingMode::None};
+	std::size_t antialiasingIndex_ = 0;
+	int samples_ = 0;
+	GpuTimer antialiasingTimer_;
+	FrameStats::CounterId antialiasingMbCounter_ = 0;
+	FrameStats::CounterId antialiasingGpuMsCounter_ = 0;
+
 	std::unique_ptr<QOpenGLContext> context_ = nullptr;
+	QOpenGLFunctions_3_3_Core * gl33_ = nullptr;
 	std::unique_ptr<QOpenGLPaintDevice> device_ = nullptr;
 };
 
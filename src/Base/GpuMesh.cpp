@@ -0,0 +1,77 @@
+#include "GpuMesh.hpp"
+
+#include <QOpenGLContext>
+
+#include <vector>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_floatsPerVertex = 9;
+
+}// namespace
+
+void GpuMesh::create(const Mesh & mesh)
+{
+	std::vector<GLfloat> vertices;
+	vertices.reserve(mesh.vertexCount() * g_floatsPerVertex);
+	for (std::size_t i = 0; i < mesh.vertexCount(); ++i)
+	{
+		const auto & position = mesh.positions[i];
+		const auto normal = i < mesh.normals.size() ? mesh.normals[i] : glm::vec3{0.f, 0.f, 1.f};
+		const auto color = i < mesh.colors.size() ? mesh.colors[i] : glm::vec3{1.f};
+		vertices.insert(vertices.end(), {position.x, position.y, position.z, normal.x, normal.y, normal.z, color.r, color.g, color.b});
+	}
+	indexCount_ = static_cast<GLsizei>(mesh.indices.size());
+
+	vao_.create();
+	vao_.bind();
+
+	vbo_.create();
+	vbo_.bind();
+	vbo_.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	vbo_.allocate(vertices.data(), static_cast<int>(vertices.size() * sizeof(GLfloat)));
+
+	ibo_.create();
+	ibo_.bind();
+	ibo_.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	ibo_.allocate(mesh.indices.data(), static_cast<int>(mesh.indices.size() * sizeof(std::uint32_t)));
+
+	auto & gl = *QOpenGLContext::currentContext()->functions();
+	constexpr auto stride = static_cast<GLsizei>(g_floatsPerVertex * sizeof(GLfloat));
+	const auto offset = [](const std::size_t floats) { return reinterpret_cast<const void *>(floats * sizeof(GLfloat)); };
+	gl.glEnableVertexAttribArray(positionLocation);
+	gl.glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, stride, offset(0));
+	gl.glEnableVertexAttribArray(normalLocation);
+	gl.glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, stride, offset(3));
+	gl.glEnableVertexAttribArray(colorLocation);
+	gl.glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, stride, offset(6));
+
+	// Index buffer binding is part of VAO state so it is released after VAO.
+	vao_.release();
+	ibo_.release();
+	vbo_.release();
+}
+
+void GpuMesh::destroy()
+{
+	vao_.destroy();
+	ibo_.destroy();
+	vbo_.destroy();
+	indexCount_ = 0;
+}
+
+void GpuMesh::draw(QOpenGLFunctions & gl) const
+{
+	gl.glDrawElements(GL_TRIANGLES, indexCount_, GL_UNSIGNED_INT, nullptr);
+}
+
+void GpuMesh::drawInstanced(QOpenGLFunctions_3_3_Core & gl, const GLsizei instances) const
+{
+	gl.glDrawElementsInstanced(GL_TRIANGLES, indexCount_, GL_UNSIGNED_INT, nullptr, instances);
+}
+
+}// namespace fgl
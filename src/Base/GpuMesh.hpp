@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Base/Mesh.hpp>
+
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLVertexArrayObject>
+
+namespace fgl
+{
+
+// Mesh uploaded to GPU. Vertices are interleaved as position, normal, color and bound
+// to attribute locations 0, 1 and 2. Requires current OpenGL context for all calls.
+class GpuMesh
+{
+public:
+	static constexpr GLuint positionLocation = 0;
+	static constexpr GLuint normalLocation = 1;
+	static constexpr GLuint colorLocation = 2;
+
+public:
+	void create(const Mesh & mesh);
+	void destroy();
+
+	void bind() { vao_.bind(); }
+	void release() { vao_.release(); }
+	// For binding through state cache instead of bind().
+	GLuint vertexArray() const { return vao_.objectId(); }
+
+	// Mesh must be bound.
+	void draw(QOpenGLFunctions & gl) const;
+	// Mesh must be bound.
+	void drawInstanced(QOpenGLFunctions_3_3_Core & gl, GLsizei instances) const;
+
+	GLsizei indexCount() const { return indexCount_; }
+
+private:
+	QOpenGLBuffer vbo_{QOpenGLBuffer::Type::VertexBuffer};
+	QOpenGLBuffer ibo_{QOpenGLBuffer::Type::IndexBuffer};
+	QOpenGLVertexArrayObject vao_;
+
+	GLsizei indexCount_ = 0;
+};
+
+}// namespace fgl
@@ -0,0 +1,68 @@
+#include "GpuTimer.hpp"
+
+namespace fgl
+{
+
+void GpuTimer::create(QOpenGLFunctions_3_3_Core & gl, const std::size_t sectionCount)
+{
+	gl_ = &gl;
+	sectionCount_ = sectionCount;
+	queries_.resize(sectionCount * latency);
+	ms_.assign(sectionCount, 0.);
+	for (auto & query: queries_)
+	{
+		gl_->glGenQueries(1, &query.id);
+	}
+}
+
+void GpuTimer::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	for (const auto & query: queries_)
+	{
+		gl_->glDeleteQueries(1, &query.id);
+	}
+	queries_.clear();
+	ms_.clear();
+	sectionCount_ = 0;
+}
+
+void GpuTimer::beginFrame()
+{
+	++frame_;
+	auto * queries = &queries_[(frame_ % latency) * sectionCount_];
+	for (std::size_t section = 0; section < sectionCount_; ++section)
+	{
+		auto & query = queries[section];
+		if (!query.issued)
+		{
+			ms_[section] = 0.;
+			continue;
+		}
+		// Query was issued latency frames ago, so waiting here is rare
+		GLuint64 nanoseconds = 0;
+		gl_->glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &nanoseconds);
+		ms_[section] = static_cast<double>(nanoseconds) / 1e6;
+		query.issued = false;
+	}
+}
+
+void GpuTimer::begin(const std::size_t section)
+{
+	Q_ASSERT(!active_);
+	auto & query = queries_[(frame_ % latency) * sectionCount_ + section];
+	gl_->glBeginQuery(GL_TIME_ELAPSED, query.id);
+	query.issued = true;
+	active_ = true;
+}
+
+void GpuTimer::end()
+{
+	gl_->glEndQuery(GL_TIME_ELAPSED);
+	active_ = false;
+}
+
+}// namespace fgl
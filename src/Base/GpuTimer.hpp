@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <cstddef>
+#include <vector>
+
+namespace fgl
+{
+
+// GPU time of frame sections measured with GL_TIME_ELAPSED queries. Results are read a few
+// frames after they were issued, so reading them does not stall the pipeline. Sections
+// must not overlap.
+class GpuTimer
+{
+public:
+	// Frames in flight, queries of a frame are reused this many frames later.
+	static constexpr std::size_t latency = 3;
+
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl, std::size_t sectionCount);
+	void destroy();
+
+	// Collects results of the frame whose queries are about to be reused.
+	void beginFrame();
+
+	void begin(std::size_t section);
+	void end();
+
+	// Milliseconds of section in the latest frame with results, zero when section was not
+	// measured in that frame.
+	double ms(std::size_t section) const { return ms_[section]; }
+
+private:
+	struct Query
+	{
+		GLuint id = 0;
+		bool issued = false;
+	};
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	// Section queries of frame i are at (i % latency) * sectionCount.
+	std::vector<Query> queries_;
+	std::vector<double> ms_;
+	std::size_t sectionCount_ = 0;
+	std::size_t frame_ = 0;
+	bool active_ = false;
+};
+
+}// namespace fgl
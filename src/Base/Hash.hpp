@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace fgl
+{
+
+// 64-bit FNV-1a, stable across runs and platforms so hashes can key on disk data.
+constexpr std::uint64_t g_hashSeed = 14695981039346656037ull;
+
+inline void hashBytes(std::uint64_t & hash, const void * data, const std::size_t size)
+{
+	const auto * bytes = static_cast<const unsigned char *>(data);
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+}
+
+// Hashes terminator too, so adjacent strings stay apart.
+inline void hashString(std::uint64_t & hash, const std::string_view value)
+{
+	hashBytes(hash, value.data(), value.size());
+	hashBytes(hash, "", 1);
+}
+
+template<typename T>
+void hashValue(std::uint64_t & hash, const T & value)
+{
+	hashBytes(hash, &value, sizeof(value));
+}
+
+}// namespace fgl
@@ -0,0 +1,354 @@
+#include "HiZCuller.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Keeps the farthest depth of 2x2 source texels, odd last row and column are folded
+// into the last destination texel.
+constexpr auto g_downsampleFragmentShader = R"(#version 330 core
+out float farthest;
+
+uniform sampler2D source;
+uniform ivec2 sourceSize;
+
+void main()
+{
+	ivec2 first = ivec2(gl_FragCoord.xy) * 2;
+	ivec2 last = min(first + 1 + ivec2(equal(first + 3, sourceSize)), sourceSize - 1);
+	farthest = 0.0;
+	for (int y = first.y; y <= last.y; ++y)
+	{
+		for (int x = first.x; x <= last.x; ++x)
+		{
+			farthest = max(farthest, texelFetch(source, ivec2(x, y), 0).r);
+		}
+	}
+}
+)";
+
+// Projects box and compares its nearest depth with the farthest depth of pyramid texels
+// under it, level is chosen so box covers at most 2x2 texels.
+constexpr auto g_testVertexShader = R"(#version 330 core
+layout(location = 0) in vec3 boxMin;
+layout(location = 1) in vec3 boxMax;
+
+flat out uint visible;
+
+uniform mat4 viewProj;
+uniform sampler2D pyramid;
+uniform ivec2 depthSize;
+uniform int levelCount;
+
+void main()
+{
+	gl_Position = vec4(0.0);
+
+	vec3 ndcMin = vec3(1e30);
+	vec3 ndcMax = vec3(-1e30);
+	for (int i = 0; i < 8; ++i)
+	{
+		vec3 corner = mix(boxMin, boxMax, vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+		vec4 clip = viewProj * vec4(corner, 1.0);
+		if (clip.z < -clip.w)
+		{
+			// Box crosses near plane
+			visible = 1u;
+			return;
+		}
+		vec3 ndc = clip.xyz / clip.w;
+		ndcMin = min(ndcMin, ndc);
+		ndcMax = max(ndcMax, ndc);
+	}
+	if (any(lessThan(ndcMax.xy, vec2(-1.0))) || any(greaterThan(ndcMin.xy, vec2(1.0))))
+	{
+		// Out of screen boxes are left to frustum culling
+		visible = 1u;
+		return;
+	}
+
+	vec2 pixelMin = clamp(ndcMin.xy * 0.5 + 0.5, 0.0, 1.0) * vec2(depthSize);
+	vec2 pixelMax = clamp(ndcMax.xy * 0.5 + 0.5, 0.0, 1.0) * vec2(depthSize);
+	float size = max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y);
+	// Texel of level L covers 2^(L + 1) pixels
+	int level = clamp(int(ceil(log2(max(size, 1.0)))) - 1, 0, levelCount - 1);
+	ivec2 levelSize = textureSize(pyramid, level);
+	float texelPixels = float(1 << (level + 1));
+	ivec2 texelMin = min(ivec2(pixelMin / texelPixels), levelSize - 1);
+	ivec2 texelMax = min(ivec2(pixelMax / texelPixels), levelSize - 1);
+
+	float farthest = 0.0;
+	for (int y = texelMin.y; y <= texelMax.y; ++y)
+	{
+		for (int x = texelMin.x; x <= texelMax.x; ++x)
+		{
+			farthest = max(farthest, texelFetch(pyramid, ivec2(x, y), level).r);
+		}
+	}
+	visible = ndcMin.z * 0.5 + 0.5 <= farthest ? 1u : 0u;
+}
+)";
+
+constexpr auto g_testFragmentShader = R"(#version 330 core
+void main()
+{
+}
+)";
+
+}// namespace
+
+void HiZCuller::create(QOpenGLFunctions_3_3_Core & gl, const std::size_t objectCount)
+{
+	gl_ = &gl;
+
+	downsampleProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	downsampleProgram_->addShaderFromSourceCode(QOpenGLShader::Vertex, FullscreenPass::vertexShader());
+	downsampleProgram_->addShaderFromSourceCode(QOpenGLShader::Fragment, g_downsampleFragmentShader);
+	downsampleProgram_->link();
+
+	// Captured outputs must be set before linking
+	testProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	testProgram_->addShaderFromSourceCode(QOpenGLShader::Vertex, g_testVertexShader);
+	testProgram_->addShaderFromSourceCode(QOpenGLShader::Fragment, g_testFragmentShader);
+	const char * varyings[] = {"visible"};
+	gl_->glTransformFeedbackVaryings(testProgram_->programId(), 1, varyings, GL_INTERLEAVED_ATTRIBS);
+	testProgram_->link();
+
+	fullscreen_.create(gl);
+	gl_->glGenFramebuffers(1, &framebuffer_);
+
+	gl_->glGenVertexArrays(1, &boxVao_);
+	gl_->glGenBuffers(1, &boxBuffer_);
+	gl_->glBindVertexArray(boxVao_);
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, boxBuffer_);
+	constexpr auto stride = static_cast<GLsizei>(2 * sizeof(glm::vec3));
+	gl_->glEnableVertexAttribArray(0);
+	gl_->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+	gl_->glEnableVertexAttribArray(1);
+	gl_->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void *>(sizeof(glm::vec3)));
+	gl_->glBindVertexArray(0);
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	for (auto & readback: readbacks_)
+	{
+		gl_->glGenBuffers(1, &readback.buffer);
+	}
+
+	hiddenGeneration_.assign(objectCount, 0u);
+	reset();
+}
+
+void HiZCuller::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	reset();
+	for (auto & readback: readbacks_)
+	{
+		gl_->glDeleteBuffers(1, &readback.buffer);
+		readback.buffer = 0;
+	}
+	gl_->glDeleteBuffers(1, &boxBuffer_);
+	gl_->glDeleteVertexArrays(1, &boxVao_);
+	gl_->glDeleteTextures(1, &pyramid_);
+	gl_->glDeleteFramebuffers(1, &framebuffer_);
+	boxBuffer_ = 0;
+	boxVao_ = 0;
+	pyramid_ = 0;
+	framebuffer_ = 0;
+	levelSizes_.clear();
+	depthSize_ = glm::ivec2{0};
+
+	fullscreen_.destroy();
+	downsampleProgram_.reset();
+	testProgram_.reset();
+}
+
+void HiZCuller::reset()
+{
+	for (auto & readback: readbacks_)
+	{
+		if (readback.fence != nullptr)
+		{
+			gl_->glDeleteSync(readback.fence);
+			readback.fence = nullptr;
+		}
+	}
+	// No object has the new generation so all are visible
+	++generation_;
+	stats_ = {};
+}
+
+void HiZCuller::beginFrame()
+{
+	++frame_;
+
+	// Oldest readback comes first, later ones are not ready when it is not
+	for (std::size_t i = 0; i < ringSize; ++i)
+	{
+		auto & readback = readbacks_[(nextReadback_ + i) % ringSize];
+		if (readback.fence == nullptr)
+		{
+			continue;
+		}
+		const auto status = gl_->glClientWaitSync(readback.fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+		gl_->glDeleteSync(readback.fence);
+		readback.fence = nullptr;
+
+		flags_.resize(readback.objects.size());
+		gl_->glBindBuffer(GL_COPY_READ_BUFFER, readback.buffer);
+		gl_->glGetBufferSubData(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(flags_.size() * sizeof(std::uint32_t)), flags_.data());
+		gl_->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+		++generation_;
+		stats_ = {readback.objects.size(), 0u, static_cast<std::size_t>(frame_ - readback.frame)};
+		for (std::size_t j = 0; j < flags_.size(); ++j)
+		{
+			if (flags_[j] == 0u)
+			{
+				hiddenGeneration_[readback.objects[j]] = generation_;
+				++stats_.culled;
+			}
+		}
+	}
+}
+
+void HiZCuller::resizePyramid(const int width, const int height)
+{
+	if (depthSize_ == glm::ivec2{width, height})
+	{
+		return;
+	}
+	depthSize_ = {width, height};
+
+	levelSizes_.clear();
+	auto size = depthSize_;
+	do
+	{
+		size = glm::max(size / 2, 1);
+		levelSizes_.push_back(size);
+	} while (size.x > 1 || size.y > 1);
+
+	gl_->glDeleteTextures(1, &pyramid_);
+	gl_->glGenTextures(1, &pyramid_);
+	gl_->glBindTexture(GL_TEXTURE_2D, pyramid_);
+	for (std::size_t level = 0; level < levelSizes_.size(); ++level)
+	{
+		gl_->glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_R32F, levelSizes_[level].x, levelSizes_[level].y, 0,
+						  GL_RED, GL_FLOAT, nullptr);
+	}
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levelSizes_.size()) - 1);
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void HiZCuller::buildPyramid(const GLuint depthTexture, const int width, const int height)
+{
+	resizePyramid(width, height);
+
+	const auto depthTest = gl_->glIsEnabled(GL_DEPTH_TEST);
+	gl_->glDisable(GL_DEPTH_TEST);
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+	downsampleProgram_->bind();
+	downsampleProgram_->setUniformValue("source", 0);
+	gl_->glActiveTexture(GL_TEXTURE0);
+
+	const auto sourceSizeUniform = downsampleProgram_->uniformLocation("sourceSize");
+	for (std::size_t level = 0; level < levelSizes_.size(); ++level)
+	{
+		gl_->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pyramid_, static_cast<GLint>(level));
+		gl_->glViewport(0, 0, levelSizes_[level].x, levelSizes_[level].y);
+
+		// Previous level is the only one visible for sampling, so it does not overlap written one
+		if (level == 0)
+		{
+			gl_->glBindTexture(GL_TEXTURE_2D, depthTexture);
+			gl_->glUniform2i(sourceSizeUniform, depthSize_.x, depthSize_.y);
+		}
+		else
+		{
+			const auto source = static_cast<GLint>(level) - 1;
+			gl_->glBindTexture(GL_TEXTURE_2D, pyramid_);
+			gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, source);
+			gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, source);
+			gl_->glUniform2i(sourceSizeUniform, levelSizes_[level - 1].x, levelSizes_[level - 1].y);
+		}
+		fullscreen_.draw();
+	}
+
+	gl_->glBindTexture(GL_TEXTURE_2D, pyramid_);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levelSizes_.size()) - 1);
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+	downsampleProgram_->release();
+
+	if (depthTest)
+	{
+		gl_->glEnable(GL_DEPTH_TEST);
+	}
+}
+
+void HiZCuller::test(const glm::mat4 & viewProj, const std::vector<std::uint32_t> & objects, const std::vector<Aabb> & boxes)
+{
+	auto & readback = readbacks_[nextReadback_];
+	if (objects.empty() || readback.fence != nullptr || pyramid_ == 0)
+	{
+		return;
+	}
+
+	boxData_.clear();
+	for (const auto object: objects)
+	{
+		boxData_.push_back(boxes[object].min);
+		boxData_.push_back(boxes[object].max);
+	}
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, boxBuffer_);
+	gl_->glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(boxData_.size() * sizeof(glm::vec3)), boxData_.data(), GL_STREAM_DRAW);
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	gl_->glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, readback.buffer);
+	gl_->glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, static_cast<GLsizeiptr>(objects.size() * sizeof(std::uint32_t)), nullptr, GL_STREAM_READ);
+	gl_->glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, readback.buffer);
+
+	testProgram_->bind();
+	gl_->glUniformMatrix4fv(testProgram_->uniformLocation("viewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+	gl_->glUniform2i(testProgram_->uniformLocation("depthSize"), depthSize_.x, depthSize_.y);
+	testProgram_->setUniformValue("levelCount", static_cast<int>(levelSizes_.size()));
+	testProgram_->setUniformValue("pyramid", 0);
+	gl_->glActiveTexture(GL_TEXTURE0);
+	gl_->glBindTexture(GL_TEXTURE_2D, pyramid_);
+
+	gl_->glEnable(GL_RASTERIZER_DISCARD);
+	gl_->glBindVertexArray(boxVao_);
+	gl_->glBeginTransformFeedback(GL_POINTS);
+	gl_->glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(objects.size()));
+	gl_->glEndTransformFeedback();
+	gl_->glBindVertexArray(0);
+	gl_->glDisable(GL_RASTERIZER_DISCARD);
+
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+	testProgram_->release();
+	gl_->glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	gl_->glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+
+	readback.fence = gl_->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.frame = frame_;
+	readback.objects = objects;
+	nextReadback_ = (nextReadback_ + 1) % ringSize;
+}
+
+}// namespace fgl
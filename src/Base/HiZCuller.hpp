@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/FullscreenPass.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace fgl
+{
+
+struct HiZStats
+{
+	std::size_t tested = 0;
+	std::size_t culled = 0;
+	// Frames between testing and reading back the result used now.
+	std::size_t latencyFrames = 0;
+};
+
+// Hierarchical Z-buffer occlusion culling. Depth of rendered frame is reduced to
+// a pyramid keeping the farthest depth of each 2x2 block, then object boxes are
+// projected and compared with a couple of pyramid texels in a vertex shader whose
+// visibility flags are captured with transform feedback. Flags are read back when
+// fence says they are ready, so next frames use them without stalling.
+//
+// Frame usage:
+//   beginFrame();                       reads finished results
+//   draw objects passing isVisible();
+//   buildPyramid(depth); test(...);     results for next frames
+class HiZCuller
+{
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl, std::size_t objectCount);
+	void destroy();
+
+	// Marks all objects visible and drops results in flight.
+	void reset();
+
+	void beginFrame();
+
+	// False only for objects found hidden by the latest result.
+	bool isVisible(std::uint32_t object) const { return hiddenGeneration_[object] != generation_; }
+
+	// Builds pyramid from depth texture, changes framebuffer binding and viewport.
+	void buildPyramid(GLuint depthTexture, int width, int height);
+
+	// Tests boxes of given objects against pyramid with matrix used to render the depth.
+	// Test is skipped when all readback buffers are still in flight.
+	void test(const glm::mat4 & viewProj, const std::vector<std::uint32_t> & objects, const std::vector<Aabb> & boxes);
+
+	// Stats of the latest result.
+	const HiZStats & stats() const { return stats_; }
+
+private:
+	static constexpr std::size_t ringSize = 3;
+
+	struct Readback
+	{
+		GLuint buffer = 0;
+		GLsync fence = nullptr;
+		std::uint64_t frame = 0;
+		std::vector<std::uint32_t> objects;
+	};
+
+private:
+	void resizePyramid(int width, int height);
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	std::unique_ptr<QOpenGLShaderProgram> downsampleProgram_ = nullptr;
+	std::unique_ptr<QOpenGLShaderProgram> testProgram_ = nullptr;
+	FullscreenPass fullscreen_;
+
+	GLuint framebuffer_ = 0;
+	GLuint pyramid_ = 0;
+	std::vector<glm::ivec2> levelSizes_;
+	glm::ivec2 depthSize_{0};
+
+	GLuint boxVao_ = 0;
+	GLuint boxBuffer_ = 0;
+	std::vector<glm::vec3> boxData_;
+
+	std::array<Readback, ringSize> readbacks_;
+	std::size_t nextReadback_ = 0;
+	std::vector<std::uint32_t> flags_;
+
+	// Objects hidden by the latest result have their generation equal to current one.
+	std::vector<std::uint32_t> hiddenGeneration_;
+	std::uint32_t generation_ = 1;
+	std::uint64_t frame_ = 0;
+
+	HiZStats stats_;
+};
+
+}// namespace fgl
@@ -0,0 +1,77 @@
+#include "InstanceBuffer.hpp"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::size_t g_initialCapacity = 1024;
+constexpr std::size_t g_texelsPerMatrix = 4;
+
+}// namespace
+
+void InstanceBuffer::create(QOpenGLFunctions_3_3_Core & gl)
+{
+	gl_ = &gl;
+	capacity_ = g_initialCapacity;
+
+	GLint maxTexels = 0;
+	gl_->glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	maxMatrices_ = static_cast<std::size_t>(maxTexels) / g_texelsPerMatrix;
+
+	gl_->glGenBuffers(1, &buffer_);
+	gl_->glBindBuffer(GL_TEXTURE_BUFFER, buffer_);
+	gl_->glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(capacity_ * sizeof(glm::mat4)), nullptr, GL_STREAM_DRAW);
+	gl_->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	// Texture refers to buffer object, reallocated storage needs no new attachment
+	gl_->glGenTextures(1, &texture_);
+	gl_->glBindTexture(GL_TEXTURE_BUFFER, texture_);
+	gl_->glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer_);
+	gl_->glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void InstanceBuffer::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	gl_->glDeleteTextures(1, &texture_);
+	gl_->glDeleteBuffers(1, &buffer_);
+	texture_ = 0;
+	buffer_ = 0;
+	capacity_ = 0;
+	maxMatrices_ = 0;
+}
+
+void InstanceBuffer::upload(const std::vector<glm::mat4> & matrices)
+{
+	if (matrices.empty())
+	{
+		return;
+	}
+	if (matrices.size() > capacity_ && matrices.size() > maxMatrices_)
+	{
+		qWarning() << "instance buffer of" << matrices.size() << "matrices exceeds texture buffer limit of" << maxMatrices_;
+	}
+	capacity_ = std::max(capacity_, matrices.size());
+
+	gl_->glBindBuffer(GL_TEXTURE_BUFFER, buffer_);
+	gl_->glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(capacity_ * sizeof(glm::mat4)), nullptr, GL_STREAM_DRAW);
+	gl_->glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(matrices.size() * sizeof(glm::mat4)), matrices.data());
+	gl_->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void InstanceBuffer::bind(const GLuint unit)
+{
+	gl_->glActiveTexture(GL_TEXTURE0 + unit);
+	gl_->glBindTexture(GL_TEXTURE_BUFFER, texture_);
+}
+
+}// namespace fgl
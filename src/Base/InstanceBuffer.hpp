@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace fgl
+{
+
+// Streaming buffer of per instance model matrices exposed as buffer texture, shaders read
+// matrix i with four texelFetch calls at 4 * i. Storage is orphaned on every upload so
+// writes never wait for draws of previous frames still using old data. Shaders can read
+// only maxMatrices() of them, as texture size is limited by GL_MAX_TEXTURE_BUFFER_SIZE.
+class InstanceBuffer
+{
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl);
+	void destroy();
+
+	// Replaces buffer contents, storage grows to fit. Warns when matrices past maxMatrices()
+	// are uploaded.
+	void upload(const std::vector<glm::mat4> & matrices);
+
+	// Binds buffer texture to texture unit.
+	void bind(GLuint unit);
+
+	std::size_t capacity() const { return capacity_; }
+	std::size_t maxMatrices() const { return maxMatrices_; }
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	GLuint buffer_ = 0;
+	GLuint texture_ = 0;
+	// In matrices.
+	std::size_t capacity_ = 0;
+	std::size_t maxMatrices_ = 0;
+};
+
+}// namespace fgl
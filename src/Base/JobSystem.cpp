@@ -0,0 +1,350 @@
+#include "JobSystem.hpp"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <thread>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::size_t g_dequeCapacity = 4096;
+constexpr std::size_t g_poolSize = 4096;
+// Ranges per thread parallelFor aims for, more of them balance uneven work better.
+constexpr std::size_t g_rangesPerThread = 8;
+// Failed attempts to find a job before worker goes to sleep.
+constexpr std::size_t g_idleSpins = 64;
+
+thread_local const JobSystem * t_system = nullptr;
+thread_local std::size_t t_thread = 0;
+
+// Chase-Lev work stealing deque with fixed capacity, after "Correct and Efficient
+// Work-Stealing for Weak Memory Models" by Le et al.
+class WorkDeque
+{
+public:
+	// Only owner thread pushes and pops. Returns false when deque is full.
+	bool push(Job * job)
+	{
+		const auto bottom = bottom_.load(std::memory_order_relaxed);
+		const auto top = top_.load(std::memory_order_acquire);
+		if (bottom - top >= static_cast<std::int64_t>(g_dequeCapacity))
+		{
+			return false;
+		}
+		buffer_[static_cast<std::size_t>(bottom) % g_dequeCapacity].store(job, std::memory_order_relaxed);
+		bottom_.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	Job * pop()
+	{
+		const auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+		bottom_.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto top = top_.load(std::memory_order_relaxed);
+		if (top > bottom)
+		{
+			bottom_.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		auto * job = buffer_[static_cast<std::size_t>(bottom) % g_dequeCapacity].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// Last job, race with thieves for it
+			if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				job = nullptr;
+			}
+			bottom_.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	// Any thread.
+	Job * steal()
+	{
+		auto top = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const auto bottom = bottom_.load(std::memory_order_acquire);
+		if (top >= bottom)
+		{
+			return nullptr;
+		}
+		auto * job = buffer_[static_cast<std::size_t>(top) % g_dequeCapacity].load(std::memory_order_relaxed);
+		if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+		return job;
+	}
+
+private:
+	alignas(64) std::atomic<std::int64_t> top_{0};
+	alignas(64) std::atomic<std::int64_t> bottom_{0};
+	std::array<std::atomic<Job *>, g_dequeCapacity> buffer_{};
+};
+
+}// namespace
+
+struct JobSystem::Worker
+{
+	WorkDeque deque;
+	std::unique_ptr<Job[]> pool = std::make_unique<Job[]>(g_poolSize);
+	std::size_t nextJob = 0;
+	// State of xorshift choosing victims to steal from.
+	std::uint32_t random = 0;
+	std::thread thread;
+};
+
+JobSystem::JobSystem(const std::size_t threadCount)
+{
+	workers_.resize(std::max<std::size_t>(threadCount, 1));
+	for (std::size_t i = 0; i < workers_.size(); ++i)
+	{
+		workers_[i] = std::make_unique<Worker>();
+		workers_[i]->random = static_cast<std::uint32_t>(i * 2654435761u + 1);
+	}
+	// The first worker is the creating thread
+	for (std::size_t i = 1; i < workers_.size(); ++i)
+	{
+		workers_[i]->thread = std::thread{[this, i] { workerLoop(i); }};
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		const std::lock_guard<std::mutex> lock{sleepMutex_};
+		stop_ = true;
+	}
+	wakeUp_.notify_all();
+	for (std::size_t i = 1; i < workers_.size(); ++i)
+	{
+		workers_[i]->thread.join();
+	}
+}
+
+JobSystem & JobSystem::instance()
+{
+	static JobSystem system{workerCount()};
+	return system;
+}
+
+std::size_t JobSystem::threadIndex() const
+{
+	return t_system == this ? t_thread : 0;
+}
+
+Job * JobSystem::allocate(Job * parent)
+{
+	const auto thread = threadIndex();
+	auto & worker = *workers_[thread];
+	Job * job = nullptr;
+	while (job == nullptr)
+	{
+		// Pool is big enough for jobs of a couple of frames, slots of jobs still in flight
+		// are skipped
+		for (std::size_t i = 0; i < g_poolSize && job == nullptr; ++i)
+		{
+			auto * candidate = &worker.pool[worker.nextJob++ % g_poolSize];
+			if (candidate->unfinished.load(std::memory_order_acquire) == 0)
+			{
+				job = candidate;
+			}
+		}
+		// All slots are in flight, help finishing them as wait() does
+		if (job == nullptr)
+		{
+			if (auto * other = findJob(thread))
+			{
+				execute(other);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	job->function = nullptr;
+	job->parent = parent;
+	job->unfinished.store(1, std::memory_order_relaxed);
+	job->dependencies.store(0, std::memory_order_relaxed);
+	job->continuationCount = 0;
+	if (parent != nullptr)
+	{
+		parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void JobSystem::addContinuation(Job * job, Job * continuation)
+{
+	Q_ASSERT_X(job->continuationCount < static_cast<std::int32_t>(Job::maxContinuations), "JobSystem::addContinuation", "too many continuations");
+	job->continuations[static_cast<std::size_t>(job->continuationCount++)] = continuation;
+	continuation->dependencies.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobSystem::run(Job * job)
+{
+	// Counted before push so thieves never see more jobs taken than pending
+	pendingJobs_.fetch_add(1, std::memory_order_seq_cst);
+	if (!workers_[threadIndex()]->deque.push(job))
+	{
+		pendingJobs_.fetch_sub(1, std::memory_order_relaxed);
+		execute(job);
+		return;
+	}
+	if (sleepingWorkers_.load(std::memory_order_seq_cst) > 0)
+	{
+		const std::lock_guard<std::mutex> lock{sleepMutex_};
+		wakeUp_.notify_one();
+	}
+}
+
+void JobSystem::wait(const Job * job)
+{
+	const auto thread = threadIndex();
+	while (!isFinished(job))
+	{
+		if (auto * other = findJob(thread))
+		{
+			execute(other);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::execute(Job * job)
+{
+	job->function(*job);
+	finish(job);
+}
+
+void JobSystem::finish(Job * job)
+{
+	// Finished job may be recycled by its creator, so fields are read beforehand
+	auto * parent = job->parent;
+	const auto continuationCount = static_cast<std::size_t>(job->continuationCount);
+	const auto continuations = job->continuations;
+	if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+	for (std::size_t i = 0; i < continuationCount; ++i)
+	{
+		if (continuations[i]->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			run(continuations[i]);
+		}
+	}
+	if (parent != nullptr)
+	{
+		finish(parent);
+	}
+}
+
+Job * JobSystem::findJob(const std::size_t thread)
+{
+	auto & worker = *workers_[thread];
+	auto * job = worker.deque.pop();
+	if (job == nullptr && workers_.size() > 1)
+	{
+		// Steal starting from random victim
+		worker.random ^= worker.random << 13;
+		worker.random ^= worker.random >> 17;
+		worker.random ^= worker.random << 5;
+		const auto first = worker.random % workers_.size();
+		for (std::size_t i = 0; i < workers_.size() && job == nullptr; ++i)
+		{
+			const auto victim = (first + i) % workers_.size();
+			if (victim != thread)
+			{
+				job = workers_[victim]->deque.steal();
+			}
+		}
+	}
+	if (job != nullptr)
+	{
+		pendingJobs_.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void JobSystem::workerLoop(const std::size_t thread)
+{
+	t_system = this;
+	t_thread = thread;
+	std::size_t idle = 0;
+	while (!stop_.load(std::memory_order_relaxed))
+	{
+		if (auto * job = findJob(thread))
+		{
+			execute(job);
+			idle = 0;
+			continue;
+		}
+		if (++idle < g_idleSpins)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		// Pushing thread checks sleeping count after publishing job, so either it
+		// notifies or we see the job here
+		std::unique_lock<std::mutex> lock{sleepMutex_};
+		sleepingWorkers_.fetch_add(1, std::memory_order_seq_cst);
+		wakeUp_.wait(lock, [this] { return stop_.load() || pendingJobs_.load(std::memory_order_seq_cst) > 0; });
+		sleepingWorkers_.fetch_sub(1, std::memory_order_relaxed);
+		idle = 0;
+	}
+}
+
+void JobSystem::splitRange(Job & job, std::size_t begin, std::size_t end, const std::size_t minRange, const RangeFunction body)
+{
+	// Right halves go to deque for thieves while this job continues with left ones
+	while (end - begin >= 2 * minRange)
+	{
+		const auto middle = begin + (end - begin) / 2;
+		run(createChild(&job, [this, middle, end, minRange, body](Job & child) {
+			splitRange(child, middle, end, minRange, body);
+		}));
+		end = middle;
+	}
+	body(begin, end);
+}
+
+Job * JobSystem::createParallelFor(const std::size_t count, const std::size_t grain, const RangeFunction body)
+{
+	const auto minRange = std::max({grain, count / (workers_.size() * g_rangesPerThread), std::size_t{1}});
+	return create([this, count, minRange, body](Job & job) {
+		if (count > 0)
+		{
+			splitRange(job, 0, count, minRange, body);
+		}
+	});
+}
+
+void JobSystem::parallelFor(const std::size_t count, const std::size_t grain, const RangeFunction body)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (workers_.size() == 1 || count < 2 * std::max<std::size_t>(grain, 1))
+	{
+		body(0, count);
+		return;
+	}
+	auto * job = createParallelFor(count, grain, body);
+	run(job);
+	wait(job);
+}
+
+}// namespace fgl
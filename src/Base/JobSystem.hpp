@@ -0,0 +1,137 @@
+#pragma once
+
+#include <Base/ParallelFor.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fgl
+{
+
+// Pooled unit of work. Job finishes when its function and all its children finished,
+// then continuations with all dependencies finished are run.
+struct alignas(64) Job
+{
+	static constexpr std::size_t maxContinuations = 6;
+	static constexpr std::size_t dataSize = 64;
+
+	void (*function)(Job & job) = nullptr;
+	Job * parent = nullptr;
+	// Own function and unfinished children.
+	std::atomic<std::int32_t> unfinished{0};
+	// Unfinished jobs this one is continuation of.
+	std::atomic<std::int32_t> dependencies{0};
+	std::int32_t continuationCount = 0;
+	std::array<Job *, maxContinuations> continuations{};
+	// Function object stored in place.
+	alignas(16) std::array<std::byte, dataSize> data{};
+};
+
+// Fixed pool of worker threads with per thread Chase-Lev deques. Owner thread pushes
+// and pops jobs at the bottom of its deque, idle threads steal from the top of others.
+// Jobs come from per thread ring pools, so running jobs does not allocate. When all
+// slots of the pool are in flight, creating thread runs other jobs until one is free.
+//
+// Jobs may be created, run and waited for from jobs and from the thread that created
+// the system, jobs must not use other systems. Task graph is built by adding
+// continuations before running its roots:
+//   auto * animation = jobs.createParallelFor(count, grain, animate);
+//   auto * culling = jobs.createParallelFor(count, grain, cull);
+//   jobs.addContinuation(animation, culling);
+//   jobs.run(animation);
+//   jobs.wait(culling);
+class JobSystem
+{
+public:
+	// Thread count includes the creating thread.
+	explicit JobSystem(std::size_t threadCount);
+	~JobSystem();
+
+	JobSystem(const JobSystem &) = delete;
+	JobSystem & operator=(const JobSystem &) = delete;
+
+	// Shared system with workerCount() threads used by parallelFor.
+	static JobSystem & instance();
+
+	std::size_t threadCount() const { return workers_.size(); }
+
+	// Function is called with job reference when it takes one. It has to be small and
+	// trivially destructible, lambdas capturing references and pointers are.
+	template<typename Function>
+	Job * create(Function function)
+	{
+		return createChild(nullptr, std::move(function));
+	}
+
+	// Parent does not finish until child finishes.
+	template<typename Function>
+	Job * createChild(Job * parent, Function function)
+	{
+		static_assert(sizeof(Function) <= Job::dataSize && alignof(Function) <= 16, "Job function is too big");
+		static_assert(std::is_trivially_destructible_v<Function>, "Job function must be trivially destructible");
+		auto * job = allocate(parent);
+		new (job->data.data()) Function(std::move(function));
+		job->function = [](Job & self) {
+			auto & stored = *std::launder(reinterpret_cast<Function *>(self.data.data()));
+			if constexpr (std::is_invocable_v<Function &, Job &>)
+			{
+				stored(self);
+			}
+			else
+			{
+				stored();
+			}
+		};
+		return job;
+	}
+
+	// Job with children processing ranges of [0, count), see parallelFor. Body must
+	// outlive the job.
+	Job * createParallelFor(std::size_t count, std::size_t grain, RangeFunction body);
+
+	// Continuation is run when job finishes. Has to be added before job is run.
+	void addContinuation(Job * job, Job * continuation);
+
+	void run(Job * job);
+
+	// Executes other jobs until job finishes.
+	void wait(const Job * job);
+
+	bool isFinished(const Job * job) const { return job->unfinished.load(std::memory_order_acquire) == 0; }
+
+	// Ranges are split in halves down to grain adapted to range size and thread count.
+	void parallelFor(std::size_t count, std::size_t grain, RangeFunction body);
+
+private:
+	struct Worker;
+
+private:
+	std::size_t threadIndex() const;
+	Job * allocate(Job * parent);
+	void execute(Job * job);
+	void finish(Job * job);
+	Job * findJob(std::size_t thread);
+	void workerLoop(std::size_t thread);
+	void splitRange(Job & job, std::size_t begin, std::size_t end, std::size_t minRange, RangeFunction body);
+
+private:
+	std::vector<std::unique_ptr<Worker>> workers_;
+
+	// Jobs pushed and not taken yet, sleeping workers wait for it.
+	std::atomic<std::size_t> pendingJobs_{0};
+	std::atomic<std::size_t> sleepingWorkers_{0};
+	std::atomic<bool> stop_{false};
+	std::mutex sleepMutex_;
+	std::condition_variable wakeUp_;
+};
+
+}// namespace fgl
@@ -0,0 +1,324 @@
+#include "Ktx2.hpp"
+
+#include <QDebug>
+#include <QFile>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::array<std::uint8_t, 12> g_identifier = {0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n'};
+// Identifier, 9 header fields and index of data format descriptor, key/value data and
+// supercompression global data.
+constexpr std::size_t g_headerBytes = 80;
+constexpr std::size_t g_levelIndexBytes = 24;
+
+// Khronos data format descriptor values
+constexpr std::uint32_t g_modelRgbsda = 1;
+constexpr std::uint32_t g_modelBc1a = 128;
+constexpr std::uint32_t g_modelBc3 = 130;
+constexpr std::uint32_t g_modelBc5 = 132;
+constexpr std::uint32_t g_modelBc7 = 134;
+constexpr std::uint32_t g_modelEtc2 = 161;
+constexpr std::uint32_t g_primariesBt709 = 1;
+constexpr std::uint32_t g_transferLinear = 1;
+constexpr std::uint32_t g_channelAlpha = 15;
+
+struct Sample
+{
+	std::uint32_t channel = 0;
+	std::uint32_t bitOffset = 0;
+	std::uint32_t bitLength = 0;
+	std::uint32_t upper = 0xffffffffu;
+};
+
+std::uint32_t vkFormat(const TextureFormat format)
+{
+	switch (format)
+	{
+		case TextureFormat::Rgba8:
+			return 37;// VK_FORMAT_R8G8B8A8_UNORM
+		case TextureFormat::Bc1:
+			return 131;// VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		case TextureFormat::Bc3:
+			return 137;// VK_FORMAT_BC3_UNORM_BLOCK
+		case TextureFormat::Bc5:
+			return 141;// VK_FORMAT_BC5_UNORM_BLOCK
+		case TextureFormat::Bc7:
+			return 145;// VK_FORMAT_BC7_UNORM_BLOCK
+		case TextureFormat::Etc2:
+			return 147;// VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+	}
+	return 0;
+}
+
+std::optional<TextureFormat> fromVkFormat(const std::uint32_t value)
+{
+	for (const auto format: {TextureFormat::Rgba8, TextureFormat::Bc1, TextureFormat::Bc3, TextureFormat::Bc5, TextureFormat::Bc7,
+							 TextureFormat::Etc2})
+	{
+		if (vkFormat(format) == value)
+		{
+			return format;
+		}
+	}
+	return std::nullopt;
+}
+
+void appendU32(std::vector<std::uint8_t> & bytes, const std::uint32_t value)
+{
+	for (std::uint32_t i = 0; i < 4u; ++i)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(value >> (8u * i)));
+	}
+}
+
+void appendU64(std::vector<std::uint8_t> & bytes, const std::uint64_t value)
+{
+	appendU32(bytes, static_cast<std::uint32_t>(value));
+	appendU32(bytes, static_cast<std::uint32_t>(value >> 32u));
+}
+
+void writeU64(std::vector<std::uint8_t> & bytes, const std::size_t offset, const std::uint64_t value)
+{
+	for (std::size_t i = 0; i < 8u; ++i)
+	{
+		bytes[offset + i] = static_cast<std::uint8_t>(value >> (8u * i));
+	}
+}
+
+std::uint32_t readU32(const std::uint8_t * bytes)
+{
+	return static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8u | static_cast<std::uint32_t>(bytes[2]) << 16u |
+		   static_cast<std::uint32_t>(bytes[3]) << 24u;
+}
+
+std::uint64_t readU64(const std::uint8_t * bytes)
+{
+	return static_cast<std::uint64_t>(readU32(bytes)) | static_cast<std::uint64_t>(readU32(bytes + 4)) << 32u;
+}
+
+// Basic data format descriptor block with its total size in front.
+std::vector<std::uint8_t> dataFormatDescriptor(const TextureFormat format)
+{
+	std::uint32_t model = g_modelRgbsda;
+	std::vector<Sample> samples;
+	switch (format)
+	{
+		case TextureFormat::Rgba8:
+			samples = {{0, 0, 8, 255}, {1, 8, 8, 255}, {2, 16, 8, 255}, {g_channelAlpha, 24, 8, 255}};
+			break;
+		case TextureFormat::Bc1:
+			model = g_modelBc1a;
+			samples = {{0, 0, 64}};
+			break;
+		case TextureFormat::Bc3:
+			model = g_modelBc3;
+			samples = {{g_channelAlpha, 0, 64}, {0, 64, 64}};
+			break;
+		case TextureFormat::Bc5:
+			model = g_modelBc5;
+			samples = {{0, 0, 64}, {1, 64, 64}};
+			break;
+		case TextureFormat::Bc7:
+			model = g_modelBc7;
+			samples = {{0, 0, 128}};
+			break;
+		case TextureFormat::Etc2:
+			model = g_modelEtc2;
+			// ETC2 color channel
+			samples = {{2, 0, 64}};
+			break;
+	}
+
+	const auto blockSize = static_cast<std::uint32_t>(24u + 16u * samples.size());
+	const std::uint32_t blockDimension = format == TextureFormat::Rgba8 ? 0u : 3u;
+	std::vector<std::uint8_t> bytes;
+	appendU32(bytes, 4u + blockSize);
+	// Khronos vendor, basic descriptor type
+	appendU32(bytes, 0u);
+	// Version 1.3
+	appendU32(bytes, 2u | blockSize << 16u);
+	appendU32(bytes, model | g_primariesBt709 << 8u | g_transferLinear << 16u);
+	appendU32(bytes, blockDimension | blockDimension << 8u);
+	appendU32(bytes, static_cast<std::uint32_t>(blockBytes(format)));
+	appendU32(bytes, 0u);
+	for (const auto & sample: samples)
+	{
+		appendU32(bytes, sample.bitOffset | (sample.bitLength - 1u) << 16u | sample.channel << 24u);
+		appendU32(bytes, 0u);
+		appendU32(bytes, 0u);
+		appendU32(bytes, sample.upper);
+	}
+	return bytes;
+}
+
+struct Header
+{
+	Ktx2Info info;
+	// Offset and length of each level
+	std::vector<std::pair<std::uint64_t, std::uint64_t>> levels;
+};
+
+std::optional<Header> readHeader(QFile & file, const QString & path)
+{
+	std::array<std::uint8_t, g_headerBytes> bytes;
+	if (file.read(reinterpret_cast<char *>(bytes.data()), static_cast<qint64>(bytes.size())) != static_cast<qint64>(bytes.size()) ||
+		!std::equal(g_identifier.begin(), g_identifier.end(), bytes.begin()))
+	{
+		qWarning() << path << "is not a KTX 2.0 file";
+		return std::nullopt;
+	}
+
+	const auto * fields = bytes.data() + g_identifier.size();
+	const auto format = fromVkFormat(readU32(fields));
+	Header header;
+	header.info.width = static_cast<int>(readU32(fields + 8));
+	header.info.height = static_cast<int>(readU32(fields + 12));
+	header.info.levelCount = static_cast<int>(readU32(fields + 28));
+	const auto depth = readU32(fields + 16);
+	const auto layers = readU32(fields + 20);
+	const auto faces = readU32(fields + 24);
+	const auto supercompression = readU32(fields + 32);
+	if (!format || depth != 0u || layers != 0u || faces != 1u || supercompression != 0u || header.info.width <= 0 || header.info.height <= 0 ||
+		header.info.levelCount <= 0 || header.info.levelCount > fullLevelCount(header.info.width, header.info.height))
+	{
+		qWarning() << path << "is not a supported KTX 2.0 texture";
+		return std::nullopt;
+	}
+	header.info.format = *format;
+
+	std::vector<std::uint8_t> index(static_cast<std::size_t>(header.info.levelCount) * g_levelIndexBytes);
+	if (file.read(reinterpret_cast<char *>(index.data()), static_cast<qint64>(index.size())) != static_cast<qint64>(index.size()))
+	{
+		qWarning() << "failed to read level index of" << path;
+		return std::nullopt;
+	}
+	const auto fileSize = static_cast<std::uint64_t>(file.size());
+	for (int level = 0; level < header.info.levelCount; ++level)
+	{
+		const auto * entry = index.data() + static_cast<std::size_t>(level) * g_levelIndexBytes;
+		const auto offset = readU64(entry);
+		const auto length = readU64(entry + 8);
+		const auto expected = levelBytes(*format, levelSize(header.info.width, level), levelSize(header.info.height, level));
+		if (length != expected || offset > fileSize || length > fileSize - offset)
+		{
+			qWarning() << "invalid level" << level << "of" << path;
+			return std::nullopt;
+		}
+		header.levels.emplace_back(offset, length);
+	}
+	return header;
+}
+
+}// namespace
+
+bool saveKtx2(const QString & path, const TextureData & texture)
+{
+	const auto levelCount = texture.levels.size();
+	const auto descriptor = dataFormatDescriptor(texture.format);
+	const auto descriptorOffset = g_headerBytes + levelCount * g_levelIndexBytes;
+
+	std::vector<std::uint8_t> bytes(g_identifier.begin(), g_identifier.end());
+	appendU32(bytes, vkFormat(texture.format));
+	// Type size is 1 for block compressed and 8 bit formats
+	appendU32(bytes, 1u);
+	appendU32(bytes, static_cast<std::uint32_t>(texture.width));
+	appendU32(bytes, static_cast<std::uint32_t>(texture.height));
+	// 2D texture without array layers
+	appendU32(bytes, 0u);
+	appendU32(bytes, 0u);
+	appendU32(bytes, 1u);
+	appendU32(bytes, static_cast<std::uint32_t>(levelCount));
+	// No supercompression
+	appendU32(bytes, 0u);
+	appendU32(bytes, static_cast<std::uint32_t>(descriptorOffset));
+	appendU32(bytes, static_cast<std::uint32_t>(descriptor.size()));
+	// No key/value data and supercompression global data
+	appendU32(bytes, 0u);
+	appendU32(bytes, 0u);
+	appendU64(bytes, 0u);
+	appendU64(bytes, 0u);
+	bytes.resize(descriptorOffset);
+	bytes.insert(bytes.end(), descriptor.begin(), descriptor.end());
+
+	// Levels from the smallest one, each aligned to block size and 4 bytes
+	const auto alignment = std::max<std::size_t>(blockBytes(texture.format), 4u);
+	for (auto level = levelCount; level-- > 0;)
+	{
+		bytes.resize((bytes.size() + alignment - 1u) / alignment * alignment);
+		const auto & data = texture.levels[level];
+		const auto entry = g_headerBytes + level * g_levelIndexBytes;
+		writeU64(bytes, entry, bytes.size());
+		writeU64(bytes, entry + 8u, data.size());
+		writeU64(bytes, entry + 16u, data.size());
+		bytes.insert(bytes.end(), data.begin(), data.end());
+	}
+
+	QFile file{path};
+	if (!file.open(QFile::WriteOnly) ||
+		file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<qint64>(bytes.size())) != static_cast<qint64>(bytes.size()))
+	{
+		qWarning() << "Failed to write" << path << file.errorString();
+		return false;
+	}
+	return true;
+}
+
+std::optional<Ktx2Info> readKtx2Info(const QString & path)
+{
+	QFile file{path};
+	if (!file.open(QFile::ReadOnly))
+	{
+		qWarning() << "Failed to open" << path << file.errorString();
+		return std::nullopt;
+	}
+	const auto header = readHeader(file, path);
+	if (!header)
+	{
+		return std::nullopt;
+	}
+	return header->info;
+}
+
+std::optional<TextureData> loadKtx2(const QString & path, const int firstLevel)
+{
+	QFile file{path};
+	if (!file.open(QFile::ReadOnly))
+	{
+		qWarning() << "Failed to open" << path << file.errorString();
+		return std::nullopt;
+	}
+	const auto header = readHeader(file, path);
+	if (!header)
+	{
+		return std::nullopt;
+	}
+
+	TextureData texture;
+	texture.format = header->info.format;
+	texture.width = header->info.width;
+	texture.height = header->info.height;
+	texture.levels.resize(header->levels.size());
+	for (auto level = static_cast<std::size_t>(std::max(firstLevel, 0)); level < header->levels.size(); ++level)
+	{
+		const auto [offset, length] = header->levels[level];
+		auto & data = texture.levels[level];
+		data.resize(static_cast<std::size_t>(length));
+		if (!file.seek(static_cast<qint64>(offset)) ||
+			file.read(reinterpret_cast<char *>(data.data()), static_cast<qint64>(length)) != static_cast<qint64>(length))
+		{
+			qWarning() << "failed to read level" << level << "of" << path;
+			return std::nullopt;
+		}
+	}
+	return texture;
+}
+
+}// namespace fgl
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Base/TextureFormat.hpp>
+
+#include <QString>
+
+#include <optional>
+
+namespace fgl
+{
+
+struct Ktx2Info
+{
+	TextureFormat format = TextureFormat::Rgba8;
+	int width = 0;
+	int height = 0;
+	int levelCount = 0;
+};
+
+// Writes 2D texture without supercompression, with data format descriptor and levels from
+// the smallest one as KTX 2.0 requires.
+bool saveKtx2(const QString & path, const TextureData & texture);
+
+// Reads header only.
+std::optional<Ktx2Info> readKtx2Info(const QString & path);
+// Reads levels from firstLevel on, finer ones are left empty. Only files saveKtx2() writes
+// are supported: 2D textures of TextureFormat without supercompression.
+std::optional<TextureData> loadKtx2(const QString & path, int firstLevel = 0);
+
+}// namespace fgl
@@ -0,0 +1,87 @@
+#include "LightClusterBuffer.hpp"
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::size_t g_initialCapacity = 64 * 1024;
+
+static_assert(sizeof(Light) == LightClusterBuffer::texelsPerLight * sizeof(glm::vec4), "Light is uploaded as is");
+static_assert(sizeof(LightClusters::Cluster) == 2 * sizeof(std::uint32_t), "Cluster is uploaded as is");
+
+}// namespace
+
+void LightClusterBuffer::create(QOpenGLFunctions_3_3_Core & gl)
+{
+	gl_ = &gl;
+	create(lights_, GL_RGBA32F);
+	create(clusters_, GL_RG32UI);
+	create(indices_, GL_R32UI);
+}
+
+void LightClusterBuffer::create(Stream & stream, const GLenum format)
+{
+	stream.capacity = g_initialCapacity;
+	gl_->glGenBuffers(1, &stream.buffer);
+	gl_->glBindBuffer(GL_TEXTURE_BUFFER, stream.buffer);
+	gl_->glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(stream.capacity), nullptr, GL_STREAM_DRAW);
+	gl_->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	gl_->glGenTextures(1, &stream.texture);
+	gl_->glBindTexture(GL_TEXTURE_BUFFER, stream.texture);
+	gl_->glTexBuffer(GL_TEXTURE_BUFFER, format, stream.buffer);
+	gl_->glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightClusterBuffer::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	for (auto * stream: {&lights_, &clusters_, &indices_})
+	{
+		gl_->glDeleteTextures(1, &stream->texture);
+		gl_->glDeleteBuffers(1, &stream->buffer);
+		*stream = {};
+	}
+}
+
+void LightClusterBuffer::upload(const std::vector<Light> & lights, const LightClusters & clusters)
+{
+	uploadedBytes_ = 0;
+	upload(lights_, lights.data(), lights.size() * sizeof(Light));
+	upload(clusters_, clusters.clusters().data(), clusters.clusters().size() * sizeof(LightClusters::Cluster));
+	upload(indices_, clusters.indices().data(), clusters.indices().size() * sizeof(std::uint32_t));
+}
+
+void LightClusterBuffer::upload(Stream & stream, const void * data, const std::size_t size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+	stream.capacity = std::max(stream.capacity, size);
+
+	gl_->glBindBuffer(GL_TEXTURE_BUFFER, stream.buffer);
+	gl_->glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(stream.capacity), nullptr, GL_STREAM_DRAW);
+	gl_->glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+	gl_->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	uploadedBytes_ += size;
+}
+
+void LightClusterBuffer::bind(const GLuint firstUnit)
+{
+	const Stream * streams[] = {&lights_, &clusters_, &indices_};
+	for (GLuint i = 0; i < 3; ++i)
+	{
+		gl_->glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+		gl_->glBindTexture(GL_TEXTURE_BUFFER, streams[i]->texture);
+	}
+}
+
+}// namespace fgl
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Base/LightClusters.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <cstddef>
+#include <vector>
+
+namespace fgl
+{
+
+// Lights and light clusters exposed to shaders as three buffer textures:
+// lights as RGBA32F, three texels per light laid out as fgl::Light (position and radius,
+// color and spot inner cosine, direction and spot outer cosine); clusters as RG32UI with
+// offset and count of light indices; light indices as R32UI. Storage is orphaned on
+// every upload, like in InstanceBuffer.
+class LightClusterBuffer
+{
+public:
+	static constexpr int texelsPerLight = 3;
+
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl);
+	void destroy();
+
+	// Lights must be those clusters were assigned from.
+	void upload(const std::vector<Light> & lights, const LightClusters & clusters);
+
+	// Binds lights, clusters and indices to texture units firstUnit, firstUnit + 1 and firstUnit + 2.
+	void bind(GLuint firstUnit);
+
+	// Bytes uploaded by the last upload().
+	std::size_t uploadedBytes() const { return uploadedBytes_; }
+
+private:
+	struct Stream
+	{
+		GLuint buffer = 0;
+		GLuint texture = 0;
+		// In bytes.
+		std::size_t capacity = 0;
+	};
+
+private:
+	void create(Stream & stream, GLenum format);
+	void upload(Stream & stream, const void * data, std::size_t size);
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	Stream lights_;
+	Stream clusters_;
+	Stream indices_;
+	std::size_t uploadedBytes_ = 0;
+};
+
+}// namespace fgl
@@ -0,0 +1,206 @@
+#include "LightClusters.hpp"
+
+#include <Base/Simd.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Padding lanes are so far away that no cluster reaches them.
+constexpr auto g_paddingCoordinate = 1e18f;
+
+}// namespace
+
+BoundingSphere lightBounds(const Light & light)
+{
+	// Cone of at most 90 degrees fits into smaller sphere, Wronski, "Cull that cone!"
+	if (!light.isSpot() || light.spotCosOuter <= 0.f)
+	{
+		return {light.position, light.radius};
+	}
+	const auto cosAngle = light.spotCosOuter;
+	if (cosAngle < std::sqrt(0.5f))
+	{
+		const auto sinAngle = std::sqrt(1.f - cosAngle * cosAngle);
+		return {light.position + light.direction * (light.radius * cosAngle), light.radius * sinAngle};
+	}
+	const auto radius = light.radius / (2.f * cosAngle);
+	return {light.position + light.direction * radius, radius};
+}
+
+void LightClusters::setGrid(const LightClusterGrid & grid)
+{
+	grid_.tilesX = std::max(grid.tilesX, 1u);
+	grid_.tilesY = std::max(grid.tilesY, 1u);
+	grid_.slices = std::max(grid.slices, 1u);
+	updateBounds();
+}
+
+void LightClusters::setProjection(const float fovY, const float aspect, const float near, const float far)
+{
+	const auto tanHalfFovY = std::tan(fovY * 0.5f);
+	const auto clampedFar = std::max(far, near * 1.01f);
+	if (!bounds_.empty() && tanHalfFovY == tanHalfFovY_ && aspect == aspect_ && near == near_ && clampedFar == far_)
+	{
+		return;
+	}
+	tanHalfFovY_ = tanHalfFovY;
+	aspect_ = aspect;
+	near_ = near;
+	far_ = clampedFar;
+	updateBounds();
+}
+
+void LightClusters::updateBounds()
+{
+	const auto slices = static_cast<float>(grid_.slices);
+	depthScale_ = slices / std::log(far_ / near_);
+	depthBias_ = -std::log(near_) * depthScale_;
+
+	bounds_.resize(static_cast<std::size_t>(grid_.tilesX) * grid_.tilesY * grid_.slices);
+	slices_.resize(grid_.slices);
+	clusters_.resize(bounds_.size());
+
+	const auto tanHalfFovX = tanHalfFovY_ * aspect_;
+	for (std::uint32_t slice = 0; slice < grid_.slices; ++slice)
+	{
+		const auto nearDepth = near_ * std::pow(far_ / near_, static_cast<float>(slice) / slices);
+		const auto farDepth = near_ * std::pow(far_ / near_, static_cast<float>(slice + 1) / slices);
+		for (std::uint32_t y = 0; y < grid_.tilesY; ++y)
+		{
+			const auto bottom = (2.f * static_cast<float>(y) / static_cast<float>(grid_.tilesY) - 1.f) * tanHalfFovY_;
+			const auto top = (2.f * static_cast<float>(y + 1) / static_cast<float>(grid_.tilesY) - 1.f) * tanHalfFovY_;
+			for (std::uint32_t x = 0; x < grid_.tilesX; ++x)
+			{
+				const auto left = (2.f * static_cast<float>(x) / static_cast<float>(grid_.tilesX) - 1.f) * tanHalfFovX;
+				const auto right = (2.f * static_cast<float>(x + 1) / static_cast<float>(grid_.tilesX) - 1.f) * tanHalfFovX;
+				// Tile sides are planes through the eye, so extremes are at near or far depth
+				auto & box = bounds_[x + grid_.tilesX * (y + grid_.tilesY * slice)];
+				box.min = glm::vec3{std::min(left * nearDepth, left * farDepth), std::min(bottom * nearDepth, bottom * farDepth), -farDepth};
+				box.max = glm::vec3{std::max(right * nearDepth, right * farDepth), std::max(top * nearDepth, top * farDepth), -nearDepth};
+			}
+		}
+	}
+}
+
+void LightClusters::assign(const std::vector<Light> & lights, const glm::mat4 & view, JobSystem & jobs)
+{
+	viewSpheres_.resize(lights.size());
+	for (std::size_t light = 0; light < lights.size(); ++light)
+	{
+		const auto sphere = lightBounds(lights[light]);
+		viewSpheres_[light] = {glm::vec3{view * glm::vec4{sphere.center, 1.f}}, sphere.radius};
+	}
+
+	jobs.parallelFor(slices_.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+		for (auto slice = begin; slice < end; ++slice)
+		{
+			assignSlice(static_cast<std::uint32_t>(slice));
+		}
+	});
+
+	// Slices are concatenated in order, so result does not depend on thread count
+	const auto clustersPerSlice = static_cast<std::size_t>(grid_.tilesX) * grid_.tilesY;
+	std::size_t total = 0;
+	for (const auto & slice: slices_)
+	{
+		total += slice.indexCount;
+	}
+	indices_.resize(total);
+	maxClusterLights_ = 0;
+	std::uint32_t offset = 0;
+	for (std::size_t slice = 0; slice < slices_.size(); ++slice)
+	{
+		const auto & data = slices_[slice];
+		std::copy(data.indices.begin(), data.indices.begin() + static_cast<std::ptrdiff_t>(data.indexCount), indices_.begin() + offset);
+		for (auto cluster = slice * clustersPerSlice; cluster < (slice + 1) * clustersPerSlice; ++cluster)
+		{
+			clusters_[cluster].offset += offset;
+			maxClusterLights_ = std::max<std::size_t>(maxClusterLights_, clusters_[cluster].count);
+		}
+		offset += static_cast<std::uint32_t>(data.indexCount);
+	}
+}
+
+void LightClusters::assignSlice(const std::uint32_t slice)
+{
+	auto & data = slices_[slice];
+	const auto clustersPerSlice = static_cast<std::size_t>(grid_.tilesX) * grid_.tilesY;
+	const auto firstCluster = slice * clustersPerSlice;
+	const auto sliceMinZ = bounds_[firstCluster].min.z;
+	const auto sliceMaxZ = bounds_[firstCluster].max.z;
+
+	data.x.clear();
+	data.y.clear();
+	data.z.clear();
+	data.radiusSquared.clear();
+	data.lights.clear();
+	for (std::size_t light = 0; light < viewSpheres_.size(); ++light)
+	{
+		const auto & sphere = viewSpheres_[light];
+		if (sphere.center.z - sphere.radius > sliceMaxZ || sphere.center.z + sphere.radius < sliceMinZ)
+		{
+			continue;
+		}
+		data.x.push_back(sphere.center.x);
+		data.y.push_back(sphere.center.y);
+		data.z.push_back(sphere.center.z);
+		data.radiusSquared.push_back(sphere.radius * sphere.radius);
+		data.lights.push_back(static_cast<std::uint32_t>(light));
+	}
+	while (data.lights.size() % simd::width != 0)
+	{
+		data.x.push_back(g_paddingCoordinate);
+		data.y.push_back(g_paddingCoordinate);
+		data.z.push_back(g_paddingCoordinate);
+		data.radiusSquared.push_back(0.f);
+		data.lights.push_back(0u);
+	}
+
+	const auto zero = simd::broadcast(0.f);
+	data.indexCount = 0;
+	for (auto cluster = firstCluster; cluster < firstCluster + clustersPerSlice; ++cluster)
+	{
+		// Compaction below writes whole packs, so room for every candidate is reserved
+		if (data.indices.size() < data.indexCount + data.lights.size())
+		{
+			data.indices.resize(std::max(data.indices.size() * 2, data.indexCount + data.lights.size()));
+		}
+
+		const auto & box = bounds_[cluster];
+		const auto minX = simd::broadcast(box.min.x);
+		const auto minY = simd::broadcast(box.min.y);
+		const auto minZ = simd::broadcast(box.min.z);
+		const auto maxX = simd::broadcast(box.max.x);
+		const auto maxY = simd::broadcast(box.max.y);
+		const auto maxZ = simd::broadcast(box.max.z);
+		auto * output = data.indices.data() + data.indexCount;
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < data.lights.size(); i += simd::width)
+		{
+			// Distance from sphere center to the closest point of box
+			const auto x = simd::load(&data.x[i]);
+			const auto y = simd::load(&data.y[i]);
+			const auto z = simd::load(&data.z[i]);
+			const auto dx = simd::max(simd::max(minX - x, x - maxX), zero);
+			const auto dy = simd::max(simd::max(minY - y, y - maxY), zero);
+			const auto dz = simd::max(simd::max(minZ - z, z - maxZ), zero);
+			const auto inside = dx * dx + dy * dy + dz * dz <= simd::load(&data.radiusSquared[i]);
+			const auto mask = simd::bits(inside);
+			for (std::size_t lane = 0; lane < simd::width; ++lane)
+			{
+				output[count] = data.lights[i + lane];
+				count += (mask >> lane) & 1u;
+			}
+		}
+		clusters_[cluster] = {static_cast<std::uint32_t>(data.indexCount), static_cast<std::uint32_t>(count)};
+		data.indexCount += count;
+	}
+}
+
+}// namespace fgl
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/JobSystem.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// Point light, or spot light when cone angles are set. Light fades out to zero at radius.
+struct Light
+{
+	glm::vec3 position{0.f};
+	float radius = 1.f;
+	glm::vec3 color{1.f};
+	// Cosines of cone half angles where spot light starts to fade out and where it ends,
+	// -1 for point lights.
+	float spotCosInner = -1.f;
+	glm::vec3 direction{0.f, -1.f, 0.f};
+	float spotCosOuter = -1.f;
+
+	bool isSpot() const { return spotCosOuter > -1.f; }
+};
+
+// Smallest sphere around light volume, cone of spot light is not a whole sphere.
+BoundingSphere lightBounds(const Light & light);
+
+struct LightClusterGrid
+{
+	std::uint32_t tilesX = 16;
+	std::uint32_t tilesY = 9;
+	// Depth slices grow exponentially from near to far plane.
+	std::uint32_t slices = 24;
+};
+
+// View frustum divided into screen tiles and depth slices with lists of lights touching
+// each of these clusters, so fragment shaders loop only over lights of their cluster.
+// Light bounding spheres are tested against view space boxes of clusters with SIMD, depth
+// slices are distributed over threads. Each slice first keeps lights overlapping its depth
+// range only, so cost grows with lights per slice, not with all lights per cluster.
+class LightClusters
+{
+public:
+	struct Cluster
+	{
+		// Range of indices().
+		std::uint32_t offset = 0;
+		std::uint32_t count = 0;
+	};
+
+public:
+	void setGrid(const LightClusterGrid & grid);
+	// Symmetric perspective projection clusters subdivide, cluster boxes are recomputed only
+	// when it changes.
+	void setProjection(float fovY, float aspect, float near, float far);
+
+	void assign(const std::vector<Light> & lights, const glm::mat4 & view, JobSystem & jobs = JobSystem::instance());
+
+	const LightClusterGrid & grid() const { return grid_; }
+	std::size_t clusterCount() const { return bounds_.size(); }
+	// Cluster of tile x, y (from the bottom left) in slice s is x + tilesX * (y + tilesY * s).
+	const std::vector<Cluster> & clusters() const { return clusters_; }
+	// Light indices of all clusters.
+	const std::vector<std::uint32_t> & indices() const { return indices_; }
+	const Aabb & clusterBounds(const std::size_t cluster) const { return bounds_[cluster]; }
+
+	// Slice of fragment at view depth d is log(d) * depthScale() + depthBias().
+	float depthScale() const { return depthScale_; }
+	float depthBias() const { return depthBias_; }
+
+	std::size_t maxClusterLights() const { return maxClusterLights_; }
+
+private:
+	struct Slice
+	{
+		// View space spheres of lights overlapping slice depth range, padded to SIMD width.
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> radiusSquared;
+		std::vector<std::uint32_t> lights;
+		// Light indices of slice clusters, only the first indexCount are valid.
+		std::vector<std::uint32_t> indices;
+		std::size_t indexCount = 0;
+	};
+
+private:
+	void updateBounds();
+	void assignSlice(std::uint32_t slice);
+
+private:
+	LightClusterGrid grid_;
+	float tanHalfFovY_ = 1.f;
+	float aspect_ = 1.f;
+	float near_ = 0.1f;
+	float far_ = 100.f;
+	float depthScale_ = 0.f;
+	float depthBias_ = 0.f;
+
+	// View space boxes of clusters.
+	std::vector<Aabb> bounds_;
+	std::vector<BoundingSphere> viewSpheres_;
+	std::vector<Slice> slices_;
+
+	std::vector<Cluster> clusters_;
+	std::vector<std::uint32_t> indices_;
+	std::size_t maxClusterLights_ = 0;
+};
+
+}// namespace fgl
@@ -0,0 +1,77 @@
+#include "Lod.hpp"
+
+#include <Base/MeshSimplifier.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace fgl
+{
+
+LodChain buildLodChain(const Mesh & mesh, const LodChainOptions & options)
+{
+	LodChain chain;
+	chain.bounds = computeBoundingSphere(mesh);
+	chain.levels.push_back({mesh, 0.f});
+
+	while (chain.levels.size() < options.maxLevels)
+	{
+		const auto & previous = chain.levels.back();
+		const auto target = static_cast<std::size_t>(static_cast<float>(previous.mesh.triangleCount()) * options.reduction);
+		if (target < options.minTriangleCount)
+		{
+			break;
+		}
+
+		auto simplified = simplifyMesh(previous.mesh, {target});
+		// Stop when topology or borders do not allow to simplify any further.
+		if (simplified.mesh.triangleCount() >= previous.mesh.triangleCount())
+		{
+			break;
+		}
+		const auto error = previous.error + simplified.error;
+		chain.levels.push_back({std::move(simplified.mesh), error});
+	}
+	return chain;
+}
+
+void LodSelector::setProjection(const float fovY, const float viewportHeight)
+{
+	projectionScale_ = viewportHeight / (2.f * std::tan(fovY * 0.5f));
+}
+
+float LodSelector::projectedRadius(const float radius, const float distance) const
+{
+	return radius * projectionScale_ / std::max(distance, 1e-3f);
+}
+
+std::uint8_t LodSelector::select(const LodChain & chain, const BoundingSphere & worldSphere,
+								 const glm::vec3 & cameraPosition, const std::uint8_t currentLevel) const
+{
+	if (chain.levels.empty() || chain.bounds.radius <= 0.f)
+	{
+		return 0u;
+	}
+
+	// Distance to the nearest point of the sphere, camera inside sphere gets finest level.
+	const auto distance = glm::length(worldSphere.center - cameraPosition) - worldSphere.radius;
+	if (distance <= 0.f)
+	{
+		return 0u;
+	}
+	const auto pixelsPerUnit = projectedRadius(worldSphere.radius, distance) / chain.bounds.radius;
+
+	for (auto level = static_cast<int>(chain.levels.size()) - 1; level > 0; --level)
+	{
+		const auto pixelError = chain.levels[static_cast<std::size_t>(level)].error * pixelsPerUnit;
+		const auto budget = level > currentLevel ? options_.pixelErrorBudget * (1.f - options_.hysteresis)
+												 : options_.pixelErrorBudget;
+		if (pixelError <= budget)
+		{
+			return static_cast<std::uint8_t>(level);
+		}
+	}
+	return 0u;
+}
+
+}// namespace fgl
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Base/Mesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+struct LodLevel
+{
+	Mesh mesh;
+	// Geometric error of the level relative to the source mesh in mesh units.
+	float error = 0.f;
+};
+
+struct LodChainOptions
+{
+	std::size_t maxLevels = 6;
+	// Each level keeps this fraction of triangles of the previous one.
+	float reduction = 0.5f;
+	std::size_t minTriangleCount = 32;
+};
+
+struct LodChain
+{
+	// Level 0 is the source mesh, next levels are coarser.
+	std::vector<LodLevel> levels;
+	// Shared by all levels.
+	BoundingSphere bounds;
+};
+
+// Builds chain of progressively simplified meshes. Each level is simplified from
+// the previous one so errors are accumulated.
+LodChain buildLodChain(const Mesh & mesh, const LodChainOptions & options = {});
+
+struct LodSelectionOptions
+{
+	// Max allowed error of selected level in screen pixels.
+	float pixelErrorBudget = 1.f;
+	// Fraction of budget used as dead zone before switching to coarser level,
+	// prevents popping back and forth on budget boundary.
+	float hysteresis = 0.25f;
+};
+
+// Selects level per object from size of its bounding sphere projected on screen.
+class LodSelector
+{
+public:
+	// Projection parameters: vertical field of view in radians and viewport height in pixels.
+	void setProjection(float fovY, float viewportHeight);
+	void setOptions(const LodSelectionOptions & options) { options_ = options; }
+	const LodSelectionOptions & options() const { return options_; }
+
+	// Projected radius in pixels of sphere at given distance from camera.
+	float projectedRadius(float radius, float distance) const;
+
+	// Returns level to use given previously selected one.
+	// World sphere is chain bounds transformed to world space.
+	std::uint8_t select(const LodChain & chain, const BoundingSphere & worldSphere,
+						const glm::vec3 & cameraPosition, std::uint8_t currentLevel) const;
+
+private:
+	LodSelectionOptions options_;
+	// Pixels per world unit at unit distance.
+	float projectionScale_ = 1.f;
+};
+
+}// namespace fgl
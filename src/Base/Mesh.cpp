@@ -0,0 +1,53 @@
+#include "Mesh.hpp"
+
+namespace fgl
+{
+
+void computeNormals(Mesh & mesh)
+{
+	mesh.normals.assign(mesh.positions.size(), glm::vec3{0.f});
+	for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		const auto i0 = mesh.indices[i];
+		const auto i1 = mesh.indices[i + 1];
+		const auto i2 = mesh.indices[i + 2];
+		// Not normalized cross product weights normals by triangle area.
+		const auto normal = glm::cross(mesh.positions[i1] - mesh.positions[i0], mesh.positions[i2] - mesh.positions[i0]);
+		mesh.normals[i0] += normal;
+		mesh.normals[i1] += normal;
+		mesh.normals[i2] += normal;
+	}
+	for (auto & normal: mesh.normals)
+	{
+		const auto length = glm::length(normal);
+		normal = length > 0.f ? normal / length : glm::vec3{0.f, 0.f, 1.f};
+	}
+}
+
+Aabb computeAabb(const Mesh & mesh)
+{
+	Aabb box;
+	for (const auto & position: mesh.positions)
+	{
+		box.expand(position);
+	}
+	return box;
+}
+
+BoundingSphere computeBoundingSphere(const Mesh & mesh)
+{
+	// Sphere around box center is good enough for culling and lod selection.
+	const auto box = computeAabb(mesh);
+	if (box.isEmpty())
+	{
+		return {};
+	}
+	BoundingSphere sphere{box.center(), 0.f};
+	for (const auto & position: mesh.positions)
+	{
+		sphere.radius = glm::max(sphere.radius, glm::length(position - sphere.center));
+	}
+	return sphere;
+}
+
+}// namespace fgl
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// CPU side indexed triangle mesh. All attribute arrays have the same size.
+struct Mesh
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec3> colors;
+	std::vector<std::uint32_t> indices;
+
+	std::size_t vertexCount() const { return positions.size(); }
+	std::size_t triangleCount() const { return indices.size() / 3u; }
+};
+
+// Recalculates smooth vertex normals from triangles.
+void computeNormals(Mesh & mesh);
+
+Aabb computeAabb(const Mesh & mesh);
+BoundingSphere computeBoundingSphere(const Mesh & mesh);
+
+}// namespace fgl
@@ -0,0 +1,94 @@
+#include "MeshPool.hpp"
+
+#include <QDebug>
+
+namespace fgl
+{
+
+void MeshPool::create(QOpenGLFunctions_3_3_Core & gl, const std::vector<Mesh> & meshes)
+{
+	gl_ = &gl;
+
+	std::vector<glm::vec4> vertices;
+	std::vector<std::uint32_t> indices;
+	for (const auto & mesh: meshes)
+	{
+		MeshRange range;
+		range.firstIndex = static_cast<GLuint>(indices.size());
+		range.indexCount = static_cast<GLuint>(mesh.indices.size());
+		range.baseVertex = static_cast<GLint>(vertices.size() / texelsPerVertex);
+		ranges_.push_back(range);
+
+		for (std::size_t i = 0; i < mesh.vertexCount(); ++i)
+		{
+			const auto normal = i < mesh.normals.size() ? mesh.normals[i] : glm::vec3{0.f, 0.f, 1.f};
+			const auto color = i < mesh.colors.size() ? mesh.colors[i] : glm::vec3{1.f};
+			vertices.insert(vertices.end(), {glm::vec4{mesh.positions[i], 1.f}, glm::vec4{normal, 0.f}, glm::vec4{color, 1.f}});
+		}
+		indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+	}
+	vertexCount_ = static_cast<GLint>(vertices.size() / texelsPerVertex);
+
+	gl_->glGenBuffers(1, &vertexBuffer_);
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+	gl_->glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec4)), vertices.data(), GL_STATIC_DRAW);
+
+	gl_->glGenBuffers(1, &indexBuffer_);
+	gl_->glGenVertexArrays(1, &pullVertexArray_);
+	gl_->glBindVertexArray(pullVertexArray_);
+	gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+	gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(std::uint32_t)), indices.data(), GL_STATIC_DRAW);
+
+	gl_->glGenVertexArrays(1, &vertexArray_);
+	gl_->glBindVertexArray(vertexArray_);
+	gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+	constexpr auto stride = static_cast<GLsizei>(texelsPerVertex * sizeof(glm::vec4));
+	const auto offset = [](const std::size_t texels) { return reinterpret_cast<const void *>(texels * sizeof(glm::vec4)); };
+	gl_->glEnableVertexAttribArray(positionLocation);
+	gl_->glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, stride, offset(0));
+	gl_->glEnableVertexAttribArray(normalLocation);
+	gl_->glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, stride, offset(1));
+	gl_->glEnableVertexAttribArray(colorLocation);
+	gl_->glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, stride, offset(2));
+
+	// Index buffer binding is part of VAO state so it is released after VAO.
+	gl_->glBindVertexArray(0);
+	gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	GLint maxTexels = 0;
+	gl_->glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	supportsPulling_ = vertices.size() <= static_cast<std::size_t>(maxTexels);
+	if (!supportsPulling_)
+	{
+		qWarning() << "mesh pool of" << vertices.size() << "texels exceeds texture buffer limit of" << maxTexels << ", vertex pulling disabled";
+	}
+
+	gl_->glGenTextures(1, &vertexTexture_);
+	gl_->glBindTexture(GL_TEXTURE_BUFFER, vertexTexture_);
+	gl_->glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, vertexBuffer_);
+	gl_->glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void MeshPool::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	gl_->glDeleteTextures(1, &vertexTexture_);
+	gl_->glDeleteVertexArrays(1, &vertexArray_);
+	gl_->glDeleteVertexArrays(1, &pullVertexArray_);
+	gl_->glDeleteBuffers(1, &indexBuffer_);
+	gl_->glDeleteBuffers(1, &vertexBuffer_);
+	vertexTexture_ = 0;
+	vertexArray_ = 0;
+	pullVertexArray_ = 0;
+	indexBuffer_ = 0;
+	vertexBuffer_ = 0;
+	ranges_.clear();
+	vertexCount_ = 0;
+	supportsPulling_ = false;
+}
+
+}// namespace fgl
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Base/Mesh.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <cstddef>
+#include <vector>
+
+namespace fgl
+{
+
+// Location of mesh inside pool buffers.
+struct MeshRange
+{
+	GLuint firstIndex = 0;
+	GLuint indexCount = 0;
+	GLint baseVertex = 0;
+};
+
+// Meshes packed into shared vertex and index buffers, so draws of different meshes need
+// no rebinding and can go into one multi draw call. Vertex is three vec4: position, normal
+// and color, bound to attribute locations 0, 1 and 2 of vertexArray() and also readable
+// as RGBA32F buffer texture for vertex pulling, as long as pool fits GL_MAX_TEXTURE_BUFFER_SIZE.
+// Requires current OpenGL context for all calls.
+class MeshPool
+{
+public:
+	static constexpr GLuint positionLocation = 0;
+	static constexpr GLuint normalLocation = 1;
+	static constexpr GLuint colorLocation = 2;
+	static constexpr GLint texelsPerVertex = 3;
+
+public:
+	void create(QOpenGLFunctions_3_3_Core & gl, const std::vector<Mesh> & meshes);
+	void destroy();
+
+	// Vertex array with attributes and index buffer.
+	GLuint vertexArray() const { return vertexArray_; }
+	// Vertex array with index buffer only, for shaders pulling vertices from vertexTexture().
+	GLuint pullVertexArray() const { return pullVertexArray_; }
+	GLuint vertexBuffer() const { return vertexBuffer_; }
+	GLuint vertexTexture() const { return vertexTexture_; }
+	// Whether all vertices are readable through vertexTexture().
+	bool supportsPulling() const { return supportsPulling_; }
+
+	const MeshRange & range(const std::size_t mesh) const { return ranges_[mesh]; }
+	std::size_t meshCount() const { return ranges_.size(); }
+	GLint vertexCount() const { return vertexCount_; }
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	GLuint vertexBuffer_ = 0;
+	GLuint indexBuffer_ = 0;
+	GLuint vertexArray_ = 0;
+	GLuint pullVertexArray_ = 0;
+	GLuint vertexTexture_ = 0;
+
+	std::vector<MeshRange> ranges_;
+	GLint vertexCount_ = 0;
+	bool supportsPulling_ = false;
+};
+
+}// namespace fgl
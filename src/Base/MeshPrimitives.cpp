@@ -0,0 +1,178 @@
+#include "MeshPrimitives.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <utility>
+
+namespace fgl
+{
+
+namespace
+{
+
+std::uint32_t midpoint(Mesh & mesh, std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> & cache,
+					   std::uint32_t a, std::uint32_t b)
+{
+	const auto key = std::make_pair(glm::min(a, b), glm::max(a, b));
+	const auto found = cache.find(key);
+	if (found != cache.end())
+	{
+		return found->second;
+	}
+	const auto index = static_cast<std::uint32_t>(mesh.positions.size());
+	mesh.positions.push_back(glm::normalize(mesh.positions[a] + mesh.positions[b]));
+	cache.emplace(key, index);
+	return index;
+}
+
+float hashNoise(const glm::ivec3 & cell)
+{
+	auto hash = static_cast<std::uint32_t>(cell.x) * 73856093u
+		^ static_cast<std::uint32_t>(cell.y) * 19349663u
+		^ static_cast<std::uint32_t>(cell.z) * 83492791u;
+	hash = (hash ^ (hash >> 13u)) * 1274126177u;
+	return static_cast<float>(hash & 0xffffu) / 65535.f * 2.f - 1.f;
+}
+
+// Value noise with trilinear interpolation.
+float valueNoise(const glm::vec3 & point)
+{
+	const auto base = glm::floor(point);
+	const auto cell = glm::ivec3{base};
+	const auto t = glm::smoothstep(glm::vec3{0.f}, glm::vec3{1.f}, point - base);
+	float result = 0.f;
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		const glm::ivec3 offset{corner & 1, (corner >> 1) & 1, (corner >> 2) & 1};
+		const auto weight = (offset.x ? t.x : 1.f - t.x) * (offset.y ? t.y : 1.f - t.y) * (offset.z ? t.z : 1.f - t.z);
+		result += weight * hashNoise(cell + offset);
+	}
+	return result;
+}
+
+}// namespace
+
+Mesh makeIcosphere(const int subdivisions, const glm::vec3 & color)
+{
+	const auto t = (1.f + std::sqrt(5.f)) * 0.5f;
+
+	Mesh mesh;
+	mesh.positions = {
+		{-1.f, t, 0.f}, {1.f, t, 0.f}, {-1.f, -t, 0.f}, {1.f, -t, 0.f},
+		{0.f, -1.f, t}, {0.f, 1.f, t}, {0.f, -1.f, -t}, {0.f, 1.f, -t},
+		{t, 0.f, -1.f}, {t, 0.f, 1.f}, {-t, 0.f, -1.f}, {-t, 0.f, 1.f},
+	};
+	for (auto & position: mesh.positions)
+	{
+		position = glm::normalize(position);
+	}
+	mesh.indices = {
+		0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+		1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+		3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+		4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+	};
+
+	for (int level = 0; level < subdivisions; ++level)
+	{
+		std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> cache;
+		std::vector<std::uint32_t> indices;
+		indices.reserve(mesh.indices.size() * 4u);
+		for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			const auto a = mesh.indices[i];
+			const auto b = mesh.indices[i + 1];
+			const auto c = mesh.indices[i + 2];
+			const auto ab = midpoint(mesh, cache, a, b);
+			const auto bc = midpoint(mesh, cache, b, c);
+			const auto ca = midpoint(mesh, cache, c, a);
+			indices.insert(indices.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+		}
+		mesh.indices = std::move(indices);
+	}
+
+	mesh.normals = mesh.positions;
+	mesh.colors.assign(mesh.positions.size(), color);
+	return mesh;
+}
+
+Mesh makeTorus(const float majorRadius, const float minorRadius, const int rings, const int sides, const glm::vec3 & color)
+{
+	Mesh mesh;
+	for (int ring = 0; ring < rings; ++ring)
+	{
+		const auto u = glm::two_pi<float>() * static_cast<float>(ring) / static_cast<float>(rings);
+		const glm::vec3 ringDirection{std::cos(u), 0.f, std::sin(u)};
+		for (int side = 0; side < sides; ++side)
+		{
+			const auto v = glm::two_pi<float>() * static_cast<float>(side) / static_cast<float>(sides);
+			const auto normal = ringDirection * std::cos(v) + glm::vec3{0.f, std::sin(v), 0.f};
+			mesh.positions.push_back(ringDirection * majorRadius + normal * minorRadius);
+			mesh.normals.push_back(normal);
+		}
+	}
+	const auto vertex = [&](const int ring, const int side) {
+		return static_cast<std::uint32_t>((ring % rings) * sides + side % sides);
+	};
+	for (int ring = 0; ring < rings; ++ring)
+	{
+		for (int side = 0; side < sides; ++side)
+		{
+			const auto a = vertex(ring, side);
+			const auto b = vertex(ring + 1, side);
+			const auto c = vertex(ring + 1, side + 1);
+			const auto d = vertex(ring, side + 1);
+			mesh.indices.insert(mesh.indices.end(), {a, d, b, b, d, c});
+		}
+	}
+	mesh.colors.assign(mesh.positions.size(), color);
+	return mesh;
+}
+
+Mesh makeBox(const glm::vec3 & halfSize, const glm::vec3 & color)
+{
+	Mesh mesh;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		for (const auto sign: {-1.f, 1.f})
+		{
+			glm::vec3 normal{0.f};
+			normal[axis] = sign;
+			// Two tangent axes chosen so that faces are counter clockwise from outside.
+			glm::vec3 u{0.f};
+			glm::vec3 v{0.f};
+			u[(axis + 1) % 3] = 1.f;
+			v[(axis + 2) % 3] = sign;
+
+			const auto base = static_cast<std::uint32_t>(mesh.positions.size());
+			for (const auto & corner: std::array<glm::vec2, 4u>{{{-1.f, -1.f}, {1.f, -1.f}, {1.f, 1.f}, {-1.f, 1.f}}})
+			{
+				mesh.positions.push_back((normal + u * corner.x + v * corner.y) * halfSize);
+				mesh.normals.push_back(normal);
+			}
+			mesh.indices.insert(mesh.indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+		}
+	}
+	mesh.colors.assign(mesh.positions.size(), color);
+	return mesh;
+}
+
+void displaceAlongNormals(Mesh & mesh, const float amplitude, const float frequency)
+{
+	if (mesh.normals.size() != mesh.positions.size())
+	{
+		computeNormals(mesh);
+	}
+	for (std::size_t i = 0; i < mesh.positions.size(); ++i)
+	{
+		const auto point = mesh.positions[i] * frequency;
+		const auto noise = valueNoise(point) + 0.5f * valueNoise(point * 2.f) + 0.25f * valueNoise(point * 4.f);
+		mesh.positions[i] += mesh.normals[i] * (noise * amplitude);
+	}
+	computeNormals(mesh);
+}
+
+}// namespace fgl
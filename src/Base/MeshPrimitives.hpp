@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Base/Mesh.hpp>
+
+namespace fgl
+{
+
+// Unit sphere made by subdividing icosahedron. Each level multiplies triangle count by 4.
+Mesh makeIcosphere(int subdivisions, const glm::vec3 & color);
+
+// Torus in XZ plane around origin.
+Mesh makeTorus(float majorRadius, float minorRadius, int rings, int sides, const glm::vec3 & color);
+
+// Axis aligned box with flat shaded faces.
+Mesh makeBox(const glm::vec3 & halfSize, const glm::vec3 & color);
+
+// Displaces vertices along normals with smooth pseudo random noise, useful to get
+// detailed "scanned" looking surfaces from primitives.
+void displaceAlongNormals(Mesh & mesh, float amplitude, float frequency);
+
+}// namespace fgl
@@ -0,0 +1,405 @@
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <queue>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_invalid = std::numeric_limits<std::uint32_t>::max();
+constexpr auto g_borderWeight = 10.0;
+// Collapses rotating triangle normal more than this (cos of angle) are rejected.
+constexpr auto g_minNormalDot = 0.2;
+
+// Symmetric 4x4 matrix of plane equation products.
+struct Quadric
+{
+	double a2 = 0., ab = 0., ac = 0., ad = 0.;
+	double b2 = 0., bc = 0., bd = 0.;
+	double c2 = 0., cd = 0.;
+	double d2 = 0.;
+
+	static Quadric fromPlane(const glm::dvec3 & normal, const double distance, const double weight)
+	{
+		const auto & n = normal;
+		const auto d = distance;
+		return {weight * n.x * n.x, weight * n.x * n.y, weight * n.x * n.z, weight * n.x * d,
+				weight * n.y * n.y, weight * n.y * n.z, weight * n.y * d,
+				weight * n.z * n.z, weight * n.z * d,
+				weight * d * d};
+	}
+
+	Quadric & operator+=(const Quadric & other)
+	{
+		a2 += other.a2, ab += other.ab, ac += other.ac, ad += other.ad;
+		b2 += other.b2, bc += other.bc, bd += other.bd;
+		c2 += other.c2, cd += other.cd;
+		d2 += other.d2;
+		return *this;
+	}
+
+	double evaluate(const glm::dvec3 & p) const
+	{
+		const auto result = a2 * p.x * p.x + 2. * ab * p.x * p.y + 2. * ac * p.x * p.z + 2. * ad * p.x
+			+ b2 * p.y * p.y + 2. * bc * p.y * p.z + 2. * bd * p.y
+			+ c2 * p.z * p.z + 2. * cd * p.z
+			+ d2;
+		return std::max(result, 0.);
+	}
+
+	// Finds point with minimal error, fails for singular systems (flat or straight regions).
+	bool optimize(glm::dvec3 & result) const
+	{
+		const glm::dmat3 m{a2, ab, ac, ab, b2, bc, ac, bc, c2};
+		const auto det = glm::determinant(m);
+		if (std::abs(det) < 1e-12)
+		{
+			return false;
+		}
+		result = glm::inverse(m) * glm::dvec3{-ad, -bd, -cd};
+		return true;
+	}
+};
+
+struct Collapse
+{
+	double cost;
+	std::uint32_t from;
+	std::uint32_t to;
+	std::uint32_t fromStamp;
+	std::uint32_t toStamp;
+	glm::vec3 position;
+
+	bool operator>(const Collapse & other) const { return cost > other.cost; }
+};
+
+class Simplifier
+{
+public:
+	explicit Simplifier(const Mesh & mesh)
+		: mesh_{mesh}
+		, positions_{mesh.positions}
+		, quadrics_(mesh.positions.size())
+		, vertexTriangles_(mesh.positions.size())
+		, stamps_(mesh.positions.size(), 0u)
+		, alive_(mesh.positions.size(), true)
+		, triangles_{mesh.indices}
+		, triangleAlive_(mesh.triangleCount(), true)
+		, triangleCount_{mesh.triangleCount()}
+	{
+		for (std::uint32_t triangle = 0; triangle < triangleCount_; ++triangle)
+		{
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				vertexTriangles_[triangles_[triangle * 3 + corner]].push_back(triangle);
+			}
+			const auto [normal, distance] = plane(triangle);
+			const auto quadric = Quadric::fromPlane(normal, distance, 1.);
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				quadrics_[triangles_[triangle * 3 + corner]] += quadric;
+			}
+		}
+		addBorderPenalties();
+		for (std::uint32_t triangle = 0; triangle < triangleCount_; ++triangle)
+		{
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				const auto a = triangles_[triangle * 3 + corner];
+				const auto b = triangles_[triangle * 3 + (corner + 1) % 3];
+				// Each interior edge is visited twice, push once.
+				if (a < b || isBorderEdge(a, b))
+				{
+					pushCollapse(a, b);
+				}
+			}
+		}
+	}
+
+	SimplifyResult run(const SimplifyOptions & options)
+	{
+		const auto maxCost = static_cast<double>(options.maxError) * static_cast<double>(options.maxError);
+		double appliedCost = 0.;
+		while (triangleCount_ > options.targetTriangleCount && !queue_.empty())
+		{
+			const auto collapse = queue_.top();
+			queue_.pop();
+			if (!alive_[collapse.from] || !alive_[collapse.to]
+				|| stamps_[collapse.from] != collapse.fromStamp || stamps_[collapse.to] != collapse.toStamp)
+			{
+				continue;
+			}
+			if (collapse.cost > maxCost)
+			{
+				break;
+			}
+			if (!canCollapse(collapse))
+			{
+				continue;
+			}
+			apply(collapse);
+			appliedCost = std::max(appliedCost, collapse.cost);
+		}
+		return {compact(), static_cast<float>(std::sqrt(appliedCost))};
+	}
+
+private:
+	std::pair<glm::dvec3, double> plane(const std::uint32_t triangle) const
+	{
+		const glm::dvec3 p0{positions_[triangles_[triangle * 3]]};
+		const glm::dvec3 p1{positions_[triangles_[triangle * 3 + 1]]};
+		const glm::dvec3 p2{positions_[triangles_[triangle * 3 + 2]]};
+		auto normal = glm::cross(p1 - p0, p2 - p0);
+		const auto length = glm::length(normal);
+		normal = length > 0. ? normal / length : glm::dvec3{0.};
+		return {normal, -glm::dot(normal, p0)};
+	}
+
+	std::size_t edgeTriangleCount(const std::uint32_t a, const std::uint32_t b) const
+	{
+		return static_cast<std::size_t>(std::count_if(vertexTriangles_[a].begin(), vertexTriangles_[a].end(), [&](const auto triangle) {
+			return triangleAlive_[triangle] && hasVertex(triangle, b);
+		}));
+	}
+
+	bool isBorderEdge(const std::uint32_t a, const std::uint32_t b) const { return edgeTriangleCount(a, b) == 1u; }
+
+	bool hasVertex(const std::uint32_t triangle, const std::uint32_t vertex) const
+	{
+		return triangles_[triangle * 3] == vertex || triangles_[triangle * 3 + 1] == vertex || triangles_[triangle * 3 + 2] == vertex;
+	}
+
+	void addBorderPenalties()
+	{
+		for (std::uint32_t triangle = 0; triangle < triangleCount_; ++triangle)
+		{
+			const auto [normal, distance] = plane(triangle);
+			static_cast<void>(distance);
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				const auto a = triangles_[triangle * 3 + corner];
+				const auto b = triangles_[triangle * 3 + (corner + 1) % 3];
+				if (!isBorderEdge(a, b))
+				{
+					continue;
+				}
+				// Plane through border edge perpendicular to the triangle.
+				const glm::dvec3 pa{positions_[a]};
+				const glm::dvec3 edge = glm::dvec3{positions_[b]} - pa;
+				auto borderNormal = glm::cross(edge, normal);
+				const auto length = glm::length(borderNormal);
+				if (length <= 0.)
+				{
+					continue;
+				}
+				borderNormal /= length;
+				const auto quadric = Quadric::fromPlane(borderNormal, -glm::dot(borderNormal, pa), g_borderWeight);
+				quadrics_[a] += quadric;
+				quadrics_[b] += quadric;
+			}
+		}
+	}
+
+	void pushCollapse(const std::uint32_t a, const std::uint32_t b)
+	{
+		auto quadric = quadrics_[a];
+		quadric += quadrics_[b];
+
+		const glm::dvec3 pa{positions_[a]};
+		const glm::dvec3 pb{positions_[b]};
+		std::array<glm::dvec3, 4u> candidates = {pa, pb, (pa + pb) * 0.5, pa};
+		const auto candidateCount = quadric.optimize(candidates[3]) ? 4u : 3u;
+
+		auto best = candidates[0];
+		auto bestCost = quadric.evaluate(best);
+		for (std::size_t i = 1; i < candidateCount; ++i)
+		{
+			const auto cost = quadric.evaluate(candidates[i]);
+			if (cost < bestCost)
+			{
+				best = candidates[i];
+				bestCost = cost;
+			}
+		}
+		queue_.push({bestCost, b, a, stamps_[b], stamps_[a], glm::vec3{best}});
+	}
+
+	// Rejects collapses which flip triangles or make mesh non manifold.
+	bool canCollapse(const Collapse & collapse)
+	{
+		const auto from = collapse.from;
+		const auto to = collapse.to;
+
+		// Link condition: vertices adjacent to both ends must be exactly the opposite
+		// vertices of triangles sharing collapsing edge.
+		auto & fromNeighbours = neighbours(from, neighboursA_);
+		auto & toNeighbours = neighbours(to, neighboursB_);
+		std::size_t shared = 0;
+		for (const auto vertex: fromNeighbours)
+		{
+			if (vertex != to && std::binary_search(toNeighbours.begin(), toNeighbours.end(), vertex))
+			{
+				++shared;
+			}
+		}
+		if (shared != edgeTriangleCount(from, to))
+		{
+			return false;
+		}
+
+		const glm::dvec3 position{collapse.position};
+		for (const auto vertex: {from, to})
+		{
+			for (const auto triangle: vertexTriangles_[vertex])
+			{
+				if (!triangleAlive_[triangle] || (hasVertex(triangle, from) && hasVertex(triangle, to)))
+				{
+					continue;
+				}
+				std::array<glm::dvec3, 3u> corners;
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					const auto index = triangles_[triangle * 3 + corner];
+					corners[corner] = index == vertex ? position : glm::dvec3{positions_[index]};
+				}
+				const auto [oldNormal, oldDistance] = plane(triangle);
+				static_cast<void>(oldDistance);
+				const auto newNormal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+				const auto length = glm::length(newNormal);
+				if (length <= 0. || glm::dot(oldNormal, newNormal / length) < g_minNormalDot)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	std::vector<std::uint32_t> & neighbours(const std::uint32_t vertex, std::vector<std::uint32_t> & result) const
+	{
+		result.clear();
+		for (const auto triangle: vertexTriangles_[vertex])
+		{
+			if (triangleAlive_[triangle])
+			{
+				result.insert(result.end(), triangles_.begin() + triangle * 3, triangles_.begin() + triangle * 3 + 3);
+			}
+		}
+		std::sort(result.begin(), result.end());
+		result.erase(std::unique(result.begin(), result.end()), result.end());
+		result.erase(std::remove(result.begin(), result.end(), vertex), result.end());
+		return result;
+	}
+
+	void apply(const Collapse & collapse)
+	{
+		const auto from = collapse.from;
+		const auto to = collapse.to;
+
+		positions_[to] = collapse.position;
+		quadrics_[to] += quadrics_[from];
+		alive_[from] = false;
+		++stamps_[to];
+
+		for (const auto triangle: vertexTriangles_[from])
+		{
+			if (!triangleAlive_[triangle])
+			{
+				continue;
+			}
+			if (hasVertex(triangle, to))
+			{
+				triangleAlive_[triangle] = false;
+				--triangleCount_;
+				continue;
+			}
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				auto & index = triangles_[triangle * 3 + corner];
+				if (index == from)
+				{
+					index = to;
+				}
+			}
+			vertexTriangles_[to].push_back(triangle);
+		}
+		vertexTriangles_[from].clear();
+
+		auto & toTriangles = vertexTriangles_[to];
+		toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(), [&](const auto triangle) {
+							  return !triangleAlive_[triangle];
+						  }),
+						  toTriangles.end());
+
+		for (const auto vertex: neighbours(to, neighboursA_))
+		{
+			pushCollapse(to, vertex);
+			pushCollapse(vertex, to);
+		}
+	}
+
+	Mesh compact() const
+	{
+		Mesh result;
+		std::vector<std::uint32_t> remap(positions_.size(), g_invalid);
+		for (std::size_t triangle = 0; triangle < triangleAlive_.size(); ++triangle)
+		{
+			if (!triangleAlive_[triangle])
+			{
+				continue;
+			}
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				const auto vertex = triangles_[triangle * 3 + corner];
+				if (remap[vertex] == g_invalid)
+				{
+					remap[vertex] = static_cast<std::uint32_t>(result.positions.size());
+					result.positions.push_back(positions_[vertex]);
+					if (vertex < mesh_.colors.size())
+					{
+						result.colors.push_back(mesh_.colors[vertex]);
+					}
+				}
+				result.indices.push_back(remap[vertex]);
+			}
+		}
+		computeNormals(result);
+		return result;
+	}
+
+private:
+	const Mesh & mesh_;
+
+	std::vector<glm::vec3> positions_;
+	std::vector<Quadric> quadrics_;
+	std::vector<std::vector<std::uint32_t>> vertexTriangles_;
+	std::vector<std::uint32_t> stamps_;
+	std::vector<bool> alive_;
+
+	std::vector<std::uint32_t> triangles_;
+	std::vector<bool> triangleAlive_;
+	std::size_t triangleCount_;
+
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> queue_;
+
+	std::vector<std::uint32_t> neighboursA_;
+	std::vector<std::uint32_t> neighboursB_;
+};
+
+}// namespace
+
+SimplifyResult simplifyMesh(const Mesh & mesh, const SimplifyOptions & options)
+{
+	if (mesh.triangleCount() <= options.targetTriangleCount)
+	{
+		return {mesh, 0.f};
+	}
+	return Simplifier{mesh}.run(options);
+}
+
+}// namespace fgl
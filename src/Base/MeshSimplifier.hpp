@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Base/Mesh.hpp>
+
+#include <limits>
+
+namespace fgl
+{
+
+struct SimplifyOptions
+{
+	// Simplification stops once mesh has this number of triangles or less.
+	std::size_t targetTriangleCount = 0;
+	// Collapses with greater geometric error are never performed.
+	float maxError = std::numeric_limits<float>::max();
+};
+
+struct SimplifyResult
+{
+	Mesh mesh;
+	// Approximate max distance between source and simplified surfaces in mesh units.
+	float error = 0.f;
+};
+
+// Quadric error metric edge collapse simplification (Garland & Heckbert).
+// Open borders are preserved with additional penalty planes, collapses that flip
+// triangles or break manifold topology are rejected.
+SimplifyResult simplifyMesh(const Mesh & mesh, const SimplifyOptions & options);
+
+}// namespace fgl
@@ -0,0 +1,243 @@
+#include "Meshlets.hpp"
+
+#include <Base/ParallelFor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_invalid = std::numeric_limits<std::uint32_t>::max();
+constexpr std::size_t g_cullGrain = 512;
+// Cones wider than this (cos of angle between axis and some normal) are not worth testing.
+constexpr auto g_minConeDot = 0.1f;
+
+glm::vec3 triangleNormal(const Mesh & mesh, const std::uint32_t * triangle)
+{
+	const auto & p0 = mesh.positions[triangle[0]];
+	const auto normal = glm::cross(mesh.positions[triangle[1]] - p0, mesh.positions[triangle[2]] - p0);
+	const auto length = glm::length(normal);
+	return length > 0.f ? normal / length : glm::vec3{0.f};
+}
+
+void computeMeshletBounds(const Mesh & mesh, const std::vector<std::uint32_t> & indices, Meshlet & meshlet)
+{
+	Aabb box;
+	glm::vec3 axis{0.f};
+	for (auto i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i += 3)
+	{
+		for (auto corner = i; corner < i + 3; ++corner)
+		{
+			box.expand(mesh.positions[indices[corner]]);
+		}
+		axis += triangleNormal(mesh, &indices[i]);
+	}
+
+	meshlet.bounds = {box.center(), 0.f};
+	for (auto i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; ++i)
+	{
+		meshlet.bounds.radius = std::max(meshlet.bounds.radius, glm::length(mesh.positions[indices[i]] - meshlet.bounds.center));
+	}
+
+	const auto axisLength = glm::length(axis);
+	if (axisLength <= 0.f)
+	{
+		return;
+	}
+	meshlet.coneAxis = axis / axisLength;
+
+	auto minDot = 1.f;
+	for (auto i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i += 3)
+	{
+		minDot = std::min(minDot, glm::dot(meshlet.coneAxis, triangleNormal(mesh, &indices[i])));
+	}
+	// Sine of cone half angle, viewing direction within 90 degrees of it sees only back faces.
+	meshlet.coneCutoff = minDot <= g_minConeDot ? 2.f : std::sqrt(1.f - minDot * minDot);
+}
+
+}// namespace
+
+MeshletMesh buildMeshlets(const Mesh & mesh, const MeshletOptions & options)
+{
+	const auto triangleCount = mesh.triangleCount();
+
+	// Vertex to triangles adjacency in compressed form.
+	std::vector<std::uint32_t> offsets(mesh.vertexCount() + 1, 0u);
+	for (const auto index: mesh.indices)
+	{
+		++offsets[index + 1];
+	}
+	for (std::size_t i = 1; i < offsets.size(); ++i)
+	{
+		offsets[i] += offsets[i - 1];
+	}
+	std::vector<std::uint32_t> adjacency(mesh.indices.size());
+	{
+		auto fill = offsets;
+		for (std::size_t i = 0; i < mesh.indices.size(); ++i)
+		{
+			adjacency[fill[mesh.indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+		}
+	}
+
+	MeshletMesh result;
+	result.indices.reserve(mesh.indices.size());
+
+	std::vector<bool> used(triangleCount, false);
+	// Local vertex slot of the current meshlet per mesh vertex.
+	std::vector<std::uint32_t> vertexMeshlet(mesh.vertexCount(), g_invalid);
+	std::deque<std::uint32_t> frontier;
+	std::size_t seed = 0;
+
+	while (true)
+	{
+		while (seed < triangleCount && used[seed])
+		{
+			++seed;
+		}
+		if (seed == triangleCount)
+		{
+			break;
+		}
+
+		const auto meshletIndex = static_cast<std::uint32_t>(result.meshlets.size());
+		Meshlet meshlet;
+		meshlet.indexOffset = static_cast<std::uint32_t>(result.indices.size());
+		std::size_t vertexCount = 0;
+		std::size_t triangles = 0;
+
+		frontier.clear();
+		frontier.push_back(static_cast<std::uint32_t>(seed));
+		while (!frontier.empty() && triangles < options.maxTriangles)
+		{
+			const auto triangle = frontier.front();
+			frontier.pop_front();
+			if (used[triangle])
+			{
+				continue;
+			}
+
+			const auto * corners = &mesh.indices[triangle * 3u];
+			std::size_t newVertices = 0;
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				newVertices += vertexMeshlet[corners[corner]] != meshletIndex ? 1u : 0u;
+			}
+			if (vertexCount + newVertices > options.maxVertices)
+			{
+				continue;
+			}
+
+			used[triangle] = true;
+			++triangles;
+			vertexCount += newVertices;
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				const auto vertex = corners[corner];
+				result.indices.push_back(vertex);
+				if (vertexMeshlet[vertex] == meshletIndex)
+				{
+					continue;
+				}
+				vertexMeshlet[vertex] = meshletIndex;
+				for (auto i = offsets[vertex]; i < offsets[vertex + 1]; ++i)
+				{
+					if (!used[adjacency[i]])
+					{
+						frontier.push_back(adjacency[i]);
+					}
+				}
+			}
+		}
+
+		meshlet.indexCount = static_cast<std::uint32_t>(result.indices.size()) - meshlet.indexOffset;
+		computeMeshletBounds(mesh, result.indices, meshlet);
+		result.meshlets.push_back(meshlet);
+	}
+	return result;
+}
+
+void cullMeshlets(const MeshletMesh & mesh, const Frustum & frustum, const glm::vec3 & cameraPosition,
+				  const MeshletCullOptions & options, MeshletDrawList & result)
+{
+	const auto & meshlets = mesh.meshlets;
+
+	// Culling writes flags in parallel, ranges are merged afterwards in order.
+	auto & visible = result.visibility;
+	visible.resize(meshlets.size());
+	parallelFor(meshlets.size(), g_cullGrain, [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			const auto & meshlet = meshlets[i];
+			auto isVisible = !options.frustum || frustum.intersects(meshlet.bounds);
+			if (isVisible && options.backfaceCone && meshlet.coneCutoff <= 1.f)
+			{
+				const auto direction = meshlet.bounds.center - cameraPosition;
+				const auto distance = glm::length(direction);
+				isVisible = glm::dot(direction, meshlet.coneAxis) < meshlet.coneCutoff * distance + meshlet.bounds.radius;
+			}
+			visible[i] = isVisible ? 1u : 0u;
+		}
+	});
+
+	result.counts.clear();
+	result.offsets.clear();
+	result.visibleMeshlets = 0;
+	result.triangles = 0;
+
+	std::size_t rangeEnd = g_invalid;
+	for (std::size_t i = 0; i < meshlets.size(); ++i)
+	{
+		if (!visible[i])
+		{
+			continue;
+		}
+		const auto & meshlet = meshlets[i];
+		++result.visibleMeshlets;
+		result.triangles += meshlet.indexCount / 3u;
+		if (rangeEnd == meshlet.indexOffset)
+		{
+			result.counts.back() += static_cast<GLsizei>(meshlet.indexCount);
+		}
+		else
+		{
+			result.counts.push_back(static_cast<GLsizei>(meshlet.indexCount));
+			result.offsets.push_back(reinterpret_cast<const void *>(meshlet.indexOffset * sizeof(std::uint32_t)));
+		}
+		rangeEnd = meshlet.indexOffset + meshlet.indexCount;
+	}
+}
+
+std::size_t countVisibleTriangles(const Mesh & mesh, const Frustum & frustum, const glm::vec3 & cameraPosition)
+{
+	std::atomic<std::size_t> total{0};
+	parallelFor(mesh.triangleCount(), g_cullGrain * 16, [&](const std::size_t begin, const std::size_t end) {
+		std::size_t count = 0;
+		for (auto triangle = begin; triangle < end; ++triangle)
+		{
+			const auto * corners = &mesh.indices[triangle * 3];
+			const auto & p0 = mesh.positions[corners[0]];
+			const auto & p1 = mesh.positions[corners[1]];
+			const auto & p2 = mesh.positions[corners[2]];
+			if (glm::dot(glm::cross(p1 - p0, p2 - p0), cameraPosition - p0) <= 0.f)
+			{
+				continue;
+			}
+			const auto outside = std::any_of(frustum.planes.begin(), frustum.planes.end(), [&](const glm::vec4 & plane) {
+				const glm::vec3 normal{plane};
+				return glm::dot(normal, p0) + plane.w < 0.f && glm::dot(normal, p1) + plane.w < 0.f && glm::dot(normal, p2) + plane.w < 0.f;
+			});
+			count += outside ? 0u : 1u;
+		}
+		total += count;
+	});
+	return total;
+}
+
+}// namespace fgl
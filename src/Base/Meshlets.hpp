@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Base/Frustum.hpp>
+#include <Base/Mesh.hpp>
+
+#include <QOpenGLFunctions>
+
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+struct Meshlet
+{
+	// Range of meshlet triangles in reordered index buffer.
+	std::uint32_t indexOffset = 0;
+	std::uint32_t indexCount = 0;
+
+	BoundingSphere bounds;
+
+	// Normal cone, all triangle normals are within cutoff of axis.
+	// Cutoff greater than one means cone is too wide to ever be culled.
+	glm::vec3 coneAxis{0.f, 0.f, 1.f};
+	float coneCutoff = 2.f;
+};
+
+struct MeshletOptions
+{
+	std::size_t maxVertices = 64;
+	std::size_t maxTriangles = 124;
+};
+
+struct MeshletMesh
+{
+	std::vector<Meshlet> meshlets;
+	// Source mesh indices reordered so that each meshlet is contiguous.
+	std::vector<std::uint32_t> indices;
+};
+
+// Greedily grows meshlets over triangle adjacency.
+MeshletMesh buildMeshlets(const Mesh & mesh, const MeshletOptions & options = {});
+
+struct MeshletCullOptions
+{
+	bool frustum = true;
+	bool backfaceCone = true;
+};
+
+// Index ranges ready for glMultiDrawElements, adjacent visible meshlets are merged.
+struct MeshletDrawList
+{
+	std::vector<GLsizei> counts;
+	std::vector<const void *> offsets;
+
+	std::size_t visibleMeshlets = 0;
+	std::size_t triangles = 0;
+
+	// Per meshlet culling results, kept between frames to avoid allocations.
+	std::vector<std::uint8_t> visibility;
+};
+
+// Culls meshlets in parallel. Frustum and camera position are in mesh object space.
+void cullMeshlets(const MeshletMesh & mesh, const Frustum & frustum, const glm::vec3 & cameraPosition,
+				  const MeshletCullOptions & options, MeshletDrawList & result);
+
+// Exact number of front facing triangles not outside the frustum, used to measure culling efficiency.
+std::size_t countVisibleTriangles(const Mesh & mesh, const Frustum & frustum, const glm::vec3 & cameraPosition);
+
+}// namespace fgl
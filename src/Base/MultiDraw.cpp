@@ -0,0 +1,163 @@
+#include "MultiDraw.hpp"
+
+#include <QOpenGLContext>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::size_t g_initialDrawIds = 4096;
+constexpr std::size_t g_texelsPerDraw = 4;
+
+bool hasIndirectMultiDraw(const QOpenGLContext & context)
+{
+	// Base instance field of indirect commands came with GL 4.2
+	const auto format = context.format();
+	const auto version = format.majorVersion() * 10 + format.minorVersion();
+	return version >= 43
+		|| (context.hasExtension("GL_ARB_multi_draw_indirect") && (version >= 42 || context.hasExtension("GL_ARB_base_instance")));
+}
+
+}// namespace
+
+void MultiDrawSubmitter::create(QOpenGLFunctions_3_3_Core & gl, const MeshPool & pool)
+{
+	gl_ = &gl;
+	pool_ = &pool;
+
+	GLint maxTexels = 0;
+	gl_->glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	maxDraws_ = static_cast<std::size_t>(maxTexels) / g_texelsPerDraw;
+
+	const auto * context = QOpenGLContext::currentContext();
+	if (hasIndirectMultiDraw(*context))
+	{
+		multiDrawIndirect_ = reinterpret_cast<MultiDrawElementsIndirect>(context->getProcAddress("glMultiDrawElementsIndirect"));
+	}
+	if (!supportsIndirect())
+	{
+		return;
+	}
+
+	gl_->glGenBuffers(1, &indirectBuffer_);
+	gl_->glGenBuffers(1, &drawIdBuffer_);
+	reserveDrawIds(g_initialDrawIds);
+
+	// Draw index is instance index of draw's single instance offset by base instance
+	gl_->glBindVertexArray(pool.vertexArray());
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer_);
+	gl_->glEnableVertexAttribArray(drawIdLocation);
+	gl_->glVertexAttribIPointer(drawIdLocation, 1, GL_UNSIGNED_INT, 0, nullptr);
+	gl_->glVertexAttribDivisor(drawIdLocation, 1);
+	gl_->glBindVertexArray(0);
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MultiDrawSubmitter::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	gl_->glDeleteBuffers(1, &indirectBuffer_);
+	gl_->glDeleteBuffers(1, &drawIdBuffer_);
+	indirectBuffer_ = 0;
+	drawIdBuffer_ = 0;
+	drawIdCapacity_ = 0;
+	multiDrawIndirect_ = nullptr;
+	maxDraws_ = 0;
+}
+
+void MultiDrawSubmitter::add(const std::size_t mesh)
+{
+	const auto & range = pool_->range(mesh);
+	DrawElementsIndirectCommand command;
+	command.count = range.indexCount;
+	command.instanceCount = 1;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	command.baseInstance = static_cast<GLuint>(commands_.size());
+	commands_.push_back(command);
+}
+
+void MultiDrawSubmitter::reserveDrawIds(const std::size_t count)
+{
+	if (count <= drawIdCapacity_)
+	{
+		return;
+	}
+	drawIdCapacity_ = std::max(count, drawIdCapacity_ * 2);
+	std::vector<GLuint> drawIds(drawIdCapacity_);
+	std::iota(drawIds.begin(), drawIds.end(), GLuint{0});
+
+	// Vertex array refers to buffer object, so reallocated storage needs no new pointer
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer_);
+	gl_->glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(drawIds.size() * sizeof(GLuint)), drawIds.data(), GL_STATIC_DRAW);
+	gl_->glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MultiDrawSubmitter::submitIndirect()
+{
+	calls_ = 0;
+	if (commands_.empty() || !supportsIndirect())
+	{
+		return;
+	}
+	Q_ASSERT_X(commands_.size() <= maxDraws_, "MultiDrawSubmitter::submitIndirect", "draws exceed texture buffer limit");
+	reserveDrawIds(commands_.size());
+
+	// Orphan storage so driver does not wait for commands of previous frames
+	const auto bytes = static_cast<GLsizeiptr>(commands_.size() * sizeof(DrawElementsIndirectCommand));
+	gl_->glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer_);
+	gl_->glBufferData(GL_DRAW_INDIRECT_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+	gl_->glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, bytes, commands_.data());
+
+	gl_->glBindVertexArray(pool_->vertexArray());
+	multiDrawIndirect_(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(commands_.size()), 0);
+	gl_->glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	calls_ = 1;
+}
+
+void MultiDrawSubmitter::submitBaseVertex(const GLint vertexStrideUniform, const GLint drawOffsetUniform)
+{
+	calls_ = 0;
+	const auto stride = pool_->vertexCount();
+	if (commands_.empty() || stride == 0 || !pool_->supportsPulling())
+	{
+		return;
+	}
+	Q_ASSERT_X(commands_.size() <= maxDraws_, "MultiDrawSubmitter::submitBaseVertex", "draws exceed texture buffer limit");
+
+	// gl_VertexID = index + base vertex must fit in int, larger lists are split into calls
+	const auto drawsPerCall = static_cast<std::size_t>((std::numeric_limits<GLint>::max() - stride) / stride);
+
+	gl_->glBindVertexArray(pool_->pullVertexArray());
+	gl_->glUniform1i(vertexStrideUniform, stride);
+	for (std::size_t first = 0; first < commands_.size(); first += drawsPerCall)
+	{
+		const auto count = std::min(drawsPerCall, commands_.size() - first);
+		counts_.resize(count);
+		offsets_.resize(count);
+		baseVertices_.resize(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const auto & command = commands_[first + i];
+			counts_[i] = static_cast<GLsizei>(command.count);
+			offsets_[i] = reinterpret_cast<const void *>(command.firstIndex * sizeof(std::uint32_t));
+			baseVertices_[i] = command.baseVertex + static_cast<GLint>(i) * stride;
+		}
+		gl_->glUniform1i(drawOffsetUniform, static_cast<GLint>(first));
+		gl_->glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts_.data(), GL_UNSIGNED_INT, offsets_.data(),
+										   static_cast<GLsizei>(count), baseVertices_.data());
+		++calls_;
+	}
+}
+
+}// namespace fgl
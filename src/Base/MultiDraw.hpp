@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Base/MeshPool.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// Record layout read by glMultiDrawElementsIndirect.
+struct DrawElementsIndirectCommand
+{
+	GLuint count = 0;
+	GLuint instanceCount = 0;
+	GLuint firstIndex = 0;
+	GLint baseVertex = 0;
+	GLuint baseInstance = 0;
+};
+
+// Submits thousands of draws of pool meshes with few GL calls. Draw i finds its data at
+// index i of per draw buffers filled by caller in order of add() calls.
+// - Indirect path writes commands into indirect buffer for one glMultiDrawElementsIndirect.
+//   Draw index comes through base instance as instanced attribute at drawIdLocation of
+//   pool vertex array. Needs GL 4.3 or ARB_multi_draw_indirect with ARB_base_instance.
+// - Base vertex path for GL 3.3, which has neither draw id nor base instance, offsets base
+//   vertex of draw i by i * pool vertex count in glMultiDrawElementsBaseVertex. Shaders
+//   pull vertices from pool vertex texture and split gl_VertexID into vertex and draw
+//   index with vertexStride and drawOffset uniforms.
+// Per draw data read from buffer texture is limited by GL_MAX_TEXTURE_BUFFER_SIZE, both
+// paths need size() <= maxDraws().
+class MultiDrawSubmitter
+{
+public:
+	static constexpr GLuint drawIdLocation = 3;
+
+public:
+	// Requires current OpenGL context, pool must outlive submitter.
+	void create(QOpenGLFunctions_3_3_Core & gl, const MeshPool & pool);
+	void destroy();
+
+	bool supportsIndirect() const { return multiDrawIndirect_ != nullptr; }
+	// Draws whose model matrices, four texels each, fit buffer texture.
+	std::size_t maxDraws() const { return maxDraws_; }
+
+	void clear() { commands_.clear(); }
+	void add(std::size_t mesh);
+	std::size_t size() const { return commands_.size(); }
+
+	// Program must be bound, binds pool vertex array and leaves it bound.
+	void submitIndirect();
+	// Program must be bound, binds pool vertex array for pulling and leaves it bound.
+	void submitBaseVertex(GLint vertexStrideUniform, GLint drawOffsetUniform);
+
+	// GL draw calls issued by the last submit.
+	std::size_t calls() const { return calls_; }
+
+private:
+	using MultiDrawElementsIndirect = void(QOPENGLF_APIENTRYP)(GLenum mode, GLenum type, const void * indirect, GLsizei drawCount, GLsizei stride);
+
+private:
+	void reserveDrawIds(std::size_t count);
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+	const MeshPool * pool_ = nullptr;
+	MultiDrawElementsIndirect multiDrawIndirect_ = nullptr;
+	std::size_t maxDraws_ = 0;
+
+	std::vector<DrawElementsIndirectCommand> commands_;
+	GLuint indirectBuffer_ = 0;
+	GLuint drawIdBuffer_ = 0;
+	std::size_t drawIdCapacity_ = 0;
+
+	// Arrays of base vertex path.
+	std::vector<GLsizei> counts_;
+	std::vector<const void *> offsets_;
+	std::vector<GLint> baseVertices_;
+
+	std::size_t calls_ = 0;
+};
+
+}// namespace fgl
@@ -0,0 +1,111 @@
+#include "ObjLoader.hpp"
+
+#include <QDebug>
+#include <QFile>
+
+#include <cstdlib>
+#include <string>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Resolves 1 based or negative relative OBJ index, returns false for invalid ones.
+bool resolveIndex(const long index, const std::size_t vertexCount, std::uint32_t & result)
+{
+	const auto count = static_cast<long>(vertexCount);
+	const auto resolved = index > 0 ? index - 1 : count + index;
+	if (index == 0 || resolved < 0 || resolved >= count)
+	{
+		return false;
+	}
+	result = static_cast<std::uint32_t>(resolved);
+	return true;
+}
+
+}// namespace
+
+std::optional<Mesh> loadObj(const QString & path, const glm::vec3 & color)
+{
+	QFile file{path};
+	if (!file.open(QFile::ReadOnly))
+	{
+		qWarning() << "Failed to open" << path << file.errorString();
+		return std::nullopt;
+	}
+	const auto data = file.readAll();
+
+	Mesh mesh;
+	std::vector<std::uint32_t> face;
+	const auto * cursor = data.constData();
+	const auto * const end = cursor + data.size();
+	while (cursor < end)
+	{
+		const auto * lineEnd = cursor;
+		while (lineEnd < end && *lineEnd != '\n')
+		{
+			++lineEnd;
+		}
+		// Numbers are parsed with strtof and strtol which stop at whitespace and slashes.
+		const std::string line{cursor, lineEnd};
+		cursor = lineEnd + 1;
+
+		if (line.size() > 2 && line[0] == 'v' && line[1] == ' ')
+		{
+			char * next = nullptr;
+			glm::vec3 position;
+			position.x = std::strtof(line.c_str() + 2, &next);
+			position.y = std::strtof(next, &next);
+			position.z = std::strtof(next, &next);
+			mesh.positions.push_back(position);
+		}
+		else if (line.size() > 2 && line[0] == 'f' && line[1] == ' ')
+		{
+			face.clear();
+			const auto * token = line.c_str() + 2;
+			while (*token)
+			{
+				char * next = nullptr;
+				const auto index = std::strtol(token, &next, 10);
+				if (next == token)
+				{
+					break;
+				}
+				std::uint32_t vertex = 0;
+				if (!resolveIndex(index, mesh.positions.size(), vertex))
+				{
+					qWarning() << "Invalid face index in" << path;
+					return std::nullopt;
+				}
+				face.push_back(vertex);
+				// Skip texture coordinate and normal indices.
+				token = next;
+				while (*token && *token != ' ' && *token != '\t' && *token != '\r')
+				{
+					++token;
+				}
+				while (*token == ' ' || *token == '\t' || *token == '\r')
+				{
+					++token;
+				}
+			}
+			for (std::size_t i = 2; i < face.size(); ++i)
+			{
+				mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
+			}
+		}
+	}
+
+	if (mesh.indices.empty())
+	{
+		qWarning() << "No faces in" << path;
+		return std::nullopt;
+	}
+	computeNormals(mesh);
+	mesh.colors.assign(mesh.positions.size(), color);
+	return mesh;
+}
+
+}// namespace fgl
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Base/Mesh.hpp>
+
+#include <QString>
+
+#include <optional>
+
+namespace fgl
+{
+
+// Loads positions and faces from Wavefront OBJ file, polygons are triangulated as fans.
+// Normals are recalculated, colors are set to the given one. Returns nothing on failure.
+std::optional<Mesh> loadObj(const QString & path, const glm::vec3 & color = glm::vec3{0.8f});
+
+}// namespace fgl
@@ -0,0 +1,351 @@
+#include "OcclusionCuller.hpp"
+
+#include <Base/ParallelFor.hpp>
+#include <Base/Simd.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace fgl
+{
+
+namespace
+{
+
+static_assert(OcclusionCuller::tileSize % simd::width == 0, "tile row must be whole SIMD registers");
+
+// Relative depth tolerance so occluder surfaces never hide their own boxes.
+constexpr auto g_depthBias = 1e-4f;
+constexpr std::size_t g_occluderGrain = 16;
+constexpr std::size_t g_testGrain = 256;
+
+std::size_t roundUpToTile(const std::size_t size)
+{
+	return std::max<std::size_t>((size + OcclusionCuller::tileSize - 1) / OcclusionCuller::tileSize, 1u)
+		* OcclusionCuller::tileSize;
+}
+
+// Clips polygon by near plane z + w >= 0, returns number of output vertices.
+std::size_t clipNear(const std::array<glm::vec4, 3u> & input, std::array<glm::vec4, 4u> & output)
+{
+	std::size_t count = 0;
+	for (std::size_t i = 0; i < input.size(); ++i)
+	{
+		const auto & current = input[i];
+		const auto & next = input[(i + 1) % input.size()];
+		const auto currentDistance = current.z + current.w;
+		const auto nextDistance = next.z + next.w;
+		if (currentDistance >= 0.f)
+		{
+			output[count++] = current;
+		}
+		if ((currentDistance >= 0.f) != (nextDistance >= 0.f))
+		{
+			const auto t = currentDistance / (currentDistance - nextDistance);
+			output[count++] = current + (next - current) * t;
+		}
+	}
+	return count;
+}
+
+}// namespace
+
+OcclusionCuller::OcclusionCuller(const std::size_t width, const std::size_t height)
+{
+	resize(width, height);
+}
+
+void OcclusionCuller::resize(const std::size_t width, const std::size_t height)
+{
+	width_ = roundUpToTile(width);
+	height_ = roundUpToTile(height);
+	tilesX_ = width_ / tileSize;
+	tilesY_ = height_ / tileSize;
+	depth_.assign(width_ * height_, 0.f);
+	tileDepth_.assign(tilesX_ * tilesY_, 0.f);
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4 & viewProj)
+{
+	viewProj_ = viewProj;
+	occluders_.clear();
+	triangles_.clear();
+	std::fill(depth_.begin(), depth_.end(), 0.f);
+	std::fill(tileDepth_.begin(), tileDepth_.end(), 0.f);
+}
+
+void OcclusionCuller::addOccluder(const Mesh & mesh, const glm::mat4 & model)
+{
+	occluders_.push_back({&mesh, viewProj_ * model});
+}
+
+void OcclusionCuller::rasterize()
+{
+	// Triangle setup, order of triangles does not change result
+	std::mutex mutex;
+	parallelFor(occluders_.size(), g_occluderGrain, [&](const std::size_t begin, const std::size_t end) {
+		std::vector<Triangle> triangles;
+		for (auto i = begin; i < end; ++i)
+		{
+			setupTriangles(occluders_[i], triangles);
+		}
+		const std::lock_guard lock{mutex};
+		triangles_.insert(triangles_.end(), triangles.begin(), triangles.end());
+	});
+
+	// Tile rows are independent so each of them is rasterized by one thread
+	parallelFor(tilesY_, 1, [&](const std::size_t begin, const std::size_t end) {
+		for (auto tileY = begin; tileY < end; ++tileY)
+		{
+			rasterizeTileRow(tileY);
+		}
+	});
+}
+
+void OcclusionCuller::setupTriangles(const Occluder & occluder, std::vector<Triangle> & triangles) const
+{
+	const auto & mesh = *occluder.mesh;
+	std::vector<glm::vec4> clip(mesh.positions.size());
+	for (std::size_t i = 0; i < clip.size(); ++i)
+	{
+		clip[i] = occluder.modelViewProj * glm::vec4{mesh.positions[i], 1.f};
+	}
+
+	for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		const std::array<glm::vec4, 3u> vertices{clip[mesh.indices[i]], clip[mesh.indices[i + 1]], clip[mesh.indices[i + 2]]};
+
+		// Trivially reject triangles outside of one frustum plane, far plane is ignored
+		const auto outside = [&](const auto & predicate) {
+			return std::all_of(vertices.begin(), vertices.end(), predicate);
+		};
+		if (outside([](const auto & v) { return v.x > v.w; }) || outside([](const auto & v) { return v.x < -v.w; })
+			|| outside([](const auto & v) { return v.y > v.w; }) || outside([](const auto & v) { return v.y < -v.w; })
+			|| outside([](const auto & v) { return v.z < -v.w; }))
+		{
+			continue;
+		}
+
+		if (std::all_of(vertices.begin(), vertices.end(), [](const auto & v) { return v.z + v.w >= 0.f; }))
+		{
+			addTriangle(vertices[0], vertices[1], vertices[2], triangles);
+			continue;
+		}
+		std::array<glm::vec4, 4u> clipped;
+		const auto count = clipNear(vertices, clipped);
+		for (std::size_t j = 2; j < count; ++j)
+		{
+			addTriangle(clipped[0], clipped[j - 1], clipped[j], triangles);
+		}
+	}
+}
+
+void OcclusionCuller::addTriangle(const glm::vec4 & v0, const glm::vec4 & v1, const glm::vec4 & v2,
+								  std::vector<Triangle> & triangles) const
+{
+	const glm::vec2 scale{static_cast<float>(width_) * 0.5f, static_cast<float>(height_) * 0.5f};
+	const auto toScreen = [&](const glm::vec4 & v) {
+		const auto inverseW = 1.f / v.w;
+		return glm::vec3{(glm::vec2{v} * inverseW + 1.f) * scale, inverseW};
+	};
+	const std::array<glm::vec3, 3u> screen{toScreen(v0), toScreen(v1), toScreen(v2)};
+
+	Triangle triangle;
+	for (std::size_t i = 0; i < 3; ++i)
+	{
+		const auto & from = screen[i];
+		const auto & to = screen[(i + 1) % 3];
+		triangle.edgeA[i] = from.y - to.y;
+		triangle.edgeB[i] = to.x - from.x;
+		triangle.edgeC[i] = from.x * to.y - from.y * to.x;
+	}
+	// Twice the signed area, non positive for back faces and degenerate triangles
+	const auto area = triangle.edgeA[0] * screen[2].x + triangle.edgeB[0] * screen[2].y + triangle.edgeC[0];
+	if (area <= 0.f)
+	{
+		return;
+	}
+
+	const auto minCorner = glm::min(screen[0], glm::min(screen[1], screen[2]));
+	const auto maxCorner = glm::max(screen[0], glm::max(screen[1], screen[2]));
+	// Pixels with centers inside of the bounding box
+	triangle.minX = std::max(static_cast<int>(std::ceil(minCorner.x - 0.5f)), 0);
+	triangle.maxX = std::min(static_cast<int>(std::floor(maxCorner.x - 0.5f)), static_cast<int>(width_) - 1);
+	triangle.minY = std::max(static_cast<int>(std::ceil(minCorner.y - 0.5f)), 0);
+	triangle.maxY = std::min(static_cast<int>(std::floor(maxCorner.y - 0.5f)), static_cast<int>(height_) - 1);
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+	{
+		return;
+	}
+
+	// Depth is linear in screen space, weights of vertices are edge functions of opposite edges
+	const glm::vec3 vertexDepth{screen[0].z, screen[1].z, screen[2].z};
+	const glm::vec3 weights = glm::vec3{vertexDepth[2], vertexDepth[0], vertexDepth[1]} / area;
+	triangle.depth = {glm::dot(triangle.edgeA, weights), glm::dot(triangle.edgeB, weights), glm::dot(triangle.edgeC, weights)};
+	triangles.push_back(triangle);
+}
+
+void OcclusionCuller::rasterizeTileRow(const std::size_t tileY)
+{
+	const auto rowBegin = static_cast<int>(tileY * tileSize);
+	const auto rowEnd = rowBegin + static_cast<int>(tileSize) - 1;
+	const auto laneOffsets = simd::sequence(0.5f);
+	const auto zero = simd::broadcast(0.f);
+
+	for (const auto & triangle: triangles_)
+	{
+		const auto minY = std::max(triangle.minY, rowBegin);
+		const auto maxY = std::min(triangle.maxY, rowEnd);
+		if (minY > maxY)
+		{
+			continue;
+		}
+		const auto a0 = simd::broadcast(triangle.edgeA[0]);
+		const auto a1 = simd::broadcast(triangle.edgeA[1]);
+		const auto a2 = simd::broadcast(triangle.edgeA[2]);
+		const auto depthA = simd::broadcast(triangle.depth.x);
+		const auto firstX = triangle.minX / static_cast<int>(simd::width) * static_cast<int>(simd::width);
+
+		for (auto y = minY; y <= maxY; ++y)
+		{
+			const auto centerY = static_cast<float>(y) + 0.5f;
+			const auto row0 = simd::broadcast(triangle.edgeB[0] * centerY + triangle.edgeC[0]);
+			const auto row1 = simd::broadcast(triangle.edgeB[1] * centerY + triangle.edgeC[1]);
+			const auto row2 = simd::broadcast(triangle.edgeB[2] * centerY + triangle.edgeC[2]);
+			const auto rowDepth = simd::broadcast(triangle.depth.y * centerY + triangle.depth.z);
+			auto * row = depth_.data() + static_cast<std::size_t>(y) * width_;
+
+			for (auto x = firstX; x <= triangle.maxX; x += static_cast<int>(simd::width))
+			{
+				const auto centerX = simd::broadcast(static_cast<float>(x)) + laneOffsets;
+				const auto inside = (a0 * centerX + row0 >= zero) & (a1 * centerX + row1 >= zero) & (a2 * centerX + row2 >= zero);
+				if (!simd::any(inside))
+				{
+					continue;
+				}
+				const auto depth = depthA * centerX + rowDepth;
+				const auto current = simd::load(row + x);
+				simd::store(row + x, simd::select(inside, simd::max(current, depth), current));
+			}
+		}
+	}
+
+	// Update farthest depth of tiles in the row
+	for (std::size_t tileX = 0; tileX < tilesX_; ++tileX)
+	{
+		auto farthest = simd::broadcast(std::numeric_limits<float>::max());
+		for (std::size_t y = 0; y < tileSize; ++y)
+		{
+			const auto * row = depth_.data() + (tileY * tileSize + y) * width_ + tileX * tileSize;
+			for (std::size_t x = 0; x < tileSize; x += simd::width)
+			{
+				farthest = simd::min(farthest, simd::load(row + x));
+			}
+		}
+		alignas(32) float lanes[simd::width];
+		simd::store(lanes, farthest);
+		tileDepth_[tileY * tilesX_ + tileX] = *std::min_element(lanes, lanes + simd::width);
+	}
+}
+
+bool OcclusionCuller::isVisible(const Aabb & box) const
+{
+	glm::vec2 minCorner{std::numeric_limits<float>::max()};
+	glm::vec2 maxCorner{std::numeric_limits<float>::lowest()};
+	auto nearestDepth = 0.f;
+	for (auto corner = 0; corner < 8; ++corner)
+	{
+		const glm::vec3 point{corner & 1 ? box.max.x : box.min.x, corner & 2 ? box.max.y : box.min.y,
+							  corner & 4 ? box.max.z : box.min.z};
+		const auto clip = viewProj_ * glm::vec4{point, 1.f};
+		if (clip.z < -clip.w)
+		{
+			// Box crosses near plane
+			return true;
+		}
+		const auto inverseW = 1.f / clip.w;
+		const auto ndc = glm::vec2{clip} * inverseW;
+		minCorner = glm::min(minCorner, ndc);
+		maxCorner = glm::max(maxCorner, ndc);
+		nearestDepth = std::max(nearestDepth, inverseW);
+	}
+	if (maxCorner.x < -1.f || maxCorner.y < -1.f || minCorner.x > 1.f || minCorner.y > 1.f)
+	{
+		return false;
+	}
+
+	// All pixels touched by the screen rectangle
+	const glm::vec2 scale{static_cast<float>(width_) * 0.5f, static_cast<float>(height_) * 0.5f};
+	const auto toPixel = [&](const float ndc, const float scale, const std::size_t size) {
+		return std::clamp(static_cast<int>(std::floor((ndc + 1.f) * scale)), 0, static_cast<int>(size) - 1);
+	};
+	const auto minX = toPixel(minCorner.x, scale.x, width_);
+	const auto maxX = toPixel(maxCorner.x, scale.x, width_);
+	const auto minY = toPixel(minCorner.y, scale.y, height_);
+	const auto maxY = toPixel(maxCorner.y, scale.y, height_);
+
+	// Box is visible when any pixel of the rectangle is farther than its nearest point
+	const auto testDepth = nearestDepth * (1.f + g_depthBias);
+	const auto simdTestDepth = simd::broadcast(testDepth);
+	const auto laneOffsets = simd::sequence(0.f);
+	const auto tile = static_cast<int>(tileSize);
+	for (auto tileY = minY / tile; tileY <= maxY / tile; ++tileY)
+	{
+		for (auto tileX = minX / tile; tileX <= maxX / tile; ++tileX)
+		{
+			if (tileDepth_[static_cast<std::size_t>(tileY) * tilesX_ + static_cast<std::size_t>(tileX)] >= testDepth)
+			{
+				continue;
+			}
+			const auto beginX = tileX * tile;
+			const auto beginY = tileY * tile;
+			if (beginX >= minX && beginX + tile - 1 <= maxX && beginY >= minY && beginY + tile - 1 <= maxY)
+			{
+				return true;
+			}
+
+			const auto rangeMin = simd::broadcast(static_cast<float>(minX));
+			const auto rangeMax = simd::broadcast(static_cast<float>(maxX));
+			for (auto y = std::max(beginY, minY); y <= std::min(beginY + tile - 1, maxY); ++y)
+			{
+				const auto * row = depth_.data() + static_cast<std::size_t>(y) * width_;
+				for (auto x = beginX; x < beginX + tile; x += static_cast<int>(simd::width))
+				{
+					const auto pixelX = simd::broadcast(static_cast<float>(x)) + laneOffsets;
+					const auto farther = (simd::load(row + x) < simdTestDepth) & (pixelX >= rangeMin) & (pixelX <= rangeMax);
+					if (simd::any(farther))
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+void OcclusionCuller::filterVisible(const std::vector<Aabb> & boxes, std::vector<std::uint32_t> & candidates)
+{
+	visibility_.resize(candidates.size());
+	parallelFor(candidates.size(), g_testGrain, [&](const std::size_t begin, const std::size_t end) {
+		for (auto i = begin; i < end; ++i)
+		{
+			visibility_[i] = isVisible(boxes[candidates[i]]) ? 1u : 0u;
+		}
+	});
+
+	std::size_t count = 0;
+	for (std::size_t i = 0; i < candidates.size(); ++i)
+	{
+		if (visibility_[i] != 0u)
+		{
+			candidates[count++] = candidates[i];
+		}
+	}
+	candidates.resize(count);
+}
+
+}// namespace fgl
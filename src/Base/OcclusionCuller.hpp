@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/Mesh.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// Software occlusion culling. Selected occluders are rasterized into low resolution
+// depth buffer on worker threads, SIMD lanes covered by triangle are written with
+// masked stores. Buffer is split into 8x8 tiles keeping the farthest depth, so
+// occludee boxes are mostly tested per tile. Depth is stored as 1 / w, zero is empty.
+class OcclusionCuller
+{
+public:
+	static constexpr std::size_t tileSize = 8;
+
+public:
+	// Size is rounded up to whole tiles.
+	explicit OcclusionCuller(std::size_t width = 256, std::size_t height = 128);
+
+	void resize(std::size_t width, std::size_t height);
+	std::size_t width() const { return width_; }
+	std::size_t height() const { return height_; }
+
+	// Clears depth buffer and queued occluders, sets camera for the frame.
+	void beginFrame(const glm::mat4 & viewProj);
+
+	// Queues mesh as occluder, mesh must be closed with counter clockwise front faces
+	// and stay alive until rasterize.
+	void addOccluder(const Mesh & mesh, const glm::mat4 & model);
+
+	// Rasterizes queued occluders.
+	void rasterize();
+
+	// Returns false when box is surely hidden by occluders or out of screen.
+	bool isVisible(const Aabb & box) const;
+
+	// Removes hidden objects from candidates keeping order, tests run on worker threads.
+	void filterVisible(const std::vector<Aabb> & boxes, std::vector<std::uint32_t> & candidates);
+
+	std::size_t occluderCount() const { return occluders_.size(); }
+	// Triangles left after clipping and back face culling in the last rasterize.
+	std::size_t rasterizedTriangles() const { return triangles_.size(); }
+
+	// Row major depth values, first row is the bottom one.
+	const std::vector<float> & depth() const { return depth_; }
+
+private:
+	struct Occluder
+	{
+		const Mesh * mesh;
+		glm::mat4 modelViewProj;
+	};
+
+	// Screen space triangle prepared for rasterization.
+	struct Triangle
+	{
+		// Edge functions a * x + b * y + c are non negative inside.
+		glm::vec3 edgeA;
+		glm::vec3 edgeB;
+		glm::vec3 edgeC;
+		// Depth plane.
+		glm::vec3 depth;
+		int minX, maxX;
+		int minY, maxY;
+	};
+
+private:
+	void setupTriangles(const Occluder & occluder, std::vector<Triangle> & triangles) const;
+	void addTriangle(const glm::vec4 & v0, const glm::vec4 & v1, const glm::vec4 & v2, std::vector<Triangle> & triangles) const;
+	void rasterizeTileRow(std::size_t tileY);
+
+private:
+	std::size_t width_ = 0;
+	std::size_t height_ = 0;
+	std::size_t tilesX_ = 0;
+	std::size_t tilesY_ = 0;
+
+	glm::mat4 viewProj_{1.f};
+
+	std::vector<Occluder> occluders_;
+	std::vector<Triangle> triangles_;
+
+	std::vector<float> depth_;
+	// Farthest depth in each tile.
+	std::vector<float> tileDepth_;
+
+	std::vector<std::uint8_t> visibility_;
+};
+
+}// namespace fgl
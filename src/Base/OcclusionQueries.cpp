@@ -0,0 +1,221 @@
+#include "OcclusionQueries.hpp"
+
+#include <Base/MeshPrimitives.hpp>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Boxes closer than this to camera may be clipped by near plane and are assumed visible.
+constexpr auto g_cameraMargin = 0.5f;
+
+constexpr auto g_boxVertexShader = R"(#version 330 core
+layout(location = 0) in vec3 position;
+
+uniform mat4 viewProj;
+uniform vec3 boxCenter;
+uniform vec3 boxSize;
+
+void main()
+{
+	gl_Position = viewProj * vec4(boxCenter + position * boxSize, 1.0);
+}
+)";
+
+constexpr auto g_boxFragmentShader = R"(#version 330 core
+out vec4 fragColor;
+
+void main()
+{
+	fragColor = vec4(1.0);
+}
+)";
+
+}// namespace
+
+void OcclusionQueries::create(QOpenGLFunctions_3_3_Core & gl, const std::size_t objectCount)
+{
+	gl_ = &gl;
+
+	boxProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	boxProgram_->addShaderFromSourceCode(QOpenGLShader::Vertex, g_boxVertexShader);
+	boxProgram_->addShaderFromSourceCode(QOpenGLShader::Fragment, g_boxFragmentShader);
+	boxProgram_->link();
+	viewProjUniform_ = boxProgram_->uniformLocation("viewProj");
+	boxCenterUniform_ = boxProgram_->uniformLocation("boxCenter");
+	boxSizeUniform_ = boxProgram_->uniformLocation("boxSize");
+
+	// Unit box around origin
+	box_.create(makeBox(glm::vec3{0.5f}, glm::vec3{1.f}));
+
+	std::vector<GLuint> queries(objectCount);
+	gl_->glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+	objects_.resize(objectCount);
+	for (std::size_t i = 0; i < objectCount; ++i)
+	{
+		objects_[i].query = queries[i];
+	}
+	reset();
+}
+
+void OcclusionQueries::destroy()
+{
+	for (const auto & object: objects_)
+	{
+		gl_->glDeleteQueries(1, &object.query);
+	}
+	objects_.clear();
+	pending_.clear();
+	box_.destroy();
+	boxProgram_.reset();
+}
+
+void OcclusionQueries::reset()
+{
+	for (auto & object: objects_)
+	{
+		object.visible = true;
+		object.pending = false;
+	}
+	pending_.clear();
+}
+
+void OcclusionQueries::beginFrame()
+{
+	++frame_;
+	stats_ = {};
+	auto latencySum = 0.;
+
+	// Queries are checked for availability only, reading unavailable result would stall
+	const auto last = std::remove_if(pending_.begin(), pending_.end(), [&](const std::uint32_t index) {
+		auto & object = objects_[index];
+		GLuint available = GL_FALSE;
+		gl_->glGetQueryObjectuiv(object.query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE)
+		{
+			return false;
+		}
+		GLuint samplesPassed = GL_FALSE;
+		gl_->glGetQueryObjectuiv(object.query, GL_QUERY_RESULT, &samplesPassed);
+		object.visible = samplesPassed != GL_FALSE;
+		object.pending = false;
+
+		++stats_.resultsRead;
+		latencySum += static_cast<double>(frame_ - object.issueFrame);
+		return true;
+	});
+	pending_.erase(last, pending_.end());
+
+	if (stats_.resultsRead != 0)
+	{
+		stats_.averageLatencyFrames = latencySum / static_cast<double>(stats_.resultsRead);
+	}
+}
+
+void OcclusionQueries::beginQuery(const std::uint32_t index)
+{
+	auto & object = objects_[index];
+	gl_->glBeginQuery(GL_ANY_SAMPLES_PASSED, object.query);
+	object.pending = true;
+	object.issueFrame = frame_;
+	pending_.push_back(index);
+	++stats_.queriesIssued;
+}
+
+void OcclusionQueries::beginObject(const std::uint32_t object)
+{
+	const auto interval = std::max(options_.visibleQueryInterval, 1u);
+	objectQueryActive_ = !objects_[object].pending && (frame_ + object) % interval == 0;
+	if (objectQueryActive_)
+	{
+		beginQuery(object);
+	}
+}
+
+void OcclusionQueries::endObject()
+{
+	if (objectQueryActive_)
+	{
+		gl_->glEndQuery(GL_ANY_SAMPLES_PASSED);
+		objectQueryActive_ = false;
+	}
+}
+
+void OcclusionQueries::queryHidden(const glm::mat4 & viewProj, const glm::vec3 & cameraPosition,
+								   const std::vector<std::uint32_t> & objects, const std::vector<Aabb> & boxes)
+{
+	stats_.objectsSkipped += objects.size();
+	if (objects.empty())
+	{
+		return;
+	}
+
+	// Boxes must not change depth buffer, both sides are tested so camera close to box still sees it
+	const auto cullFace = gl_->glIsEnabled(GL_CULL_FACE);
+	gl_->glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	gl_->glDepthMask(GL_FALSE);
+	gl_->glDisable(GL_CULL_FACE);
+
+	boxProgram_->bind();
+	gl_->glUniformMatrix4fv(viewProjUniform_, 1, GL_FALSE, glm::value_ptr(viewProj));
+	box_.bind();
+
+	for (const auto index: objects)
+	{
+		auto & object = objects_[index];
+		if (object.pending)
+		{
+			continue;
+		}
+		const auto & box = boxes[index];
+		if (glm::all(glm::greaterThan(cameraPosition, box.min - g_cameraMargin))
+			&& glm::all(glm::lessThan(cameraPosition, box.max + g_cameraMargin)))
+		{
+			object.visible = true;
+			continue;
+		}
+
+		gl_->glUniform3fv(boxCenterUniform_, 1, glm::value_ptr(box.center()));
+		gl_->glUniform3fv(boxSizeUniform_, 1, glm::value_ptr(box.max - box.min));
+		beginQuery(index);
+		gl_->glDrawElements(GL_TRIANGLES, box_.indexCount(), GL_UNSIGNED_INT, nullptr);
+		gl_->glEndQuery(GL_ANY_SAMPLES_PASSED);
+	}
+
+	box_.release();
+	boxProgram_->release();
+
+	gl_->glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	gl_->glDepthMask(GL_TRUE);
+	if (cullFace)
+	{
+		gl_->glEnable(GL_CULL_FACE);
+	}
+}
+
+bool OcclusionQueries::beginConditional(const std::uint32_t index)
+{
+	const auto & object = objects_[index];
+	if (!object.pending || object.issueFrame != frame_)
+	{
+		return false;
+	}
+	// Waiting happens on GPU only, CPU just records the draw
+	gl_->glBeginConditionalRender(object.query, GL_QUERY_WAIT);
+	++stats_.conditionalDraws;
+	--stats_.objectsSkipped;
+	return true;
+}
+
+void OcclusionQueries::endConditional()
+{
+	gl_->glEndConditionalRender();
+}
+
+}// namespace fgl
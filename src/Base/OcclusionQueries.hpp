@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/GpuMesh.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace fgl
+{
+
+struct OcclusionQueryOptions
+{
+	// Visible objects are queried while drawn once per this number of frames to notice
+	// they got hidden. Objects are spread over frames.
+	std::uint32_t visibleQueryInterval = 8;
+};
+
+struct OcclusionQueryStats
+{
+	std::size_t queriesIssued = 0;
+	// Hidden objects drawn neither directly nor conditionally.
+	std::size_t objectsSkipped = 0;
+	std::size_t conditionalDraws = 0;
+	std::size_t resultsRead = 0;
+	// Average number of frames between issuing query and reading its result.
+	double averageLatencyFrames = 0.;
+};
+
+// GPU occlusion culling with GL_ANY_SAMPLES_PASSED queries. Results are read only when
+// available, so visibility lags one or more frames behind but CPU never waits for GPU.
+// Visibility is kept per object across frames: hidden objects have their boxes queried
+// every frame, visible ones are queried while drawn at an interval.
+//
+// Frame usage:
+//   beginFrame();
+//   visible objects: beginObject(i); draw; endObject();
+//   queryHidden(viewProj, hidden objects, boxes);
+//   big hidden objects: if (beginConditional(i)) { draw; endConditional(); }
+class OcclusionQueries
+{
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl, std::size_t objectCount);
+	void destroy();
+
+	void setOptions(const OcclusionQueryOptions & options) { options_ = options; }
+	const OcclusionQueryOptions & options() const { return options_; }
+
+	// Marks all objects visible and drops pending results.
+	void reset();
+
+	// Reads available query results without waiting and starts new stats.
+	void beginFrame();
+
+	// Visibility by the latest available result, objects start visible.
+	bool isVisible(std::uint32_t object) const { return objects_[object].visible; }
+
+	// Wrap draw of visible object, query is issued when visibility is due to be rechecked.
+	void beginObject(std::uint32_t object);
+	void endObject();
+
+	// Draws boxes of hidden objects with queries, color and depth writes are disabled.
+	// Must be called after visible objects are drawn, binds its own program and VAO.
+	void queryHidden(const glm::mat4 & viewProj, const glm::vec3 & cameraPosition,
+					 const std::vector<std::uint32_t> & objects, const std::vector<Aabb> & boxes);
+
+	// Starts conditional render by box query of this frame, draws in between are skipped
+	// by GPU when box is hidden. Returns false when object was not queried this frame.
+	bool beginConditional(std::uint32_t object);
+	void endConditional();
+
+	const OcclusionQueryStats & stats() const { return stats_; }
+
+private:
+	struct Object
+	{
+		GLuint query = 0;
+		std::uint64_t issueFrame = 0;
+		bool visible = true;
+		bool pending = false;
+	};
+
+private:
+	void beginQuery(std::uint32_t object);
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+	OcclusionQueryOptions options_;
+
+	std::unique_ptr<QOpenGLShaderProgram> boxProgram_ = nullptr;
+	GLint viewProjUniform_ = -1;
+	GLint boxCenterUniform_ = -1;
+	GLint boxSizeUniform_ = -1;
+	GpuMesh box_;
+
+	std::vector<Object> objects_;
+	std::vector<std::uint32_t> pending_;
+	std::uint64_t frame_ = 0;
+	bool objectQueryActive_ = false;
+
+	OcclusionQueryStats stats_;
+};
+
+}// namespace fgl
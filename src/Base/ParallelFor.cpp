@@ -0,0 +1,18 @@
+#include "ParallelFor.hpp"
+
+#include <Base/JobSystem.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace fgl
+{
+
+std::size_t workerCount() { return std::max<std::size_t>(std::thread::hardware_concurrency(), 1u); }
+
+void parallelFor(const std::size_t count, const std::size_t grain, const RangeFunction body)
+{
+	JobSystem::instance().parallelFor(count, grain, body);
+}
+
+}// namespace fgl
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+namespace fgl
+{
+
+// Non owning reference to callable taking range, unlike std::function never allocates.
+// Referenced callable must outlive the reference.
+class RangeFunction
+{
+public:
+	template<typename Function>
+	RangeFunction(const Function & function)
+		: object_(&function)
+		, call_([](const void * object, const std::size_t begin, const std::size_t end) {
+			(*static_cast<const Function *>(object))(begin, end);
+		})
+	{
+	}
+
+	void operator()(const std::size_t begin, const std::size_t end) const { call_(object_, begin, end); }
+
+private:
+	const void * object_;
+	void (*call_)(const void * object, std::size_t begin, std::size_t end);
+};
+
+// Number of threads used by parallel algorithms including calling one.
+std::size_t workerCount();
+
+// Splits [0, count) into ranges of at least grain elements and calls body(begin, end)
+// for them as jobs of the shared job system. Returns when all ranges are processed,
+// calling thread executes jobs meanwhile.
+void parallelFor(std::size_t count, std::size_t grain, RangeFunction body);
+
+}// namespace fgl
@@ -0,0 +1,192 @@
+#include "Parameters.hpp"
+
+#include <QDebug>
+
+#include <cstring>
+
+namespace fgl
+{
+
+namespace
+{
+
+bool acceptsType(const ParameterType type, const GLenum uniformType)
+{
+	switch (type)
+	{
+		case ParameterType::Int:
+			// Samplers are set to texture units
+			return uniformType == GL_INT || uniformType == GL_BOOL || uniformType == GL_SAMPLER_2D || uniformType == GL_SAMPLER_3D
+				|| uniformType == GL_SAMPLER_2D_SHADOW || uniformType == GL_SAMPLER_2D_ARRAY || uniformType == GL_SAMPLER_CUBE
+				|| uniformType == GL_SAMPLER_BUFFER;
+		case ParameterType::Float:
+			return uniformType == GL_FLOAT;
+		case ParameterType::Vec2:
+			return uniformType == GL_FLOAT_VEC2;
+		case ParameterType::Vec3:
+			return uniformType == GL_FLOAT_VEC3;
+		case ParameterType::Vec4:
+			return uniformType == GL_FLOAT_VEC4;
+		case ParameterType::Mat4:
+			return uniformType == GL_FLOAT_MAT4;
+	}
+	return false;
+}
+
+}// namespace
+
+std::uint32_t parameterSize(const ParameterType type)
+{
+	switch (type)
+	{
+		case ParameterType::Int:
+			return sizeof(GLint);
+		case ParameterType::Float:
+			return sizeof(float);
+		case ParameterType::Vec2:
+			return sizeof(glm::vec2);
+		case ParameterType::Vec3:
+			return sizeof(glm::vec3);
+		case ParameterType::Vec4:
+			return sizeof(glm::vec4);
+		case ParameterType::Mat4:
+			return sizeof(glm::mat4);
+	}
+	return 0;
+}
+
+ParameterLayout::Id ParameterLayout::add(std::string name, const ParameterType type)
+{
+	entries_.push_back(Entry{std::move(name), type, size_});
+	size_ += parameterSize(type);
+	return static_cast<Id>(entries_.size() - 1);
+}
+
+ParameterLayout::Id ParameterLayout::find(const std::string_view name) const
+{
+	for (std::size_t i = 0; i < entries_.size(); ++i)
+	{
+		if (entries_[i].name == name)
+		{
+			return static_cast<Id>(i);
+		}
+	}
+	return invalid;
+}
+
+ParameterBlock::ParameterBlock(const ParameterLayout & layout)
+	: layout_(&layout)
+	, values_(layout.size())
+{
+}
+
+void ParameterBlock::set(const ParameterLayout::Id id, const ParameterType type, const void * value)
+{
+	const auto & entry = layout_->entries()[id];
+	Q_ASSERT_X(entry.type == type, "ParameterBlock::set", "value type differs from layout entry type");
+	auto * target = values_.data() + entry.offset;
+	const auto size = parameterSize(type);
+	if (std::memcmp(target, value, size) == 0)
+	{
+		return;
+	}
+	std::memcpy(target, value, size);
+	++version_;
+}
+
+void ProgramParameters::create(QOpenGLFunctions_3_3_Core & gl, const ShaderReflection & reflection, const ParameterLayout & layout)
+{
+	gl_ = &gl;
+	layout_ = &layout;
+	locations_.clear();
+	for (const auto & entry: layout.entries())
+	{
+		const auto * uniform = reflection.findUniform(entry.name);
+		auto location = -1;
+		if (uniform == nullptr)
+		{
+			qWarning() << "program" << reflection.program() << "has no active uniform" << entry.name.c_str();
+		}
+		else if (uniform->location < 0)
+		{
+			qWarning() << "program" << reflection.program() << "has uniform" << entry.name.c_str() << "in uniform block";
+		}
+		else if (!acceptsType(entry.type, uniform->type))
+		{
+			qWarning() << "program" << reflection.program() << "has uniform" << entry.name.c_str() << "of type"
+					   << shaderTypeName(uniform->type) << "not matching parameter";
+		}
+		else
+		{
+			location = uniform->location;
+		}
+		locations_.push_back(location);
+	}
+	shadow_.assign(layout.size(), std::byte{0});
+	invalidate();
+}
+
+void ProgramParameters::invalidate()
+{
+	shadowValid_ = false;
+	lastBlock_ = nullptr;
+	lastVersion_ = 0;
+}
+
+std::size_t ProgramParameters::apply(const ParameterBlock & block)
+{
+	Q_ASSERT_X(&block.layout() == layout_, "ProgramParameters::apply", "block has layout of another program");
+	if (lastBlock_ == &block && lastVersion_ == block.version())
+	{
+		return 0;
+	}
+
+	std::size_t bytes = 0;
+	const auto & entries = layout_->entries();
+	for (std::size_t i = 0; i < entries.size(); ++i)
+	{
+		const auto & entry = entries[i];
+		const auto size = parameterSize(entry.type);
+		const auto * value = block.data(static_cast<ParameterLayout::Id>(i));
+		auto * sent = shadow_.data() + entry.offset;
+		if (locations_[i] < 0 || (shadowValid_ && std::memcmp(sent, value, size) == 0))
+		{
+			continue;
+		}
+		upload(locations_[i], entry.type, value);
+		std::memcpy(sent, value, size);
+		bytes += size;
+	}
+	shadowValid_ = true;
+	lastBlock_ = &block;
+	lastVersion_ = block.version();
+	return bytes;
+}
+
+void ProgramParameters::upload(const GLint location, const ParameterType type, const std::byte * value)
+{
+	const auto * floats = reinterpret_cast<const GLfloat *>(value);
+	switch (type)
+	{
+		case ParameterType::Int:
+			gl_->glUniform1iv(location, 1, reinterpret_cast<const GLint *>(value));
+			break;
+		case ParameterType::Float:
+			gl_->glUniform1fv(location, 1, floats);
+			break;
+		case ParameterType::Vec2:
+			gl_->glUniform2fv(location, 1, floats);
+			break;
+		case ParameterType::Vec3:
+			gl_->glUniform3fv(location, 1, floats);
+			break;
+		case ParameterType::Vec4:
+			gl_->glUniform4fv(location, 1, floats);
+			break;
+		case ParameterType::Mat4:
+			gl_->glUniformMatrix4fv(location, 1, GL_FALSE, floats);
+			break;
+	}
+}
+
+}// namespace fgl
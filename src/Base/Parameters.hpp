@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Base/ShaderReflection.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fgl
+{
+
+enum class ParameterType : std::uint8_t
+{
+	Int,
+	Float,
+	Vec2,
+	Vec3,
+	Vec4,
+	Mat4,
+};
+
+std::uint32_t parameterSize(ParameterType type);
+
+// Names and types of shader parameters, with offsets of their values in parameter blocks.
+// Names are looked up at load time only, later code refers to parameters by ids.
+class ParameterLayout
+{
+public:
+	using Id = std::uint32_t;
+	static constexpr Id invalid = ~Id{0};
+
+	struct Entry
+	{
+		std::string name;
+		ParameterType type;
+		std::uint32_t offset;
+	};
+
+public:
+	Id add(std::string name, ParameterType type);
+	// Returns invalid for unknown names.
+	Id find(std::string_view name) const;
+
+	const std::vector<Entry> & entries() const { return entries_; }
+	// Bytes of values of all parameters.
+	std::uint32_t size() const { return size_; }
+
+private:
+	std::vector<Entry> entries_;
+	std::uint32_t size_ = 0;
+};
+
+// Values of layout parameters, e.g. of a material. Setting a value equal to the current
+// one does not change version, so programs skip blocks they have already applied.
+class ParameterBlock
+{
+public:
+	explicit ParameterBlock(const ParameterLayout & layout);
+
+	void set(ParameterLayout::Id id, int value) { set(id, ParameterType::Int, &value); }
+	void set(ParameterLayout::Id id, float value) { set(id, ParameterType::Float, &value); }
+	void set(ParameterLayout::Id id, const glm::vec2 & value) { set(id, ParameterType::Vec2, &value); }
+	void set(ParameterLayout::Id id, const glm::vec3 & value) { set(id, ParameterType::Vec3, &value); }
+	void set(ParameterLayout::Id id, const glm::vec4 & value) { set(id, ParameterType::Vec4, &value); }
+	void set(ParameterLayout::Id id, const glm::mat4 & value) { set(id, ParameterType::Mat4, &value); }
+
+	const ParameterLayout & layout() const { return *layout_; }
+	const std::byte * data(const ParameterLayout::Id id) const { return values_.data() + layout_->entries()[id].offset; }
+	// Changes every time a value changes.
+	std::uint64_t version() const { return version_; }
+
+private:
+	void set(ParameterLayout::Id id, ParameterType type, const void * value);
+
+private:
+	const ParameterLayout * layout_;
+	std::vector<std::byte> values_;
+	std::uint64_t version_ = 1;
+};
+
+// Parameters of a layout bound to uniform locations of a program. Keeps copy of values
+// last sent to the program, so applying a block uploads only parameters that differ.
+class ProgramParameters
+{
+public:
+	// Builds table of locations from reflection. Parameters missing in program or of other
+	// type than program uniforms are reported and skipped.
+	void create(QOpenGLFunctions_3_3_Core & gl, const ShaderReflection & reflection, const ParameterLayout & layout);
+
+	// Program must be bound. Returns bytes uploaded.
+	std::size_t apply(const ParameterBlock & block);
+	// Forgets values sent to program, next apply uploads all parameters.
+	void invalidate();
+
+	GLint location(const ParameterLayout::Id id) const { return locations_[id]; }
+
+private:
+	void upload(GLint location, ParameterType type, const std::byte * value);
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+	const ParameterLayout * layout_ = nullptr;
+
+	std::vector<GLint> locations_;
+	std::vector<std::byte> shadow_;
+	bool shadowValid_ = false;
+
+	const ParameterBlock * lastBlock_ = nullptr;
+	std::uint64_t lastVersion_ = 0;
+};
+
+}// namespace fgl
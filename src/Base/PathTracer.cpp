@@ -0,0 +1,237 @@
+#include "PathTracer.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Bounces before russian roulette may end paths.
+constexpr std::size_t g_rouletteBounce = 2;
+constexpr auto g_maxSurvival = 0.95f;
+// Offset of secondary ray origins along face normal relative to coordinates magnitude,
+// so rays do not hit the surface they start from.
+constexpr auto g_rayOffset = 1e-4f;
+constexpr auto g_gamma = 2.2f;
+
+// Hash of Jarzynski and Olano, "Hash Functions for GPU Rendering".
+std::uint32_t pcgHash(const std::uint32_t value)
+{
+	const auto state = value * 747796405u + 2891336453u;
+	const auto word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+class Random
+{
+public:
+	explicit Random(const std::uint32_t seed)
+		: state_(pcgHash(seed))
+	{
+	}
+
+	// Uniform in [0, 1).
+	float next()
+	{
+		state_ = pcgHash(state_);
+		return static_cast<float>(state_ >> 8u) * (1.f / 16777216.f);
+	}
+
+private:
+	std::uint32_t state_;
+};
+
+// Cosine weighted direction around normal, basis from Duff et al., "Building an
+// Orthonormal Basis, Revisited".
+glm::vec3 sampleCosine(const glm::vec3 & normal, Random & random)
+{
+	const auto radius = std::sqrt(random.next());
+	const auto angle = 2.f * glm::pi<float>() * random.next();
+	const auto x = radius * std::cos(angle);
+	const auto y = radius * std::sin(angle);
+	const auto z = std::sqrt(std::max(0.f, 1.f - radius * radius));
+
+	const auto sign = std::copysign(1.f, normal.z);
+	const auto a = -1.f / (sign + normal.z);
+	const auto b = normal.x * normal.y * a;
+	const glm::vec3 tangent{1.f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x};
+	const glm::vec3 bitangent{b, sign + normal.y * normal.y * a, -normal.y};
+	return glm::normalize(tangent * x + bitangent * y + normal * z);
+}
+
+float maxComponent(const glm::vec3 & value)
+{
+	return std::max(value.x, std::max(value.y, value.z));
+}
+
+std::uint32_t toByte(const float value)
+{
+	return static_cast<std::uint32_t>(std::lround(std::pow(std::clamp(value, 0.f, 1.f), 1.f / g_gamma) * 255.f));
+}
+
+}// namespace
+
+PathTracer::PathTracer(const RayTracingScene & scene, const std::size_t width, const std::size_t height)
+	: scene_(scene)
+	, width_(std::max<std::size_t>(width, 1u))
+	, height_(std::max<std::size_t>(height, 1u))
+	, tilesX_((width_ + tileSize - 1) / tileSize)
+	, tilesY_((height_ + tileSize - 1) / tileSize)
+	, accumulated_(width_ * height_)
+	, tileRays_(tilesX_ * tilesY_)
+{
+}
+
+void PathTracer::setCamera(const glm::mat4 & view, const glm::mat4 & projection)
+{
+	inverseViewProj_ = glm::inverse(projection * view);
+	reset();
+}
+
+void PathTracer::setSettings(const PathTracerSettings & settings)
+{
+	settings_ = settings;
+	reset();
+}
+
+void PathTracer::reset()
+{
+	std::fill(accumulated_.begin(), accumulated_.end(), glm::vec3{0.f});
+	sampleCount_ = 0;
+	rayCount_ = 0;
+}
+
+void PathTracer::renderSample(JobSystem & jobs)
+{
+	// Tiles differ a lot in cost, so they are taken one by one
+	jobs.parallelFor(tileRays_.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+		for (auto tile = begin; tile < end; ++tile)
+		{
+			tileRays_[tile] = renderTile(tile);
+		}
+	});
+	++sampleCount_;
+
+	rayCount_ = 0;
+	for (const auto rays: tileRays_)
+	{
+		rayCount_ += rays;
+	}
+}
+
+std::uint64_t PathTracer::renderTile(const std::size_t tile)
+{
+	const auto beginX = tile % tilesX_ * tileSize;
+	const auto beginY = tile / tilesX_ * tileSize;
+	const auto endX = std::min(beginX + tileSize, width_);
+	const auto endY = std::min(beginY + tileSize, height_);
+
+	std::uint64_t rays = 0;
+	for (auto y = beginY; y < endY; ++y)
+	{
+		for (auto x = beginX; x < endX; ++x)
+		{
+			accumulated_[y * width_ + x] += tracePath(x, y, rays);
+		}
+	}
+	return rays;
+}
+
+glm::vec3 PathTracer::tracePath(const std::size_t x, const std::size_t y, std::uint64_t & rays) const
+{
+	Random random{static_cast<std::uint32_t>(y * width_ + x) + pcgHash(static_cast<std::uint32_t>(sampleCount_))};
+	const glm::vec2 pixel{static_cast<float>(x) + random.next(), static_cast<float>(y) + random.next()};
+	auto ray = rayFromScreen(inverseViewProj_, pixel, glm::vec2{static_cast<float>(width_), static_cast<float>(height_)});
+	ray.maxDistance = std::numeric_limits<float>::max();
+
+	glm::vec3 radiance{0.f};
+	glm::vec3 throughput{1.f};
+	for (std::size_t bounce = 0;; ++bounce)
+	{
+		const auto hit = scene_.intersect(ray);
+		++rays;
+		if (!hit.isHit())
+		{
+			radiance += throughput * sky(ray.direction);
+			break;
+		}
+
+		// Surfaces are two sided, the side facing the ray is shaded
+		const auto position = ray.origin + ray.direction * hit.distance;
+		auto faceNormal = glm::normalize(scene_.faceNormal(hit.primitive));
+		if (glm::dot(faceNormal, ray.direction) > 0.f)
+		{
+			faceNormal = -faceNormal;
+		}
+		auto normal = scene_.normal(hit);
+		if (glm::dot(normal, faceNormal) < 0.f)
+		{
+			normal = -normal;
+		}
+		const auto albedo = scene_.color(hit);
+		const auto origin = position + faceNormal * (g_rayOffset * std::max(1.f, maxComponent(glm::abs(position))));
+
+		// Sun is a delta light, bounce rays never hit it, so it is sampled with shadow ray
+		const auto sunCosine = glm::dot(normal, settings_.sunDirection);
+		if (sunCosine > 0.f && glm::dot(faceNormal, settings_.sunDirection) > 0.f)
+		{
+			++rays;
+			if (!scene_.occluded(Ray{origin, settings_.sunDirection, std::numeric_limits<float>::max()}))
+			{
+				radiance += throughput * albedo * settings_.sunIrradiance * (sunCosine / glm::pi<float>());
+			}
+		}
+
+		if (bounce == settings_.maxBounces)
+		{
+			break;
+		}
+		// Probability of cosine weighted direction cancels cosine and 1 / pi of Lambertian BRDF
+		throughput *= albedo;
+		if (bounce >= g_rouletteBounce)
+		{
+			const auto survival = std::min(maxComponent(throughput), g_maxSurvival);
+			if (random.next() >= survival)
+			{
+				break;
+			}
+			throughput /= survival;
+		}
+		ray = Ray{origin, sampleCosine(normal, random), std::numeric_limits<float>::max()};
+		if (glm::dot(ray.direction, faceNormal) <= 0.f)
+		{
+			// Shading normal differs from face one and direction went under the surface
+			break;
+		}
+	}
+	return radiance;
+}
+
+glm::vec3 PathTracer::sky(const glm::vec3 & direction) const
+{
+	if (direction.y < 0.f)
+	{
+		return settings_.groundRadiance;
+	}
+	return glm::mix(settings_.skyHorizon, settings_.skyZenith, direction.y);
+}
+
+std::vector<std::uint32_t> PathTracer::resolve() const
+{
+	std::vector<std::uint32_t> result(accumulated_.size());
+	const auto scale = 1.f / static_cast<float>(std::max<std::size_t>(sampleCount_, 1u));
+	for (std::size_t i = 0; i < result.size(); ++i)
+	{
+		const auto color = accumulated_[i] * scale;
+		result[i] = toByte(color.r) | toByte(color.g) << 8 | toByte(color.b) << 16 | 0xffu << 24;
+	}
+	return result;
+}
+
+}// namespace fgl
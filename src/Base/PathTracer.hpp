@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Base/JobSystem.hpp>
+#include <Base/RayTracingScene.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+struct PathTracerSettings
+{
+	// Diffuse bounces after the first hit, paths are also ended by russian roulette.
+	std::size_t maxBounces = 4;
+	// Direction towards the sun and irradiance it gives to surfaces facing it.
+	glm::vec3 sunDirection = glm::normalize(glm::vec3{0.4f, 1.f, 0.6f});
+	glm::vec3 sunIrradiance{2.f};
+	// Radiance of sky at zenith and at horizon, below horizon is the ground one.
+	glm::vec3 skyZenith{0.25f, 0.4f, 0.75f};
+	glm::vec3 skyHorizon{0.65f, 0.7f, 0.75f};
+	glm::vec3 groundRadiance{0.4f, 0.38f, 0.35f};
+};
+
+// Unidirectional path tracer over a ray tracing scene with Lambertian surfaces colored
+// by vertex colors, lit by sky and by the sun sampled with shadow rays. Each call of
+// renderSample() adds one sample per pixel to the accumulation buffer, tiles of the
+// image are distributed over threads of a job system. Random numbers depend on pixel
+// and sample index only, so images do not depend on thread count.
+class PathTracer
+{
+public:
+	static constexpr std::size_t tileSize = 16;
+
+public:
+	PathTracer(const RayTracingScene & scene, std::size_t width, std::size_t height);
+
+	// Changing camera or settings restarts accumulation.
+	void setCamera(const glm::mat4 & view, const glm::mat4 & projection);
+	void setSettings(const PathTracerSettings & settings);
+	void reset();
+
+	void renderSample(JobSystem & jobs = JobSystem::instance());
+
+	std::size_t width() const { return width_; }
+	std::size_t height() const { return height_; }
+	std::size_t sampleCount() const { return sampleCount_; }
+	// Camera, bounce and shadow rays traced by the last renderSample().
+	std::uint64_t rayCount() const { return rayCount_; }
+
+	// Average of accumulated samples as RGBA8 with red in the lowest byte, rows go from top
+	// to bottom. Colors are clamped to [0, 1] and gamma corrected, no tone mapping.
+	std::vector<std::uint32_t> resolve() const;
+
+private:
+	// Returns radiance arriving along camera ray through pixel and counts traced rays.
+	glm::vec3 tracePath(std::size_t x, std::size_t y, std::uint64_t & rays) const;
+	glm::vec3 sky(const glm::vec3 & direction) const;
+	std::uint64_t renderTile(std::size_t tile);
+
+private:
+	const RayTracingScene & scene_;
+	std::size_t width_;
+	std::size_t height_;
+	std::size_t tilesX_;
+	std::size_t tilesY_;
+
+	glm::mat4 inverseViewProj_{1.f};
+	PathTracerSettings settings_;
+
+	// Sums of samples.
+	std::vector<glm::vec3> accumulated_;
+	std::size_t sampleCount_ = 0;
+	std::vector<std::uint64_t> tileRays_;
+	std::uint64_t rayCount_ = 0;
+};
+
+}// namespace fgl
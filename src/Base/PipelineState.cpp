@@ -0,0 +1,165 @@
+#include "PipelineState.hpp"
+
+#include <Base/Hash.hpp>
+
+#include <QDebug>
+
+namespace fgl
+{
+
+namespace
+{
+
+bool isCompareFunc(const GLenum func)
+{
+	switch (func)
+	{
+		case GL_NEVER:
+		case GL_LESS:
+		case GL_EQUAL:
+		case GL_LEQUAL:
+		case GL_GREATER:
+		case GL_NOTEQUAL:
+		case GL_GEQUAL:
+		case GL_ALWAYS:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool isBlendFactor(const GLenum factor)
+{
+	switch (factor)
+	{
+		case GL_ZERO:
+		case GL_ONE:
+		case GL_SRC_COLOR:
+		case GL_ONE_MINUS_SRC_COLOR:
+		case GL_DST_COLOR:
+		case GL_ONE_MINUS_DST_COLOR:
+		case GL_SRC_ALPHA:
+		case GL_ONE_MINUS_SRC_ALPHA:
+		case GL_DST_ALPHA:
+		case GL_ONE_MINUS_DST_ALPHA:
+		case GL_CONSTANT_COLOR:
+		case GL_ONE_MINUS_CONSTANT_COLOR:
+		case GL_CONSTANT_ALPHA:
+		case GL_ONE_MINUS_CONSTANT_ALPHA:
+		case GL_SRC_ALPHA_SATURATE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool isStencilOp(const GLenum op)
+{
+	switch (op)
+	{
+		case GL_KEEP:
+		case GL_ZERO:
+		case GL_REPLACE:
+		case GL_INCR:
+		case GL_INCR_WRAP:
+		case GL_DECR:
+		case GL_DECR_WRAP:
+		case GL_INVERT:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Reports states GL would reject or silently ignore.
+void validate(const GLuint program, const RenderState & state)
+{
+	const auto report = [&](const char * problem) {
+		qWarning() << "pipeline of program" << program << problem;
+	};
+	if (state.blend.enabled && (!isBlendFactor(state.blend.source) || !isBlendFactor(state.blend.destination)))
+	{
+		report("has invalid blend factor");
+	}
+	if (!isCompareFunc(state.depth.func))
+	{
+		report("has invalid depth function");
+	}
+	if (state.depth.write && !state.depth.test)
+	{
+		report("writes depth with depth test disabled, GL skips such writes");
+	}
+	if (state.cull.enabled && state.cull.face != GL_BACK && state.cull.face != GL_FRONT && state.cull.face != GL_FRONT_AND_BACK)
+	{
+		report("has invalid cull face");
+	}
+	if (state.stencil.test
+		&& (!isCompareFunc(state.stencil.func) || !isStencilOp(state.stencil.stencilFail) || !isStencilOp(state.stencil.depthFail)
+			|| !isStencilOp(state.stencil.pass)))
+	{
+		report("has invalid stencil function or operation");
+	}
+}
+
+}// namespace
+
+RenderState RenderState::translucent()
+{
+	RenderState state;
+	state.blend = {true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA};
+	state.depth.write = false;
+	return state;
+}
+
+PipelineState PipelineState::create(QOpenGLFunctions_3_3_Core & gl, const ShaderReflection & reflection,
+									 const RenderState & renderState, const VertexFormat & vertexFormat)
+{
+	PipelineState pipeline;
+	pipeline.program_ = reflection.program();
+	pipeline.renderState_ = renderState;
+	pipeline.vertexFormat_ = vertexFormat;
+
+	GLint linked = GL_FALSE;
+	if (pipeline.program_ != 0)
+	{
+		gl.glGetProgramiv(pipeline.program_, GL_LINK_STATUS, &linked);
+	}
+	if (linked != GL_TRUE)
+	{
+		qWarning() << "pipeline program" << pipeline.program_ << "is not linked";
+	}
+	// Invalid render state is still applied as given, problems are only reported
+	validate(pipeline.program_, renderState);
+	pipeline.valid_ = linked == GL_TRUE;
+	if (!vertexFormat.attributes().empty())
+	{
+		pipeline.vertexBindings_ = vertexFormat.bind(reflection);
+	}
+
+	auto hash = g_hashSeed;
+	hashValue(hash, reflection.interfaceHash());
+	for (const auto & attribute: vertexFormat.attributes())
+	{
+		hashString(hash, attribute.name);
+		hashValue(hash, attribute.components);
+		hashValue(hash, attribute.offset);
+	}
+	const auto & state = renderState;
+	for (const auto value: {GLuint{state.blend.enabled}, state.blend.source, state.blend.destination, GLuint{state.depth.test},
+							GLuint{state.depth.write}, state.depth.func, GLuint{state.cull.enabled}, state.cull.face,
+							GLuint{state.stencil.test}, state.stencil.func, static_cast<GLuint>(state.stencil.reference),
+							state.stencil.readMask, state.stencil.writeMask, state.stencil.stencilFail, state.stencil.depthFail,
+							state.stencil.pass})
+	{
+		hashValue(hash, value);
+	}
+	pipeline.key_ = hash;
+	return pipeline;
+}
+
+void PipelineState::setupVertexArray(QOpenGLFunctions_3_3_Core & gl) const
+{
+	vertexFormat_.apply(gl, vertexBindings_);
+}
+
+}// namespace fgl
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <Base/ShaderReflection.hpp>
+#include <Base/VertexFormat.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <cstdint>
+
+namespace fgl
+{
+
+struct BlendState
+{
+	bool enabled = false;
+	GLenum source = GL_ONE;
+	GLenum destination = GL_ZERO;
+
+	bool operator==(const BlendState & other) const
+	{
+		return enabled == other.enabled && source == other.source && destination == other.destination;
+	}
+};
+
+struct DepthState
+{
+	bool test = true;
+	bool write = true;
+	GLenum func = GL_LESS;
+
+	bool operator==(const DepthState & other) const
+	{
+		return test == other.test && write == other.write && func == other.func;
+	}
+};
+
+struct CullState
+{
+	bool enabled = true;
+	GLenum face = GL_BACK;
+
+	bool operator==(const CullState & other) const { return enabled == other.enabled && face == other.face; }
+};
+
+// Same for front and back faces.
+struct StencilState
+{
+	bool test = false;
+	GLenum func = GL_ALWAYS;
+	GLint reference = 0;
+	GLuint readMask = 0xff;
+	GLuint writeMask = 0xff;
+	GLenum stencilFail = GL_KEEP;
+	GLenum depthFail = GL_KEEP;
+	GLenum pass = GL_KEEP;
+
+	bool operator==(const StencilState & other) const
+	{
+		return test == other.test && func == other.func && reference == other.reference && readMask == other.readMask
+			&& writeMask == other.writeMask && stencilFail == other.stencilFail && depthFail == other.depthFail && pass == other.pass;
+	}
+};
+
+// Fixed function state of draws. Defaults are opaque depth tested geometry with back face
+// culling, the state scenes set up at init.
+struct RenderState
+{
+	BlendState blend;
+	DepthState depth;
+	CullState cull;
+	StencilState stencil;
+
+	// Alpha blended without depth writes.
+	static RenderState translucent();
+};
+
+// Immutable program, vertex format and render state validated and baked at load time.
+// Applying it through GLStateCache issues only calls for state differing from current.
+class PipelineState
+{
+public:
+	// Validates state once and logs problems. Pipelines with unlinked programs are invalid.
+	// Empty vertex format means vertex arrays are set up by their owners, like GpuMesh.
+	static PipelineState create(QOpenGLFunctions_3_3_Core & gl, const ShaderReflection & reflection,
+								const RenderState & renderState, const VertexFormat & vertexFormat = {});
+
+	bool valid() const { return valid_; }
+	GLuint program() const { return program_; }
+	const RenderState & renderState() const { return renderState_; }
+
+	// Sets up attribute pointers of bound vertex array from bound array buffer.
+	void setupVertexArray(QOpenGLFunctions_3_3_Core & gl) const;
+
+	// Hash of program interface, vertex format and render state, same in every run.
+	std::uint64_t key() const { return key_; }
+
+private:
+	GLuint program_ = 0;
+	RenderState renderState_;
+	VertexFormat vertexFormat_;
+	VertexFormat::Bindings vertexBindings_;
+	std::uint64_t key_ = 0;
+	bool valid_ = false;
+};
+
+}// namespace fgl
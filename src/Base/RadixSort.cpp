@@ -0,0 +1,116 @@
+#include "RadixSort.hpp"
+
+#include <Base/ParallelFor.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::size_t g_radixBits = 8;
+constexpr std::size_t g_bucketCount = std::size_t{1} << g_radixBits;
+constexpr std::size_t g_passCount = 64 / g_radixBits;
+// Smaller blocks spend more time on histograms than on scattering.
+constexpr std::size_t g_minBlockSize = 16384;
+constexpr std::size_t g_blocksPerWorker = 2;
+
+using Histogram = std::array<std::size_t, g_bucketCount>;
+
+std::size_t digit(const std::uint64_t key, const std::size_t pass)
+{
+	return static_cast<std::size_t>(key >> (pass * g_radixBits)) & (g_bucketCount - 1);
+}
+
+}// namespace
+
+void radixSort(std::vector<SortItem> & items, std::vector<SortItem> & scratch, const bool parallel)
+{
+	const auto count = items.size();
+	if (count < 2)
+	{
+		return;
+	}
+	scratch.resize(count);
+
+	const auto blockCount = parallel ? std::clamp<std::size_t>(count / g_minBlockSize, 1, workerCount() * g_blocksPerWorker) : 1;
+	const auto blockSize = (count + blockCount - 1) / blockCount;
+	std::vector<Histogram> histograms(blockCount);
+
+	// Digit counts of all passes in one sweep, a pass is skipped when all keys share the digit
+	std::array<Histogram, g_passCount> totals{};
+	for (const auto & item: items)
+	{
+		for (std::size_t pass = 0; pass < g_passCount; ++pass)
+		{
+			++totals[pass][digit(item.key, pass)];
+		}
+	}
+
+	auto * source = &items;
+	auto * destination = &scratch;
+	for (std::size_t pass = 0; pass < g_passCount; ++pass)
+	{
+		if (totals[pass][digit(items.front().key, pass)] == count)
+		{
+			continue;
+		}
+
+		// Single block gets counts from totals, order of items does not change them
+		if (blockCount == 1)
+		{
+			histograms.front() = totals[pass];
+		}
+		else
+		{
+			parallelFor(blockCount, 1, [&](const std::size_t begin, const std::size_t end) {
+				for (auto block = begin; block < end; ++block)
+				{
+					auto & histogram = histograms[block];
+					histogram.fill(0);
+					const auto last = std::min(count, (block + 1) * blockSize);
+					for (auto i = block * blockSize; i < last; ++i)
+					{
+						++histogram[digit((*source)[i].key, pass)];
+					}
+				}
+			});
+		}
+
+		// Turn counts into output offsets, blocks of the same digit follow in block order
+		std::size_t offset = 0;
+		for (std::size_t bucket = 0; bucket < g_bucketCount; ++bucket)
+		{
+			for (auto & histogram: histograms)
+			{
+				const auto bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+		}
+
+		parallelFor(blockCount, 1, [&](const std::size_t begin, const std::size_t end) {
+			for (auto block = begin; block < end; ++block)
+			{
+				auto & offsets = histograms[block];
+				const auto last = std::min(count, (block + 1) * blockSize);
+				for (auto i = block * blockSize; i < last; ++i)
+				{
+					const auto & item = (*source)[i];
+					(*destination)[offsets[digit(item.key, pass)]++] = item;
+				}
+			}
+		});
+		std::swap(source, destination);
+	}
+
+	if (source != &items)
+	{
+		items.swap(scratch);
+	}
+}
+
+}// namespace fgl
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+struct SortItem
+{
+	std::uint64_t key;
+	std::uint32_t payload;
+};
+
+// Stable LSD radix sort by key, 8 bits per pass. Passes over bytes equal in all keys
+// are skipped, so keys using only a part of bits take fewer passes. Parallel version
+// splits items into blocks with own histograms and scatters them on worker threads.
+// Scratch is resized as needed, keeping it between calls avoids allocations.
+void radixSort(std::vector<SortItem> & items, std::vector<SortItem> & scratch, bool parallel = true);
+
+}// namespace fgl
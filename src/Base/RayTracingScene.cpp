@@ -0,0 +1,225 @@
+#include "RayTracingScene.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace fgl
+{
+
+void RayTracingScene::add(const Mesh & mesh, const glm::mat4 & model)
+{
+	const auto normalMatrix = glm::transpose(glm::inverse(glm::mat3{model}));
+	for (const auto index: mesh.indices)
+	{
+		positions_.push_back(glm::vec3{model * glm::vec4{mesh.positions[index], 1.f}});
+		normals_.push_back(glm::normalize(normalMatrix * mesh.normals[index]));
+		colors_.push_back(mesh.colors[index]);
+	}
+}
+
+void RayTracingScene::build()
+{
+	std::vector<Aabb> bounds(triangleCount());
+	for (std::size_t triangle = 0; triangle < bounds.size(); ++triangle)
+	{
+		for (std::size_t corner = 0; corner < 3; ++corner)
+		{
+			bounds[triangle].expand(positions_[triangle * 3 + corner]);
+		}
+	}
+	BvhBuildOptions options;
+	options.maxLeafSize = simd::width;
+	bvh_.build(std::move(bounds), options);
+
+	// Leaves may be larger than SIMD width when splitting does not pay off
+	const auto & nodes = bvh_.nodes();
+	const auto & primitives = bvh_.primitives();
+	packs_.clear();
+	leafPacks_.assign(nodes.size(), {});
+	for (std::size_t index = 0; index < nodes.size(); ++index)
+	{
+		const auto & node = nodes[index];
+		if (!node.isLeaf())
+		{
+			continue;
+		}
+		leafPacks_[index].first = static_cast<std::uint32_t>(packs_.size());
+		for (std::uint32_t begin = 0; begin < node.primitiveCount; begin += simd::width)
+		{
+			Pack pack{};
+			const auto count = std::min<std::uint32_t>(node.primitiveCount - begin, simd::width);
+			for (std::uint32_t lane = 0; lane < count; ++lane)
+			{
+				const auto triangle = primitives[node.primitiveBegin + begin + lane];
+				const auto & v0 = positions_[triangle * 3];
+				const auto edge1 = positions_[triangle * 3 + 1] - v0;
+				const auto edge2 = positions_[triangle * 3 + 2] - v0;
+				for (auto axis = 0; axis < 3; ++axis)
+				{
+					pack.v0[axis][lane] = v0[axis];
+					pack.edge1[axis][lane] = edge1[axis];
+					pack.edge2[axis][lane] = edge2[axis];
+				}
+				pack.triangles[lane] = triangle;
+			}
+			packs_.push_back(pack);
+			++leafPacks_[index].count;
+		}
+	}
+}
+
+template<typename PackTest>
+void RayTracingScene::traverse(const Ray & ray, float & maxDistance, PackTest && test) const
+{
+	const auto & nodes = bvh_.nodes();
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	const RayBoxTest boxTest{ray};
+	const auto axis = glm::abs(ray.direction.x) > glm::abs(ray.direction.y)
+		? (glm::abs(ray.direction.x) > glm::abs(ray.direction.z) ? 0 : 2)
+		: (glm::abs(ray.direction.y) > glm::abs(ray.direction.z) ? 1 : 2);
+	const auto backwards = ray.direction[axis] < 0.f;
+
+	// Build limits tree depth so stack never overflows.
+	std::uint32_t stack[128];
+	std::size_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize != 0)
+	{
+		const auto index = stack[--stackSize];
+		const auto & node = nodes[index];
+		if (!boxTest.intersects(node.bounds, maxDistance))
+		{
+			continue;
+		}
+		if (node.isLeaf())
+		{
+			const auto & leaf = leafPacks_[index];
+			for (auto pack = leaf.first; pack < leaf.first + leaf.count; ++pack)
+			{
+				if (test(packs_[pack]))
+				{
+					return;
+				}
+			}
+			continue;
+		}
+		// Visit nearer child first so farther one is likely culled by hit distance.
+		stack[stackSize++] = backwards ? node.left : node.left + 1;
+		stack[stackSize++] = backwards ? node.left + 1 : node.left;
+	}
+}
+
+RayHit RayTracingScene::intersect(const Ray & ray) const
+{
+	RayHit hit;
+	hit.distance = ray.maxDistance;
+	traverse(ray, hit.distance, [&](const Pack & pack) {
+		intersect(pack, ray, hit);
+		return false;
+	});
+	return hit;
+}
+
+bool RayTracingScene::occluded(const Ray & ray) const
+{
+	auto maxDistance = ray.maxDistance;
+	auto found = false;
+	traverse(ray, maxDistance, [&](const Pack & pack) {
+		RayHit hit;
+		hit.distance = maxDistance;
+		found = intersect(pack, ray, hit);
+		return found;
+	});
+	return found;
+}
+
+bool RayTracingScene::intersect(const Pack & pack, const Ray & ray, RayHit & hit) const
+{
+	// Moller-Trumbore test of simd::width triangles
+	const auto zero = simd::broadcast(0.f);
+	const auto one = simd::broadcast(1.f);
+	const auto dx = simd::broadcast(ray.direction.x);
+	const auto dy = simd::broadcast(ray.direction.y);
+	const auto dz = simd::broadcast(ray.direction.z);
+	const auto e1x = simd::load(pack.edge1[0]);
+	const auto e1y = simd::load(pack.edge1[1]);
+	const auto e1z = simd::load(pack.edge1[2]);
+	const auto e2x = simd::load(pack.edge2[0]);
+	const auto e2y = simd::load(pack.edge2[1]);
+	const auto e2z = simd::load(pack.edge2[2]);
+
+	const auto px = dy * e2z - dz * e2y;
+	const auto py = dz * e2x - dx * e2z;
+	const auto pz = dx * e2y - dy * e2x;
+	const auto determinant = e1x * px + e1y * py + e1z * pz;
+	const auto inverseDeterminant = one / determinant;
+
+	const auto tx = simd::broadcast(ray.origin.x) - simd::load(pack.v0[0]);
+	const auto ty = simd::broadcast(ray.origin.y) - simd::load(pack.v0[1]);
+	const auto tz = simd::broadcast(ray.origin.z) - simd::load(pack.v0[2]);
+	const auto u = (tx * px + ty * py + tz * pz) * inverseDeterminant;
+
+	const auto qx = ty * e1z - tz * e1y;
+	const auto qy = tz * e1x - tx * e1z;
+	const auto qz = tx * e1y - ty * e1x;
+	const auto v = (dx * qx + dy * qy + dz * qz) * inverseDeterminant;
+	const auto distance = (e2x * qx + e2y * qy + e2z * qz) * inverseDeterminant;
+
+	// Comparisons with NaN of degenerate triangles are false
+	const auto hits = (simd::abs(determinant) > zero) & (u >= zero) & (v >= zero) & (u + v <= one) & (distance > zero)
+		& (distance < simd::broadcast(hit.distance));
+	const auto mask = simd::bits(hits);
+	if (mask == 0u)
+	{
+		return false;
+	}
+
+	alignas(32) float distances[simd::width];
+	alignas(32) float us[simd::width];
+	alignas(32) float vs[simd::width];
+	simd::store(distances, distance);
+	simd::store(us, u);
+	simd::store(vs, v);
+	for (std::size_t lane = 0; lane < simd::width; ++lane)
+	{
+		if ((mask & (1u << lane)) != 0u && distances[lane] < hit.distance)
+		{
+			hit.primitive = pack.triangles[lane];
+			hit.distance = distances[lane];
+			hit.barycentric = {us[lane], vs[lane]};
+		}
+	}
+	return true;
+}
+
+glm::vec3 RayTracingScene::normal(const RayHit & hit) const
+{
+	const auto * normals = &normals_[hit.primitive * 3u];
+	const auto & weights = hit.barycentric;
+	return glm::normalize(normals[0] * (1.f - weights.x - weights.y) + normals[1] * weights.x + normals[2] * weights.y);
+}
+
+glm::vec3 RayTracingScene::color(const RayHit & hit) const
+{
+	const auto * colors = &colors_[hit.primitive * 3u];
+	const auto & weights = hit.barycentric;
+	return colors[0] * (1.f - weights.x - weights.y) + colors[1] * weights.x + colors[2] * weights.y;
+}
+
+glm::vec3 RayTracingScene::faceNormal(const std::uint32_t triangle) const
+{
+	const auto * positions = &positions_[triangle * 3u];
+	return glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+}
+
+Aabb RayTracingScene::bounds() const
+{
+	const auto & nodes = bvh_.nodes();
+	return nodes.empty() ? Aabb{} : nodes.front().bounds;
+}
+
+}// namespace fgl
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Base/Bvh.hpp>
+#include <Base/Mesh.hpp>
+#include <Base/Simd.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// Meshes placed in the world flattened into one triangle list with SAH BVH over it, for
+// ray queries of offline renderers. Triangles of each leaf are stored as packs of
+// simd::width triangles in SoA layout, so a ray is tested against the whole pack at once.
+class RayTracingScene
+{
+public:
+	// Copies world space triangles, normals and colors of mesh. Call build() afterwards.
+	void add(const Mesh & mesh, const glm::mat4 & model);
+	void build();
+
+	// Closest hit, hit primitive is triangle index.
+	RayHit intersect(const Ray & ray) const;
+	// Returns true when anything is hit closer than ray max distance.
+	bool occluded(const Ray & ray) const;
+
+	// Interpolated attributes at hit point.
+	glm::vec3 normal(const RayHit & hit) const;
+	glm::vec3 color(const RayHit & hit) const;
+	// Normal of triangle plane, not normalized.
+	glm::vec3 faceNormal(std::uint32_t triangle) const;
+
+	std::size_t triangleCount() const { return positions_.size() / 3u; }
+	Aabb bounds() const;
+	const Bvh & bvh() const { return bvh_; }
+
+private:
+	struct alignas(32) Pack
+	{
+		// First vertex and edges to the second and the third one, padding lanes are
+		// degenerate triangles which are never hit.
+		float v0[3][simd::width];
+		float edge1[3][simd::width];
+		float edge2[3][simd::width];
+		std::uint32_t triangles[simd::width];
+	};
+
+	struct LeafPacks
+	{
+		std::uint32_t first = 0;
+		std::uint32_t count = 0;
+	};
+
+private:
+	// Finds the closest hit in the pack closer than hit distance, returns true if found.
+	bool intersect(const Pack & pack, const Ray & ray, RayHit & hit) const;
+	template<typename PackTest>
+	void traverse(const Ray & ray, float & maxDistance, PackTest && test) const;
+
+private:
+	// Three entries per triangle.
+	std::vector<glm::vec3> positions_;
+	std::vector<glm::vec3> normals_;
+	std::vector<glm::vec3> colors_;
+
+	Bvh bvh_;
+	std::vector<Pack> packs_;
+	// Packs of leaf nodes by node index.
+	std::vector<LeafPacks> leafPacks_;
+};
+
+}// namespace fgl
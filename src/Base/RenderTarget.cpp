@@ -0,0 +1,132 @@
+#include "RenderTarget.hpp"
+
+#include <Base/SceneFramebuffer.hpp>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr auto g_presentFragmentShader = R"(#version 330 core
+in vec2 uv;
+out vec4 fragColor;
+
+uniform sampler2D colorTexture;
+
+void main()
+{
+	fragColor = texture(colorTexture, uv);
+}
+)";
+
+}// namespace
+
+void RenderTarget::create(QOpenGLFunctions_3_3_Core & gl, const int width, const int height)
+{
+	gl_ = &gl;
+	width_ = width;
+	height_ = height;
+
+	gl_->glGenFramebuffers(1, &framebuffer_);
+	createTextures();
+
+	presentProgram_ = std::make_unique<QOpenGLShaderProgram>();
+	presentProgram_->addShaderFromSourceCode(QOpenGLShader::Vertex, FullscreenPass::vertexShader());
+	presentProgram_->addShaderFromSourceCode(QOpenGLShader::Fragment, g_presentFragmentShader);
+	presentProgram_->link();
+	presentProgram_->bind();
+	presentProgram_->setUniformValue("colorTexture", 0);
+	presentProgram_->release();
+
+	fullscreen_.create(gl);
+}
+
+void RenderTarget::destroy()
+{
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	destroyTextures();
+	gl_->glDeleteFramebuffers(1, &framebuffer_);
+	framebuffer_ = 0;
+	presentProgram_.reset();
+	fullscreen_.destroy();
+}
+
+void RenderTarget::resize(const int width, const int height)
+{
+	if (width == width_ && height == height_)
+	{
+		return;
+	}
+	width_ = width;
+	height_ = height;
+	destroyTextures();
+	createTextures();
+}
+
+void RenderTarget::bind()
+{
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+	gl_->glViewport(0, 0, width_, height_);
+}
+
+void RenderTarget::release()
+{
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer());
+}
+
+void RenderTarget::present()
+{
+	const auto depthTest = gl_->glIsEnabled(GL_DEPTH_TEST);
+	gl_->glDisable(GL_DEPTH_TEST);
+
+	presentProgram_->bind();
+	gl_->glActiveTexture(GL_TEXTURE0);
+	gl_->glBindTexture(GL_TEXTURE_2D, colorTexture_);
+	fullscreen_.draw();
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+	presentProgram_->release();
+
+	if (depthTest)
+	{
+		gl_->glEnable(GL_DEPTH_TEST);
+	}
+}
+
+void RenderTarget::createTextures()
+{
+	const auto createTexture = [&](const GLint format, const GLenum dataFormat, const GLenum type) {
+		GLuint texture = 0;
+		gl_->glGenTextures(1, &texture);
+		gl_->glBindTexture(GL_TEXTURE_2D, texture);
+		gl_->glTexImage2D(GL_TEXTURE_2D, 0, format, width_, height_, 0, dataFormat, type, nullptr);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		return texture;
+	};
+	colorTexture_ = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+	depthTexture_ = createTexture(GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT);
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+
+	gl_->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+	gl_->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture_, 0);
+	gl_->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture_, 0);
+	Q_ASSERT(gl_->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	release();
+}
+
+void RenderTarget::destroyTextures()
+{
+	gl_->glDeleteTextures(1, &colorTexture_);
+	gl_->glDeleteTextures(1, &depthTexture_);
+	colorTexture_ = 0;
+	depthTexture_ = 0;
+}
+
+}// namespace fgl
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Base/FullscreenPass.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+
+#include <memory>
+
+namespace fgl
+{
+
+// Offscreen framebuffer with RGBA8 color and 32 bit float depth textures. Unlike default
+// framebuffer its depth can be sampled by later passes.
+class RenderTarget
+{
+public:
+	// Requires current OpenGL context.
+	void create(QOpenGLFunctions_3_3_Core & gl, int width, int height);
+	void destroy();
+
+	// Recreates textures when size changed.
+	void resize(int width, int height);
+
+	int width() const { return width_; }
+	int height() const { return height_; }
+	GLuint colorTexture() const { return colorTexture_; }
+	GLuint depthTexture() const { return depthTexture_; }
+
+	// Binds framebuffer and sets viewport to its size.
+	void bind();
+	// Binds scene framebuffer back, see sceneFramebuffer().
+	void release();
+
+	// Draws color texture over the whole viewport of currently bound framebuffer.
+	void present();
+
+private:
+	void createTextures();
+	void destroyTextures();
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+
+	int width_ = 0;
+	int height_ = 0;
+
+	GLuint framebuffer_ = 0;
+	GLuint colorTexture_ = 0;
+	GLuint depthTexture_ = 0;
+
+	std::unique_ptr<QOpenGLShaderProgram> presentProgram_ = nullptr;
+	FullscreenPass fullscreen_;
+};
+
+}// namespace fgl
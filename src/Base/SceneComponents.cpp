@@ -0,0 +1,38 @@
+#include "SceneComponents.hpp"
+
+namespace fgl
+{
+
+void copyWorldTransforms(World & world, const TransformHierarchy & hierarchy, const bool parallel)
+{
+	auto query = world.query<const TransformNode, Transform>();
+	const auto copy = [&](const TransformNode & node, Transform & transform) {
+		transform.world = hierarchy.world(node.node);
+	};
+	if (parallel)
+	{
+		query.parallelForEach(copy);
+	}
+	else
+	{
+		query.forEach(copy);
+	}
+}
+
+void updateWorldBounds(World & world, const bool parallel)
+{
+	auto query = world.query<const Transform, const LocalBounds, WorldBounds>();
+	const auto update = [](const Transform & transform, const LocalBounds & local, WorldBounds & bounds) {
+		bounds.box = fgl::transform(local.box, transform.world);
+	};
+	if (parallel)
+	{
+		query.parallelForEach(update);
+	}
+	else
+	{
+		query.forEach(update);
+	}
+}
+
+}// namespace fgl
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Base/Bounds.hpp>
+#include <Base/Ecs.hpp>
+#include <Base/TransformHierarchy.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace fgl
+{
+
+// Built-in components consumed by renderers.
+
+struct Transform
+{
+	glm::mat4 world{1.f};
+};
+
+// Entities with this component get world transform from hierarchy node.
+struct TransformNode
+{
+	TransformHierarchy::Node node = TransformHierarchy::none;
+};
+
+struct LocalBounds
+{
+	Aabb box;
+};
+
+struct WorldBounds
+{
+	Aabb box;
+};
+
+// Index into mesh array of renderer.
+struct MeshInstance
+{
+	std::uint32_t mesh = 0;
+};
+
+struct Material
+{
+	glm::vec4 color{1.f};
+	// Index into material array of renderer.
+	std::uint32_t id = 0;
+};
+
+// Copies world matrices of hierarchy nodes into transforms.
+void copyWorldTransforms(World & world, const TransformHierarchy & hierarchy, bool parallel = true);
+
+// Transforms local bounds of entities into world space.
+void updateWorldBounds(World & world, bool parallel = true);
+
+}// namespace fgl
@@ -0,0 +1,22 @@
+#include "SceneFramebuffer.hpp"
+
+#include <QOpenGLContext>
+
+namespace fgl
+{
+
+namespace
+{
+
+GLuint g_sceneFramebuffer = 0;
+
+}// namespace
+
+GLuint sceneFramebuffer()
+{
+	return g_sceneFramebuffer != 0 ? g_sceneFramebuffer : QOpenGLContext::currentContext()->defaultFramebufferObject();
+}
+
+void setSceneFramebuffer(const GLuint framebuffer) { g_sceneFramebuffer = framebuffer; }
+
+}// namespace fgl
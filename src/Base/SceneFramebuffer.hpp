@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QOpenGLFunctions>
+
+namespace fgl
+{
+
+// Framebuffer scene passes draw into after offscreen ones, the one passes must bind back
+// instead of default framebuffer. Window anti-aliasing points it to its offscreen target.
+GLuint sceneFramebuffer();
+
+// Zero restores default framebuffer of current context.
+void setSceneFramebuffer(GLuint framebuffer);
+
+}// namespace fgl
@@ -0,0 +1,186 @@
+#include "ShaderReflection.hpp"
+
+#include <Base/Hash.hpp>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+std::string stripArraySuffix(std::string name)
+{
+	constexpr std::string_view suffix = "[0]";
+	if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+	{
+		name.resize(name.size() - suffix.size());
+	}
+	return name;
+}
+
+template<typename T>
+const T * findByName(const std::vector<T> & items, const std::string_view name)
+{
+	const auto it = std::lower_bound(items.begin(), items.end(), name, [](const T & item, const std::string_view key) {
+		return item.name < key;
+	});
+	return it != items.end() && it->name == name ? &*it : nullptr;
+}
+
+template<typename T>
+void sortByName(std::vector<T> & items)
+{
+	std::sort(items.begin(), items.end(), [](const T & lhs, const T & rhs) { return lhs.name < rhs.name; });
+}
+
+}// namespace
+
+ShaderReflection ShaderReflection::reflect(QOpenGLFunctions_3_3_Core & gl, const GLuint program)
+{
+	ShaderReflection reflection;
+	reflection.program_ = program;
+
+	GLint count = 0;
+	GLint maxLength = 0;
+	GLsizei length = 0;
+	GLint size = 0;
+	GLenum type = 0;
+
+	gl.glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+	gl.glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+	std::string name(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+	for (GLint i = 0; i < count; ++i)
+	{
+		gl.glGetActiveAttrib(program, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+		const std::string attributeName{name.data(), static_cast<std::size_t>(length)};
+		const auto location = gl.glGetAttribLocation(program, attributeName.c_str());
+		// Built-in inputs like gl_VertexID have no location and need no binding
+		if (location >= 0)
+		{
+			reflection.attributes_.push_back(ShaderAttribute{attributeName, type, size, location});
+		}
+	}
+
+	gl.glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+	gl.glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+	name.assign(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+	for (GLint i = 0; i < count; ++i)
+	{
+		const auto index = static_cast<GLuint>(i);
+		gl.glGetActiveUniformBlockName(program, index, static_cast<GLsizei>(name.size()), &length, name.data());
+		gl.glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+		reflection.blocks_.push_back(ShaderUniformBlock{std::string{name.data(), static_cast<std::size_t>(length)}, index, size});
+	}
+
+	gl.glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	gl.glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	name.assign(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+	for (GLint i = 0; i < count; ++i)
+	{
+		auto index = static_cast<GLuint>(i);
+		gl.glGetActiveUniform(program, index, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+		GLint block = -1;
+		GLint offset = -1;
+		gl.glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+		gl.glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset);
+		const std::string uniformName{name.data(), static_cast<std::size_t>(length)};
+		const auto location = block < 0 ? gl.glGetUniformLocation(program, uniformName.c_str()) : -1;
+		reflection.uniforms_.push_back(ShaderUniform{stripArraySuffix(uniformName), type, size, location, block, offset});
+	}
+
+	sortByName(reflection.attributes_);
+	sortByName(reflection.uniforms_);
+	sortByName(reflection.blocks_);
+
+	// Block indices are assigned by driver, so blocks are hashed in name order by size
+	auto hash = g_hashSeed;
+	for (const auto & attribute: reflection.attributes_)
+	{
+		hashString(hash, attribute.name);
+		hashValue(hash, attribute.type);
+		hashValue(hash, attribute.size);
+		hashValue(hash, attribute.location);
+	}
+	for (const auto & uniform: reflection.uniforms_)
+	{
+		hashString(hash, uniform.name);
+		hashValue(hash, uniform.type);
+		hashValue(hash, uniform.size);
+		hashValue(hash, uniform.offset);
+	}
+	for (const auto & block: reflection.blocks_)
+	{
+		hashString(hash, block.name);
+		hashValue(hash, block.size);
+	}
+	reflection.interfaceHash_ = hash;
+	return reflection;
+}
+
+const ShaderAttribute * ShaderReflection::findAttribute(const std::string_view name) const
+{
+	return findByName(attributes_, name);
+}
+
+const ShaderUniform * ShaderReflection::findUniform(const std::string_view name) const
+{
+	return findByName(uniforms_, name);
+}
+
+const ShaderUniformBlock * ShaderReflection::findBlock(const std::string_view name) const
+{
+	return findByName(blocks_, name);
+}
+
+GLint ShaderReflection::uniformLocation(const std::string_view name) const
+{
+	const auto * uniform = findUniform(name);
+	return uniform != nullptr ? uniform->location : -1;
+}
+
+const char * shaderTypeName(const GLenum type)
+{
+	switch (type)
+	{
+		case GL_FLOAT:
+			return "float";
+		case GL_FLOAT_VEC2:
+			return "vec2";
+		case GL_FLOAT_VEC3:
+			return "vec3";
+		case GL_FLOAT_VEC4:
+			return "vec4";
+		case GL_INT:
+			return "int";
+		case GL_INT_VEC2:
+			return "ivec2";
+		case GL_INT_VEC3:
+			return "ivec3";
+		case GL_INT_VEC4:
+			return "ivec4";
+		case GL_UNSIGNED_INT:
+			return "uint";
+		case GL_BOOL:
+			return "bool";
+		case GL_FLOAT_MAT3:
+			return "mat3";
+		case GL_FLOAT_MAT4:
+			return "mat4";
+		case GL_SAMPLER_2D:
+			return "sampler2D";
+		case GL_SAMPLER_2D_SHADOW:
+			return "sampler2DShadow";
+		case GL_SAMPLER_2D_ARRAY:
+			return "sampler2DArray";
+		case GL_SAMPLER_CUBE:
+			return "samplerCube";
+		case GL_SAMPLER_BUFFER:
+			return "samplerBuffer";
+		default:
+			return "other";
+	}
+}
+
+}// namespace fgl
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fgl
+{
+
+struct ShaderAttribute
+{
+	std::string name;
+	GLenum type;
+	GLint size;
+	GLint location;
+};
+
+struct ShaderUniform
+{
+	// Arrays are named without [0] suffix.
+	std::string name;
+	GLenum type;
+	GLint size;
+	// -1 for members of uniform blocks.
+	GLint location;
+	// Index into uniform blocks and byte offset in block, -1 for default block uniforms.
+	GLint block;
+	GLint offset;
+};
+
+struct ShaderUniformBlock
+{
+	std::string name;
+	GLuint index;
+	GLint size;
+};
+
+// Active attributes, uniforms and uniform blocks of a linked program, enumerated once after
+// link and sorted by name. Binding tables of vertex formats and parameters are built from
+// it at load time, so drawing never looks names up.
+class ShaderReflection
+{
+public:
+	static ShaderReflection reflect(QOpenGLFunctions_3_3_Core & gl, GLuint program);
+
+	GLuint program() const { return program_; }
+
+	const std::vector<ShaderAttribute> & attributes() const { return attributes_; }
+	const std::vector<ShaderUniform> & uniforms() const { return uniforms_; }
+	const std::vector<ShaderUniformBlock> & blocks() const { return blocks_; }
+
+	// Return nullptr for names not active in program.
+	const ShaderAttribute * findAttribute(std::string_view name) const;
+	const ShaderUniform * findUniform(std::string_view name) const;
+	const ShaderUniformBlock * findBlock(std::string_view name) const;
+	// Location of default block uniform, -1 if not active.
+	GLint uniformLocation(std::string_view name) const;
+
+	// Hash of program interface, equal for programs with equal reflection in any run.
+	std::uint64_t interfaceHash() const { return interfaceHash_; }
+
+private:
+	GLuint program_ = 0;
+	std::vector<ShaderAttribute> attributes_;
+	std::vector<ShaderUniform> uniforms_;
+	std::vector<ShaderUniformBlock> blocks_;
+	std::uint64_t interfaceHash_ = 0;
+};
+
+// GLSL name of GL type for load time reports.
+const char * shaderTypeName(GLenum type);
+
+}// namespace fgl
@@ -0,0 +1,92 @@
+#include "ShaderSource.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <vector>
+
+namespace fgl
+{
+
+namespace
+{
+
+// Appends file with includes expanded, files included before are skipped as with include
+// guards. #line directives number sources in inclusion order, so compiler messages like
+// 1:12 point at line 12 of the first included file, 0 is the loaded file itself.
+bool appendWithIncludes(const QString & path, std::vector<QString> & included, QByteArray & output)
+{
+	QFile file{path};
+	if (!file.open(QFile::ReadOnly))
+	{
+		qWarning() << "failed to read shader" << path;
+		return false;
+	}
+	const auto sourceNumber = QByteArray::number(static_cast<int>(included.size()));
+	included.push_back(QDir::cleanPath(path));
+
+	const auto lines = file.readAll().split('\n');
+	for (int i = 0; i < lines.size(); ++i)
+	{
+		const auto & line = lines.at(i);
+		const auto trimmed = line.trimmed();
+		if (!trimmed.startsWith("#include"))
+		{
+			output.append(line);
+			if (i + 1 < lines.size())
+			{
+				output.append('\n');
+			}
+			continue;
+		}
+
+		const auto open = trimmed.indexOf('"');
+		const auto close = trimmed.indexOf('"', open + 1);
+		if (open < 0 || close < 0)
+		{
+			qWarning() << "malformed include in shader" << path << "line" << i + 1;
+			return false;
+		}
+		const auto includePath = QDir::cleanPath(QFileInfo{path}.path() + "/" + QString::fromUtf8(trimmed.mid(open + 1, close - open - 1)));
+		if (std::find(included.begin(), included.end(), includePath) == included.end())
+		{
+			output.append("#line 1 " + QByteArray::number(static_cast<int>(included.size())) + "\n");
+			if (!appendWithIncludes(includePath, included, output))
+			{
+				return false;
+			}
+			output.append('\n');
+		}
+		output.append("#line " + QByteArray::number(i + 2) + " " + sourceNumber + "\n");
+	}
+	return true;
+}
+
+}// namespace
+
+QByteArray loadShaderSource(const QString & path, const QByteArray & defines)
+{
+	QByteArray source;
+	std::vector<QString> included;
+	if (!appendWithIncludes(path, included, source))
+	{
+		return {};
+	}
+	if (!defines.isEmpty())
+	{
+		// Defines go after version line, which may be the only line without newline
+		auto versionEnd = source.indexOf('\n');
+		if (versionEnd < 0)
+		{
+			versionEnd = source.size();
+			source.append('\n');
+		}
+		source.insert(versionEnd + 1, defines + "#line 2 0\n");
+	}
+	return source;
+}
+
+}// namespace fgl
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+namespace fgl
+{
+
+// Reads shader source, usually from resources, expands #include "path" lines relative to
+// including file and inserts defines after version line to select shader variant.
+// Returns empty source when any file can not be read.
+QByteArray loadShaderSource(const QString & path, const QByteArray & defines = {});
+
+}// namespace fgl
@@ -0,0 +1,179 @@
+#include "ShaderVariants.hpp"
+
+#include <Base/Hash.hpp>
+#include <Base/ShaderSource.hpp>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+ShaderDefines::ShaderDefines(const std::initializer_list<std::string_view> names)
+{
+	for (const auto name: names)
+	{
+		set(name);
+	}
+}
+
+ShaderDefines & ShaderDefines::set(const std::string_view name, const std::string_view value)
+{
+	const auto it = std::lower_bound(defines_.begin(), defines_.end(), name, [](const auto & define, const std::string_view key) {
+		return define.first < key;
+	});
+	if (it != defines_.end() && it->first == name)
+	{
+		it->second = value;
+	}
+	else
+	{
+		defines_.emplace(it, std::string{name}, std::string{value});
+	}
+	return *this;
+}
+
+QByteArray ShaderDefines::source() const
+{
+	QByteArray source;
+	for (const auto & [name, value]: defines_)
+	{
+		source += QByteArray{"#define "} + QByteArray{name.c_str()} + " " + QByteArray{value.c_str()} + "\n";
+	}
+	return source;
+}
+
+std::string ShaderDefines::toString() const
+{
+	std::string result;
+	for (const auto & [name, value]: defines_)
+	{
+		if (!result.empty())
+		{
+			result += ' ';
+		}
+		result += value.empty() ? name : name + "=" + value;
+	}
+	return result;
+}
+
+ShaderVariants::Key ShaderVariants::key(const QString & vertexPath, const QString & fragmentPath, const ShaderDefines & defines)
+{
+	auto hash = g_hashSeed;
+	hashString(hash, vertexPath.toStdString());
+	hashString(hash, fragmentPath.toStdString());
+	for (const auto & [name, value]: defines.defines())
+	{
+		hashString(hash, name);
+		hashString(hash, value);
+	}
+	return hash;
+}
+
+QOpenGLShaderProgram * ShaderVariants::program(const QString & vertexPath, const QString & fragmentPath, const ShaderDefines & defines)
+{
+	const auto variantKey = key(vertexPath, fragmentPath, defines);
+	const auto it = programs_.find(variantKey);
+	if (it != programs_.end())
+	{
+		return it->second.get();
+	}
+
+	if (prewarmed_)
+	{
+		++lateCompiles_;
+		qWarning() << "shader variant compiled on request, add to pre-warm list:"
+				   << (vertexPath + " " + fragmentPath + " " + QString::fromStdString(defines.toString())).trimmed();
+	}
+	auto * program = compile(vertexPath, fragmentPath, defines);
+	programs_[variantKey].reset(program);
+	return program;
+}
+
+QOpenGLShaderProgram * ShaderVariants::compile(const QString & vertexPath, const QString & fragmentPath, const ShaderDefines & defines)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// Cacheable sources are compiled at link time only when no binary of them is cached
+	auto program = std::make_unique<QOpenGLShaderProgram>();
+	const auto defineSource = defines.source();
+	const auto linked = program->addCacheableShaderFromSourceCode(QOpenGLShader::Vertex, loadShaderSource(vertexPath, defineSource))
+		&& program->addCacheableShaderFromSourceCode(QOpenGLShader::Fragment, loadShaderSource(fragmentPath, defineSource))
+		&& program->link();
+	compileMs_ += static_cast<double>(timer.nsecsElapsed()) / 1e6;
+	if (!linked)
+	{
+		qWarning() << "failed to build shader variant" << vertexPath << fragmentPath << QString::fromStdString(defines.toString());
+		return nullptr;
+	}
+	return program.release();
+}
+
+std::size_t ShaderVariants::prewarm(const QString & listPath)
+{
+	QFile file{listPath};
+	if (!file.open(QFile::ReadOnly))
+	{
+		qWarning() << "failed to read shader pre-warm list" << listPath;
+		return 0;
+	}
+
+	const auto startMs = compileMs_;
+	std::size_t compiled = 0;
+	for (const auto & line: file.readAll().split('\n'))
+	{
+		const auto content = line.left(line.indexOf('#') < 0 ? line.size() : line.indexOf('#')).trimmed();
+		std::vector<QByteArray> words;
+		for (const auto & word: content.split(' '))
+		{
+			if (!word.isEmpty())
+			{
+				words.push_back(word);
+			}
+		}
+		if (words.size() < 2)
+		{
+			continue;
+		}
+
+		ShaderDefines defines;
+		for (std::size_t i = 2; i < words.size(); ++i)
+		{
+			const auto separator = words[i].indexOf('=');
+			if (separator < 0)
+			{
+				defines.set(words[i].constData());
+			}
+			else
+			{
+				defines.set(words[i].left(separator).constData(), words[i].mid(separator + 1).constData());
+			}
+		}
+
+		const auto vertexPath = QString::fromUtf8(words[0].constData());
+		const auto fragmentPath = QString::fromUtf8(words[1].constData());
+		auto & program = programs_[key(vertexPath, fragmentPath, defines)];
+		if (program == nullptr)
+		{
+			program.reset(compile(vertexPath, fragmentPath, defines));
+			++compiled;
+		}
+	}
+	prewarmed_ = true;
+	qInfo() << "pre-warmed" << compiled << "shader variants in" << compileMs_ - startMs << "ms";
+	return compiled;
+}
+
+void ShaderVariants::clear()
+{
+	programs_.clear();
+	prewarmed_ = false;
+	lateCompiles_ = 0;
+	compileMs_ = 0.;
+}
+
+}// namespace fgl
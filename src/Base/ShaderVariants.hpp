@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QByteArray>
+#include <QOpenGLShaderProgram>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fgl
+{
+
+// Preprocessor defines selecting a shader variant, kept sorted by name so equal sets give
+// equal variant keys regardless of order they were set in.
+class ShaderDefines
+{
+public:
+	ShaderDefines() = default;
+	ShaderDefines(std::initializer_list<std::string_view> names);
+
+	// Replaces value of already set define.
+	ShaderDefines & set(std::string_view name, std::string_view value = {});
+
+	bool empty() const { return defines_.empty(); }
+	// Lines of #define directives.
+	QByteArray source() const;
+	// Space separated NAME or NAME=VALUE items as in pre-warm lists.
+	std::string toString() const;
+
+	const std::vector<std::pair<std::string, std::string>> & defines() const { return defines_; }
+
+private:
+	std::vector<std::pair<std::string, std::string>> defines_;
+};
+
+// Programs of shader variants compiled lazily on first request and kept by variant key.
+// Variants known in advance are compiled at load time from pre-warm list, so drawing does
+// not hitch on compilation. Sources go through Qt program binary cache, so variants
+// compiled in previous runs only load binaries when driver supports program binaries.
+class ShaderVariants
+{
+public:
+	using Key = std::uint64_t;
+
+public:
+	static Key key(const QString & vertexPath, const QString & fragmentPath, const ShaderDefines & defines);
+
+	// Defines go to both stages. Returns nullptr if variant fails to compile or link, failed
+	// variants are not retried. Programs live until clear.
+	QOpenGLShaderProgram * program(const QString & vertexPath, const QString & fragmentPath, const ShaderDefines & defines = {});
+
+	// Compiles variants of list file with a variant per line: vertex shader path, fragment
+	// shader path and defines separated by spaces, # starts comment. Returns count of
+	// variants compiled. After pre-warm, variants compiled on request are logged with
+	// lines to add to the list.
+	std::size_t prewarm(const QString & listPath);
+
+	void clear();
+
+	std::size_t size() const { return programs_.size(); }
+	// Variants compiled on request after pre-warm.
+	std::size_t lateCompiles() const { return lateCompiles_; }
+	double compileMs() const { return compileMs_; }
+
+private:
+	QOpenGLShaderProgram * compile(const QString & vertexPath, const QString & fragmentPath, const ShaderDefines & defines);
+
+private:
+	std::unordered_map<Key, std::unique_ptr<QOpenGLShaderProgram>> programs_;
+	bool prewarmed_ = false;
+	std::size_t lateCompiles_ = 0;
+	double compileMs_ = 0.;
+};
+
+}// namespace fgl
@@ -0,0 +1,165 @@
+#pragma once
+
+// Thin wrappers over the widest float SIMD available at compile time: AVX (8 lanes),
+// SSE2 (4 lanes) or plain scalar code. Algorithms are written once in terms of
+// simd::Float and simd::Mask and process simd::width elements per step.
+
+#if defined(__AVX__)
+#define FGL_SIMD_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FGL_SIMD_SSE 1
+#include <emmintrin.h>
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace fgl
+{
+namespace simd
+{
+
+#if defined(FGL_SIMD_AVX)
+
+constexpr std::size_t width = 8;
+
+struct Float
+{
+	__m256 v;
+};
+
+struct Mask
+{
+	__m256 v;
+};
+
+inline Float broadcast(const float value) { return {_mm256_set1_ps(value)}; }
+inline Float load(const float * data) { return {_mm256_loadu_ps(data)}; }
+inline void store(float * data, const Float value) { _mm256_storeu_ps(data, value.v); }
+
+inline Float operator+(const Float a, const Float b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline Float operator-(const Float a, const Float b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline Float operator*(const Float a, const Float b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline Float operator/(const Float a, const Float b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline Float min(const Float a, const Float b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline Float max(const Float a, const Float b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline Float abs(const Float a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v)}; }
+inline Float sqrt(const Float a) { return {_mm256_sqrt_ps(a.v)}; }
+
+inline Mask operator<(const Float a, const Float b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline Mask operator<=(const Float a, const Float b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+inline Mask operator>(const Float a, const Float b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+inline Mask operator>=(const Float a, const Float b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+
+inline Mask operator&(const Mask a, const Mask b) { return {_mm256_and_ps(a.v, b.v)}; }
+inline Mask operator|(const Mask a, const Mask b) { return {_mm256_or_ps(a.v, b.v)}; }
+inline Mask andNot(const Mask a, const Mask b) { return {_mm256_andnot_ps(b.v, a.v)}; }
+inline Float select(const Mask mask, const Float a, const Float b) { return {_mm256_blendv_ps(b.v, a.v, mask.v)}; }
+
+// Lane i of mask is bit i of result.
+inline std::uint32_t bits(const Mask mask) { return static_cast<std::uint32_t>(_mm256_movemask_ps(mask.v)); }
+
+#elif defined(FGL_SIMD_SSE)
+
+constexpr std::size_t width = 4;
+
+struct Float
+{
+	__m128 v;
+};
+
+struct Mask
+{
+	__m128 v;
+};
+
+inline Float broadcast(const float value) { return {_mm_set1_ps(value)}; }
+inline Float load(const float * data) { return {_mm_loadu_ps(data)}; }
+inline void store(float * data, const Float value) { _mm_storeu_ps(data, value.v); }
+
+inline Float operator+(const Float a, const Float b) { return {_mm_add_ps(a.v, b.v)}; }
+inline Float operator-(const Float a, const Float b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline Float operator*(const Float a, const Float b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline Float operator/(const Float a, const Float b) { return {_mm_div_ps(a.v, b.v)}; }
+inline Float min(const Float a, const Float b) { return {_mm_min_ps(a.v, b.v)}; }
+inline Float max(const Float a, const Float b) { return {_mm_max_ps(a.v, b.v)}; }
+inline Float abs(const Float a) { return {_mm_andnot_ps(_mm_set1_ps(-0.f), a.v)}; }
+inline Float sqrt(const Float a) { return {_mm_sqrt_ps(a.v)}; }
+
+inline Mask operator<(const Float a, const Float b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline Mask operator<=(const Float a, const Float b) { return {_mm_cmple_ps(a.v, b.v)}; }
+inline Mask operator>(const Float a, const Float b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline Mask operator>=(const Float a, const Float b) { return {_mm_cmpge_ps(a.v, b.v)}; }
+
+inline Mask operator&(const Mask a, const Mask b) { return {_mm_and_ps(a.v, b.v)}; }
+inline Mask operator|(const Mask a, const Mask b) { return {_mm_or_ps(a.v, b.v)}; }
+inline Mask andNot(const Mask a, const Mask b) { return {_mm_andnot_ps(b.v, a.v)}; }
+inline Float select(const Mask mask, const Float a, const Float b)
+{
+	return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+}
+
+// Lane i of mask is bit i of result.
+inline std::uint32_t bits(const Mask mask) { return static_cast<std::uint32_t>(_mm_movemask_ps(mask.v)); }
+
+#else
+
+constexpr std::size_t width = 1;
+
+struct Float
+{
+	float v;
+};
+
+struct Mask
+{
+	bool v;
+};
+
+inline Float broadcast(const float value) { return {value}; }
+inline Float load(const float * data) { return {*data}; }
+inline void store(float * data, const Float value) { *data = value.v; }
+
+inline Float operator+(const Float a, const Float b) { return {a.v + b.v}; }
+inline Float operator-(const Float a, const Float b) { return {a.v - b.v}; }
+inline Float operator*(const Float a, const Float b) { return {a.v * b.v}; }
+inline Float operator/(const Float a, const Float b) { return {a.v / b.v}; }
+inline Float min(const Float a, const Float b) { return {a.v < b.v ? a.v : b.v}; }
+inline Float max(const Float a, const Float b) { return {a.v > b.v ? a.v : b.v}; }
+inline Float abs(const Float a) { return {std::fabs(a.v)}; }
+inline Float sqrt(const Float a) { return {std::sqrt(a.v)}; }
+
+inline Mask operator<(const Float a, const Float b) { return {a.v < b.v}; }
+inline Mask operator<=(const Float a, const Float b) { return {a.v <= b.v}; }
+inline Mask operator>(const Float a, const Float b) { return {a.v > b.v}; }
+inline Mask operator>=(const Float a, const Float b) { return {a.v >= b.v}; }
+
+inline Mask operator&(const Mask a, const Mask b) { return {a.v && b.v}; }
+inline Mask operator|(const Mask a, const Mask b) { return {a.v || b.v}; }
+inline Mask andNot(const Mask a, const Mask b) { return {a.v && !b.v}; }
+inline Float select(const Mask mask, const Float a, const Float b) { return mask.v ? a : b; }
+
+inline std::uint32_t bits(const Mask mask) { return mask.v ? 1u : 0u; }
+
+#endif
+
+// Lanes are equal to first..first + width - 1.
+inline Float sequence(const float first)
+{
+	alignas(32) float values[width];
+	for (std::size_t i = 0; i < width; ++i)
+	{
+		values[i] = first + static_cast<float>(i);
+	}
+	return load(values);
+}
+
+inline Mask trueMask() { return broadcast(0.f) <= broadcast(0.f); }
+
+inline bool any(const Mask mask) { return bits(mask) != 0u; }
+inline bool all(const Mask mask) { return bits(mask) == (1u << width) - 1u; }
+
+}// namespace simd
+}// namespace fgl
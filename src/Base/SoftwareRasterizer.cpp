@@ -0,0 +1,422 @@
+#include "SoftwareRasterizer.hpp"
+
+#include <Base/ParallelFor.hpp>
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace fgl
+{
+
+namespace
+{
+
+static_assert(SoftwareRasterizer::tileSize % simd::width == 0, "tile row must be whole SIMD registers");
+
+// Draws of one geometry job, demo meshes are too small to schedule them one by one.
+constexpr std::size_t g_drawsPerChunk = 64;
+
+std::size_t roundUpToTile(const std::size_t size)
+{
+	return std::max<std::size_t>((size + SoftwareRasterizer::tileSize - 1) / SoftwareRasterizer::tileSize, 1u)
+		* SoftwareRasterizer::tileSize;
+}
+
+double elapsedMs(const QElapsedTimer & timer)
+{
+	return static_cast<double>(timer.nsecsElapsed()) / 1e6;
+}
+
+std::uint32_t toByte(const float value)
+{
+	return static_cast<std::uint32_t>(std::lround(std::clamp(value, 0.f, 1.f) * 255.f));
+}
+
+// Clips polygon with varyings by near plane z + w >= 0, returns number of output vertices.
+template<typename Vertex>
+std::size_t clipNear(const std::array<Vertex, 3u> & input, std::array<Vertex, 4u> & output, const std::size_t varyingCount)
+{
+	std::size_t count = 0;
+	for (std::size_t i = 0; i < input.size(); ++i)
+	{
+		const auto & current = input[i];
+		const auto & next = input[(i + 1) % input.size()];
+		const auto currentDistance = current.position.z + current.position.w;
+		const auto nextDistance = next.position.z + next.position.w;
+		if (currentDistance >= 0.f)
+		{
+			output[count++] = current;
+		}
+		if ((currentDistance >= 0.f) != (nextDistance >= 0.f))
+		{
+			const auto t = currentDistance / (currentDistance - nextDistance);
+			auto & clipped = output[count++];
+			clipped.position = current.position + (next.position - current.position) * t;
+			for (std::size_t j = 0; j < varyingCount; ++j)
+			{
+				clipped.varyings[j] = current.varyings[j] + (next.varyings[j] - current.varyings[j]) * t;
+			}
+		}
+	}
+	return count;
+}
+
+// Pixels exactly on an edge belong to the triangle only when the edge is top or left one,
+// so pixels of shared edges are drawn once.
+simd::Mask covers(const simd::Float edge, const bool topLeft)
+{
+	const auto zero = simd::broadcast(0.f);
+	return topLeft ? edge >= zero : edge > zero;
+}
+
+}// namespace
+
+SoftwareRasterizer::SoftwareRasterizer(const std::size_t width, const std::size_t height)
+{
+	resize(width, height);
+}
+
+void SoftwareRasterizer::resize(const std::size_t width, const std::size_t height)
+{
+	width_ = std::max<std::size_t>(width, 1u);
+	height_ = std::max<std::size_t>(height, 1u);
+	stride_ = roundUpToTile(width_);
+	tilesX_ = stride_ / tileSize;
+	tilesY_ = roundUpToTile(height_) / tileSize;
+	colors_.assign(stride_ * tilesY_ * tileSize, 0u);
+	depth_.assign(stride_ * tilesY_ * tileSize, 1.f);
+	bins_.assign(tilesX_ * tilesY_, {});
+	tileFragments_.assign(tilesX_ * tilesY_, 0u);
+}
+
+void SoftwareRasterizer::clear(const glm::vec4 & color, const float depth)
+{
+	const auto pixel = toByte(color.r) | toByte(color.g) << 8 | toByte(color.b) << 16 | toByte(color.a) << 24;
+	std::fill(colors_.begin(), colors_.end(), pixel);
+	std::fill(depth_.begin(), depth_.end(), depth);
+	draws_.clear();
+	stats_ = {};
+}
+
+void SoftwareRasterizer::draw(const RasterShader & shader, const std::uint32_t drawId, const std::size_t vertexCount,
+							  const std::uint32_t * indices, const std::size_t indexCount)
+{
+	Q_ASSERT_X(shader.varyingCount() <= RasterShader::maxVaryings, "SoftwareRasterizer::draw", "too many varyings");
+	draws_.push_back({&shader, drawId, vertexCount, indices, indexCount});
+	++stats_.draws;
+	stats_.triangles += indexCount / 3;
+}
+
+void SoftwareRasterizer::flush()
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// Vertex shading and triangle setup, chunks are fixed ranges of draws so binning
+	// below sees triangles in submission order
+	const auto chunkCount = (draws_.size() + g_drawsPerChunk - 1) / g_drawsPerChunk;
+	if (chunks_.size() < chunkCount)
+	{
+		chunks_.resize(chunkCount);
+	}
+	parallelFor(chunkCount, 1, [&](const std::size_t begin, const std::size_t end) {
+		for (auto index = begin; index < end; ++index)
+		{
+			auto & chunk = chunks_[index];
+			chunk.triangles.clear();
+			const auto lastDraw = std::min((index + 1) * g_drawsPerChunk, draws_.size());
+			for (auto draw = index * g_drawsPerChunk; draw < lastDraw; ++draw)
+			{
+				processDraw(draws_[draw], chunk);
+			}
+		}
+	});
+	stats_.geometryMs += elapsedMs(timer);
+
+	timer.restart();
+	for (auto & bin: bins_)
+	{
+		bin.clear();
+	}
+	for (std::size_t index = 0; index < chunkCount; ++index)
+	{
+		for (const auto & triangle: chunks_[index].triangles)
+		{
+			binTriangle(triangle);
+		}
+		stats_.setupTriangles += chunks_[index].triangles.size();
+	}
+	stats_.binMs += elapsedMs(timer);
+
+	// Tiles own disjoint pixels, so each of them is rasterized by one thread without locks
+	timer.restart();
+	parallelFor(bins_.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+		for (auto tile = begin; tile < end; ++tile)
+		{
+			tileFragments_[tile] = rasterizeTile(tile);
+		}
+	});
+	for (const auto fragments: tileFragments_)
+	{
+		stats_.fragments += fragments;
+	}
+	stats_.rasterMs += elapsedMs(timer);
+
+	draws_.clear();
+}
+
+void SoftwareRasterizer::processDraw(const Draw & draw, Chunk & chunk) const
+{
+	const auto & shader = *draw.shader;
+	const auto varyingCount = shader.varyingCount();
+	chunk.vertices.resize(draw.vertexCount);
+	for (std::size_t i = 0; i < draw.vertexCount; ++i)
+	{
+		auto & vertex = chunk.vertices[i];
+		vertex.position = shader.vertex(draw.id, static_cast<std::uint32_t>(i), vertex.varyings.data());
+	}
+
+	for (std::size_t i = 0; i + 2 < draw.indexCount; i += 3)
+	{
+		const std::array<ClipVertex, 3u> vertices{chunk.vertices[draw.indices[i]], chunk.vertices[draw.indices[i + 1]],
+												  chunk.vertices[draw.indices[i + 2]]};
+
+		// Trivially reject triangles outside of one frustum plane
+		const auto outside = [&](const auto & predicate) {
+			return std::all_of(vertices.begin(), vertices.end(), [&](const auto & v) { return predicate(v.position); });
+		};
+		if (outside([](const auto & p) { return p.x > p.w; }) || outside([](const auto & p) { return p.x < -p.w; })
+			|| outside([](const auto & p) { return p.y > p.w; }) || outside([](const auto & p) { return p.y < -p.w; })
+			|| outside([](const auto & p) { return p.z > p.w; }) || outside([](const auto & p) { return p.z < -p.w; }))
+		{
+			continue;
+		}
+
+		if (std::all_of(vertices.begin(), vertices.end(), [](const auto & v) { return v.position.z + v.position.w >= 0.f; }))
+		{
+			addTriangle(shader, varyingCount, vertices[0], vertices[1], vertices[2], chunk.triangles);
+			continue;
+		}
+		std::array<ClipVertex, 4u> clipped;
+		const auto count = clipNear(vertices, clipped, varyingCount);
+		for (std::size_t j = 2; j < count; ++j)
+		{
+			addTriangle(shader, varyingCount, clipped[0], clipped[j - 1], clipped[j], chunk.triangles);
+		}
+	}
+}
+
+void SoftwareRasterizer::addTriangle(const RasterShader & shader, const std::size_t varyingCount, const ClipVertex & v0,
+									 const ClipVertex & v1, const ClipVertex & v2, std::vector<Triangle> & triangles) const
+{
+	// Window coordinates with depth in [0, 1] and 1 / w
+	const glm::vec2 scale{static_cast<float>(width_) * 0.5f, static_cast<float>(height_) * 0.5f};
+	const auto toWindow = [&](const ClipVertex & v) {
+		const auto inverseW = 1.f / v.position.w;
+		const auto ndc = glm::vec3{v.position} * inverseW;
+		return glm::vec4{(glm::vec2{ndc} + 1.f) * scale, ndc.z * 0.5f + 0.5f, inverseW};
+	};
+	std::array<glm::vec4, 3u> window{toWindow(v0), toWindow(v1), toWindow(v2)};
+	std::array<const ClipVertex *, 3u> source{&v0, &v1, &v2};
+
+	// Twice the signed area, positive for counter clockwise triangles
+	auto area = (window[1].x - window[0].x) * (window[2].y - window[0].y) - (window[2].x - window[0].x) * (window[1].y - window[0].y);
+	if (area < 0.f && !cullBackFaces_)
+	{
+		std::swap(window[1], window[2]);
+		std::swap(source[1], source[2]);
+		area = -area;
+	}
+	if (!(area > 0.f))
+	{
+		return;
+	}
+
+	Triangle triangle;
+	triangle.shader = &shader;
+	triangle.topLeft = 0;
+	triangle.varyingCount = static_cast<std::uint32_t>(varyingCount);
+	for (std::size_t i = 0; i < 3; ++i)
+	{
+		const auto & from = window[i];
+		const auto & to = window[(i + 1) % 3];
+		triangle.edgeA[i] = from.y - to.y;
+		triangle.edgeB[i] = to.x - from.x;
+		triangle.edgeC[i] = from.x * to.y - from.y * to.x;
+		// Inside is on the left, so left edges go down and top edges go left
+		if (triangle.edgeA[i] > 0.f || (triangle.edgeA[i] == 0.f && triangle.edgeB[i] < 0.f))
+		{
+			triangle.topLeft |= 1u << i;
+		}
+	}
+
+	const auto minCorner = glm::min(glm::vec2{window[0]}, glm::min(glm::vec2{window[1]}, glm::vec2{window[2]}));
+	const auto maxCorner = glm::max(glm::vec2{window[0]}, glm::max(glm::vec2{window[1]}, glm::vec2{window[2]}));
+	// Pixels with centers inside of the bounding box
+	triangle.minX = std::max(static_cast<int>(std::ceil(minCorner.x - 0.5f)), 0);
+	triangle.maxX = std::min(static_cast<int>(std::floor(maxCorner.x - 0.5f)), static_cast<int>(width_) - 1);
+	triangle.minY = std::max(static_cast<int>(std::ceil(minCorner.y - 0.5f)), 0);
+	triangle.maxY = std::min(static_cast<int>(std::floor(maxCorner.y - 0.5f)), static_cast<int>(height_) - 1);
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+	{
+		return;
+	}
+
+	// Values linear in window space, weights of vertices are edge functions of opposite edges
+	const auto plane = [&](const glm::vec3 & values) {
+		const glm::vec3 weights = glm::vec3{values[2], values[0], values[1]} / area;
+		return glm::vec3{glm::dot(triangle.edgeA, weights), glm::dot(triangle.edgeB, weights), glm::dot(triangle.edgeC, weights)};
+	};
+	const glm::vec3 inverseW{window[0].w, window[1].w, window[2].w};
+	triangle.depth = plane({window[0].z, window[1].z, window[2].z});
+	triangle.inverseW = plane(inverseW);
+	// Varyings divided by w are linear, fragments multiply them back by interpolated w
+	for (std::size_t i = 0; i < varyingCount; ++i)
+	{
+		triangle.varyings[i] = plane(glm::vec3{source[0]->varyings[i], source[1]->varyings[i], source[2]->varyings[i]} * inverseW);
+	}
+	triangles.push_back(triangle);
+}
+
+void SoftwareRasterizer::binTriangle(const Triangle & triangle)
+{
+	const auto tile = static_cast<int>(tileSize);
+	const auto firstTileX = triangle.minX / tile;
+	const auto lastTileX = triangle.maxX / tile;
+	const auto firstTileY = triangle.minY / tile;
+	const auto lastTileY = triangle.maxY / tile;
+	const auto single = firstTileX == lastTileX && firstTileY == lastTileY;
+
+	for (auto tileY = firstTileY; tileY <= lastTileY; ++tileY)
+	{
+		for (auto tileX = firstTileX; tileX <= lastTileX; ++tileX)
+		{
+			// Large triangles skip tiles outside of one edge, the edge is tested at the pixel
+			// center of the tile farthest inside of it
+			auto outside = false;
+			for (std::size_t i = 0; i < 3 && !single; ++i)
+			{
+				const auto x = static_cast<float>(tileX * tile + (triangle.edgeA[i] >= 0.f ? tile - 1 : 0)) + 0.5f;
+				const auto y = static_cast<float>(tileY * tile + (triangle.edgeB[i] >= 0.f ? tile - 1 : 0)) + 0.5f;
+				outside = outside || triangle.edgeA[i] * x + triangle.edgeB[i] * y + triangle.edgeC[i] < 0.f;
+			}
+			if (!outside)
+			{
+				bins_[static_cast<std::size_t>(tileY) * tilesX_ + static_cast<std::size_t>(tileX)].push_back(&triangle);
+				++stats_.binned;
+			}
+		}
+	}
+}
+
+std::size_t SoftwareRasterizer::rasterizeTile(const std::size_t tile)
+{
+	const auto tileBeginX = static_cast<int>(tile % tilesX_ * tileSize);
+	const auto tileBeginY = static_cast<int>(tile / tilesX_ * tileSize);
+	const auto tileEndX = tileBeginX + static_cast<int>(tileSize) - 1;
+	const auto tileEndY = tileBeginY + static_cast<int>(tileSize) - 1;
+	const auto laneOffsets = simd::sequence(0.5f);
+	const auto right = simd::broadcast(static_cast<float>(width_));
+	const auto zero = simd::broadcast(0.f);
+	const auto one = simd::broadcast(1.f);
+	const auto byteScale = simd::broadcast(255.f);
+	const auto half = simd::broadcast(0.5f);
+
+	std::array<simd::Float, RasterShader::maxVaryings> varyingA;
+	std::array<simd::Float, RasterShader::maxVaryings> varyingRow;
+	std::array<simd::Float, RasterShader::maxVaryings> varyings;
+	std::array<simd::Float, 4u> rgba;
+	alignas(32) float channels[4][simd::width];
+	std::size_t fragments = 0;
+
+	for (const auto * triangle: bins_[tile])
+	{
+		const auto minX = std::max(triangle->minX, tileBeginX);
+		const auto maxX = std::min(triangle->maxX, tileEndX);
+		const auto minY = std::max(triangle->minY, tileBeginY);
+		const auto maxY = std::min(triangle->maxY, tileEndY);
+		const auto firstX = minX / static_cast<int>(simd::width) * static_cast<int>(simd::width);
+		const auto varyingCount = triangle->varyingCount;
+		const auto & shader = *triangle->shader;
+
+		const auto a0 = simd::broadcast(triangle->edgeA[0]);
+		const auto a1 = simd::broadcast(triangle->edgeA[1]);
+		const auto a2 = simd::broadcast(triangle->edgeA[2]);
+		const auto topLeft0 = (triangle->topLeft & 1u) != 0u;
+		const auto topLeft1 = (triangle->topLeft & 2u) != 0u;
+		const auto topLeft2 = (triangle->topLeft & 4u) != 0u;
+		const auto depthA = simd::broadcast(triangle->depth.x);
+		const auto inverseWA = simd::broadcast(triangle->inverseW.x);
+		for (std::size_t i = 0; i < varyingCount; ++i)
+		{
+			varyingA[i] = simd::broadcast(triangle->varyings[i].x);
+		}
+
+		for (auto y = minY; y <= maxY; ++y)
+		{
+			const auto centerY = static_cast<float>(y) + 0.5f;
+			const auto row0 = simd::broadcast(triangle->edgeB[0] * centerY + triangle->edgeC[0]);
+			const auto row1 = simd::broadcast(triangle->edgeB[1] * centerY + triangle->edgeC[1]);
+			const auto row2 = simd::broadcast(triangle->edgeB[2] * centerY + triangle->edgeC[2]);
+			const auto rowDepth = simd::broadcast(triangle->depth.y * centerY + triangle->depth.z);
+			const auto rowInverseW = simd::broadcast(triangle->inverseW.y * centerY + triangle->inverseW.z);
+			for (std::size_t i = 0; i < varyingCount; ++i)
+			{
+				varyingRow[i] = simd::broadcast(triangle->varyings[i].y * centerY + triangle->varyings[i].z);
+			}
+			auto * depthRow = depth_.data() + static_cast<std::size_t>(y) * stride_;
+			auto * colorRow = colors_.data() + static_cast<std::size_t>(y) * stride_;
+
+			for (auto x = firstX; x <= maxX; x += static_cast<int>(simd::width))
+			{
+				const auto centerX = simd::broadcast(static_cast<float>(x)) + laneOffsets;
+				const auto inside = covers(a0 * centerX + row0, topLeft0) & covers(a1 * centerX + row1, topLeft1)
+					& covers(a2 * centerX + row2, topLeft2) & (centerX < right);
+				if (!simd::any(inside))
+				{
+					continue;
+				}
+
+				// Early depth test, shaders write neither depth nor discard pixels
+				const auto depth = depthA * centerX + rowDepth;
+				const auto current = simd::load(depthRow + x);
+				const auto passed = inside & (depth < current);
+				const auto mask = simd::bits(passed);
+				if (mask == 0u)
+				{
+					continue;
+				}
+				simd::store(depthRow + x, simd::select(passed, depth, current));
+
+				const auto w = one / (inverseWA * centerX + rowInverseW);
+				for (std::size_t i = 0; i < varyingCount; ++i)
+				{
+					varyings[i] = (varyingA[i] * centerX + varyingRow[i]) * w;
+				}
+				shader.fragment(varyings.data(), rgba.data());
+
+				for (std::size_t channel = 0; channel < rgba.size(); ++channel)
+				{
+					simd::store(channels[channel], simd::min(simd::max(rgba[channel], zero), one) * byteScale + half);
+				}
+				for (std::size_t lane = 0; lane < simd::width; ++lane)
+				{
+					if ((mask & (1u << lane)) == 0u)
+					{
+						continue;
+					}
+					colorRow[static_cast<std::size_t>(x) + lane] = static_cast<std::uint32_t>(channels[0][lane])
+						| static_cast<std::uint32_t>(channels[1][lane]) << 8 | static_cast<std::uint32_t>(channels[2][lane]) << 16
+						| static_cast<std::uint32_t>(channels[3][lane]) << 24;
+					++fragments;
+				}
+			}
+		}
+	}
+	return fragments;
+}
+
+}// namespace fgl
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <Base/Simd.hpp>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fgl
+{
+
+// C++ counterpart of a shader program for SoftwareRasterizer. Vertex stage runs once per
+// vertex of a draw, fragment stage runs for simd::width pixels of a row at once. Both
+// stages are called from worker threads, so they must not modify the shader.
+class RasterShader
+{
+public:
+	static constexpr std::size_t maxVaryings = 8;
+
+public:
+	virtual ~RasterShader() = default;
+
+	// Number of floats passed from vertex to fragment stage, at most maxVaryings.
+	virtual std::size_t varyingCount() const = 0;
+	// Returns clip space position of vertex of draw and writes its varyings, draw is
+	// the id passed to SoftwareRasterizer::draw like gl_DrawID.
+	virtual glm::vec4 vertex(std::uint32_t draw, std::uint32_t vertex, float * varyings) const = 0;
+	// Writes red, green, blue and alpha in [0, 1] from perspective correct varyings.
+	virtual void fragment(const simd::Float * varyings, simd::Float * rgba) const = 0;
+};
+
+struct RasterStats
+{
+	std::size_t draws = 0;
+	std::size_t triangles = 0;
+	// Triangles left after clipping, back face and zero area culling.
+	std::size_t setupTriangles = 0;
+	// Pairs of triangle and tile it overlaps.
+	std::size_t binned = 0;
+	// Pixels passed depth test and written.
+	std::size_t fragments = 0;
+
+	double geometryMs = 0.;
+	double binMs = 0.;
+	double rasterMs = 0.;
+};
+
+// Tiled software rasterizer for hosts without GPU. Draws are queued and executed by
+// flush(): vertices are shaded and triangles set up in parallel over draws, triangles
+// are binned into tileSize x tileSize screen tiles and tiles are rasterized in parallel,
+// each by one thread, with SIMD half space edge tests, depth test GL_LESS and
+// perspective correct varyings. Follows GL conventions: counter clockwise front faces,
+// first row is the bottom one, pixel centers at half integers, top left fill rule.
+class SoftwareRasterizer
+{
+public:
+	static constexpr std::size_t tileSize = 64;
+
+public:
+	SoftwareRasterizer(std::size_t width, std::size_t height);
+
+	void resize(std::size_t width, std::size_t height);
+	void setCullBackFaces(const bool cull) { cullBackFaces_ = cull; }
+
+	// Clears color and depth and resets stats.
+	void clear(const glm::vec4 & color, float depth = 1.f);
+	// Queues indexed triangle list, indices refer to vertices [0, vertexCount) of the draw.
+	// Shader and indices must stay alive until flush().
+	void draw(const RasterShader & shader, std::uint32_t drawId, std::size_t vertexCount, const std::uint32_t * indices,
+			  std::size_t indexCount);
+	// Renders queued draws in submission order.
+	void flush();
+
+	std::size_t width() const { return width_; }
+	std::size_t height() const { return height_; }
+	// Pixels between starts of rows.
+	std::size_t stride() const { return stride_; }
+	// RGBA8 pixels with red in the lowest byte, rows go from bottom to top.
+	const std::uint32_t * colors() const { return colors_.data(); }
+	const float * depth() const { return depth_.data(); }
+
+	// Counters accumulated since clear().
+	const RasterStats & stats() const { return stats_; }
+
+private:
+	struct Draw
+	{
+		const RasterShader * shader;
+		std::uint32_t id;
+		std::size_t vertexCount;
+		const std::uint32_t * indices;
+		std::size_t indexCount;
+	};
+
+	struct ClipVertex
+	{
+		glm::vec4 position;
+		std::array<float, RasterShader::maxVaryings> varyings;
+	};
+
+	struct Triangle
+	{
+		const RasterShader * shader;
+		// Edge functions a * x + b * y + c are positive inside.
+		glm::vec3 edgeA;
+		glm::vec3 edgeB;
+		glm::vec3 edgeC;
+		// Edges where zero counts as inside by top left rule, bit per edge.
+		std::uint32_t topLeft;
+		std::uint32_t varyingCount;
+		// Planes a * x + b * y + c of window depth, 1 / w and varyings divided by w.
+		glm::vec3 depth;
+		glm::vec3 inverseW;
+		std::array<glm::vec3, RasterShader::maxVaryings> varyings;
+		int minX, maxX;
+		int minY, maxY;
+	};
+
+	// Draws processed by one geometry job, triangles keep submission order.
+	struct Chunk
+	{
+		std::vector<ClipVertex> vertices;
+		std::vector<Triangle> triangles;
+	};
+
+private:
+	void processDraw(const Draw & draw, Chunk & chunk) const;
+	void addTriangle(const RasterShader & shader, std::size_t varyingCount, const ClipVertex & v0, const ClipVertex & v1,
+					 const ClipVertex & v2, std::vector<Triangle> & triangles) const;
+	void binTriangle(const Triangle & triangle);
+	std::size_t rasterizeTile(std::size_t tile);
+
+private:
+	std::size_t width_ = 0;
+	std::size_t height_ = 0;
+	std::size_t stride_ = 0;
+	std::size_t tilesX_ = 0;
+	std::size_t tilesY_ = 0;
+	bool cullBackFaces_ = true;
+
+	std::vector<std::uint32_t> colors_;
+	std::vector<float> depth_;
+
+	std::vector<Draw> draws_;
+	std::vector<Chunk> chunks_;
+	// Triangles overlapping each tile in submission order.
+	std::vector<std::vector<const Triangle *>> bins_;
+	std::vector<std::size_t> tileFragments_;
+
+	RasterStats stats_;
+};
+
+}// namespace fgl
@@ -0,0 +1,818 @@
+#include "TextureCompression.hpp"
+
+#include <Base/ParallelFor.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace fgl
+{
+
+namespace
+{
+
+using Block = std::array<std::uint32_t, 16>;
+using Colors = std::array<glm::vec4, 16>;
+using Indices = std::array<int, 16>;
+
+constexpr int g_blockSize = 4;
+constexpr int g_powerIterations = 8;
+constexpr int g_refineIterations = 2;
+// Interpolation factors of BC1 indices towards the second endpoint.
+constexpr float g_bc1Factors[] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+// BC7 4 bit index weights out of 64.
+constexpr int g_bc7Weights[] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+// ETC1 intensity modifier tables, indices are +small, +large, -small, -large.
+constexpr int g_etcModifiers[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+int channel(const std::uint32_t pixel, const int index)
+{
+	return static_cast<int>(pixel >> (8 * index) & 0xffu);
+}
+
+Block loadBlock(const Rgba8Image & image, const int blockX, const int blockY)
+{
+	Block block;
+	for (int y = 0; y < g_blockSize; ++y)
+	{
+		const auto row = static_cast<std::size_t>(std::min(blockY * g_blockSize + y, image.height - 1)) * static_cast<std::size_t>(image.width);
+		for (int x = 0; x < g_blockSize; ++x)
+		{
+			const auto column = static_cast<std::size_t>(std::min(blockX * g_blockSize + x, image.width - 1));
+			block[static_cast<std::size_t>(y * g_blockSize + x)] = image.pixels[row + column];
+		}
+	}
+	return block;
+}
+
+// First channels of pixels, the rest are zero so they do not affect fitting.
+Colors toColors(const Block & block, const int channels)
+{
+	Colors colors;
+	for (std::size_t i = 0; i < block.size(); ++i)
+	{
+		colors[i] = glm::vec4{0.f};
+		for (int c = 0; c < channels; ++c)
+		{
+			colors[i][c] = static_cast<float>(channel(block[i], c));
+		}
+	}
+	return colors;
+}
+
+float distance2(const glm::vec4 & a, const glm::vec4 & b)
+{
+	const auto d = a - b;
+	return glm::dot(d, d);
+}
+
+void storeLittleEndian(std::uint8_t * out, const std::uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+	{
+		out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+	}
+}
+
+// Ends of colors projected on their principal axis.
+void principalEndpoints(const Colors & colors, glm::vec4 & first, glm::vec4 & second)
+{
+	glm::vec4 mean{0.f};
+	glm::vec4 min{255.f};
+	glm::vec4 max{0.f};
+	for (const auto & color: colors)
+	{
+		mean += color;
+		min = glm::min(min, color);
+		max = glm::max(max, color);
+	}
+	mean /= static_cast<float>(colors.size());
+
+	glm::mat4 covariance{0.f};
+	for (const auto & color: colors)
+	{
+		const auto d = color - mean;
+		covariance += glm::outerProduct(d, d);
+	}
+
+	// Power iteration from the bounding box diagonal
+	auto axis = max - min;
+	for (int i = 0; i < g_powerIterations && glm::dot(axis, axis) > 1e-6f; ++i)
+	{
+		axis = covariance * axis;
+		axis /= std::max(std::abs(axis.x), std::max(std::abs(axis.y), std::max(std::abs(axis.z), std::abs(axis.w))));
+	}
+	if (glm::dot(axis, axis) <= 1e-6f)
+	{
+		first = mean;
+		second = mean;
+		return;
+	}
+	axis = glm::normalize(axis);
+
+	auto minT = std::numeric_limits<float>::max();
+	auto maxT = std::numeric_limits<float>::lowest();
+	for (const auto & color: colors)
+	{
+		const auto t = glm::dot(color - mean, axis);
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+	first = glm::clamp(mean + axis * minT, 0.f, 255.f);
+	second = glm::clamp(mean + axis * maxT, 0.f, 255.f);
+}
+
+// Least squares endpoints for factors of pixels towards the second one, false when they are
+// not determined.
+bool refineEndpoints(const Colors & colors, const std::array<float, 16> & factors, glm::vec4 & first, glm::vec4 & second)
+{
+	float aa = 0.f;
+	float ab = 0.f;
+	float bb = 0.f;
+	glm::vec4 ax{0.f};
+	glm::vec4 bx{0.f};
+	for (std::size_t i = 0; i < colors.size(); ++i)
+	{
+		const auto t = factors[i];
+		const auto s = 1.f - t;
+		aa += s * s;
+		ab += s * t;
+		bb += t * t;
+		ax += s * colors[i];
+		bx += t * colors[i];
+	}
+	const auto determinant = aa * bb - ab * ab;
+	if (std::abs(determinant) < 1e-6f)
+	{
+		return false;
+	}
+	first = glm::clamp((ax * bb - bx * ab) / determinant, 0.f, 255.f);
+	second = glm::clamp((bx * aa - ax * ab) / determinant, 0.f, 255.f);
+	return true;
+}
+
+// BC1
+
+std::uint16_t toRgb565(const glm::vec4 & color)
+{
+	const auto r = static_cast<std::uint16_t>(std::lround(color.r * 31.f / 255.f));
+	const auto g = static_cast<std::uint16_t>(std::lround(color.g * 63.f / 255.f));
+	const auto b = static_cast<std::uint16_t>(std::lround(color.b * 31.f / 255.f));
+	return static_cast<std::uint16_t>(r << 11u | g << 5u | b);
+}
+
+glm::vec4 fromRgb565(const std::uint16_t value)
+{
+	const auto r = value >> 11u;
+	const auto g = value >> 5u & 63u;
+	const auto b = value & 31u;
+	return {static_cast<float>(r << 3u | r >> 2u), static_cast<float>(g << 2u | g >> 4u), static_cast<float>(b << 3u | b >> 2u), 0.f};
+}
+
+// Nearest colors of four color palette, returns squared error.
+float bc1Indices(const Colors & colors, const std::uint16_t first, const std::uint16_t second, Indices & indices)
+{
+	std::array<glm::vec4, 4> palette;
+	for (std::size_t i = 0; i < palette.size(); ++i)
+	{
+		palette[i] = glm::mix(fromRgb565(first), fromRgb565(second), g_bc1Factors[i]);
+	}
+	float error = 0.f;
+	for (std::size_t i = 0; i < colors.size(); ++i)
+	{
+		auto best = std::numeric_limits<float>::max();
+		for (std::size_t p = 0; p < palette.size(); ++p)
+		{
+			const auto d = distance2(colors[i], palette[p]);
+			if (d < best)
+			{
+				best = d;
+				indices[i] = static_cast<int>(p);
+			}
+		}
+		error += best;
+	}
+	return error;
+}
+
+std::uint64_t encodeBc1(const Block & block, const EncoderPreset preset, float & error)
+{
+	const auto colors = toColors(block, 3);
+	glm::vec4 first;
+	glm::vec4 second;
+	principalEndpoints(colors, first, second);
+	auto color0 = toRgb565(first);
+	auto color1 = toRgb565(second);
+	Indices indices;
+	error = bc1Indices(colors, color0, color1, indices);
+
+	for (int iteration = 0; preset == EncoderPreset::Quality && iteration < g_refineIterations; ++iteration)
+	{
+		std::array<float, 16> factors;
+		for (std::size_t i = 0; i < factors.size(); ++i)
+		{
+			factors[i] = g_bc1Factors[indices[i]];
+		}
+		if (!refineEndpoints(colors, factors, first, second))
+		{
+			break;
+		}
+		const auto refined0 = toRgb565(first);
+		const auto refined1 = toRgb565(second);
+		Indices refinedIndices;
+		const auto refinedError = bc1Indices(colors, refined0, refined1, refinedIndices);
+		if (refinedError >= error)
+		{
+			break;
+		}
+		color0 = refined0;
+		color1 = refined1;
+		indices = refinedIndices;
+		error = refinedError;
+	}
+
+	// Four color mode needs the first endpoint to be larger, equal ones would give three
+	// color mode with transparent black
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+		for (auto & index: indices)
+		{
+			index ^= 1;
+		}
+	}
+	else if (color0 == color1)
+	{
+		indices.fill(0);
+	}
+
+	std::uint64_t bits = static_cast<std::uint64_t>(color0) | static_cast<std::uint64_t>(color1) << 16u;
+	for (std::size_t i = 0; i < indices.size(); ++i)
+	{
+		bits |= static_cast<std::uint64_t>(indices[i]) << (32u + 2u * i);
+	}
+	return bits;
+}
+
+// BC4
+
+std::array<int, 8> bc4Palette(const int first, const int second)
+{
+	std::array<int, 8> palette{first, second};
+	if (first > second)
+	{
+		for (int i = 1; i <= 6; ++i)
+		{
+			palette[static_cast<std::size_t>(i + 1)] = ((7 - i) * first + i * second) / 7;
+		}
+	}
+	else
+	{
+		for (int i = 1; i <= 4; ++i)
+		{
+			palette[static_cast<std::size_t>(i + 1)] = ((5 - i) * first + i * second) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+	return palette;
+}
+
+int bc4Indices(const std::array<int, 16> & values, const int first, const int second, Indices & indices)
+{
+	const auto palette = bc4Palette(first, second);
+	int error = 0;
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		auto best = std::numeric_limits<int>::max();
+		for (std::size_t p = 0; p < palette.size(); ++p)
+		{
+			const auto d = (values[i] - palette[p]) * (values[i] - palette[p]);
+			if (d < best)
+			{
+				best = d;
+				indices[i] = static_cast<int>(p);
+			}
+		}
+		error += best;
+	}
+	return error;
+}
+
+std::uint64_t encodeBc4(const Block & block, const int channelIndex, const EncoderPreset preset, float & error)
+{
+	std::array<int, 16> values;
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		values[i] = channel(block[i], channelIndex);
+	}
+	const auto [min, max] = std::minmax_element(values.begin(), values.end());
+	auto first = *max;
+	auto second = *min;
+	Indices indices;
+	auto bestError = bc4Indices(values, first, second, indices);
+
+	const auto tryEndpoints = [&](const int candidateFirst, const int candidateSecond) {
+		Indices candidateIndices;
+		const auto candidateError = bc4Indices(values, candidateFirst, candidateSecond, candidateIndices);
+		if (candidateError < bestError)
+		{
+			first = candidateFirst;
+			second = candidateSecond;
+			indices = candidateIndices;
+			bestError = candidateError;
+		}
+	};
+
+	if (preset == EncoderPreset::Quality && *max > *min)
+	{
+		// Least squares endpoints of eight value mode
+		Colors colors;
+		std::array<float, 16> factors;
+		for (std::size_t i = 0; i < values.size(); ++i)
+		{
+			colors[i] = glm::vec4{static_cast<float>(values[i]), 0.f, 0.f, 0.f};
+			factors[i] = indices[i] == 0 ? 0.f : indices[i] == 1 ? 1.f : static_cast<float>(indices[i] - 1) / 7.f;
+		}
+		glm::vec4 refinedFirst;
+		glm::vec4 refinedSecond;
+		if (refineEndpoints(colors, factors, refinedFirst, refinedSecond))
+		{
+			const auto candidateFirst = static_cast<int>(std::lround(refinedFirst.x));
+			const auto candidateSecond = static_cast<int>(std::lround(refinedSecond.x));
+			if (candidateFirst > candidateSecond)
+			{
+				tryEndpoints(candidateFirst, candidateSecond);
+			}
+		}
+
+		// Six value mode spans values between 0 and 255, which it has exactly
+		auto innerMin = 255;
+		auto innerMax = 0;
+		for (const auto value: values)
+		{
+			if (value != 0 && value != 255)
+			{
+				innerMin = std::min(innerMin, value);
+				innerMax = std::max(innerMax, value);
+			}
+		}
+		if (innerMin <= innerMax)
+		{
+			tryEndpoints(innerMin, innerMax);
+		}
+	}
+
+	error = static_cast<float>(bestError);
+	std::uint64_t bits = static_cast<std::uint64_t>(first) | static_cast<std::uint64_t>(second) << 8u;
+	for (std::size_t i = 0; i < indices.size(); ++i)
+	{
+		bits |= static_cast<std::uint64_t>(indices[i]) << (16u + 3u * i);
+	}
+	return bits;
+}
+
+// BC7 mode 6
+
+class BitWriter
+{
+public:
+	void write(const std::uint64_t value, const int bits)
+	{
+		const auto word = static_cast<std::size_t>(position_ / 64);
+		const auto shift = position_ % 64;
+		words_[word] |= value << shift;
+		if (shift + bits > 64)
+		{
+			words_[word + 1] |= value >> (64 - shift);
+		}
+		position_ += bits;
+	}
+
+	const std::array<std::uint64_t, 2> & words() const { return words_; }
+
+private:
+	std::array<std::uint64_t, 2> words_{};
+	int position_ = 0;
+};
+
+// 7 bit endpoint with p-bit, expanded value is (q << 1) | p.
+glm::ivec4 quantizeBc7(const glm::vec4 & color, const int pBit)
+{
+	return glm::clamp(glm::ivec4{glm::round((color - static_cast<float>(pBit)) * 0.5f)}, 0, 127);
+}
+
+glm::ivec4 expandBc7(const glm::ivec4 & quantized, const int pBit)
+{
+	return quantized * 2 + pBit;
+}
+
+float bc7Indices(const Colors & colors, const glm::ivec4 & first, const glm::ivec4 & second, Indices & indices)
+{
+	std::array<glm::vec4, 16> palette;
+	for (std::size_t i = 0; i < palette.size(); ++i)
+	{
+		palette[i] = glm::vec4{((64 - g_bc7Weights[i]) * first + g_bc7Weights[i] * second + 32) / 64};
+	}
+	float error = 0.f;
+	for (std::size_t i = 0; i < colors.size(); ++i)
+	{
+		auto best = std::numeric_limits<float>::max();
+		for (std::size_t p = 0; p < palette.size(); ++p)
+		{
+			const auto d = distance2(colors[i], palette[p]);
+			if (d < best)
+			{
+				best = d;
+				indices[i] = static_cast<int>(p);
+			}
+		}
+		error += best;
+	}
+	return error;
+}
+
+struct Bc7Endpoints
+{
+	glm::ivec4 first{0};
+	glm::ivec4 second{0};
+	int firstPBit = 0;
+	int secondPBit = 0;
+};
+
+// Quantizes endpoints with p-bits, fast preset picks p-bit of each endpoint separately and
+// quality one tries all of their combinations. Returns squared error.
+float quantizeBc7Endpoints(const Colors & colors, const glm::vec4 & first, const glm::vec4 & second, const EncoderPreset preset,
+						   Bc7Endpoints & endpoints, Indices & indices)
+{
+	const auto closestPBit = [](const glm::vec4 & color) {
+		const auto error = [&](const int pBit) {
+			return distance2(glm::vec4{expandBc7(quantizeBc7(color, pBit), pBit)}, color);
+		};
+		return error(1) < error(0) ? 1 : 0;
+	};
+
+	auto best = std::numeric_limits<float>::max();
+	for (int combination = 0; combination < 4; ++combination)
+	{
+		Bc7Endpoints candidate;
+		if (preset == EncoderPreset::Fast)
+		{
+			if (combination > 0)
+			{
+				break;
+			}
+			candidate.firstPBit = closestPBit(first);
+			candidate.secondPBit = closestPBit(second);
+		}
+		else
+		{
+			candidate.firstPBit = combination & 1;
+			candidate.secondPBit = combination >> 1;
+		}
+		candidate.first = quantizeBc7(first, candidate.firstPBit);
+		candidate.second = quantizeBc7(second, candidate.secondPBit);
+
+		Indices candidateIndices;
+		const auto error = bc7Indices(colors, expandBc7(candidate.first, candidate.firstPBit),
+									  expandBc7(candidate.second, candidate.secondPBit), candidateIndices);
+		if (error < best)
+		{
+			best = error;
+			endpoints = candidate;
+			indices = candidateIndices;
+		}
+	}
+	return best;
+}
+
+std::array<std::uint64_t, 2> encodeBc7(const Block & block, const EncoderPreset preset, float & error)
+{
+	const auto colors = toColors(block, 4);
+	glm::vec4 first;
+	glm::vec4 second;
+	principalEndpoints(colors, first, second);
+	Bc7Endpoints endpoints;
+	Indices indices;
+	error = quantizeBc7Endpoints(colors, first, second, preset, endpoints, indices);
+
+	for (int iteration = 0; preset == EncoderPreset::Quality && iteration < g_refineIterations; ++iteration)
+	{
+		std::array<float, 16> factors;
+		for (std::size_t i = 0; i < factors.size(); ++i)
+		{
+			factors[i] = static_cast<float>(g_bc7Weights[indices[i]]) / 64.f;
+		}
+		if (!refineEndpoints(colors, factors, first, second))
+		{
+			break;
+		}
+		Bc7Endpoints refined;
+		Indices refinedIndices;
+		const auto refinedError = quantizeBc7Endpoints(colors, first, second, preset, refined, refinedIndices);
+		if (refinedError >= error)
+		{
+			break;
+		}
+		endpoints = refined;
+		indices = refinedIndices;
+		error = refinedError;
+	}
+
+	// The highest bit of the first index is implicit zero
+	if (indices[0] >= 8)
+	{
+		std::swap(endpoints.first, endpoints.second);
+		std::swap(endpoints.firstPBit, endpoints.secondPBit);
+		for (auto & index: indices)
+		{
+			index = 15 - index;
+		}
+	}
+
+	BitWriter writer;
+	writer.write(1u << 6u, 7);
+	for (int c = 0; c < 4; ++c)
+	{
+		writer.write(static_cast<std::uint64_t>(endpoints.first[c]), 7);
+		writer.write(static_cast<std::uint64_t>(endpoints.second[c]), 7);
+	}
+	writer.write(static_cast<std::uint64_t>(endpoints.firstPBit), 1);
+	writer.write(static_cast<std::uint64_t>(endpoints.secondPBit), 1);
+	for (std::size_t i = 0; i < indices.size(); ++i)
+	{
+		writer.write(static_cast<std::uint64_t>(indices[i]), i == 0 ? 3 : 4);
+	}
+	return writer.words();
+}
+
+// ETC1 blocks, which ETC2 decodes the same way as long as differential colors do not overflow
+
+struct EtcSubblock
+{
+	std::array<glm::ivec3, 8> colors;
+	// Pixel bit positions, x * 4 + y
+	std::array<int, 8> positions;
+	glm::vec3 average{0.f};
+};
+
+struct EtcFit
+{
+	// Quantized base color, 4 or 5 bits per channel
+	glm::ivec3 base{0};
+	int table = 0;
+	std::array<int, 8> indices{};
+	int error = std::numeric_limits<int>::max();
+};
+
+int etcModifier(const int table, const int index)
+{
+	const auto modifier = g_etcModifiers[table][index & 1];
+	return (index & 2) != 0 ? -modifier : modifier;
+}
+
+glm::ivec3 expandEtc(const glm::ivec3 & base, const int bits)
+{
+	return bits == 4 ? base * 17 : base << 3 | base >> 2;
+}
+
+// Best modifier table and indices for base color.
+void fitEtcTables(const EtcSubblock & subblock, const glm::ivec3 & base, const int bits, EtcFit & fit)
+{
+	const auto color = expandEtc(base, bits);
+	for (int table = 0; table < 8; ++table)
+	{
+		EtcFit candidate;
+		candidate.base = base;
+		candidate.table = table;
+		candidate.error = 0;
+		for (std::size_t i = 0; i < subblock.colors.size() && candidate.error < fit.error; ++i)
+		{
+			auto best = std::numeric_limits<int>::max();
+			for (int index = 0; index < 4; ++index)
+			{
+				const auto d = glm::clamp(color + etcModifier(table, index), 0, 255) - subblock.colors[i];
+				const auto error = d.x * d.x + d.y * d.y + d.z * d.z;
+				if (error < best)
+				{
+					best = error;
+					candidate.indices[i] = index;
+				}
+			}
+			candidate.error += best;
+		}
+		if (candidate.error < fit.error)
+		{
+			fit = candidate;
+		}
+	}
+}
+
+// Fits for base colors around the subblock average, index 1 is the rounded average.
+std::array<EtcFit, 3> fitEtcSubblock(const EtcSubblock & subblock, const int bits, const EncoderPreset preset)
+{
+	const auto maxValue = (1 << bits) - 1;
+	const auto rounded = glm::ivec3{glm::round(subblock.average * static_cast<float>(maxValue) / 255.f)};
+	std::array<EtcFit, 3> fits;
+	for (int offset = -1; offset <= 1; ++offset)
+	{
+		if (preset == EncoderPreset::Fast && offset != 0)
+		{
+			continue;
+		}
+		fitEtcTables(subblock, glm::clamp(rounded + offset, 0, maxValue), bits, fits[static_cast<std::size_t>(offset + 1)]);
+	}
+	return fits;
+}
+
+std::array<std::uint8_t, 8> packEtc(const bool differential, const bool flip, const EtcSubblock (&subblocks)[2], const EtcFit & first,
+									const EtcFit & second)
+{
+	std::array<std::uint8_t, 8> bytes{};
+	for (int c = 0; c < 3; ++c)
+	{
+		const auto value = differential ? first.base[c] << 3 | ((second.base[c] - first.base[c]) & 7) : first.base[c] << 4 | second.base[c];
+		bytes[static_cast<std::size_t>(c)] = static_cast<std::uint8_t>(value);
+	}
+	bytes[3] = static_cast<std::uint8_t>(first.table << 5 | second.table << 2 | (differential ? 2 : 0) | (flip ? 1 : 0));
+
+	std::uint32_t indexBits = 0;
+	const EtcFit * fits[] = {&first, &second};
+	for (int s = 0; s < 2; ++s)
+	{
+		for (std::size_t i = 0; i < 8; ++i)
+		{
+			const auto index = static_cast<std::uint32_t>(fits[s]->indices[i]);
+			const auto position = static_cast<std::uint32_t>(subblocks[s].positions[i]);
+			indexBits |= (index >> 1u) << (16u + position) | (index & 1u) << position;
+		}
+	}
+	for (int i = 0; i < 4; ++i)
+	{
+		bytes[static_cast<std::size_t>(4 + i)] = static_cast<std::uint8_t>(indexBits >> (24 - 8 * i));
+	}
+	return bytes;
+}
+
+std::array<std::uint8_t, 8> encodeEtc(const Block & block, const EncoderPreset preset, float & error)
+{
+	std::array<std::uint8_t, 8> best{};
+	auto bestError = std::numeric_limits<int>::max();
+	for (const auto flip: {false, true})
+	{
+		// Side by side 2x4 subblocks, or 4x2 ones on top of each other when flipped
+		EtcSubblock subblocks[2];
+		std::array<std::size_t, 2> counts{};
+		for (int y = 0; y < g_blockSize; ++y)
+		{
+			for (int x = 0; x < g_blockSize; ++x)
+			{
+				const auto s = static_cast<std::size_t>(flip ? y / 2 : x / 2);
+				const auto pixel = block[static_cast<std::size_t>(y * g_blockSize + x)];
+				const glm::ivec3 color{channel(pixel, 0), channel(pixel, 1), channel(pixel, 2)};
+				subblocks[s].colors[counts[s]] = color;
+				subblocks[s].positions[counts[s]] = x * 4 + y;
+				subblocks[s].average += glm::vec3{color} / 8.f;
+				++counts[s];
+			}
+		}
+
+		const auto tryCandidate = [&](const bool differential, const EtcFit & first, const EtcFit & second) {
+			if (first.error == std::numeric_limits<int>::max() || second.error == std::numeric_limits<int>::max() ||
+				first.error + second.error >= bestError)
+			{
+				return;
+			}
+			bestError = first.error + second.error;
+			best = packEtc(differential, flip, subblocks, first, second);
+		};
+
+		// Individual mode, 4 bit base colors
+		const auto individual0 = fitEtcSubblock(subblocks[0], 4, preset);
+		const auto individual1 = fitEtcSubblock(subblocks[1], 4, preset);
+		const auto bestFit = [](const std::array<EtcFit, 3> & fits) {
+			return *std::min_element(fits.begin(), fits.end(), [](const EtcFit & a, const EtcFit & b) { return a.error < b.error; });
+		};
+		tryCandidate(false, bestFit(individual0), bestFit(individual1));
+
+		// Differential mode, 5 bit base colors with the second one within [-4, 3] of the first
+		const auto differential0 = fitEtcSubblock(subblocks[0], 5, preset);
+		const auto differential1 = fitEtcSubblock(subblocks[1], 5, preset);
+		for (const auto & first: differential0)
+		{
+			for (const auto & second: differential1)
+			{
+				const auto delta = second.base - first.base;
+				if (glm::all(glm::greaterThanEqual(delta, glm::ivec3{-4})) && glm::all(glm::lessThanEqual(delta, glm::ivec3{3})))
+				{
+					tryCandidate(true, first, second);
+				}
+			}
+		}
+	}
+	error = static_cast<float>(bestError);
+	return best;
+}
+
+void encodeBlock(const Block & block, const TextureFormat format, const EncoderPreset preset, std::uint8_t * out, float & error)
+{
+	switch (format)
+	{
+		case TextureFormat::Rgba8:
+			std::memcpy(out, block.data(), sizeof(block));
+			error = 0.f;
+			break;
+		case TextureFormat::Bc1:
+			storeLittleEndian(out, encodeBc1(block, preset, error));
+			break;
+		case TextureFormat::Bc3:
+		{
+			float alphaError = 0.f;
+			storeLittleEndian(out, encodeBc4(block, 3, preset, alphaError));
+			storeLittleEndian(out + 8, encodeBc1(block, preset, error));
+			error += alphaError;
+			break;
+		}
+		case TextureFormat::Bc5:
+		{
+			float greenError = 0.f;
+			storeLittleEndian(out, encodeBc4(block, 0, preset, error));
+			storeLittleEndian(out + 8, encodeBc4(block, 1, preset, greenError));
+			error += greenError;
+			break;
+		}
+		case TextureFormat::Bc7:
+		{
+			const auto words = encodeBc7(block, preset, error);
+			storeLittleEndian(out, words[0]);
+			storeLittleEndian(out + 8, words[1]);
+			break;
+		}
+		case TextureFormat::Etc2:
+		{
+			const auto bytes = encodeEtc(block, preset, error);
+			std::memcpy(out, bytes.data(), bytes.size());
+			break;
+		}
+	}
+}
+
+}// namespace
+
+const char * encoderPresetName(const EncoderPreset preset)
+{
+	return preset == EncoderPreset::Fast ? "fast" : "quality";
+}
+
+std::optional<EncoderPreset> parseEncoderPreset(const QString & name)
+{
+	for (const auto preset: {EncoderPreset::Fast, EncoderPreset::Quality})
+	{
+		if (name.toLower() == encoderPresetName(preset))
+		{
+			return preset;
+		}
+	}
+	return std::nullopt;
+}
+
+EncodedLevel encode(const Rgba8Image & image, const TextureFormat format, const EncoderPreset preset)
+{
+	EncodedLevel result;
+	result.bytes.resize(levelBytes(format, image.width, image.height));
+	if (format == TextureFormat::Rgba8)
+	{
+		std::memcpy(result.bytes.data(), image.pixels.data(), result.bytes.size());
+		return result;
+	}
+
+	const auto blocksX = (image.width + g_blockSize - 1) / g_blockSize;
+	const auto blocksY = (image.height + g_blockSize - 1) / g_blockSize;
+	const auto bytesPerBlock = blockBytes(format);
+	std::vector<double> rowErrors(static_cast<std::size_t>(blocksY), 0.);
+	parallelFor(static_cast<std::size_t>(blocksY), 1, [&](const std::size_t begin, const std::size_t end) {
+		for (auto row = begin; row < end; ++row)
+		{
+			auto * out = result.bytes.data() + row * static_cast<std::size_t>(blocksX) * bytesPerBlock;
+			for (int column = 0; column < blocksX; ++column)
+			{
+				float error = 0.f;
+				encodeBlock(loadBlock(image, column, static_cast<int>(row)), format, preset, out, error);
+				rowErrors[row] += static_cast<double>(error);
+				out += bytesPerBlock;
+			}
+		}
+	});
+	for (const auto error: rowErrors)
+	{
+		result.squaredError += error;
+	}
+	return result;
+}
+
+}// namespace fgl
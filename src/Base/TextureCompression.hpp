@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Base/TextureFormat.hpp>
+
+#include <QString>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace fgl
+{
+
+enum class EncoderPreset
+{
+	// Endpoints along principal axis of block colors
+	Fast,
+	// Endpoints refined by least squares, more mode and base color candidates are tried
+	Quality,
+};
+
+const char * encoderPresetName(EncoderPreset preset);
+std::optional<EncoderPreset> parseEncoderPreset(const QString & name);
+
+struct EncodedLevel
+{
+	std::vector<std::uint8_t> bytes;
+	// Sum of squared errors of encoded channels over all pixels of blocks.
+	double squaredError = 0.;
+};
+
+// Encodes image into blocks of format, block rows are spread over worker threads. Blocks
+// crossing image edge repeat its last row and column. Rgba8 is copied as it is.
+EncodedLevel encode(const Rgba8Image & image, TextureFormat format, EncoderPreset preset);
+
+}// namespace fgl
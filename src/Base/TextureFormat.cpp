@@ -0,0 +1,256 @@
+#include "TextureFormat.hpp"
+
+#include <QDebug>
+#include <QImage>
+#include <QOpenGLContext>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr TextureFormat g_formats[] = {TextureFormat::Rgba8, TextureFormat::Bc1, TextureFormat::Bc3,
+									   TextureFormat::Bc5, TextureFormat::Bc7, TextureFormat::Etc2};
+
+std::uint32_t average(const std::uint32_t a, const std::uint32_t b, const std::uint32_t c, const std::uint32_t d)
+{
+	std::uint32_t result = 0;
+	for (std::uint32_t shift = 0; shift < 32u; shift += 8u)
+	{
+		const auto sum = (a >> shift & 0xffu) + (b >> shift & 0xffu) + (c >> shift & 0xffu) + (d >> shift & 0xffu) + 2u;
+		result |= (sum / 4u) << shift;
+	}
+	return result;
+}
+
+bool hasVersion(const QOpenGLContext & context, const int major, const int minor)
+{
+	const auto format = context.format();
+	return format.majorVersion() > major || (format.majorVersion() == major && format.minorVersion() >= minor);
+}
+
+}// namespace
+
+const char * textureFormatName(const TextureFormat format)
+{
+	switch (format)
+	{
+		case TextureFormat::Rgba8:
+			return "rgba8";
+		case TextureFormat::Bc1:
+			return "bc1";
+		case TextureFormat::Bc3:
+			return "bc3";
+		case TextureFormat::Bc5:
+			return "bc5";
+		case TextureFormat::Bc7:
+			return "bc7";
+		case TextureFormat::Etc2:
+			return "etc2";
+	}
+	return "unknown";
+}
+
+std::optional<TextureFormat> parseTextureFormat(const QString & name)
+{
+	const auto lower = name.toLower();
+	for (const auto format: g_formats)
+	{
+		if (lower == textureFormatName(format))
+		{
+			return format;
+		}
+	}
+	return std::nullopt;
+}
+
+std::size_t blockBytes(const TextureFormat format)
+{
+	switch (format)
+	{
+		case TextureFormat::Rgba8:
+			return 4u;
+		case TextureFormat::Bc1:
+		case TextureFormat::Etc2:
+			return 8u;
+		case TextureFormat::Bc3:
+		case TextureFormat::Bc5:
+		case TextureFormat::Bc7:
+			return 16u;
+	}
+	return 0u;
+}
+
+std::size_t levelBytes(const TextureFormat format, const int width, const int height)
+{
+	if (format == TextureFormat::Rgba8)
+	{
+		return static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4u;
+	}
+	const auto blocksX = static_cast<std::size_t>((width + 3) / 4);
+	const auto blocksY = static_cast<std::size_t>((height + 3) / 4);
+	return blocksX * blocksY * blockBytes(format);
+}
+
+int channelCount(const TextureFormat format)
+{
+	switch (format)
+	{
+		case TextureFormat::Bc5:
+			return 2;
+		case TextureFormat::Bc1:
+		case TextureFormat::Etc2:
+			return 3;
+		case TextureFormat::Rgba8:
+		case TextureFormat::Bc3:
+		case TextureFormat::Bc7:
+			return 4;
+	}
+	return 4;
+}
+
+int levelSize(const int size, const int level)
+{
+	return std::max(size >> level, 1);
+}
+
+int fullLevelCount(const int width, const int height)
+{
+	return static_cast<int>(std::floor(std::log2(static_cast<float>(std::max({width, height, 1}))))) + 1;
+}
+
+std::optional<Rgba8Image> loadRgba8Image(const QString & path)
+{
+	QImage image;
+	if (!image.load(path))
+	{
+		return std::nullopt;
+	}
+	// OpenGL rows go from the bottom
+	image = image.convertToFormat(QImage::Format_RGBA8888).mirrored();
+
+	Rgba8Image result;
+	result.width = image.width();
+	result.height = image.height();
+	result.pixels.resize(static_cast<std::size_t>(result.width) * static_cast<std::size_t>(result.height));
+	for (int y = 0; y < result.height; ++y)
+	{
+		std::memcpy(&result.pixels[static_cast<std::size_t>(y) * static_cast<std::size_t>(result.width)], image.constScanLine(y),
+					static_cast<std::size_t>(result.width) * sizeof(std::uint32_t));
+	}
+	return result;
+}
+
+Rgba8Image downsample(const Rgba8Image & image)
+{
+	const auto width = image.width;
+	const auto height = image.height;
+	Rgba8Image result;
+	result.width = levelSize(width, 1);
+	result.height = levelSize(height, 1);
+	result.pixels.resize(static_cast<std::size_t>(result.width) * static_cast<std::size_t>(result.height));
+	for (int y = 0; y < result.height; ++y)
+	{
+		const auto * row0 = &image.pixels[static_cast<std::size_t>(std::min(2 * y, height - 1)) * static_cast<std::size_t>(width)];
+		const auto * row1 = &image.pixels[static_cast<std::size_t>(std::min(2 * y + 1, height - 1)) * static_cast<std::size_t>(width)];
+		for (int x = 0; x < result.width; ++x)
+		{
+			const auto x0 = std::min(2 * x, width - 1);
+			const auto x1 = std::min(2 * x + 1, width - 1);
+			result.pixels[static_cast<std::size_t>(y) * static_cast<std::size_t>(result.width) + static_cast<std::size_t>(x)] =
+				average(row0[x0], row0[x1], row1[x0], row1[x1]);
+		}
+	}
+	return result;
+}
+
+std::size_t TextureData::bytes() const
+{
+	std::size_t result = 0;
+	for (const auto & level: levels)
+	{
+		result += level.size();
+	}
+	return result;
+}
+
+GLenum glInternalFormat(const TextureFormat format)
+{
+	switch (format)
+	{
+		case TextureFormat::Rgba8:
+			return GL_RGBA8;
+		case TextureFormat::Bc1:
+			return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case TextureFormat::Bc3:
+			return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case TextureFormat::Bc5:
+			return GL_COMPRESSED_RG_RGTC2;
+		case TextureFormat::Bc7:
+			return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		case TextureFormat::Etc2:
+			return GL_COMPRESSED_RGB8_ETC2;
+	}
+	return GL_NONE;
+}
+
+bool isTextureFormatSupported(const TextureFormat format)
+{
+	const auto * context = QOpenGLContext::currentContext();
+	switch (format)
+	{
+		case TextureFormat::Rgba8:
+		case TextureFormat::Bc5:
+			return true;
+		case TextureFormat::Bc1:
+		case TextureFormat::Bc3:
+			return context->hasExtension("GL_EXT_texture_compression_s3tc");
+		case TextureFormat::Bc7:
+			return hasVersion(*context, 4, 2) || context->hasExtension("GL_ARB_texture_compression_bptc");
+		case TextureFormat::Etc2:
+			return hasVersion(*context, 4, 3) || context->hasExtension("GL_ARB_ES3_compatibility");
+	}
+	return false;
+}
+
+GLuint createTexture(QOpenGLFunctions_3_3_Core & gl, const TextureData & data)
+{
+	if (!isTextureFormatSupported(data.format))
+	{
+		qWarning() << "texture format" << textureFormatName(data.format) << "is not supported";
+		return 0;
+	}
+
+	GLuint texture = 0;
+	gl.glGenTextures(1, &texture);
+	gl.glBindTexture(GL_TEXTURE_2D, texture);
+	const auto levelCount = static_cast<int>(data.levels.size());
+	for (int level = 0; level < levelCount; ++level)
+	{
+		const auto width = levelSize(data.width, level);
+		const auto height = levelSize(data.height, level);
+		const auto & bytes = data.levels[static_cast<std::size_t>(level)];
+		if (data.format == TextureFormat::Rgba8)
+		{
+			gl.glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes.data());
+		}
+		else
+		{
+			// Blocks go to driver as they are, no decoding on CPU
+			gl.glCompressedTexImage2D(GL_TEXTURE_2D, level, glInternalFormat(data.format), width, height, 0,
+									  static_cast<GLsizei>(bytes.size()), bytes.data());
+		}
+	}
+	gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, std::max(levelCount - 1, 0));
+	gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl.glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
+
+}// namespace fgl
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace fgl
+{
+
+// Formats of 4x4 blocks except Rgba8.
+enum class TextureFormat
+{
+	Rgba8,
+	// RGB, alpha is ignored
+	Bc1,
+	// BC1 color with BC4 alpha
+	Bc3,
+	// BC4 red and green, for normal maps
+	Bc5,
+	// RGBA, mode 6 only
+	Bc7,
+	// RGB, ETC1 compatible blocks
+	Etc2,
+};
+
+const char * textureFormatName(TextureFormat format);
+std::optional<TextureFormat> parseTextureFormat(const QString & name);
+
+// Bytes of 4x4 block, or of pixel for Rgba8.
+std::size_t blockBytes(TextureFormat format);
+std::size_t levelBytes(TextureFormat format, int width, int height);
+// Channels encoded by format, used for error averaging.
+int channelCount(TextureFormat format);
+
+int levelSize(int size, int level);
+// Levels down to 1x1.
+int fullLevelCount(int width, int height);
+
+// Pixels with red in the lowest byte, rows go from the bottom as OpenGL expects.
+struct Rgba8Image
+{
+	int width = 0;
+	int height = 0;
+	std::vector<std::uint32_t> pixels;
+};
+
+// Decodes image file of any format Qt reads.
+std::optional<Rgba8Image> loadRgba8Image(const QString & path);
+// Box filter to the next level, the last row or column of odd sizes is repeated.
+Rgba8Image downsample(const Rgba8Image & image);
+
+// Mip levels from level 0, all in the same format.
+struct TextureData
+{
+	TextureFormat format = TextureFormat::Rgba8;
+	int width = 0;
+	int height = 0;
+	std::vector<std::vector<std::uint8_t>> levels;
+
+	std::size_t bytes() const;
+};
+
+GLenum glInternalFormat(TextureFormat format);
+// Requires current OpenGL context.
+bool isTextureFormatSupported(TextureFormat format);
+
+// Mipmapped texture with all levels of data, 0 when format is not supported.
+GLuint createTexture(QOpenGLFunctions_3_3_Core & gl, const TextureData & data);
+
+}// namespace fgl
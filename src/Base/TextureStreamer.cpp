@@ -0,0 +1,485 @@
+#include "TextureStreamer.hpp"
+
+#include <Base/Ktx2.hpp>
+
+#include <QDebug>
+#include <QImageReader>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::uint32_t g_placeholderColor = 0xff808080u;
+
+bool isKtx2(const QString & path)
+{
+	return path.endsWith(".ktx2");
+}
+
+}// namespace
+
+TextureStreamer::~TextureStreamer()
+{
+	stopThreads();
+}
+
+void TextureStreamer::create(QOpenGLFunctions_3_3_Core & gl, const TextureStreamerSettings & settings, const std::size_t decodeThreads)
+{
+	gl_ = &gl;
+	settings_ = settings;
+
+	gl_->glGenTextures(1, &placeholder_);
+	gl_->glBindTexture(GL_TEXTURE_2D, placeholder_);
+	gl_->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &g_placeholderColor);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+	gl_->glGenBuffers(static_cast<GLsizei>(pixelBufferCount), pixelBuffers_.data());
+
+	stop_ = false;
+	for (std::size_t i = 0; i < std::max<std::size_t>(decodeThreads, 1u); ++i)
+	{
+		threads_.emplace_back([this] { decodeLoop(); });
+	}
+}
+
+void TextureStreamer::destroy()
+{
+	stopThreads();
+	if (gl_ == nullptr)
+	{
+		return;
+	}
+	for (auto & texture: textures_)
+	{
+		gl_->glDeleteTextures(1, &texture.texture);
+	}
+	gl_->glDeleteTextures(1, &placeholder_);
+	gl_->glDeleteBuffers(static_cast<GLsizei>(pixelBufferCount), pixelBuffers_.data());
+	textures_.clear();
+	requested_.clear();
+	uploads_.clear();
+	decodeQueue_.clear();
+	decoded_.clear();
+	placeholder_ = 0;
+	pixelBuffers_.fill(0);
+	residentBytes_ = 0;
+	loadingBytes_ = 0;
+	pendingDecodes_ = 0;
+	stats_ = {};
+}
+
+void TextureStreamer::stopThreads()
+{
+	{
+		std::lock_guard lock{mutex_};
+		stop_ = true;
+	}
+	wakeUp_.notify_all();
+	for (auto & thread: threads_)
+	{
+		thread.join();
+	}
+	threads_.clear();
+}
+
+TextureStreamer::TextureId TextureStreamer::add(const QString & path)
+{
+	Texture texture;
+	texture.path = path;
+	if (isKtx2(path))
+	{
+		// Levels are read as they are, so there may be fewer of them
+		const auto info = readKtx2Info(path);
+		if (info && isTextureFormatSupported(info->format))
+		{
+			texture.format = info->format;
+			texture.width = info->width;
+			texture.height = info->height;
+			texture.levelCount = info->levelCount;
+		}
+		else
+		{
+			qWarning() << "failed to use" << path;
+			texture.failed = true;
+		}
+	}
+	else
+	{
+		const auto size = QImageReader{path}.size();
+		if (size.isValid() && !size.isEmpty())
+		{
+			texture.width = size.width();
+			texture.height = size.height();
+			texture.levelCount = fullLevelCount(texture.width, texture.height);
+		}
+		else
+		{
+			qWarning() << "failed to read size of" << path;
+			texture.failed = true;
+		}
+	}
+
+	const auto largest = std::max(texture.width, texture.height);
+	while (texture.tailLevel + 1 < texture.levelCount && levelSize(largest, texture.tailLevel) > settings_.tailSize)
+	{
+		++texture.tailLevel;
+	}
+	texture.residentLevel = texture.levelCount;
+	texture.wantedLevel = texture.levelCount;
+	texture.loadingLevel = texture.levelCount;
+	textures_.push_back(texture);
+	return static_cast<TextureId>(textures_.size() - 1);
+}
+
+void TextureStreamer::request(const TextureId id, const float screenPixels)
+{
+	auto & texture = textures_[id];
+	if (texture.failed)
+	{
+		return;
+	}
+	// Finest level still not smaller than the screen size, texture is magnified at most twice
+	const auto largest = static_cast<float>(std::max(texture.width, texture.height));
+	const auto level = std::clamp(static_cast<int>(std::floor(std::log2(largest / std::max(screenPixels, 1.f)))), 0, texture.tailLevel);
+	if (texture.lastUsedFrame != frame_)
+	{
+		texture.lastUsedFrame = frame_;
+		texture.wantedLevel = level;
+		requested_.push_back(id);
+		return;
+	}
+	texture.wantedLevel = std::min(texture.wantedLevel, level);
+}
+
+void TextureStreamer::update()
+{
+	stats_.uploadedBytes = 0;
+	stats_.uploadedLevels = 0;
+	stats_.evictedBytes = 0;
+	stats_.decodesStarted = 0;
+
+	collectDecoded();
+	uploadDecoded();
+	// Budget may have been lowered
+	evict(0);
+	startDecodes();
+
+	stats_.residentBytes = residentBytes_;
+	stats_.pendingDecodes = pendingDecodes_;
+	stats_.residentTextures = static_cast<std::size_t>(std::count_if(textures_.begin(), textures_.end(), [](const Texture & texture) {
+		return texture.residentLevel < texture.levelCount;
+	}));
+	stats_.missingLevels = 0;
+	for (const auto id: requested_)
+	{
+		const auto & texture = textures_[id];
+		stats_.missingLevels += static_cast<std::size_t>(std::max(texture.residentLevel - texture.wantedLevel, 0));
+	}
+	requested_.clear();
+	++frame_;
+}
+
+GLuint TextureStreamer::texture(const TextureId id) const
+{
+	const auto & texture = textures_[id];
+	return texture.residentLevel < texture.levelCount ? texture.texture : placeholder_;
+}
+
+std::size_t TextureStreamer::levelBytes(const Texture & texture, const int level) const
+{
+	return fgl::levelBytes(texture.format, levelSize(texture.width, level), levelSize(texture.height, level));
+}
+
+std::size_t TextureStreamer::levelsBytes(const Texture & texture, const int firstLevel, const int endLevel) const
+{
+	std::size_t bytes = 0;
+	for (auto level = firstLevel; level < endLevel; ++level)
+	{
+		bytes += levelBytes(texture, level);
+	}
+	return bytes;
+}
+
+void TextureStreamer::decodeLevels(Decode & decode)
+{
+	if (isKtx2(decode.path))
+	{
+		auto texture = loadKtx2(decode.path, decode.firstLevel);
+		if (texture && texture->format == decode.format && static_cast<int>(texture->levels.size()) >= decode.endLevel)
+		{
+			for (auto level = decode.firstLevel; level < decode.endLevel; ++level)
+			{
+				decode.levels.push_back(std::move(texture->levels[static_cast<std::size_t>(level)]));
+			}
+		}
+		return;
+	}
+
+	auto image = loadRgba8Image(decode.path);
+	if (!image)
+	{
+		return;
+	}
+	for (int level = 0; level < decode.endLevel; ++level)
+	{
+		if (level >= decode.firstLevel)
+		{
+			const auto * bytes = reinterpret_cast<const std::uint8_t *>(image->pixels.data());
+			decode.levels.emplace_back(bytes, bytes + image->pixels.size() * sizeof(std::uint32_t));
+		}
+		if (level + 1 < decode.endLevel)
+		{
+			image = downsample(*image);
+		}
+	}
+}
+
+void TextureStreamer::decodeLoop()
+{
+	for (;;)
+	{
+		Decode job;
+		{
+			std::unique_lock lock{mutex_};
+			wakeUp_.wait(lock, [&] { return stop_ || !decodeQueue_.empty(); });
+			if (stop_)
+			{
+				return;
+			}
+			job = std::move(decodeQueue_.front());
+			decodeQueue_.pop_front();
+		}
+		decodeLevels(job);
+		std::lock_guard lock{mutex_};
+		decoded_.push_back(std::move(job));
+	}
+}
+
+void TextureStreamer::collectDecoded()
+{
+	std::vector<Decode> decoded;
+	{
+		std::lock_guard lock{mutex_};
+		decoded.swap(decoded_);
+	}
+	for (auto & decode: decoded)
+	{
+		--pendingDecodes_;
+		auto & texture = textures_[decode.id];
+		if (decode.levels.empty())
+		{
+			qWarning() << "failed to decode" << decode.path;
+			texture.failed = true;
+			texture.loadingLevel = texture.levelCount;
+			loadingBytes_ -= decode.reservedBytes;
+			continue;
+		}
+		uploads_.push_back(std::move(decode));
+	}
+}
+
+void TextureStreamer::uploadDecoded()
+{
+	while (!uploads_.empty())
+	{
+		auto & decode = uploads_.front();
+		auto & texture = textures_[decode.id];
+		// Coarse levels first, texture is complete after each of them
+		while (texture.residentLevel > decode.firstLevel)
+		{
+			const auto level = texture.residentLevel - 1;
+			const auto bytes = levelBytes(texture, level);
+			if (stats_.uploadedBytes > 0 && stats_.uploadedBytes + bytes > settings_.uploadBudget)
+			{
+				return;
+			}
+			if (!uploadLevel(texture, level, decode.levels[static_cast<std::size_t>(level - decode.firstLevel)]))
+			{
+				// Rest of decode is dropped, the levels are requested again
+				qWarning() << "failed to upload level" << level << "of" << decode.path;
+				break;
+			}
+			decode.reservedBytes -= bytes;
+			loadingBytes_ -= bytes;
+			stats_.uploadedBytes += bytes;
+			++stats_.uploadedLevels;
+		}
+		loadingBytes_ -= decode.reservedBytes;
+		texture.loadingLevel = texture.levelCount;
+		uploads_.pop_front();
+	}
+}
+
+bool TextureStreamer::uploadLevel(Texture & texture, const int level, const std::vector<std::uint8_t> & bytes)
+{
+	if (texture.texture == 0)
+	{
+		gl_->glGenTextures(1, &texture.texture);
+		gl_->glBindTexture(GL_TEXTURE_2D, texture.texture);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.levelCount - 1);
+	}
+	else
+	{
+		gl_->glBindTexture(GL_TEXTURE_2D, texture.texture);
+	}
+
+	// Orphaned storage lets driver keep copying previous contents of the buffer meanwhile
+	const auto size = static_cast<GLsizeiptr>(bytes.size());
+	gl_->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers_[nextPixelBuffer_]);
+	nextPixelBuffer_ = (nextPixelBuffer_ + 1) % pixelBufferCount;
+	gl_->glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	if (auto * data = gl_->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT))
+	{
+		std::memcpy(data, bytes.data(), bytes.size());
+		// Contents are undefined when unmap fails, e.g. after video memory was lost
+		if (gl_->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+		{
+			gl_->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			gl_->glBindTexture(GL_TEXTURE_2D, 0);
+			return false;
+		}
+	}
+	else
+	{
+		// Mapping may fail when out of memory, driver copies the data then
+		gl_->glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, bytes.data());
+	}
+	const auto width = levelSize(texture.width, level);
+	const auto height = levelSize(texture.height, level);
+	if (texture.format == TextureFormat::Rgba8)
+	{
+		gl_->glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+	else
+	{
+		// Compressed blocks are copied as they are
+		gl_->glCompressedTexImage2D(GL_TEXTURE_2D, level, glInternalFormat(texture.format), width, height, 0, static_cast<GLsizei>(size), nullptr);
+	}
+	gl_->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+	texture.residentLevel = level;
+	residentBytes_ += bytes.size();
+	return true;
+}
+
+void TextureStreamer::dropLevel(Texture & texture)
+{
+	// Empty image releases level storage
+	const auto level = texture.residentLevel;
+	gl_->glBindTexture(GL_TEXTURE_2D, texture.texture);
+	gl_->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+	gl_->glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	gl_->glBindTexture(GL_TEXTURE_2D, 0);
+
+	const auto bytes = levelBytes(texture, level);
+	texture.residentLevel = level + 1;
+	residentBytes_ -= bytes;
+	stats_.evictedBytes += bytes;
+}
+
+bool TextureStreamer::evict(const std::size_t bytes)
+{
+	const auto fits = [&] { return residentBytes_ + loadingBytes_ + bytes <= settings_.memoryBudget; };
+	if (fits())
+	{
+		return true;
+	}
+
+	// Levels of textures being loaded stay, so reserved bytes remain valid
+	evictionCandidates_.clear();
+	for (std::size_t id = 0; id < textures_.size(); ++id)
+	{
+		const auto & texture = textures_[id];
+		if (texture.residentLevel < texture.tailLevel && texture.loadingLevel == texture.levelCount)
+		{
+			evictionCandidates_.push_back(static_cast<TextureId>(id));
+		}
+	}
+	std::sort(evictionCandidates_.begin(), evictionCandidates_.end(),
+			  [&](const TextureId a, const TextureId b) { return textures_[a].lastUsedFrame < textures_[b].lastUsedFrame; });
+
+	// Textures not used this frame lose levels down to the tail, used ones only levels finer
+	// than requested
+	for (const auto id: evictionCandidates_)
+	{
+		auto & texture = textures_[id];
+		const auto keepLevel = texture.lastUsedFrame == frame_ ? texture.wantedLevel : texture.tailLevel;
+		while (!fits() && texture.residentLevel < keepLevel)
+		{
+			dropLevel(texture);
+		}
+		if (fits())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void TextureStreamer::startDecodes()
+{
+	// The most blurred textures first
+	const auto missing = [&](const TextureId id) { return textures_[id].residentLevel - textures_[id].wantedLevel; };
+	std::sort(requested_.begin(), requested_.end(), [&](const TextureId a, const TextureId b) { return missing(a) > missing(b); });
+
+	for (const auto id: requested_)
+	{
+		if (pendingDecodes_ >= settings_.maxPendingDecodes)
+		{
+			break;
+		}
+		auto & texture = textures_[id];
+		if (texture.failed || texture.loadingLevel < texture.levelCount || texture.wantedLevel >= texture.residentLevel)
+		{
+			continue;
+		}
+
+		// Finest level fitting into memory budget, mip tail is loaded in any case
+		const auto coarsestLevel = std::min(texture.residentLevel - 1, texture.tailLevel);
+		auto level = texture.wantedLevel;
+		while (level <= coarsestLevel && !evict(levelsBytes(texture, level, texture.residentLevel)))
+		{
+			++level;
+		}
+		if (level > coarsestLevel)
+		{
+			if (texture.residentLevel < texture.levelCount)
+			{
+				continue;
+			}
+			level = texture.tailLevel;
+		}
+
+		Decode decode;
+		decode.id = id;
+		decode.path = texture.path;
+		decode.format = texture.format;
+		decode.firstLevel = level;
+		decode.endLevel = texture.residentLevel;
+		decode.reservedBytes = levelsBytes(texture, level, texture.residentLevel);
+		texture.loadingLevel = level;
+		loadingBytes_ += decode.reservedBytes;
+		++pendingDecodes_;
+		++stats_.decodesStarted;
+		{
+			std::lock_guard lock{mutex_};
+			decodeQueue_.push_back(std::move(decode));
+		}
+		wakeUp_.notify_one();
+	}
+}
+
+}// namespace fgl
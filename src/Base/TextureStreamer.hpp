@@ -0,0 +1,180 @@
+#pragma once
+
+#include <Base/TextureFormat.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QString>
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fgl
+{
+
+struct TextureStreamerSettings
+{
+	// GPU memory of all streamed mip levels. Mip tails are counted but never evicted.
+	std::size_t memoryBudget = std::size_t{64} << 20u;
+	// Texel bytes uploaded per frame, at least one level is uploaded when anything is pending.
+	std::size_t uploadBudget = std::size_t{4} << 20u;
+	// Levels of this size and smaller form the mip tail loaded with the first request.
+	int tailSize = 32;
+	// Decodes waiting or running at once, further requests wait for the next frames.
+	std::size_t maxPendingDecodes = 8;
+};
+
+// Streams mip levels of image files to GPU as they are needed. Images are decoded to RGBA8
+// and mip levels are built by box filter on decode threads of the streamer, so long decodes
+// never run inside job system waits of a frame. Levels of KTX2 files are read from them as
+// they are, compressed blocks are not decoded. Decoded levels are copied to pixel unpack
+// buffers and uploaded from coarse to fine within per frame byte budget. Texture keeps only
+// levels from GL_TEXTURE_BASE_LEVEL down, so it is complete after each uploaded level and
+// sampling is clamped to resident ones. When memory budget is exceeded, finest levels of
+// least recently used textures are dropped first.
+//
+// Each frame: request() visible textures with their screen size, update(), then draw with
+// texture().
+class TextureStreamer
+{
+public:
+	using TextureId = std::uint32_t;
+
+	struct Stats
+	{
+		std::size_t residentBytes = 0;
+		std::size_t residentTextures = 0;
+		// Values of the last update().
+		std::size_t uploadedBytes = 0;
+		std::size_t uploadedLevels = 0;
+		std::size_t evictedBytes = 0;
+		std::size_t decodesStarted = 0;
+		std::size_t pendingDecodes = 0;
+		// Levels of requested textures finer than resident ones, zero when every request is met.
+		std::size_t missingLevels = 0;
+	};
+
+public:
+	TextureStreamer() = default;
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer &) = delete;
+	TextureStreamer & operator=(const TextureStreamer &) = delete;
+
+	// Requires current OpenGL context, starts decode threads.
+	void create(QOpenGLFunctions_3_3_Core & gl, const TextureStreamerSettings & settings = {}, std::size_t decodeThreads = 2);
+	void destroy();
+
+	void setSettings(const TextureStreamerSettings & settings) { settings_ = settings; }
+	const TextureStreamerSettings & settings() const { return settings_; }
+
+	// Reads image size or KTX2 header only, nothing is decoded until the first request.
+	TextureId add(const QString & path);
+
+	// Texture covers screenPixels pixels along its larger side this frame, levels coarser than
+	// that are enough.
+	void request(TextureId id, float screenPixels);
+
+	// Uploads decoded levels, evicts levels over memory budget and starts decodes of requested
+	// levels. Call once per frame after requests and before drawing.
+	void update();
+
+	// Texture with resident levels or 1x1 gray placeholder.
+	GLuint texture(TextureId id) const;
+	// Finest resident and wanted levels, level count when none.
+	int residentLevel(const TextureId id) const { return textures_[id].residentLevel; }
+	int wantedLevel(const TextureId id) const { return textures_[id].wantedLevel; }
+	int levelCount(const TextureId id) const { return textures_[id].levelCount; }
+
+	std::size_t textureCount() const { return textures_.size(); }
+	const Stats & stats() const { return stats_; }
+
+private:
+	static constexpr std::size_t pixelBufferCount = 4;
+
+	struct Texture
+	{
+		QString path;
+		TextureFormat format = TextureFormat::Rgba8;
+		int width = 1;
+		int height = 1;
+		int levelCount = 1;
+		// Levels from tailLevel down are loaded together and never evicted.
+		int tailLevel = 0;
+		GLuint texture = 0;
+		int residentLevel = 1;
+		// Finest level requested this frame.
+		int wantedLevel = 1;
+		// Finest level being decoded or waiting for upload.
+		int loadingLevel = 1;
+		std::uint64_t lastUsedFrame = 0;
+		bool failed = false;
+	};
+
+	struct Decode
+	{
+		TextureId id = 0;
+		QString path;
+		TextureFormat format = TextureFormat::Rgba8;
+		// Decoded levels are [firstLevel, endLevel), coarser ones are already resident.
+		int firstLevel = 0;
+		int endLevel = 0;
+		// Memory budget taken by levels not uploaded yet.
+		std::size_t reservedBytes = 0;
+		// Data of levels from firstLevel, empty when decoding failed.
+		std::vector<std::vector<std::uint8_t>> levels;
+	};
+
+private:
+	static void decodeLevels(Decode & decode);
+	void decodeLoop();
+	void stopThreads();
+
+	std::size_t levelBytes(const Texture & texture, int level) const;
+	std::size_t levelsBytes(const Texture & texture, int firstLevel, int endLevel) const;
+
+	void collectDecoded();
+	void uploadDecoded();
+	// Returns false when pixel buffer contents were lost, level is not resident then.
+	bool uploadLevel(Texture & texture, int level, const std::vector<std::uint8_t> & bytes);
+	void dropLevel(Texture & texture);
+	// Drops levels until bytes more fit into memory budget, unused textures go first, then
+	// levels finer than requested. Returns whether they fit.
+	bool evict(std::size_t bytes);
+	void startDecodes();
+
+private:
+	QOpenGLFunctions_3_3_Core * gl_ = nullptr;
+	TextureStreamerSettings settings_;
+
+	std::vector<Texture> textures_;
+	std::vector<TextureId> requested_;
+	std::vector<TextureId> evictionCandidates_;
+	std::uint64_t frame_ = 1;
+	std::size_t residentBytes_ = 0;
+	// Bytes of levels being decoded or waiting for upload and not resident yet.
+	std::size_t loadingBytes_ = 0;
+	std::size_t pendingDecodes_ = 0;
+
+	GLuint placeholder_ = 0;
+	std::array<GLuint, pixelBufferCount> pixelBuffers_{};
+	std::size_t nextPixelBuffer_ = 0;
+	// Decoded levels partially uploaded, in order of completion.
+	std::deque<Decode> uploads_;
+
+	std::vector<std::thread> threads_;
+	std::mutex mutex_;
+	std::condition_variable wakeUp_;
+	std::deque<Decode> decodeQueue_;
+	std::vector<Decode> decoded_;
+	bool stop_ = false;
+
+	Stats stats_;
+};
+
+}// namespace fgl
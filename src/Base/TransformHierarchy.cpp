@@ -0,0 +1,278 @@
+#include "TransformHierarchy.hpp"
+
+#include <Base/ParallelFor.hpp>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+constexpr std::uint32_t g_noIndex = std::numeric_limits<std::uint32_t>::max();
+// Smaller updates are not worth waking worker threads.
+constexpr std::size_t g_minParallelNodes = 8192;
+constexpr std::size_t g_rangesPerWorker = 4;
+
+}// namespace
+
+void TransformHierarchy::reserve(const std::size_t count)
+{
+	local_.reserve(count);
+	world_.reserve(count);
+	parent_.reserve(count);
+	subtreeEnd_.reserve(count);
+	dirty_.reserve(count);
+	nodeOf_.reserve(count);
+	indexOf_.reserve(count);
+}
+
+TransformHierarchy::Node TransformHierarchy::add(const glm::mat4 & local, const Node parent)
+{
+	const auto node = static_cast<Node>(local_.size());
+	const auto index = static_cast<std::uint32_t>(local_.size());
+	const auto parentIndex = parent == none ? g_noIndex : indexOf_[parent];
+
+	local_.push_back(local);
+	world_.push_back(local);
+	parent_.push_back(parentIndex);
+	subtreeEnd_.push_back(index + 1);
+	dirty_.push_back(1u);
+	nodeOf_.push_back(node);
+	indexOf_.push_back(index);
+	dirtyIndices_.push_back(index);
+
+	if (parentIndex == g_noIndex || orderDirty_)
+	{
+		return node;
+	}
+	if (subtreeEnd_[parentIndex] != index)
+	{
+		// Parent subtree is not the last one, appended node breaks contiguous subtrees
+		orderDirty_ = true;
+		return node;
+	}
+	// All ancestors end where parent subtree ends
+	for (auto ancestor = parentIndex; ancestor != g_noIndex; ancestor = parent_[ancestor])
+	{
+		subtreeEnd_[ancestor] = index + 1;
+	}
+	return node;
+}
+
+void TransformHierarchy::setLocal(const Node node, const glm::mat4 & local)
+{
+	const auto index = indexOf_[node];
+	local_[index] = local;
+	if (dirty_[index] == 0u)
+	{
+		dirty_[index] = 1u;
+		dirtyIndices_.push_back(index);
+	}
+}
+
+TransformHierarchy::Node TransformHierarchy::parent(const Node node) const
+{
+	const auto parentIndex = parent_[indexOf_[node]];
+	return parentIndex == g_noIndex ? none : nodeOf_[parentIndex];
+}
+
+void TransformHierarchy::sortDepthFirst()
+{
+	const auto count = static_cast<std::uint32_t>(local_.size());
+
+	// Children lists keeping current order of siblings
+	std::vector<std::uint32_t> firstChild(count, g_noIndex);
+	std::vector<std::uint32_t> nextSibling(count, g_noIndex);
+	for (auto index = count; index-- > 0;)
+	{
+		const auto parent = parent_[index];
+		if (parent != g_noIndex)
+		{
+			nextSibling[index] = firstChild[parent];
+			firstChild[parent] = index;
+		}
+	}
+
+	// Preorder traversal of every root without explicit stack
+	std::vector<std::uint32_t> newIndex(count);
+	std::uint32_t position = 0;
+	for (std::uint32_t root = 0; root < count; ++root)
+	{
+		if (parent_[root] != g_noIndex)
+		{
+			continue;
+		}
+		auto index = root;
+		while (true)
+		{
+			newIndex[index] = position++;
+			if (firstChild[index] != g_noIndex)
+			{
+				index = firstChild[index];
+				continue;
+			}
+			while (index != root && nextSibling[index] == g_noIndex)
+			{
+				index = parent_[index];
+			}
+			if (index == root)
+			{
+				break;
+			}
+			index = nextSibling[index];
+		}
+	}
+
+	const auto permute = [&](auto & values) {
+		auto sorted = values;
+		for (std::uint32_t index = 0; index < count; ++index)
+		{
+			sorted[newIndex[index]] = values[index];
+		}
+		values.swap(sorted);
+	};
+	permute(local_);
+	permute(world_);
+	permute(dirty_);
+	permute(nodeOf_);
+
+	std::vector<std::uint32_t> parents(count);
+	for (std::uint32_t index = 0; index < count; ++index)
+	{
+		parents[newIndex[index]] = parent_[index] == g_noIndex ? g_noIndex : newIndex[parent_[index]];
+	}
+	parent_.swap(parents);
+
+	for (std::uint32_t index = 0; index < count; ++index)
+	{
+		subtreeEnd_[index] = index + 1;
+		indexOf_[nodeOf_[index]] = index;
+	}
+	for (auto index = count; index-- > 0;)
+	{
+		if (parent_[index] != g_noIndex)
+		{
+			subtreeEnd_[parent_[index]] = std::max(subtreeEnd_[parent_[index]], subtreeEnd_[index]);
+		}
+	}
+
+	for (auto & index: dirtyIndices_)
+	{
+		index = newIndex[index];
+	}
+	orderDirty_ = false;
+}
+
+void TransformHierarchy::computeWorld(const std::uint32_t index)
+{
+	const auto parent = parent_[index];
+	world_[index] = parent == g_noIndex ? local_[index] : world_[parent] * local_[index];
+}
+
+void TransformHierarchy::update(const bool parallel)
+{
+	if (orderDirty_)
+	{
+		sortDepthFirst();
+	}
+
+	// Dirty nodes inside already collected subtrees are covered by them
+	ranges_.clear();
+	std::sort(dirtyIndices_.begin(), dirtyIndices_.end());
+	std::uint32_t covered = 0;
+	std::size_t changedCount = 0;
+	for (const auto index: dirtyIndices_)
+	{
+		dirty_[index] = 0u;
+		if (index >= covered)
+		{
+			ranges_.push_back({index, subtreeEnd_[index]});
+			covered = subtreeEnd_[index];
+			changedCount += covered - index;
+		}
+	}
+	dirtyIndices_.clear();
+
+	// Big subtrees are split into subtrees of children after computing their roots serially
+	changedNodes_.clear();
+	changedWorlds_.clear();
+	const auto runParallel = parallel && changedCount >= g_minParallelNodes && workerCount() > 1;
+	while (runParallel && ranges_.size() < workerCount() * g_rangesPerWorker)
+	{
+		const auto largest = std::max_element(ranges_.begin(), ranges_.end(), [](const auto & a, const auto & b) {
+			return a.end - a.begin < b.end - b.begin;
+		});
+		if (largest->end - largest->begin < g_minParallelNodes / g_rangesPerWorker)
+		{
+			break;
+		}
+		const auto root = *largest;
+		computeWorld(root.begin);
+		changedNodes_.push_back(nodeOf_[root.begin]);
+		changedWorlds_.push_back(world_[root.begin]);
+
+		std::vector<Range> children;
+		for (auto child = root.begin + 1; child < root.end; child = subtreeEnd_[child])
+		{
+			children.push_back({child, subtreeEnd_[child]});
+		}
+		const auto position = ranges_.erase(largest);
+		ranges_.insert(position, children.begin(), children.end());
+	}
+
+	// Every range writes its own slice of changed list
+	rangeOffsets_.resize(ranges_.size());
+	auto offset = changedNodes_.size();
+	for (std::size_t i = 0; i < ranges_.size(); ++i)
+	{
+		rangeOffsets_[i] = offset;
+		offset += ranges_[i].end - ranges_[i].begin;
+	}
+	changedNodes_.resize(offset);
+	changedWorlds_.resize(offset);
+
+	const auto updateRanges = [&](const std::size_t begin, const std::size_t end) {
+		for (auto range = begin; range < end; ++range)
+		{
+			auto output = rangeOffsets_[range];
+			for (auto index = ranges_[range].begin; index < ranges_[range].end; ++index, ++output)
+			{
+				computeWorld(index);
+				changedNodes_[output] = nodeOf_[index];
+				changedWorlds_[output] = world_[index];
+			}
+		}
+	};
+	if (runParallel)
+	{
+		parallelFor(ranges_.size(), 1, updateRanges);
+	}
+	else
+	{
+		updateRanges(0, ranges_.size());
+	}
+}
+
+void TransformHierarchy::updateAll()
+{
+	if (orderDirty_)
+	{
+		sortDepthFirst();
+	}
+	for (const auto index: dirtyIndices_)
+	{
+		dirty_[index] = 0u;
+	}
+	dirtyIndices_.clear();
+
+	for (std::uint32_t index = 0; index < local_.size(); ++index)
+	{
+		computeWorld(index);
+	}
+	changedNodes_ = nodeOf_;
+	changedWorlds_ = world_;
+}
+
+}// namespace fgl
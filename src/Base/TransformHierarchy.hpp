@@ -0,0 +1,79 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace fgl
+{
+
+// Transform hierarchy with local and world matrices in structure of arrays layout. Nodes
+// are kept in depth first order, so parents precede children and every subtree is a
+// contiguous range. Only subtrees of nodes with changed local matrices are recomputed,
+// and world matrices changed by an update are gathered into a compact list for upload.
+class TransformHierarchy
+{
+public:
+	// Stable node handle, nodes are numbered in order of creation.
+	using Node = std::uint32_t;
+	static constexpr Node none = std::numeric_limits<Node>::max();
+
+public:
+	void reserve(std::size_t count);
+	std::size_t size() const { return local_.size(); }
+
+	// Parent must already exist. Adding into the middle of hierarchy makes next update
+	// restore depth first order.
+	Node add(const glm::mat4 & local, Node parent = none);
+
+	void setLocal(Node node, const glm::mat4 & local);
+	const glm::mat4 & local(Node node) const { return local_[indexOf_[node]]; }
+	// Valid after update.
+	const glm::mat4 & world(Node node) const { return world_[indexOf_[node]]; }
+	Node parent(Node node) const;
+
+	// Recomputes world matrices of dirty subtrees, in parallel when there are several
+	// big independent ones.
+	void update(bool parallel = true);
+
+	// Recomputes every world matrix, for comparison with incremental update.
+	void updateAll();
+
+	// Nodes with world matrices changed by the last update and the matrices packed in the same order.
+	const std::vector<Node> & changedNodes() const { return changedNodes_; }
+	const std::vector<glm::mat4> & changedWorlds() const { return changedWorlds_; }
+
+private:
+	struct Range
+	{
+		std::uint32_t begin;
+		std::uint32_t end;
+	};
+
+private:
+	void sortDepthFirst();
+	void computeWorld(std::uint32_t index);
+
+private:
+	// Arrays indexed by position in depth first order.
+	std::vector<glm::mat4> local_;
+	std::vector<glm::mat4> world_;
+	std::vector<std::uint32_t> parent_;
+	// One past the last descendant.
+	std::vector<std::uint32_t> subtreeEnd_;
+	std::vector<std::uint8_t> dirty_;
+	std::vector<Node> nodeOf_;
+
+	std::vector<std::uint32_t> indexOf_;
+	std::vector<std::uint32_t> dirtyIndices_;
+	bool orderDirty_ = false;
+
+	std::vector<Range> ranges_;
+	std::vector<std::size_t> rangeOffsets_;
+	std::vector<Node> changedNodes_;
+	std::vector<glm::mat4> changedWorlds_;
+};
+
+}// namespace fgl
@@ -0,0 +1,87 @@
+#include "VertexFormat.hpp"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace fgl
+{
+
+namespace
+{
+
+GLint floatComponents(const GLenum type)
+{
+	switch (type)
+	{
+		case GL_FLOAT:
+			return 1;
+		case GL_FLOAT_VEC2:
+			return 2;
+		case GL_FLOAT_VEC3:
+			return 3;
+		case GL_FLOAT_VEC4:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+}// namespace
+
+VertexFormat & VertexFormat::add(std::string name, const GLint components)
+{
+	attributes_.push_back(Attribute{std::move(name), components, static_cast<std::uint32_t>(stride_)});
+	stride_ += static_cast<GLsizei>(components * sizeof(GLfloat));
+	return *this;
+}
+
+VertexFormat::Bindings VertexFormat::bind(const ShaderReflection & reflection) const
+{
+	Bindings bindings;
+	for (const auto & attribute: attributes_)
+	{
+		const auto * input = reflection.findAttribute(attribute.name);
+		bindings.push_back(input != nullptr ? input->location : -1);
+	}
+
+	// Inputs without data read constant defaults, which is always a mistake here
+	for (const auto & input: reflection.attributes())
+	{
+		const auto attribute = std::find_if(attributes_.begin(), attributes_.end(), [&](const Attribute & candidate) {
+			return candidate.name == input.name;
+		});
+		if (attribute == attributes_.end())
+		{
+			qWarning() << "program" << reflection.program() << "input" << input.name.c_str() << "is missing in vertex format";
+		}
+		else if (floatComponents(input.type) == 0)
+		{
+			qWarning() << "program" << reflection.program() << "input" << input.name.c_str() << "of type"
+					   << shaderTypeName(input.type) << "is not float";
+		}
+		else if (floatComponents(input.type) > attribute->components)
+		{
+			qWarning() << "program" << reflection.program() << "input" << input.name.c_str() << "of type"
+					   << shaderTypeName(input.type) << "is wider than" << attribute->components << "components of vertex format";
+		}
+	}
+	return bindings;
+}
+
+void VertexFormat::apply(QOpenGLFunctions_3_3_Core & gl, const Bindings & bindings) const
+{
+	for (std::size_t i = 0; i < attributes_.size(); ++i)
+	{
+		if (bindings[i] < 0)
+		{
+			continue;
+		}
+		const auto location = static_cast<GLuint>(bindings[i]);
+		gl.glEnableVertexAttribArray(location);
+		gl.glVertexAttribPointer(location, attributes_[i].components, GL_FLOAT, GL_FALSE, stride_,
+								 reinterpret_cast<const void *>(static_cast<std::uintptr_t>(attributes_[i].offset)));
+	}
+}
+
+}// namespace fgl
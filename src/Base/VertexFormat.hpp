@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Base/ShaderReflection.hpp>
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fgl
+{
+
+// Interleaved float vertex attributes named as shader inputs. Shaders need no explicit
+// locations, formats are bound against reflected programs at load time.
+class VertexFormat
+{
+public:
+	struct Attribute
+	{
+		std::string name;
+		GLint components;
+		std::uint32_t offset;
+	};
+
+	// Locations of format attributes in a program, -1 for attributes program does not use.
+	using Bindings = std::vector<GLint>;
+
+public:
+	// Appends attribute after previous ones.
+	VertexFormat & add(std::string name, GLint components);
+
+	const std::vector<Attribute> & attributes() const { return attributes_; }
+	GLsizei stride() const { return stride_; }
+
+	// Program inputs missing in format or of other size are reported.
+	Bindings bind(const ShaderReflection & reflection) const;
+	// Sets up attribute pointers of bound vertex array to bound array buffer.
+	void apply(QOpenGLFunctions_3_3_Core & gl, const Bindings & bindings) const;
+
+private:
+	std::vector<Attribute> attributes_;
+	GLsizei stride_ = 0;
+};
+
+}// namespace fgl
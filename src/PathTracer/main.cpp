@@ -0,0 +1,208 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QImage>
+
+#include <Base/JobSystem.hpp>
+#include <Base/MeshPrimitives.hpp>
+#include <Base/ObjLoader.hpp>
+#include <Base/ParallelFor.hpp>
+#include <Base/PathTracer.hpp>
+#include <Base/RayTracingScene.hpp>
+#include <Base/Simd.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr auto g_fovY = glm::radians(50.f);
+constexpr auto g_gridSize = 5;
+// Samples per pixel rendered for each thread count of scaling measurement.
+constexpr std::size_t g_scalingSamples = 4;
+
+double elapsedMs(const QElapsedTimer & timer) { return static_cast<double>(timer.nsecsElapsed()) / 1e6; }
+
+// Ground with a grid of the same primitives other scenes use, or the model standing on
+// the ground instead of them.
+void makeScene(const QString & modelPath, fgl::RayTracingScene & scene)
+{
+	scene.add(fgl::makeBox(glm::vec3{60.f, 0.5f, 60.f}, glm::vec3{0.6f}), glm::translate(glm::mat4{1.f}, glm::vec3{0.f, -0.5f, 0.f}));
+
+	if (!modelPath.isEmpty())
+	{
+		auto model = fgl::loadObj(modelPath, glm::vec3{0.8f, 0.6f, 0.4f});
+		if (model)
+		{
+			// Fit model into 8 units cube standing on the ground
+			const auto box = fgl::computeAabb(*model);
+			const auto size = box.max - box.min;
+			const auto scale = 8.f / std::max(size.x, std::max(size.y, size.z));
+			const glm::vec3 offset{-box.center().x, -box.min.y, -box.center().z};
+			scene.add(*model, glm::translate(glm::scale(glm::mat4{1.f}, glm::vec3{scale}), offset));
+			return;
+		}
+		qWarning() << "failed to load" << modelPath << "using generated scene";
+	}
+
+	std::mt19937 random{11};
+	std::uniform_real_distribution<float> unit{0.f, 1.f};
+	for (int x = 0; x < g_gridSize; ++x)
+	{
+		for (int z = 0; z < g_gridSize; ++z)
+		{
+			const glm::vec3 color{0.2f + 0.7f * unit(random), 0.2f + 0.7f * unit(random), 0.2f + 0.7f * unit(random)};
+			fgl::Mesh mesh;
+			switch ((x + z) % 3)
+			{
+				case 0:
+					mesh = fgl::makeIcosphere(3, color);
+					break;
+				case 1:
+					mesh = fgl::makeTorus(0.7f, 0.3f, 48, 24, color);
+					break;
+				default:
+					mesh = fgl::makeBox(glm::vec3{0.4f + 0.4f * unit(random), 0.5f + unit(random), 0.4f + 0.4f * unit(random)}, color);
+					break;
+			}
+			// Rotation is around vertical axis, so lowest point stays the same
+			const glm::vec3 position{(static_cast<float>(x) - (g_gridSize - 1) * 0.5f) * 3.f, -fgl::computeAabb(mesh).min.y,
+									 (static_cast<float>(z) - (g_gridSize - 1) * 0.5f) * 3.f};
+			scene.add(mesh, glm::rotate(glm::translate(glm::mat4{1.f}, position), 6.28f * unit(random), glm::vec3{0.f, 1.f, 0.f}));
+		}
+	}
+}
+
+bool save(const fgl::PathTracer & tracer, const QString & path)
+{
+	const auto pixels = tracer.resolve();
+	const QImage image{reinterpret_cast<const uchar *>(pixels.data()), static_cast<int>(tracer.width()),
+					   static_cast<int>(tracer.height()), static_cast<int>(tracer.width() * sizeof(std::uint32_t)),
+					   QImage::Format_RGBA8888};
+	return image.save(path);
+}
+
+// Renders a few samples with job systems of growing thread count.
+void measureScaling(fgl::PathTracer & tracer)
+{
+	std::vector<std::size_t> threadCounts;
+	for (std::size_t threads = 1; threads < fgl::workerCount(); threads *= 2)
+	{
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(fgl::workerCount());
+
+	double singleRaysPerMs = 0.;
+	for (const auto threads: threadCounts)
+	{
+		fgl::JobSystem jobs{threads};
+		tracer.reset();
+		std::uint64_t rays = 0;
+		QElapsedTimer timer;
+		timer.start();
+		for (std::size_t sample = 0; sample < g_scalingSamples; ++sample)
+		{
+			tracer.renderSample(jobs);
+			rays += tracer.rayCount();
+		}
+		const auto raysPerMs = static_cast<double>(rays) / elapsedMs(timer);
+		if (threads == 1)
+		{
+			singleRaysPerMs = raysPerMs;
+		}
+		const auto speedup = raysPerMs / singleRaysPerMs;
+		qInfo().noquote() << QString{"%1 threads: %2 M rays/s, x%3 of single thread, efficiency %4%"}
+								 .arg(threads)
+								 .arg(raysPerMs / 1e3, 0, 'f', 2)
+								 .arg(speedup, 0, 'f', 2)
+								 .arg(100. * speedup / static_cast<double>(threads), 0, 'f', 0);
+	}
+	tracer.reset();
+}
+
+}// namespace
+
+int main(int argc, char ** argv)
+{
+	QCoreApplication app{argc, argv};
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("CPU path tracer rendering reference images without GPU");
+	parser.addHelpOption();
+	const QCommandLineOption modelOption{"model", "OBJ model to render instead of generated scene.", "path"};
+	const QCommandLineOption widthOption{"width", "Image width.", "pixels", "640"};
+	const QCommandLineOption heightOption{"height", "Image height.", "pixels", "480"};
+	const QCommandLineOption samplesOption{"samples", "Samples per pixel.", "count", "64"};
+	const QCommandLineOption bouncesOption{"bounces", "Maximum diffuse bounces.", "count", "4"};
+	const QCommandLineOption outputOption{"output", "Image path, rewritten every time sample count doubles.", "path", "path-traced.png"};
+	const QCommandLineOption scalingOption{"scaling", "Measure rays per second with growing thread count before rendering."};
+	parser.addOption(modelOption);
+	parser.addOption(widthOption);
+	parser.addOption(heightOption);
+	parser.addOption(samplesOption);
+	parser.addOption(bouncesOption);
+	parser.addOption(outputOption);
+	parser.addOption(scalingOption);
+	parser.process(app);
+
+	const auto width = static_cast<std::size_t>(std::max(parser.value(widthOption).toInt(), 1));
+	const auto height = static_cast<std::size_t>(std::max(parser.value(heightOption).toInt(), 1));
+	const auto samples = static_cast<std::size_t>(std::max(parser.value(samplesOption).toInt(), 1));
+	const auto output = parser.value(outputOption);
+
+	QElapsedTimer timer;
+	timer.start();
+	fgl::RayTracingScene scene;
+	makeScene(parser.value(modelOption), scene);
+	scene.build();
+	qInfo().noquote() << QString{"%1 triangles, BVH with %2 nodes built in %3 ms, SIMD width %4, workers %5"}
+							 .arg(scene.triangleCount())
+							 .arg(scene.bvh().nodes().size())
+							 .arg(elapsedMs(timer), 0, 'f', 1)
+							 .arg(fgl::simd::width)
+							 .arg(fgl::workerCount());
+
+	fgl::PathTracer tracer{scene, width, height};
+	fgl::PathTracerSettings settings;
+	settings.maxBounces = static_cast<std::size_t>(std::max(parser.value(bouncesOption).toInt(), 0));
+	tracer.setSettings(settings);
+	const auto aspect = static_cast<float>(width) / static_cast<float>(height);
+	tracer.setCamera(glm::lookAt(glm::vec3{0.f, 7.f, 16.f}, glm::vec3{0.f, 1.f, 0.f}, glm::vec3{0.f, 1.f, 0.f}),
+					 glm::perspective(g_fovY, aspect, 0.1f, 100.f));
+
+	if (parser.isSet(scalingOption))
+	{
+		measureScaling(tracer);
+	}
+
+	// Progressive rendering, image converges as samples accumulate
+	std::uint64_t rays = 0;
+	double renderMs = 0.;
+	for (std::size_t sample = 1; sample <= samples; ++sample)
+	{
+		timer.restart();
+		tracer.renderSample();
+		renderMs += elapsedMs(timer);
+		rays += tracer.rayCount();
+		if ((sample & (sample - 1)) != 0 && sample != samples)
+		{
+			continue;
+		}
+		qInfo().noquote() << QString{"%1 samples per pixel: %2 s, %3 M rays/s"}
+								 .arg(sample)
+								 .arg(renderMs / 1e3, 0, 'f', 2)
+								 .arg(static_cast<double>(rays) / renderMs / 1e3, 0, 'f', 2);
+		if (!save(tracer, output))
+		{
+			qWarning() << "failed to save" << output;
+			return 1;
+		}
+	}
+	qInfo() << "saved" << output;
+	return 0;
+}
@@ -0,0 +1,152 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+#include <Base/Ktx2.hpp>
+#include <Base/ParallelFor.hpp>
+#include <Base/TextureCompression.hpp>
+
+#include <cmath>
+
+namespace
+{
+
+constexpr auto g_megabyte = 1024. * 1024.;
+
+double megabytes(const std::size_t bytes) { return static_cast<double>(bytes) / g_megabyte; }
+
+// Block padding makes levels narrower than a block grow, tiny images may grow as a whole.
+QString savedText(const std::size_t uncompressed, const std::size_t compressed)
+{
+	const auto saved = megabytes(uncompressed) - megabytes(compressed);
+	const auto percent = uncompressed > 0 ? 100. * saved / megabytes(uncompressed) : 0.;
+	if (compressed >= uncompressed)
+	{
+		return QString{"grew %1 MB (%2%)"}.arg(-saved, 0, 'f', 2).arg(-percent, 0, 'f', 0);
+	}
+	return QString{"saved %1 MB (%2%)"}.arg(saved, 0, 'f', 2).arg(percent, 0, 'f', 0);
+}
+
+double psnr(const double squaredError, const double samples)
+{
+	return squaredError > 0. ? 10. * std::log10(255. * 255. * samples / squaredError) : 99.;
+}
+
+}// namespace
+
+int main(int argc, char ** argv)
+{
+	QCoreApplication app{argc, argv};
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Encodes images with mip levels into block compressed KTX2 textures");
+	parser.addHelpOption();
+	parser.addPositionalArgument("images", "Images to encode, any format Qt reads.", "<images...>");
+	const QCommandLineOption formatOption{"format", "Block format: bc1 (RGB), bc3 (RGBA), bc5 (RG normal maps), bc7 (RGBA), etc2 (RGB).",
+										  "format", "bc7"};
+	const QCommandLineOption presetOption{"preset", "Encoder preset: fast or quality.", "preset", "quality"};
+	const QCommandLineOption outputOption{"output", "Directory of KTX2 files, the one of each image by default.", "directory"};
+	const QCommandLineOption noMipmapsOption{"no-mipmaps", "Encode the first level only."};
+	parser.addOption(formatOption);
+	parser.addOption(presetOption);
+	parser.addOption(outputOption);
+	parser.addOption(noMipmapsOption);
+	parser.process(app);
+
+	const auto format = fgl::parseTextureFormat(parser.value(formatOption));
+	const auto preset = fgl::parseEncoderPreset(parser.value(presetOption));
+	const auto images = parser.positionalArguments();
+	if (!format || *format == fgl::TextureFormat::Rgba8 || !preset || images.isEmpty())
+	{
+		parser.showHelp(1);
+	}
+	if (parser.isSet(outputOption))
+	{
+		QDir{}.mkpath(parser.value(outputOption));
+	}
+
+	std::size_t totalUncompressed = 0;
+	std::size_t totalCompressed = 0;
+	double totalPixels = 0.;
+	double totalMs = 0.;
+	auto failed = false;
+	for (const auto & image: images)
+	{
+		const QFileInfo info{image};
+		const auto output = QDir{parser.isSet(outputOption) ? parser.value(outputOption) : info.path()}.filePath(info.completeBaseName() + ".ktx2");
+		auto level = fgl::loadRgba8Image(image);
+		if (!level)
+		{
+			qWarning() << "failed to load" << image;
+			failed = true;
+			continue;
+		}
+
+		fgl::TextureData texture;
+		texture.format = *format;
+		texture.width = level->width;
+		texture.height = level->height;
+		const auto levelCount = parser.isSet(noMipmapsOption) ? 1 : fgl::fullLevelCount(level->width, level->height);
+		std::size_t uncompressed = 0;
+		double pixels = 0.;
+		double squaredError = 0.;
+		QElapsedTimer timer;
+		timer.start();
+		for (int i = 0; i < levelCount; ++i)
+		{
+			auto encoded = fgl::encode(*level, *format, *preset);
+			uncompressed += fgl::levelBytes(fgl::TextureFormat::Rgba8, level->width, level->height);
+			pixels += static_cast<double>(level->width) * static_cast<double>(level->height);
+			// Error of the first level, the one seen close up
+			if (i == 0)
+			{
+				squaredError = encoded.squaredError;
+			}
+			texture.levels.push_back(std::move(encoded.bytes));
+			if (i + 1 < levelCount)
+			{
+				level = fgl::downsample(*level);
+			}
+		}
+		const auto ms = static_cast<double>(timer.nsecsElapsed()) / 1e6;
+		if (!fgl::saveKtx2(output, texture))
+		{
+			failed = true;
+			continue;
+		}
+
+		const auto compressed = texture.bytes();
+		const auto blocks = static_cast<double>(fgl::levelBytes(*format, texture.width, texture.height) / fgl::blockBytes(*format));
+		qInfo().noquote() << QString{"%1: %2x%3, %4 levels in %5 ms, %6 MB -> %7 MB, %8, PSNR %9 dB"}
+								 .arg(output)
+								 .arg(texture.width)
+								 .arg(texture.height)
+								 .arg(levelCount)
+								 .arg(ms, 0, 'f', 1)
+								 .arg(megabytes(uncompressed), 0, 'f', 2)
+								 .arg(megabytes(compressed), 0, 'f', 2)
+								 .arg(savedText(uncompressed, compressed))
+								 .arg(psnr(squaredError, blocks * 16. * fgl::channelCount(*format)), 0, 'f', 2);
+		totalUncompressed += uncompressed;
+		totalCompressed += compressed;
+		totalPixels += pixels;
+		totalMs += ms;
+	}
+
+	if (totalUncompressed > 0)
+	{
+		qInfo().noquote() << QString{"%1 %2 with %3 preset: %4 MB of RGBA8 -> %5 MB, %6, %7 Mpixels/s on %8 workers"}
+								 .arg(images.size())
+								 .arg(fgl::textureFormatName(*format))
+								 .arg(fgl::encoderPresetName(*preset))
+								 .arg(megabytes(totalUncompressed), 0, 'f', 2)
+								 .arg(megabytes(totalCompressed), 0, 'f', 2)
+								 .arg(savedText(totalUncompressed, totalCompressed))
+								 .arg(totalPixels / totalMs / 1e3, 0, 'f', 2)
+								 .arg(fgl::workerCount());
+	}
+	return failed ? 1 : 0;
+}